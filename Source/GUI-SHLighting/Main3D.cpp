@@ -328,17 +328,25 @@ void Main3DApp::mFunction_SHPreprocess_SphericalMap(int shOrder, int monteCarloS
 
 	uint32_t width = m_pShTex->GetWidth();
 	uint32_t height = m_pShTex->GetHeight();
-	std::vector<Color4u> colorBuff(width*height);
+	std::vector<Vec3> dirList(width*height);
 	for (int y = 0; y < height; ++y)
 	{
 		for (int x = 0; x < width; ++x)
 		{
-			Vec3 dir = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
-			Vec3 reconstructedColor = mShvec.Eval(dir);
-			Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
-			colorBuff.at(y*width + x) = color;
+			dirList.at(y*width + x) = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
 		}
 	}
+
+	//reconstruct all pixels at once (batch SH evaluation)
+	std::vector<Color4f> reconstructedColorList;
+	mShvec.Eval(dirList, reconstructedColorList);
+	std::vector<Color4u> colorBuff(width*height);
+	for (int i = 0; i < width*height; ++i)
+	{
+		const Color4f& reconstructedColor = reconstructedColorList.at(i);
+		Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
+		colorBuff.at(i) = color;
+	}
 	m_pShTex->SetPixelArray(colorBuff);
 	m_pShTex->UpdateToVideoMemory();
 }
@@ -353,17 +361,25 @@ void Main3DApp::mFunction_SHPreprocess_CubeMap(int shOrder, int monteCarloSample
 
 	uint32_t width = m_pShTex->GetWidth();
 	uint32_t height = m_pShTex->GetHeight();
-	std::vector<Color4u> colorBuff(width*height);
+	std::vector<Vec3> dirList(width*height);
 	for (int y = 0; y < height; ++y)
 	{
 		for (int x = 0; x < width; ++x)
 		{
-			Vec3 dir = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
-			Color4f reconstructedColor = mShvec.Eval(dir);
-			Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
-			colorBuff.at(y*width + x) = color;
+			dirList.at(y*width + x) = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
 		}
 	}
+
+	//reconstruct all pixels at once (batch SH evaluation)
+	std::vector<Color4f> reconstructedColorList;
+	mShvec.Eval(dirList, reconstructedColorList);
+	std::vector<Color4u> colorBuff(width*height);
+	for (int i = 0; i < width*height; ++i)
+	{
+		const Color4f& reconstructedColor = reconstructedColorList.at(i);
+		Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
+		colorBuff.at(i) = color;
+	}
 	m_pShTex->SetPixelArray(colorBuff);
 	m_pShTex->UpdateToVideoMemory();
 }
@@ -374,18 +390,26 @@ void Main3DApp::mFunction_SHPreprocess_Rotation(RigidTransform t)
 
 	uint32_t width = m_pShTex->GetWidth();
 	uint32_t height = m_pShTex->GetHeight();
-	std::vector<Color4u> colorBuff(width*height);
+	std::vector<Vec3> dirList(width*height);
 	for (int y = 0; y < height; ++y)
 	{
 		for (int x = 0; x < width; ++x)
 		{
-			Vec3 dir = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
-			//Use 'EvalRotated' instead of Eval()  (because these 2 use different SH vector)
-			Color4f reconstructedColor = mShvec.EvalRotated(dir);
-			Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
-			colorBuff.at(y*width + x) = color;
+			dirList.at(y*width + x) = Ut::PixelCoordToDirection_SphericalMapping(x, y, width, height);
 		}
 	}
+
+	//reconstruct all pixels at once (batch SH evaluation)
+	//Use 'EvalRotated' instead of Eval()  (because these 2 use different SH vector)
+	std::vector<Color4f> reconstructedColorList;
+	mShvec.EvalRotated(dirList, reconstructedColorList);
+	std::vector<Color4u> colorBuff(width*height);
+	for (int i = 0; i < width*height; ++i)
+	{
+		const Color4f& reconstructedColor = reconstructedColorList.at(i);
+		Color4u color = { uint8_t(reconstructedColor.x * 255.0f), uint8_t(reconstructedColor.y * 255.0f) , uint8_t(reconstructedColor.z * 255.0f),255 };
+		colorBuff.at(i) = color;
+	}
 	m_pShTex->SetPixelArray(colorBuff);
 	m_pShTex->UpdateToVideoMemory();
 }
@@ -0,0 +1,220 @@
+/***********************************************************
+
+							BVH SAH builder
+
+		desc: binned SAH split shared by BVH for scene and
+		BVH for triangular mesh. Primitive references are
+		partitioned in place, no sub-list is copied.
+
+***********************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+
+bool Noise3D::BvhSahBuilder::SplitBinned(
+	std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end,
+	const N_AABB& nodeAabb, const N_AABB& centroidAabb, uint32_t maxPrimitiveCountPerLeaf,
+	uint32_t& outMid, N_AABB& outLeftAabb, N_AABB& outLeftCentroidAabb, N_AABB& outRightAabb, N_AABB& outRightCentroidAabb,
+	uint32_t threadCount)
+{
+	uint32_t count = end - begin;
+	if (count <= 1)return false;
+	if (maxPrimitiveCountPerLeaf == 0)maxPrimitiveCountPerLeaf = 1;
+
+	//1. choose the axis where centroids spread the most
+	Vec3 extent = centroidAabb.max - centroidAabb.min;
+	uint32_t axis = 0;
+	if (extent.y > extent.x && extent.y >= extent.z)axis = 1;
+	else if (extent.z > extent.x && extent.z > extent.y)axis = 2;
+	float axisMin = mFunction_GetVecComponent(centroidAabb.min, axis);
+	float axisExtent = mFunction_GetVecComponent(extent, axis);
+
+	//only the top levels (large ranges) are worth parallel reduction
+	if (count < c_parallelReductionThreshold)threadCount = 1;
+
+	uint32_t mid = begin;
+	if (axisExtent > 0.0f)
+	{
+		//2. put centroids into bins
+		struct Bin
+		{
+			Bin() :count(0) {}
+			N_AABB aabb;
+			uint32_t count;
+		};
+		float binScale = float(c_binCount) / axisExtent;
+		auto binIndex = [&](const N_BvhBuildPrimitive& p)->uint32_t
+		{
+			int b = int((mFunction_GetVecComponent(p.centroid, axis) - axisMin) * binScale);
+			if (b < 0)b = 0;
+			if (b >= int(c_binCount))b = c_binCount - 1;
+			return uint32_t(b);
+		};
+
+		//each chunk is binned separately, then merged in chunk order
+		//(AABB union and integer count are exact, so the result is identical for any thread count)
+		std::vector<Bin> chunkBinsList(std::max<uint32_t>(threadCount, 1) * c_binCount);
+		uint32_t chunkCount = Ut::ParallelFor(count, threadCount,
+			[&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			Bin* localBins = &chunkBinsList[chunkId * c_binCount];
+			for (uint32_t i = begin + chunkBegin; i < begin + chunkEnd; ++i)
+			{
+				Bin& bin = localBins[binIndex(primList[i])];
+				++bin.count;
+				bin.aabb.Union(primList[i].aabb);
+			}
+		});
+		Bin bins[c_binCount];
+		for (uint32_t c = 0; c < chunkCount; ++c)
+		{
+			for (uint32_t i = 0; i < c_binCount; ++i)
+			{
+				bins[i].count += chunkBinsList[c * c_binCount + i].count;
+				bins[i].aabb.Union(chunkBinsList[c * c_binCount + i].aabb);
+			}
+		}
+
+		//3. sweep from both sides to evaluate the cost of splitting after bin i
+		float rightArea[c_binCount];
+		uint32_t rightCount[c_binCount];
+		N_AABB accumAabb;
+		uint32_t accumCount = 0;
+		for (int i = c_binCount - 1; i > 0; --i)
+		{
+			accumAabb.Union(bins[i].aabb);
+			accumCount += bins[i].count;
+			rightArea[i] = accumAabb.SurfaceArea();
+			rightCount[i] = accumCount;
+		}
+
+		float nodeArea = nodeAabb.SurfaceArea();
+		float invNodeArea = nodeArea > 0.0f ? 1.0f / nodeArea : 0.0f;
+		float minCost = std::numeric_limits<float>::infinity();
+		uint32_t minCostSplitBin = 0;
+		accumAabb.Reset();
+		accumCount = 0;
+		for (uint32_t i = 0; i < c_binCount - 1; ++i)
+		{
+			accumAabb.Union(bins[i].aabb);
+			accumCount += bins[i].count;
+			if (accumCount == 0 || rightCount[i + 1] == 0)continue;
+			float cost = c_traversalCost +
+				(float(accumCount) * accumAabb.SurfaceArea() + float(rightCount[i + 1]) * rightArea[i + 1]) * invNodeArea;
+			if (cost < minCost)
+			{
+				minCost = cost;
+				minCostSplitBin = i;
+			}
+		}
+
+		//4. a leaf is cheaper than the best split
+		float leafCost = float(count);
+		if (count <= maxPrimitiveCountPerLeaf && leafCost <= minCost)return false;
+
+		//5. partition in place
+		if (minCost < std::numeric_limits<float>::infinity())
+		{
+			auto iter = std::partition(primList.begin() + begin, primList.begin() + end,
+				[&](const N_BvhBuildPrimitive& p) {return binIndex(p) <= minCostSplitBin; });
+			mid = uint32_t(iter - primList.begin());
+		}
+	}
+	else
+	{
+		//all centroids coincide, SAH can't separate them
+		if (count <= maxPrimitiveCountPerLeaf)return false;
+	}
+
+	//(degenerated case) split by count, in a deterministic way
+	if (mid == begin || mid == end)
+	{
+		mid = begin + count / 2;
+		std::nth_element(primList.begin() + begin, primList.begin() + mid, primList.begin() + end,
+			[&](const N_BvhBuildPrimitive& a, const N_BvhBuildPrimitive& b)
+		{
+			float ca = mFunction_GetVecComponent(a.centroid, axis);
+			float cb = mFunction_GetVecComponent(b.centroid, axis);
+			return ca < cb || (ca == cb && a.id < b.id);
+		});
+	}
+
+	outMid = mid;
+	BvhSahBuilder::ComputeRangeAabb(primList, begin, mid, outLeftAabb, outLeftCentroidAabb, threadCount);
+	BvhSahBuilder::ComputeRangeAabb(primList, mid, end, outRightAabb, outRightCentroidAabb, threadCount);
+	return true;
+}
+
+void Noise3D::BvhSahBuilder::ComputeRangeAabb(const std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, N_AABB & outAabb, N_AABB & outCentroidAabb, uint32_t threadCount)
+{
+	outAabb.Reset();
+	outCentroidAabb.Reset();
+	if (end <= begin)return;
+	if (end - begin < c_parallelReductionThreshold)threadCount = 1;
+
+	//per-chunk reduction, then merge
+	std::vector<N_AABB> chunkAabbList(std::max<uint32_t>(threadCount, 1));
+	std::vector<N_AABB> chunkCentroidAabbList(std::max<uint32_t>(threadCount, 1));
+	uint32_t chunkCount = Ut::ParallelFor(end - begin, threadCount,
+		[&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		N_AABB& aabb = chunkAabbList[chunkId];
+		N_AABB& centroidAabb = chunkCentroidAabbList[chunkId];
+		for (uint32_t i = begin + chunkBegin; i < begin + chunkEnd; ++i)
+		{
+			aabb.Union(primList[i].aabb);
+			centroidAabb.Union(N_AABB(primList[i].centroid, primList[i].centroid));
+		}
+	});
+	for (uint32_t c = 0; c < chunkCount; ++c)
+	{
+		outAabb.Union(chunkAabbList[c]);
+		outCentroidAabb.Union(chunkCentroidAabbList[c]);
+	}
+}
+
+void Noise3D::BvhSahBuilder::ComputeStatistics(const std::vector<N_BvhLinearNode>& nodeList, N_BvhBuildStatistics & outStat)
+{
+	outStat = N_BvhBuildStatistics();
+	if (nodeList.empty())return;
+
+	float rootArea = nodeList.front().GetAABB().SurfaceArea();
+	float invRootArea = rootArea > 0.0f ? 1.0f / rootArea : 0.0f;
+
+	//skip index of each ancestor on current path, the size of it is the depth of current node
+	std::vector<uint32_t> ancestorEndList;
+	for (uint32_t i = 0; i < nodeList.size(); ++i)
+	{
+		while (!ancestorEndList.empty() && ancestorEndList.back() <= i)ancestorEndList.pop_back();
+
+		const N_BvhLinearNode& node = nodeList[i];
+		float relativeArea = node.GetAABB().SurfaceArea() * invRootArea;
+		outStat.maxDepth = std::max<uint32_t>(outStat.maxDepth, ancestorEndList.size());
+		++outStat.nodeCount;
+
+		if (node.IsLeafNode())
+		{
+			++outStat.leafNodeCount;
+			outStat.primitiveCount += node.primitiveCount;
+			outStat.maxLeafPrimitiveCount = std::max<uint32_t>(outStat.maxLeafPrimitiveCount, node.primitiveCount);
+			outStat.sahCost += relativeArea * float(node.primitiveCount);
+		}
+		else
+		{
+			outStat.sahCost += relativeArea * c_traversalCost;
+			ancestorEndList.push_back(node.offset);
+		}
+	}
+}
+
+inline float Noise3D::BvhSahBuilder::mFunction_GetVecComponent(const Vec3& vec, uint32_t id)
+{
+	switch (id)
+	{
+	case 0:return vec.x;
+	case 1: return vec.y;
+	case 2:return vec.z;
+	default:return std::numeric_limits<float>::quiet_NaN();
+	}
+}
@@ -0,0 +1,51 @@
+/***********************************************************************
+
+							h: BVH SAH builder
+		desc: binned SAH(Surface Area Heuristic) split of a primitive
+		range, shared by BVH for scene and BVH for triangular mesh.
+		reference: pbrt-v3 /src/accelerators/bvh.cpp,
+		Ingo Wald, On fast Construction of SAH-based Bounding Volume Hierarchies(2007)
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	class /*_declspec(dllexport)*/ BvhSahBuilder
+	{
+	public:
+
+		//find the best SAH split of primList[begin, end) and partition the range in place.
+		//return false if the range should become a leaf node.
+		//if true is returned, [begin, outMid) and [outMid, end) are the 2 children,
+		//with their AABB and AABB of centroids output.
+		//(large ranges are binned by 'threadCount' threads, result doesn't depend on thread count)
+		static bool SplitBinned(
+			std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end,
+			const N_AABB& nodeAabb, const N_AABB& centroidAabb, uint32_t maxPrimitiveCountPerLeaf,
+			uint32_t& outMid, N_AABB& outLeftAabb, N_AABB& outLeftCentroidAabb, N_AABB& outRightAabb, N_AABB& outRightCentroidAabb,
+			uint32_t threadCount = 1);
+
+		//compute AABB and AABB of centroids of primList[begin, end)
+		static void ComputeRangeAabb(const std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, N_AABB& outAabb, N_AABB& outCentroidAabb, uint32_t threadCount = 1);
+
+		//statistics of a flattened BVH (any build method)
+		static void ComputeStatistics(const std::vector<N_BvhLinearNode>& nodeList, N_BvhBuildStatistics& outStat);
+
+		//cost of traversing a node, relative to a primitive intersection test
+		static constexpr float c_traversalCost = 0.125f;
+
+		static const uint32_t c_binCount = 16;
+
+		//primitive count above which the binning/AABB reduction of a range is done in parallel
+		static const uint32_t c_parallelReductionThreshold = 65536;
+
+		//primitive count above which the 2 sub-trees are built in parallel
+		static const uint32_t c_parallelBuildThreshold = 4096;
+
+	private:
+
+		static float mFunction_GetVecComponent(const Vec3& vec, uint32_t id);
+	};
+}
@@ -42,7 +42,12 @@ N_AABB Noise3D::BvhNodeForTriangularMesh::GetAABB() const
 ***********************************************/
 
 
-Noise3D::BvhTreeForTriangularMesh::BvhTreeForTriangularMesh()
+Noise3D::BvhTreeForTriangularMesh::BvhTreeForTriangularMesh():
+	m_pVB(nullptr),
+	m_pIB(nullptr),
+	mBuildMethod(NOISE_BVH_BUILD_METHOD::SAH_BINNED),
+	mMaxTriangleCountPerLeaf(4),
+	mBuildThreadCount(0)
 {
 }
 
@@ -61,12 +66,179 @@ bool Noise3D::BvhTreeForTriangularMesh::Construct(Mesh* pMesh)
 		return false;
 	}
 
+	//clear previous build result (the tree might be rebuilt several times)
+	BvhTreeForTriangularMesh::Reset();
+	BvhTreeForTriangularMesh::GetRoot()->GetTriangleIndexList().clear();
+	mLinearNodeList.clear();
+	mWideNodeList.clear();
+	mLinearTriangleIdList.clear();
+	mLinearTriangleList.clear();
+	mBuildStat = N_BvhBuildStatistics();
+
+	uint32_t triangleCount = pMesh->GetTriangleCount();
+	m_pVB = pMesh->GetVertexBuffer();
+	m_pIB = pMesh->GetIndexBuffer();
+	BvhNodeForTriangularMesh* pRootNode = BvhTreeForTriangularMesh::GetRoot();
+
+	if (mBuildMethod == NOISE_BVH_BUILD_METHOD::SAH_BINNED)
+	{
+		uint32_t threadCount = Ut::ResolveThreadCount(mBuildThreadCount);
+
+		//triangle references are partitioned in place, no sub-list is copied
+		std::vector<N_BvhBuildPrimitive> primList(triangleCount);
+		Ut::ParallelFor(triangleCount, triangleCount >= BvhSahBuilder::c_parallelReductionThreshold ? threadCount : 1,
+			[&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+			{
+				Vec3 v0 = (*m_pVB)[(*m_pIB)[i * 3 + 0]].Pos;
+				Vec3 v1 = (*m_pVB)[(*m_pIB)[i * 3 + 1]].Pos;
+				Vec3 v2 = (*m_pVB)[(*m_pIB)[i * 3 + 2]].Pos;
+				primList[i] = N_BvhBuildPrimitive(i, mFunction_ComputeAabb(v0, v1, v2));
+			}
+		});
+
+		N_AABB rootAabb, rootCentroidAabb;
+		BvhSahBuilder::ComputeRangeAabb(primList, 0, triangleCount, rootAabb, rootCentroidAabb, threadCount);
+		if (!rootAabb.IsValid())
+		{
+			ERROR_MSG("BvhTreeForTriangularMesh: AABB of root(the whole mesh) should have a positive volume.");
+			return false;
+		}
+		pRootNode->SetAABB(rootAabb);
+		mFunction_SplitSahBinned(pRootNode, primList, 0, triangleCount, rootCentroidAabb, threadCount);
+	}
+	else
+	{
+		if (!mFunction_ConstructMidPoint(pMesh))return false;
+	}
+
+	//flatten the tree into a compact depth-first node array for traversal
+	mLinearNodeList.reserve(2 * triangleCount / 3 + 1);
+	mLinearTriangleIdList.reserve(triangleCount);
+	mFunction_Flatten(pRootNode);
+
+	//copy triangles in leaf order for hit tests
+	mLinearTriangleList.resize(mLinearTriangleIdList.size());
+	for (uint32_t i = 0; i < mLinearTriangleIdList.size(); ++i)
+	{
+		uint32_t triId = mLinearTriangleIdList[i];
+		mLinearTriangleList[i] = N_BvhTriangle(
+			(*m_pVB)[(*m_pIB)[triId * 3 + 0]].Pos,
+			(*m_pVB)[(*m_pIB)[triId * 3 + 1]].Pos,
+			(*m_pVB)[(*m_pIB)[triId * 3 + 2]].Pos);
+	}
+
+	BvhSahBuilder::ComputeStatistics(mLinearNodeList, mBuildStat);
+	BvhWideCollapser::Collapse(mLinearNodeList, mWideNodeList);
+	mBuildStat.wideNodeCount = mWideNodeList.size();
+
+	return true;
+}
+
+bool Noise3D::BvhTreeForTriangularMesh::ConstructFromLinearNodes(Mesh * pMesh, const std::vector<N_BvhLinearNode>& nodeList, const std::vector<uint32_t>& triangleIdList)
+{
+	if (pMesh == nullptr)
+	{
+		ERROR_MSG("BvhTreeForTriangularMesh: construction failed. mesh is nullptr.");
+		return false;
+	}
+
+	BvhTreeForTriangularMesh::Reset();
+	BvhTreeForTriangularMesh::GetRoot()->GetTriangleIndexList().clear();
+	mWideNodeList.clear();
+	mBuildStat = N_BvhBuildStatistics();
+
+	m_pVB = pMesh->GetVertexBuffer();
+	m_pIB = pMesh->GetIndexBuffer();
+	uint32_t triangleCount = pMesh->GetTriangleCount();
+	for (uint32_t triId : triangleIdList)
+	{
+		if (triId >= triangleCount)
+		{
+			ERROR_MSG("BvhTreeForTriangularMesh: triangle id out of range, tree doesn't match the mesh.");
+			return false;
+		}
+	}
+	mLinearNodeList = nodeList;
+	mLinearTriangleIdList = triangleIdList;
+
+	//the same as Construct()
+	mLinearTriangleList.resize(mLinearTriangleIdList.size());
+	for (uint32_t i = 0; i < mLinearTriangleIdList.size(); ++i)
+	{
+		uint32_t triId = mLinearTriangleIdList[i];
+		mLinearTriangleList[i] = N_BvhTriangle(
+			(*m_pVB)[(*m_pIB)[triId * 3 + 0]].Pos,
+			(*m_pVB)[(*m_pIB)[triId * 3 + 1]].Pos,
+			(*m_pVB)[(*m_pIB)[triId * 3 + 2]].Pos);
+	}
+
+	if (!mLinearNodeList.empty())BvhTreeForTriangularMesh::GetRoot()->SetAABB(mLinearNodeList[0].GetAABB());
+	BvhSahBuilder::ComputeStatistics(mLinearNodeList, mBuildStat);
+	BvhWideCollapser::Collapse(mLinearNodeList, mWideNodeList);
+	mBuildStat.wideNodeCount = mWideNodeList.size();
+
+	return true;
+}
+
+const std::vector<N_BvhLinearNode>& Noise3D::BvhTreeForTriangularMesh::GetLinearNodeList() const
+{
+	return mLinearNodeList;
+}
+
+const std::vector<N_BvhWideNode>& Noise3D::BvhTreeForTriangularMesh::GetWideNodeList() const
+{
+	return mWideNodeList;
+}
+
+const std::vector<uint32_t>& Noise3D::BvhTreeForTriangularMesh::GetLinearTriangleIdList() const
+{
+	return mLinearTriangleIdList;
+}
+
+const std::vector<N_BvhTriangle>& Noise3D::BvhTreeForTriangularMesh::GetLinearTriangleList() const
+{
+	return mLinearTriangleList;
+}
+
+void Noise3D::BvhTreeForTriangularMesh::SetBuildMethod(NOISE_BVH_BUILD_METHOD method)
+{
+	mBuildMethod = method;
+}
+
+NOISE_BVH_BUILD_METHOD Noise3D::BvhTreeForTriangularMesh::GetBuildMethod() const
+{
+	return mBuildMethod;
+}
+
+void Noise3D::BvhTreeForTriangularMesh::SetMaxTriangleCountPerLeaf(uint32_t count)
+{
+	mMaxTriangleCountPerLeaf = (count > 0 ? count : 1);
+}
+
+void Noise3D::BvhTreeForTriangularMesh::SetBuildThreadCount(uint32_t threadCount)
+{
+	mBuildThreadCount = threadCount;
+}
+
+const N_BvhBuildStatistics & Noise3D::BvhTreeForTriangularMesh::GetBuildStatistics() const
+{
+	return mBuildStat;
+}
+
+/******************************************
+
+							PRIVATE
+
+******************************************/
+
+bool Noise3D::BvhTreeForTriangularMesh::mFunction_ConstructMidPoint(Mesh * pMesh)
+{
 	//store computed AABB of triangle in pair
 	uint32_t triangleCount = pMesh->GetTriangleCount();
 	std::vector<TriIdListAabbPair> infoList;
 	infoList.reserve(triangleCount);
-	m_pVB = pMesh->GetVertexBuffer();
-	m_pIB = pMesh->GetIndexBuffer();
 
 	//compute AABB of each triangles
 	for (uint32_t i = 0; i < triangleCount; ++i)
@@ -100,15 +272,45 @@ bool Noise3D::BvhTreeForTriangularMesh::Construct(Mesh* pMesh)
 		ERROR_MSG("BvhTreeForTriangularMesh: failed to split the root BVH node.");
 		return false;
 	}
-
 	return true;
 }
 
-/******************************************
+bool Noise3D::BvhTreeForTriangularMesh::mFunction_SplitSahBinned(BvhNodeForTriangularMesh * pNode, std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, const N_AABB & centroidAabb, uint32_t threadCount)
+{
+	uint32_t mid = 0;
+	N_AABB leftAabb, leftCentroidAabb, rightAabb, rightCentroidAabb;
+	if (!BvhSahBuilder::SplitBinned(primList, begin, end, pNode->GetAABB(), centroidAabb, mMaxTriangleCountPerLeaf,
+		mid, leftAabb, leftCentroidAabb, rightAabb, rightCentroidAabb, threadCount))
+	{
+		//leaf node
+		std::vector<uint32_t>& triIdList = pNode->GetTriangleIndexList();
+		triIdList.reserve(end - begin);
+		for (uint32_t i = begin; i < end; ++i)triIdList.push_back(primList[i].id);
+		return true;
+	}
 
-							PRIVATE
+	//children are created before sub-trees are built, so child order never depends on thread scheduling
+	BvhNodeForTriangularMesh* pLeftChild = pNode->CreateChildNode();
+	pLeftChild->SetAABB(leftAabb);
+	BvhNodeForTriangularMesh* pRightChild = pNode->CreateChildNode();
+	pRightChild->SetAABB(rightAabb);
 
-******************************************/
+	//the 2 sub-trees touch disjoint ranges of primList, build the left one in another thread
+	if (threadCount > 1 && end - begin >= BvhSahBuilder::c_parallelBuildThreshold)
+	{
+		uint32_t leftThreadCount = threadCount / 2;
+		std::thread leftThread([&]() {
+			mFunction_SplitSahBinned(pLeftChild, primList, begin, mid, leftCentroidAabb, leftThreadCount); });
+		mFunction_SplitSahBinned(pRightChild, primList, mid, end, rightCentroidAabb, threadCount - leftThreadCount);
+		leftThread.join();
+	}
+	else
+	{
+		mFunction_SplitSahBinned(pLeftChild, primList, begin, mid, leftCentroidAabb, 1);
+		mFunction_SplitSahBinned(pRightChild, primList, mid, end, rightCentroidAabb, 1);
+	}
+	return true;
+}
 
 bool Noise3D::BvhTreeForTriangularMesh::mFunction_SplitMidPoint(BvhNodeForTriangularMesh * pNode, std::vector<TriIdListAabbPair>& infoList)
 {
@@ -262,6 +464,41 @@ bool Noise3D::BvhTreeForTriangularMesh::mFunction_SplitMidPoint(BvhNodeForTriang
 	return true;
 }
 
+void Noise3D::BvhTreeForTriangularMesh::mFunction_Flatten(BvhNodeForTriangularMesh * pNode)
+{
+	//pre-order traversal. (be careful that the node list might be re-allocated
+	//during recursion, so use index instead of reference)
+	uint32_t currentIndex = mLinearNodeList.size();
+	N_AABB aabb = pNode->GetAABB();
+	N_BvhLinearNode linearNode;
+	linearNode.aabbMin = aabb.min;
+	linearNode.aabbMax = aabb.max;
+	mLinearNodeList.push_back(linearNode);
+
+	if (pNode->IsLeafNode())
+	{
+		const std::vector<uint32_t>& triIdList = pNode->GetTriangleIndexList();
+		if (triIdList.empty())
+		{
+			//empty leaf is regarded as an interior node without child
+			mLinearNodeList.at(currentIndex).offset = currentIndex + 1;
+			return;
+		}
+		mLinearNodeList.at(currentIndex).offset = mLinearTriangleIdList.size();
+		mLinearNodeList.at(currentIndex).primitiveCount = triIdList.size();
+		mLinearTriangleIdList.insert(mLinearTriangleIdList.end(), triIdList.begin(), triIdList.end());
+	}
+	else
+	{
+		for (uint32_t i = 0; i < pNode->GetChildNodeCount(); ++i)
+		{
+			mFunction_Flatten(pNode->GetChildNode(i));
+		}
+		//skip index: the node after the whole sub-tree
+		mLinearNodeList.at(currentIndex).offset = mLinearNodeList.size();
+	}
+}
+
 inline N_AABB Noise3D::BvhTreeForTriangularMesh::mFunction_ComputeAabb(Vec3 v0, Vec3 v1, Vec3 v2)
 {
 	N_AABB aabb;
@@ -57,8 +57,42 @@ namespace Noise3D
 
 		bool Construct(Mesh* pMesh);
 
+		//restore a flattened tree (e.g. from .n3dmesh cache) instead of building it. only the linear
+		//lists are restored (not the pointer-based nodes), triangles and wide nodes are derived from the mesh
+		bool ConstructFromLinearNodes(Mesh* pMesh, const std::vector<N_BvhLinearNode>& nodeList, const std::vector<uint32_t>& triangleIdList);
+
+		//flattened nodes in depth-first order (produced after Construct())
+		const std::vector<N_BvhLinearNode>& GetLinearNodeList() const;
+
+		//linear node list collapsed into 4/8-ary nodes (wide node 0 is the root). leaf children refer to GetLinearTriangleIdList()
+		const std::vector<N_BvhWideNode>& GetWideNodeList() const;
+
+		//triangle ids reordered by leaf nodes. a leaf node refers to range [offset, offset+primitiveCount)
+		const std::vector<uint32_t>& GetLinearTriangleIdList() const;
+
+		//intersection-only triangles, i-th one is triangle GetLinearTriangleIdList()[i] (model space).
+		//vertex positions are copied when the tree is constructed
+		const std::vector<N_BvhTriangle>& GetLinearTriangleList() const;
+
+		//build method used by following Construct() (SAH_BINNED by default)
+		void SetBuildMethod(NOISE_BVH_BUILD_METHOD method);
+
+		NOISE_BVH_BUILD_METHOD GetBuildMethod() const;
+
+		//max triangle count in a leaf node (for SAH builder)
+		void SetMaxTriangleCountPerLeaf(uint32_t count);
+
+		//thread count of SAH build, 0 for std::thread::hardware_concurrency() (default).
+		//built tree is identical for any thread count
+		void SetBuildThreadCount(uint32_t threadCount);
+
+		//statistics of the last Construct()
+		const N_BvhBuildStatistics& GetBuildStatistics() const;
+
 	private:
 
+
+
 		//SceneObject ptr and its aabb cache
 		struct TriIdListAabbPair
 		{
@@ -71,14 +105,44 @@ namespace Noise3D
 			N_AABB aabb;//cached result
 		};
 
+		//the original midpoint build (left/middle/right piles)
+		bool mFunction_ConstructMidPoint(Mesh* pMesh);
+
 		bool mFunction_SplitMidPoint(BvhNodeForTriangularMesh* pNode,std::vector<TriIdListAabbPair>& infoList);
 
+
+		//binned SAH split. primList[begin,end) is partitioned in place
+		//large sub-trees are built in parallel by 'threadCount' threads
+		bool mFunction_SplitSahBinned(BvhNodeForTriangularMesh* pNode, std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, const N_AABB& centroidAabb, uint32_t threadCount);
+
+
 		N_AABB mFunction_ComputeAabb(Vec3 v0, Vec3 v1, Vec3 v2);
 
 		float mFunction_GetVecComponent(Vec3 vec, uint32_t id);
 
+		//convert pointer-based tree into depth-first linear node array
+		void mFunction_Flatten(BvhNodeForTriangularMesh* pNode);
+
 		const std::vector<N_DefaultVertex>* m_pVB;
 		const std::vector<uint32_t>* m_pIB;
+
+		std::vector<N_BvhLinearNode> mLinearNodeList;
+
+		std::vector<N_BvhWideNode> mWideNodeList;
+
+		std::vector<uint32_t> mLinearTriangleIdList;
+
+		std::vector<N_BvhTriangle> mLinearTriangleList;
+
+		NOISE_BVH_BUILD_METHOD mBuildMethod;
+
+		uint32_t mMaxTriangleCountPerLeaf;
+
+		uint32_t mBuildThreadCount;
+
+		N_BvhBuildStatistics mBuildStat;
+
+
 	};
 
 }
@@ -50,7 +50,12 @@ N_AABB Noise3D::BvhNodeForScene::GetAABB()
 
 ***********************************************/
 
-Noise3D::BvhTreeForScene::BvhTreeForScene()
+Noise3D::BvhTreeForScene::BvhTreeForScene():
+	mBuildMethod(NOISE_BVH_BUILD_METHOD::SAH_BINNED),
+	mBuildThreadCount(0),
+	m_pBuiltSceneNode(nullptr),
+	mBuiltMethod(NOISE_BVH_BUILD_METHOD::SAH_BINNED),
+	mRefitRebuildThreshold(2.0f)
 {
 }
 
@@ -70,29 +75,50 @@ bool Noise3D::BvhTreeForScene::Construct(SceneNode * pNode)
 		ERROR_MSG("BvhTreeForScene: construction failed. scene node is nullptr.");
 		return false;
 	}
-	//i arbitrarily choose an traverse order to get all the scene nodes
-	std::vector<ISceneObject*> tmpSceneObjectList;
-	SceneGraph* pGraph = pNode->GetHostTree();
-	pGraph->TraverseSceneObjects(NOISE_TREE_TRAVERSE_ORDER::PRE_ORDER,pNode, tmpSceneObjectList);
+
+	//linear node list will be re-generated (pointer-based nodes of previous build are removed)
+	BvhTreeForScene::Reset();
+	mLinearNodeList.clear();
+	mWideNodeList.clear();
+	mLinearObjectList.clear();
+	mBuildSurfaceAreaList.clear();
+	mObjectRecordList.clear();
+	mObjectRecordIndexMap.clear();
+	mBuildStat = N_BvhBuildStatistics();
+	m_pBuiltSceneNode = nullptr;
+
+	std::vector<GI::IGiRenderable*> objectList;
+	mFunction_CollectCollidableObjects(pNode, objectList);
 
 	//store computed AABB of object in pair
 	std::vector<ObjectAabbPair> infoList;
-	infoList.reserve(tmpSceneObjectList.size());
-	for (uint32_t i = 0; i < tmpSceneObjectList.size(); ++i)
+	infoList.reserve(objectList.size());
+	mObjectRecordList.reserve(objectList.size());
+	for (GI::IGiRenderable* pSO : objectList)
 	{
-		//it should be an Collidable object/ GI Renderable first
-		if (GI::IGiRenderable* pSO = dynamic_cast<GI::IGiRenderable*>(tmpSceneObjectList.at(i)))
+		//two-level: mesh's internal BVH is in model space. it's rebuilt only if the
+		//geometry changed, moving the scene node doesn't invalidate it
+		if (pSO->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
 		{
-			//not collidable, then no need to add it to BVH
-			//after all, BVH is built for acceleration of ray-XXX intersection
-			if (pSO->IsCollidable())
+			Mesh* pMesh = static_cast<Mesh*>(pSO);
+			if (!pMesh->IsBvhTreeUpToDate())
 			{
-				ObjectAabbPair info;
-				info.pObj = pSO;
-				info.aabb = pSO->ComputeWorldAABB_Accurate();
-				infoList.push_back(info);
+				pMesh->GetBvhTree().SetBuildThreadCount(mBuildThreadCount);
+				pMesh->RebuildBvhTree();
 			}
 		}
+
+		ObjectAabbPair info;
+		info.pObj = pSO;
+		info.aabb = mFunction_ComputeObjectWorldAabb(pSO);
+		infoList.push_back(info);
+
+		//remember the state the object is bounded with, for the following Refit()
+		ObjectRecord record;
+		record.pObj = pSO;
+		mFunction_IsObjectRecordOutdated(record);
+		mObjectRecordIndexMap[pSO] = mObjectRecordList.size();
+		mObjectRecordList.push_back(record);
 	}
 
 	//AABB of Bvh Node that include the whole scene
@@ -110,17 +136,182 @@ bool Noise3D::BvhTreeForScene::Construct(SceneNode * pNode)
 	BvhNodeForScene* pRootNode = BvhTreeForScene::GetRoot();
 	pRootNode->SetAABB(rootAabb);
 
-	//start to recursive splitting(info list might be splitted and copied many times)
-	//(2019.3.25)could be optimized with std::partition
-	if (!mFunction_SplitMidPointViaAabbSlabs(pRootNode, infoList))
+	if (mBuildMethod == NOISE_BVH_BUILD_METHOD::SAH_BINNED)
+	{
+		//object references are partitioned in place
+		std::vector<N_BvhBuildPrimitive> primList(infoList.size());
+		for (uint32_t i = 0; i < infoList.size(); ++i)primList[i] = N_BvhBuildPrimitive(i, infoList[i].aabb);
+		uint32_t threadCount = Ut::ResolveThreadCount(mBuildThreadCount);
+		N_AABB tmpAabb, rootCentroidAabb;
+		BvhSahBuilder::ComputeRangeAabb(primList, 0, primList.size(), tmpAabb, rootCentroidAabb, threadCount);
+		mFunction_SplitSahBinned(pRootNode, infoList, primList, 0, primList.size(), rootCentroidAabb, threadCount);
+	}
+	else
 	{
-		ERROR_MSG("BvhTreeForScene: failed to split the root BVH node.");
+		//start to recursive splitting(info list might be splitted and copied many times)
+		//(2019.3.25)could be optimized with std::partition
+		if (!mFunction_SplitMidPointViaAabbSlabs(pRootNode, infoList))
+		{
+			ERROR_MSG("BvhTreeForScene: failed to split the root BVH node.");
+			return false;
+		}
+	}
+
+	//3. flatten the tree into a compact depth-first node array for traversal
+	mLinearObjectList.reserve(infoList.size());
+	mFunction_Flatten(pRootNode);
+	BvhSahBuilder::ComputeStatistics(mLinearNodeList, mBuildStat);
+	BvhWideCollapser::Collapse(mLinearNodeList, mWideNodeList);
+	mBuildStat.wideNodeCount = mWideNodeList.size();
+
+	//surface area of nodes right after build, to measure the degradation caused by refit
+	mBuildSurfaceAreaList.resize(mLinearNodeList.size());
+	for (uint32_t i = 0; i < mLinearNodeList.size(); ++i)mBuildSurfaceAreaList[i] = mLinearNodeList[i].GetAABB().SurfaceArea();
+	m_pBuiltSceneNode = pNode;
+	mBuiltMethod = mBuildMethod;
+
+	return true;
+}
+
+bool Noise3D::BvhTreeForScene::Refit(SceneNode * pNode)
+{
+	if (pNode == nullptr)
+	{
+		ERROR_MSG("BvhTreeForScene: refit failed. scene node is nullptr.");
 		return false;
 	}
 
+	mRefitStat = N_BvhRefitStatistics();
+
+	//tree is not built for this scene (or with another method), refit is impossible
+	if (pNode != m_pBuiltSceneNode || mBuiltMethod != mBuildMethod || mLinearNodeList.empty())
+	{
+		mRefitStat.isFullyRebuilt = true;
+		return BvhTreeForScene::Construct(pNode);
+	}
+
+	//objects were added/removed/reordered, topology of the tree is invalid
+	std::vector<GI::IGiRenderable*> objectList;
+	mFunction_CollectCollidableObjects(pNode, objectList);
+	bool isObjectListChanged = (objectList.size() != mObjectRecordList.size());
+	for (uint32_t i = 0; !isObjectListChanged && i < objectList.size(); ++i)
+	{
+		isObjectListChanged = (objectList[i] != mObjectRecordList[i].pObj);
+	}
+	if (isObjectListChanged)
+	{
+		mRefitStat.isFullyRebuilt = true;
+		return BvhTreeForScene::Construct(pNode);
+	}
+
+	//1. find dirty objects and re-bound them
+	std::unordered_map<GI::IGiRenderable*, N_AABB> dirtyAabbMap;
+	for (ObjectRecord& record : mObjectRecordList)
+	{
+		if (record.pObj->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
+		{
+			Mesh* pMesh = static_cast<Mesh*>(record.pObj);
+			if (!pMesh->IsBvhTreeUpToDate())
+			{
+				pMesh->GetBvhTree().SetBuildThreadCount(mBuildThreadCount);
+				pMesh->RebuildBvhTree();
+				++mRefitStat.rebuiltMeshBvhCount;
+			}
+		}
+
+		if (mFunction_IsObjectRecordOutdated(record))
+		{
+			dirtyAabbMap[record.pObj] = mFunction_ComputeObjectWorldAabb(record.pObj);
+		}
+	}
+	mRefitStat.dirtyObjectCount = dirtyAabbMap.size();
+	if (dirtyAabbMap.empty())return true;
+
+	//2. bottom-up refit (children are visited before father in post-order)
+	std::vector<BvhNodeForScene*> nodeList;
+	BvhTreeForScene::Traverse_PostOrder(nodeList);
+	for (auto pn : nodeList)
+	{
+		if (pn->IsLeafNode())
+		{
+			auto iter = dirtyAabbMap.find(pn->GetGiRenderable());
+			if (iter != dirtyAabbMap.end())pn->SetAABB(iter->second);
+		}
+		else
+		{
+			N_AABB aabb;
+			for (uint32_t i = 0; i < pn->GetChildNodeCount(); ++i)aabb.Union(pn->GetChildNode(i)->GetAABB());
+			pn->SetAABB(aabb);
+		}
+	}
+	mFunction_Reflatten();
+
+	//3. rebuild the top-most sub-trees which are degraded too much
+	if (mRefitRebuildThreshold > 1.0f)
+	{
+		std::vector<uint32_t> degradedNodeIndexList;
+		for (uint32_t i = 0; i < mLinearNodeList.size();)
+		{
+			const N_BvhLinearNode& node = mLinearNodeList[i];
+			if (!node.IsLeafNode() && node.GetAABB().SurfaceArea() > mBuildSurfaceAreaList[i] * mRefitRebuildThreshold)
+			{
+				degradedNodeIndexList.push_back(i);
+				i = node.GetSkipIndex(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		if (!degradedNodeIndexList.empty())
+		{
+			//sub-tree can't be rebuilt in place with MIDPOINT (node count might change)
+			if (mBuildMethod != NOISE_BVH_BUILD_METHOD::SAH_BINNED)
+			{
+				mRefitStat.isFullyRebuilt = true;
+				return BvhTreeForScene::Construct(pNode);
+			}
+
+			//linear index of a node equals its pre-order index in pointer-based tree
+			std::vector<BvhNodeForScene*> preOrderNodeList;
+			BvhTreeForScene::Traverse_PreOrder(preOrderNodeList);
+			uint32_t threadCount = Ut::ResolveThreadCount(mBuildThreadCount);
+			for (uint32_t index : degradedNodeIndexList)
+			{
+				mFunction_RebuildSubtree(preOrderNodeList[index], threadCount);
+			}
+			mFunction_Reflatten();
+			mRefitStat.rebuiltSubtreeCount = degradedNodeIndexList.size();
+
+			//a SAH sub-tree with k objects always has 2k-1 nodes, so rebuilt sub-trees stay in the same index range
+			for (uint32_t index : degradedNodeIndexList)
+			{
+				uint32_t end = mLinearNodeList[index].GetSkipIndex(index);
+				for (uint32_t i = index; i < end; ++i)mBuildSurfaceAreaList[i] = mLinearNodeList[i].GetAABB().SurfaceArea();
+			}
+		}
+	}
+
 	return true;
 }
 
+void Noise3D::BvhTreeForScene::MarkObjectDirty(GI::IGiRenderable * pObj)
+{
+	auto iter = mObjectRecordIndexMap.find(pObj);
+	if (iter != mObjectRecordIndexMap.end())mObjectRecordList[iter->second].isMarkedDirty = true;
+}
+
+void Noise3D::BvhTreeForScene::SetRefitRebuildThreshold(float surfaceAreaRatio)
+{
+	mRefitRebuildThreshold = surfaceAreaRatio;
+}
+
+const N_BvhRefitStatistics & Noise3D::BvhTreeForScene::GetRefitStatistics() const
+{
+	return mRefitStat;
+}
+
 void Noise3D::BvhTreeForScene::TraverseSceneObjects(NOISE_TREE_TRAVERSE_ORDER order, std::vector<GI::IGiRenderable*>& outResult) const
 {
 	std::vector<BvhNodeForScene*> nodeList;
@@ -153,6 +344,41 @@ void Noise3D::BvhTreeForScene::TraverseSceneObjects(NOISE_TREE_TRAVERSE_ORDER or
 	}
 }
 
+const std::vector<N_BvhLinearNode>& Noise3D::BvhTreeForScene::GetLinearNodeList() const
+{
+	return mLinearNodeList;
+}
+
+const std::vector<N_BvhWideNode>& Noise3D::BvhTreeForScene::GetWideNodeList() const
+{
+	return mWideNodeList;
+}
+
+const std::vector<GI::IGiRenderable*>& Noise3D::BvhTreeForScene::GetLinearObjectList() const
+{
+	return mLinearObjectList;
+}
+
+void Noise3D::BvhTreeForScene::SetBuildMethod(NOISE_BVH_BUILD_METHOD method)
+{
+	mBuildMethod = method;
+}
+
+NOISE_BVH_BUILD_METHOD Noise3D::BvhTreeForScene::GetBuildMethod() const
+{
+	return mBuildMethod;
+}
+
+void Noise3D::BvhTreeForScene::SetBuildThreadCount(uint32_t threadCount)
+{
+	mBuildThreadCount = threadCount;
+}
+
+const N_BvhBuildStatistics & Noise3D::BvhTreeForScene::GetBuildStatistics() const
+{
+	return mBuildStat;
+}
+
 /*********************************************
 
 							PRIVATE
@@ -285,12 +511,7 @@ bool Noise3D::BvhTreeForScene::mFunction_SplitMidPointViaAabbSlabs(BvhNodeForSce
 		pNode->SetAABB(info.aabb);
 		pNode->SetGiRenderable(info.pObj);
 
-		//rebuild mesh's internal BVH
-		if (info.pObj->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
-		{
-			Mesh* pMesh = static_cast<Mesh*>(info.pObj);
-			pMesh->RebuildBvhTree();
-		}
+		//(mesh's internal BVH has been rebuilt in Construct())
 		return true;
 	}
 
@@ -390,6 +611,228 @@ bool Noise3D::BvhTreeForScene::mFunction_SplitMidPointViaAabbSlabs(BvhNodeForSce
 	return true;
 }
 
+bool Noise3D::BvhTreeForScene::mFunction_SplitSahBinned(BvhNodeForScene * pNode, const std::vector<ObjectAabbPair>& infoList, std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, const N_AABB & centroidAabb, uint32_t threadCount)
+{
+	if (begin >= end)return false;
+
+	//scene BVH node holds only one object, so splitting continues until 1 object is left
+	uint32_t mid = 0;
+	N_AABB leftAabb, leftCentroidAabb, rightAabb, rightCentroidAabb;
+	if (!BvhSahBuilder::SplitBinned(primList, begin, end, pNode->GetAABB(), centroidAabb, 1,
+		mid, leftAabb, leftCentroidAabb, rightAabb, rightCentroidAabb, threadCount))
+	{
+		const ObjectAabbPair& info = infoList[primList[begin].id];
+		pNode->SetAABB(info.aabb);
+		pNode->SetGiRenderable(info.pObj);
+		return true;
+	}
+
+	//children are created before sub-trees are built, so child order never depends on thread scheduling
+	BvhNodeForScene* pLeftChild = pNode->CreateChildNode();
+	pLeftChild->SetAABB(leftAabb);
+	BvhNodeForScene* pRightChild = pNode->CreateChildNode();
+	pRightChild->SetAABB(rightAabb);
+
+	if (threadCount > 1 && end - begin >= BvhSahBuilder::c_parallelBuildThreshold)
+	{
+		uint32_t leftThreadCount = threadCount / 2;
+		std::thread leftThread([&]() {
+			mFunction_SplitSahBinned(pLeftChild, infoList, primList, begin, mid, leftCentroidAabb, leftThreadCount); });
+		mFunction_SplitSahBinned(pRightChild, infoList, primList, mid, end, rightCentroidAabb, threadCount - leftThreadCount);
+		leftThread.join();
+	}
+	else
+	{
+		mFunction_SplitSahBinned(pLeftChild, infoList, primList, begin, mid, leftCentroidAabb, 1);
+		mFunction_SplitSahBinned(pRightChild, infoList, primList, mid, end, rightCentroidAabb, 1);
+	}
+	return true;
+}
+
+void Noise3D::BvhTreeForScene::mFunction_CollectCollidableObjects(SceneNode * pNode, std::vector<GI::IGiRenderable*>& outList)
+{
+	//i arbitrarily choose an traverse order to get all the scene nodes
+	std::vector<ISceneObject*> tmpSceneObjectList;
+	SceneGraph* pGraph = pNode->GetHostTree();
+	pGraph->TraverseSceneObjects(NOISE_TREE_TRAVERSE_ORDER::PRE_ORDER, pNode, tmpSceneObjectList);
+
+	outList.reserve(tmpSceneObjectList.size());
+	for (auto pObj : tmpSceneObjectList)
+	{
+		//it should be an Collidable object/ GI Renderable first
+		if (GI::IGiRenderable* pSO = dynamic_cast<GI::IGiRenderable*>(pObj))
+		{
+			//not collidable, then no need to add it to BVH
+			//after all, BVH is built for acceleration of ray-XXX intersection
+			if (pSO->IsCollidable())outList.push_back(pSO);
+		}
+	}
+}
+
+N_AABB Noise3D::BvhTreeForScene::mFunction_ComputeObjectWorldAabb(GI::IGiRenderable * pObj)
+{
+	if (pObj->GetObjectType() != NOISE_SCENE_OBJECT_TYPE::MESH)return pObj->ComputeWorldAABB_Accurate();
+
+	//mesh: instead of transforming every vertex, transform the boxes of a cut of the
+	//top levels of its (model space) BVH, which is O(1) and much tighter than transformed root AABB
+	Mesh* pMesh = static_cast<Mesh*>(pObj);
+	SceneNode* pSceneNode = pMesh->GetAttachedSceneNode();
+	const std::vector<N_BvhLinearNode>& meshNodeList = pMesh->GetBvhTree().GetLinearNodeList();
+	if (pSceneNode == nullptr || meshNodeList.empty())return pObj->ComputeWorldAABB_Accurate();
+
+	std::vector<uint32_t> cutList(1, 0);
+	for (uint32_t i = 0; i < cutList.size() && cutList.size() < c_meshBoundingNodeCount;)
+	{
+		const N_BvhLinearNode& node = meshNodeList[cutList[i]];
+		if (node.IsLeafNode())
+		{
+			++i;
+			continue;
+		}
+
+		//replace interior node with its children
+		uint32_t childIndex = cutList[i] + 1;
+		cutList.erase(cutList.begin() + i);
+		while (childIndex < node.offset)
+		{
+			cutList.push_back(childIndex);
+			childIndex = meshNodeList[childIndex].GetSkipIndex(childIndex);
+		}
+	}
+
+	const Matrix worldMat = pSceneNode->EvalWorldTransform().GetAffineTransformMatrix();
+	N_AABB outAabb;
+	for (uint32_t index : cutList)
+	{
+		const N_BvhLinearNode& node = meshNodeList[index];
+		if (node.IsLeafNode() == false && node.offset == index + 1)continue;//empty node
+		for (uint32_t corner = 0; corner < 8; ++corner)
+		{
+			Vec3 v(
+				(corner & 1) ? node.aabbMax.x : node.aabbMin.x,
+				(corner & 2) ? node.aabbMax.y : node.aabbMin.y,
+				(corner & 4) ? node.aabbMax.z : node.aabbMin.z);
+			Vec3 worldV = AffineTransform::TransformVector_MatrixMul(v, worldMat);
+			outAabb.Union(N_AABB(worldV, worldV));
+		}
+	}
+	return outAabb;
+}
+
+bool Noise3D::BvhTreeForScene::mFunction_IsObjectRecordOutdated(ObjectRecord & record)
+{
+	bool isOutdated = record.isMarkedDirty;
+	record.isMarkedDirty = false;
+
+	SceneNode* pSceneNode = record.pObj->GetAttachedSceneNode();
+	if (pSceneNode != nullptr)
+	{
+		Matrix worldMat = pSceneNode->EvalWorldTransform().GetAffineTransformMatrix();
+		if (worldMat != record.worldMat)
+		{
+			record.worldMat = worldMat;
+			isOutdated = true;
+		}
+	}
+
+	uint32_t geometryVersion = record.geometryVersion;
+	switch (record.pObj->GetObjectType())
+	{
+	case NOISE_SCENE_OBJECT_TYPE::MESH:
+		geometryVersion = static_cast<Mesh*>(record.pObj)->GetGeometryVersion();
+		break;
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_BOX:
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_SPHERE:
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_RECT:
+		geometryVersion = static_cast<ILogicalShape*>(record.pObj)->GetGeometryVersion();
+		break;
+	default:
+		break;
+	}
+	if (geometryVersion != record.geometryVersion)
+	{
+		record.geometryVersion = geometryVersion;
+		isOutdated = true;
+	}
+
+	return isOutdated;
+}
+
+void Noise3D::BvhTreeForScene::mFunction_RebuildSubtree(BvhNodeForScene * pNode, uint32_t threadCount)
+{
+	//gather objects (with refitted AABB) of the sub-tree, then remove the old sub-tree
+	std::vector<BvhNodeForScene*> subtreeNodeList;
+	BvhTreeForScene::Traverse_PreOrder(pNode, subtreeNodeList);
+	std::vector<ObjectAabbPair> infoList;
+	for (auto pn : subtreeNodeList)
+	{
+		if (pn->IsLeafNode() && pn->GetGiRenderable() != nullptr)
+		{
+			ObjectAabbPair info;
+			info.pObj = pn->GetGiRenderable();
+			info.aabb = pn->GetAABB();
+			infoList.push_back(info);
+		}
+	}
+
+	std::vector<BvhNodeForScene*> childList;
+	for (uint32_t i = 0; i < pNode->GetChildNodeCount(); ++i)childList.push_back(pNode->GetChildNode(i));
+	for (auto pn : childList)BvhTreeForScene::Remove(pn);
+
+	std::vector<N_BvhBuildPrimitive> primList(infoList.size());
+	for (uint32_t i = 0; i < infoList.size(); ++i)primList[i] = N_BvhBuildPrimitive(i, infoList[i].aabb);
+	N_AABB tmpAabb, centroidAabb;
+	BvhSahBuilder::ComputeRangeAabb(primList, 0, primList.size(), tmpAabb, centroidAabb, threadCount);
+	mFunction_SplitSahBinned(pNode, infoList, primList, 0, primList.size(), centroidAabb, threadCount);
+}
+
+void Noise3D::BvhTreeForScene::mFunction_Reflatten()
+{
+	uint32_t objectCount = mLinearObjectList.size();
+	mLinearNodeList.clear();
+	mLinearObjectList.clear();
+	mLinearObjectList.reserve(objectCount);
+	mFunction_Flatten(BvhTreeForScene::GetRoot());
+	BvhSahBuilder::ComputeStatistics(mLinearNodeList, mBuildStat);
+	BvhWideCollapser::Collapse(mLinearNodeList, mWideNodeList);
+	mBuildStat.wideNodeCount = mWideNodeList.size();
+}
+
+void Noise3D::BvhTreeForScene::mFunction_Flatten(BvhNodeForScene * pNode)
+{
+	//pre-order traversal. (be careful that the node list might be re-allocated
+	//during recursion, so use index instead of reference)
+	uint32_t currentIndex = mLinearNodeList.size();
+	N_AABB aabb = pNode->GetAABB();
+	N_BvhLinearNode linearNode;
+	linearNode.aabbMin = aabb.min;
+	linearNode.aabbMax = aabb.max;
+	mLinearNodeList.push_back(linearNode);
+
+	if (pNode->IsLeafNode())
+	{
+		GI::IGiRenderable* pObj = pNode->GetGiRenderable();
+		if (pObj == nullptr)
+		{
+			//empty leaf is regarded as an interior node without child
+			mLinearNodeList.at(currentIndex).offset = currentIndex + 1;
+			return;
+		}
+		mLinearNodeList.at(currentIndex).offset = mLinearObjectList.size();
+		mLinearNodeList.at(currentIndex).primitiveCount = 1;
+		mLinearObjectList.push_back(pObj);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < pNode->GetChildNodeCount(); ++i)
+		{
+			mFunction_Flatten(pNode->GetChildNode(i));
+		}
+		//skip index: the node after the whole sub-tree
+		mLinearNodeList.at(currentIndex).offset = mLinearNodeList.size();
+	}
+}
+
 inline float Noise3D::BvhTreeForScene::mFunction_GetVecComponent(Vec3 vec, uint32_t id)
 {
 	switch (id)
@@ -63,8 +63,47 @@ namespace Noise3D
 
 		void TraverseSceneObjects(NOISE_TREE_TRAVERSE_ORDER order, std::vector<GI::IGiRenderable*>& outResult) const;
 
+		//flattened nodes in depth-first order (produced after Construct())
+		const std::vector<N_BvhLinearNode>& GetLinearNodeList() const;
+
+		//linear node list collapsed into 4/8-ary nodes (wide node 0 is the root). leaf children refer to GetLinearObjectList()
+		const std::vector<N_BvhWideNode>& GetWideNodeList() const;
+
+		//scene objects reordered by leaf nodes. a leaf node refers to range [offset, offset+primitiveCount)
+		const std::vector<GI::IGiRenderable*>& GetLinearObjectList() const;
+
+		//build method used by following Construct() (SAH_BINNED by default)
+		void SetBuildMethod(NOISE_BVH_BUILD_METHOD method);
+
+		NOISE_BVH_BUILD_METHOD GetBuildMethod() const;
+
+		//thread count of SAH build, 0 for std::thread::hardware_concurrency() (default).
+		//built tree is identical for any thread count
+		void SetBuildThreadCount(uint32_t threadCount);
+
+		//statistics of the last Construct() (or the tree after last Refit())
+		const N_BvhBuildStatistics& GetBuildStatistics() const;
+
+		//incrementally update the tree built by Construct(pNode), e.g. every frame of a progressive preview.
+		//objects whose world transform (or mesh/logical shape geometry) changed are re-bounded, then AABBs are refitted bottom-up.
+		//mesh's internal BVH is in model space, it's never rebuilt just because the mesh moved.
+		//the whole tree is re-constructed if collidable objects under pNode were added/removed.
+		bool Refit(SceneNode* pNode);
+
+		//force an object to be re-bounded by next Refit() (e.g. its bounds changed in a way that isn't versioned)
+		void MarkObjectDirty(GI::IGiRenderable* pObj);
+
+		//after refit, a sub-tree whose AABB surface area grows over 'ratio' times of the built one is rebuilt
+		//(only the sub-tree for SAH_BINNED, the whole tree for MIDPOINT). ratio<=1 disables it. 2.0 by default
+		void SetRefitRebuildThreshold(float surfaceAreaRatio);
+
+		//what the last Refit() did
+		const N_BvhRefitStatistics& GetRefitStatistics() const;
+
 	private:
 
+
+
 		//SceneObject ptr and its aabb cache
 		struct ObjectAabbPair
 		{
@@ -75,12 +114,76 @@ namespace Noise3D
 			N_AABB aabb;//cached result
 		};
 
+		//collidable object and the state it was bounded with (to detect dirty objects in Refit())
+		struct ObjectRecord
+		{
+			ObjectRecord() : pObj(nullptr), geometryVersion(0), isMarkedDirty(false) {}
+
+			GI::IGiRenderable* pObj;
+			Matrix worldMat;
+			uint32_t geometryVersion;//for mesh and logical shapes
+			bool isMarkedDirty;
+		};
+
 		//deprecated
 		bool mFunction_SplitMidPointViaCentroid(BvhNodeForScene* pNode,const std::vector<ObjectAabbPair>& infoList);
 
 		bool mFunction_SplitMidPointViaAabbSlabs(BvhNodeForScene* pNode, const std::vector<ObjectAabbPair>& infoList);
 
+		//binned SAH split, one object per leaf. primList[begin,end) is partitioned in place, id of primitive is index of infoList
+		bool mFunction_SplitSahBinned(BvhNodeForScene* pNode, const std::vector<ObjectAabbPair>& infoList, std::vector<N_BvhBuildPrimitive>& primList, uint32_t begin, uint32_t end, const N_AABB& centroidAabb, uint32_t threadCount);
+
+
 		float mFunction_GetVecComponent(Vec3 vec, uint32_t id);
+
+		//collidable GI renderable objects under pNode, in pre-order
+		void mFunction_CollectCollidableObjects(SceneNode* pNode, std::vector<GI::IGiRenderable*>& outList);
+
+		//world AABB of object. (mesh's is computed with its BVH, not every vertex)
+		N_AABB mFunction_ComputeObjectWorldAabb(GI::IGiRenderable* pObj);
+
+		//compare with current state, update the record and return true if it's changed (or marked dirty)
+		bool mFunction_IsObjectRecordOutdated(ObjectRecord& record);
+
+		//re-split a sub-tree with SAH, with AABBs currently held by its leaves
+		void mFunction_RebuildSubtree(BvhNodeForScene* pNode, uint32_t threadCount);
+
+		//re-generate linear node list from pointer-based tree
+		void mFunction_Reflatten();
+
+		//convert pointer-based tree into depth-first linear node array
+		void mFunction_Flatten(BvhNodeForScene* pNode);
+
+		std::vector<N_BvhLinearNode> mLinearNodeList;
+
+		std::vector<N_BvhWideNode> mWideNodeList;
+
+		std::vector<GI::IGiRenderable*> mLinearObjectList;
+
+		NOISE_BVH_BUILD_METHOD mBuildMethod;
+
+		uint32_t mBuildThreadCount;
+
+		N_BvhBuildStatistics mBuildStat;
+
+		//refit states
+		static const uint32_t c_meshBoundingNodeCount = 16;
+
+		SceneNode* m_pBuiltSceneNode;
+
+		NOISE_BVH_BUILD_METHOD mBuiltMethod;
+
+		std::vector<float> mBuildSurfaceAreaList;//surface area of linear nodes right after build
+
+		std::vector<ObjectRecord> mObjectRecordList;//pre-order, same as mFunction_CollectCollidableObjects()
+
+		std::unordered_map<GI::IGiRenderable*, uint32_t> mObjectRecordIndexMap;
+
+		float mRefitRebuildThreshold;
+
+		N_BvhRefitStatistics mRefitStat;
+
 	};
 
+
 }
@@ -0,0 +1,127 @@
+
+/***********************************************************************
+
+							cpp: BVH wide collapser
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+
+void Noise3D::BvhWideCollapser::Collapse(const std::vector<N_BvhLinearNode>& linearNodeList, std::vector<N_BvhWideNode>& outWideNodeList)
+{
+	outWideNodeList.clear();
+	if (linearNodeList.empty())return;
+	outWideNodeList.reserve(linearNodeList.size() / (N_BvhWideNode::c_width - 1) + 1);
+
+	//a single leaf: root wide node with only one child
+	const N_BvhLinearNode& root = linearNodeList.front();
+	if (root.IsLeafNode())
+	{
+		N_BvhWideNode wideNode;
+		wideNode.SetChildAABB(0, root.GetAABB());
+		wideNode.childIndex[0] = root.offset;
+		wideNode.childPrimitiveCount[0] = root.primitiveCount;
+		wideNode.childCount = 1;
+		outWideNodeList.push_back(wideNode);
+		return;
+	}
+
+	mFunction_CollapseNode(linearNodeList, 0, outWideNodeList);
+}
+
+/***********************************************
+
+							PRIVATE
+
+***********************************************/
+
+uint32_t Noise3D::BvhWideCollapser::mFunction_CollapseNode(const std::vector<N_BvhLinearNode>& linearNodeList, uint32_t linearNodeId, std::vector<N_BvhWideNode>& outWideNodeList)
+{
+	const uint32_t c_width = N_BvhWideNode::c_width;
+
+	//children of the linear node (first child follows its parent, siblings are linked by skip index)
+	uint32_t slotList[c_width];
+	uint32_t slotCount = 0;
+	const N_BvhLinearNode& node = linearNodeList[linearNodeId];
+	for (uint32_t childId = linearNodeId + 1; childId < node.offset && slotCount < c_width; childId = linearNodeList[childId].GetSkipIndex(childId))
+	{
+		slotList[slotCount++] = childId;
+	}
+
+	//pull up grandchildren: open the interior child with the largest surface area while it still fits
+	while (slotCount < c_width)
+	{
+		int bestSlot = -1;
+		float bestArea = -1.0f;
+		for (uint32_t i = 0; i < slotCount; ++i)
+		{
+			const N_BvhLinearNode& child = linearNodeList[slotList[i]];
+			if (child.IsLeafNode())continue;
+			if (slotCount - 1 + mFunction_GetChildCount(linearNodeList, slotList[i]) > c_width)continue;
+			float area = child.GetAABB().SurfaceArea();
+			if (area > bestArea)
+			{
+				bestArea = area;
+				bestSlot = int(i);
+			}
+		}
+		if (bestSlot < 0)break;
+
+		uint32_t openedId = slotList[bestSlot];
+		const N_BvhLinearNode& opened = linearNodeList[openedId];
+
+		//empty interior node (from empty leaf) is simply dropped
+		if (opened.offset == openedId + 1)
+		{
+			slotList[bestSlot] = slotList[--slotCount];
+			continue;
+		}
+
+		bool isFirst = true;
+		for (uint32_t childId = openedId + 1; childId < opened.offset; childId = linearNodeList[childId].GetSkipIndex(childId))
+		{
+			if (isFirst)
+			{
+				slotList[bestSlot] = childId;
+				isFirst = false;
+			}
+			else
+			{
+				slotList[slotCount++] = childId;
+			}
+		}
+	}
+
+	//father is stored before its sub-trees (depth-first), it's filled after children are collapsed
+	uint32_t wideNodeId = outWideNodeList.size();
+	outWideNodeList.push_back(N_BvhWideNode());
+	N_BvhWideNode wideNode;
+	wideNode.childCount = slotCount;
+	for (uint32_t i = 0; i < slotCount; ++i)
+	{
+		const N_BvhLinearNode& child = linearNodeList[slotList[i]];
+		wideNode.SetChildAABB(i, child.GetAABB());
+		if (child.IsLeafNode())
+		{
+			wideNode.childIndex[i] = child.offset;
+			wideNode.childPrimitiveCount[i] = child.primitiveCount;
+		}
+		else
+		{
+			wideNode.childIndex[i] = mFunction_CollapseNode(linearNodeList, slotList[i], outWideNodeList);
+			wideNode.childPrimitiveCount[i] = 0;
+		}
+	}
+	outWideNodeList[wideNodeId] = wideNode;
+	return wideNodeId;
+}
+
+uint32_t Noise3D::BvhWideCollapser::mFunction_GetChildCount(const std::vector<N_BvhLinearNode>& linearNodeList, uint32_t linearNodeId)
+{
+	uint32_t count = 0;
+	const N_BvhLinearNode& node = linearNodeList[linearNodeId];
+	for (uint32_t childId = linearNodeId + 1; childId < node.offset; childId = linearNodeList[childId].GetSkipIndex(childId))++count;
+	return count;
+}
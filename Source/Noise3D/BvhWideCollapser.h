@@ -0,0 +1,30 @@
+/***********************************************************************
+
+							h: BVH wide collapser
+		desc: collapse a flattened binary/ternary BVH into a wide(4-ary/8-ary)
+		BVH, shared by BVH for scene and BVH for triangular mesh.
+		the wide BVH refers to the same linear primitive list.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	class /*_declspec(dllexport)*/ BvhWideCollapser
+	{
+	public:
+
+		//wide node 0 is the root. an interior child with the largest surface area is replaced
+		//by its children repeatedly, until the node is full (or all children are leaves).
+		//result only depends on the input node list.
+		static void Collapse(const std::vector<N_BvhLinearNode>& linearNodeList, std::vector<N_BvhWideNode>& outWideNodeList);
+
+	private:
+
+		//collapse the sub-tree of an interior linear node, return index of the created wide node
+		static uint32_t mFunction_CollapseNode(const std::vector<N_BvhLinearNode>& linearNodeList, uint32_t linearNodeId, std::vector<N_BvhWideNode>& outWideNodeList);
+
+		static uint32_t mFunction_GetChildCount(const std::vector<N_BvhLinearNode>& linearNodeList, uint32_t linearNodeId);
+	};
+}
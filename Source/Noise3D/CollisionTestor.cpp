@@ -12,6 +12,8 @@
 using namespace Noise3D;
 using namespace Noise3D::D3D;
 
+bool CollisionTestor::mIsWideBvhTraversalEnabled = true;
+
 CollisionTestor::CollisionTestor():
 	m_pRefShaderVarMgr(nullptr),
 	m_pSOGpuWriteableBuffer(nullptr),
@@ -642,28 +644,42 @@ bool Noise3D::CollisionTestor::IntersectRayMeshWithBvh(const N_Ray & ray, Mesh *
 	RayIntersectionTransformHelper helper;
 	if (!helper.Ray_WorldToModel(ray, false, pMesh, localRay))return false;
 
-	//gather all possible triangle candidates
-	std::vector<uint32_t> triangleIndexList;
-	CollisionTestor::mFunction_IntersectRayMeshInternalBvhNode(localRay, pMesh->GetBvhTree().GetRoot(), triangleIndexList);
+	//flattened BVH (depth-first node array)
+	const BvhTreeForTriangularMesh& bvh = pMesh->GetBvhTree();
+	const std::vector<N_BvhLinearNode>& nodeList = bvh.GetLinearNodeList();
+	const std::vector<N_BvhWideNode>& wideNodeList = bvh.GetWideNodeList();
+	const std::vector<uint32_t>& triIdList = bvh.GetLinearTriangleIdList();
+	const std::vector<N_BvhTriangle>& triList = bvh.GetLinearTriangleList();
 
 	//get vertex data (be noted that the vertex is in MODEL SPACE
-	const std::vector<N_DefaultVertex>* pVB = pMesh->GetVertexBuffer();
-	const std::vector<uint32_t>* pIB = pMesh->GetIndexBuffer();
+	const std::vector<N_DefaultVertex>& vb = *pMesh->GetVertexBuffer();
+	const std::vector<uint32_t>& ib = *pMesh->GetIndexBuffer();
 
-	for (auto triId : triangleIndexList)
+	//leaf node, test triangles in its range of linear triangle list.
+	//vertex attributes are only fetched for triangles that are hit
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
 	{
-		N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
-		const N_DefaultVertex& v0 = pVB->at(pIB->at(3 * triId + 0));
-		const N_DefaultVertex& v1 = pVB->at(pIB->at(3 * triId + 1));
-		const N_DefaultVertex& v2 = pVB->at(pIB->at(3 * triId + 2));
-
-		//delegate each ray-tri intersection task to another function
-		if (CollisionTestor::IntersectRayTriangle(localRay, v0, v1, v2, hitInfo))
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
 		{
-			hitInfo.triangleIndex = triId;
-			outHitRes.hitList.push_back(hitInfo);
+			float t = 0.0f;
+			if (!CollisionTestor::mFunction_IntersectRayBvhTriangle(r, triList[i], t))continue;
+
+			uint32_t triId = triIdList[i];
+			N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+			const N_DefaultVertex& v0 = vb[ib[3 * triId + 0]];
+			const N_DefaultVertex& v1 = vb[ib[3 * triId + 1]];
+			const N_DefaultVertex& v2 = vb[ib[3 * triId + 2]];
+
+			//delegate each ray-tri intersection task to another function
+			if (CollisionTestor::IntersectRayTriangle(r, v0, v1, v2, hitInfo))
+			{
+				hitInfo.triangleIndex = triId;
+				outHitRes.hitList.push_back(hitInfo);
+			}
 		}
-	}
+		return false;
+	};
+	CollisionTestor::mFunction_TraverseLinearBvh(nodeList, localRay, leafFunc);
 
 	//convert result point back to world space
 	helper.HitResult_ModelToWorld(outHitRes);
@@ -671,6 +687,127 @@ bool Noise3D::CollisionTestor::IntersectRayMeshWithBvh(const N_Ray & ray, Mesh *
 	return true;
 }
 
+bool Noise3D::CollisionTestor::IntersectRayMeshWithBvh_ClosestHit(const N_Ray & ray, Mesh * pMesh, N_RayHitInfo & outHitInfo)
+{
+	if (pMesh == nullptr)
+	{
+		ERROR_MSG("CollisionTestor: object is nullptr.");
+		return false;
+	}
+
+	if (!pMesh->IsBvhTreeBuilt())
+	{
+		ERROR_MSG("CollisionTestor: mesh's internal BVH hasn't been built!");
+		return false;
+	}
+
+	if (!pMesh->Collidable::IsCollidable())return false;
+
+	//convert ray to model space (affine transform keeps ray's parameter t, so t can be compared in any space)
+	N_Ray localRay;
+	RayIntersectionTransformHelper helper;
+	if (!helper.Ray_WorldToModel(ray, false, pMesh, localRay))return false;
+
+	const BvhTreeForTriangularMesh& bvh = pMesh->GetBvhTree();
+	const std::vector<N_BvhLinearNode>& nodeList = bvh.GetLinearNodeList();
+	const std::vector<N_BvhWideNode>& wideNodeList = bvh.GetWideNodeList();
+	const std::vector<uint32_t>& triIdList = bvh.GetLinearTriangleIdList();
+	const std::vector<N_BvhTriangle>& triList = bvh.GetLinearTriangleList();
+	const std::vector<N_DefaultVertex>& vb = *pMesh->GetVertexBuffer();
+	const std::vector<uint32_t>& ib = *pMesh->GetIndexBuffer();
+
+	//only precomputed triangles (contiguous in leaf order) are used during traversal, each hit clips the ray
+	int closestTriId = -1;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			float t = 0.0f;
+			if (CollisionTestor::mFunction_IntersectRayBvhTriangle(r, triList[i], t))
+			{
+				r.t_max = t;
+				closestTriId = triIdList[i];
+			}
+		}
+		return false;
+	};
+	CollisionTestor::mFunction_TraverseBvh(nodeList, wideNodeList, localRay, true, leafFunc);
+	if (closestTriId < 0)return false;
+
+	//vertex attributes are interpolated only once, for the closest triangle
+	localRay.t_max = ray.t_max;
+	const N_DefaultVertex& v0 = vb[ib[3 * closestTriId + 0]];
+	const N_DefaultVertex& v1 = vb[ib[3 * closestTriId + 1]];
+	const N_DefaultVertex& v2 = vb[ib[3 * closestTriId + 2]];
+	if (!CollisionTestor::IntersectRayTriangle(localRay, v0, v1, v2, outHitInfo))return false;
+	outHitInfo.triangleIndex = closestTriId;
+
+	//convert result point back to world space
+	helper.HitInfo_ModelToWorld(outHitInfo);
+	return true;
+}
+
+bool Noise3D::CollisionTestor::IntersectRayMeshWithBvh_AnyHit(const N_Ray & ray, Mesh * pMesh)
+{
+	if (pMesh == nullptr)
+	{
+		ERROR_MSG("CollisionTestor: object is nullptr.");
+		return false;
+	}
+
+	if (!pMesh->IsBvhTreeBuilt())
+	{
+		ERROR_MSG("CollisionTestor: mesh's internal BVH hasn't been built!");
+		return false;
+	}
+
+	if (!pMesh->Collidable::IsCollidable())return false;
+
+	N_Ray localRay;
+	RayIntersectionTransformHelper helper;
+	if (!helper.Ray_WorldToModel(ray, false, pMesh, localRay))return false;
+
+	const BvhTreeForTriangularMesh& bvh = pMesh->GetBvhTree();
+	const std::vector<N_BvhLinearNode>& nodeList = bvh.GetLinearNodeList();
+	const std::vector<N_BvhWideNode>& wideNodeList = bvh.GetWideNodeList();
+	const std::vector<N_BvhTriangle>& triList = bvh.GetLinearTriangleList();
+
+	//traversal order doesn't matter, terminate on the first hit
+	bool isHit = false;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			float t = 0.0f;
+			if (CollisionTestor::mFunction_IntersectRayBvhTriangle(r, triList[i], t))
+			{
+				isHit = true;
+				return true;
+			}
+		}
+		return false;
+	};
+	CollisionTestor::mFunction_TraverseBvh(nodeList, wideNodeList, localRay, false, leafFunc);
+	return isHit;
+}
+
+bool Noise3D::CollisionTestor::IntersectRayGiRenderable_ClosestHit(const N_Ray & ray, GI::IGiRenderable * pRenderable, N_RayHitInfo & outHitInfo)
+{
+	if (pRenderable == nullptr)return false;
+
+	//mesh with BVH has its own closest-hit traversal, other objects only produce 1 or 2 hits
+	if (pRenderable->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
+	{
+		Mesh* pMesh = static_cast<Mesh*>(pRenderable);
+		if (pMesh->IsBvhTreeBuilt())
+			return CollisionTestor::IntersectRayMeshWithBvh_ClosestHit(ray, pMesh, outHitInfo);
+	}
+
+	N_RayHitResult tmpResult;
+	CollisionTestor::mFunction_IntersectRayGiRenderable(ray, pRenderable, tmpResult);
+	return CollisionTestor::mFunction_GetClosestHit(ray, tmpResult, outHitInfo);
+}
+
 bool Noise3D::CollisionTestor::IntersectRayMesh_GpuBased(const N_Ray & ray, Mesh * pMesh, N_RayHitResult & outHitRes)
 {
 	//(2019.4.26)WARNING:STill BUGGY
@@ -749,33 +886,121 @@ bool Noise3D::CollisionTestor::IntersectRayMesh_GpuBased(const N_Ray & ray, Mesh
 bool Noise3D::CollisionTestor::IntersectRayScene(const N_Ray & ray, N_RayHitResult & outHitRes)
 {
 	//warn the user if BVH is not rebuilt
-	BvhNodeForScene* pBvhRoot = mBvhTree.GetRoot();
-	if (pBvhRoot->IsLeafNode() && pBvhRoot->GetGiRenderable() == nullptr)
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
 	{
 		WARNING_MSG("IntersectRayScene: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
 		return false;
 	}
 
-	//start the recursion and BVH branch pruning
-	mFunction_IntersectRayBvhNode(ray, pBvhRoot, outHitRes);
+	//stackless traversal of flattened BVH and branch pruning
+	//BVH leaf node, extract concrete object to intersect
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			N_RayHitResult tmpResult;
+			CollisionTestor::mFunction_IntersectRayGiRenderable(r, objList[i], tmpResult);
+			outHitRes.Union(tmpResult);
+		}
+		return false;
+	};
+	N_Ray tmpRay = ray;
+	CollisionTestor::mFunction_TraverseLinearBvh(nodeList, tmpRay, leafFunc);
 	return outHitRes.HasAnyHit();
 }
 
 bool Noise3D::CollisionTestor::IntersectRaySceneForPathTracer(const N_Ray & ray, N_RayHitResultForPathTracer & outHitRes)
 {
 	//warn the user if BVH is not rebuilt
-	BvhNodeForScene* pBvhRoot = mBvhTree.GetRoot();
-	if (pBvhRoot->IsLeafNode() && pBvhRoot->GetGiRenderable() == nullptr)
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
 	{
 		WARNING_MSG("IntersectRaySceneForPathTracer: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
 		return false;
 	}
 
-	//start the recursion and BVH branch pruning
-	mFunction_IntersectRayBvhNodeForPathTracer(ray, pBvhRoot, outHitRes);
+	//similar to the common version, extra info(hit object) is added
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			GI::IGiRenderable* pRenderable = objList[i];
+			N_RayHitResult tmpResult;
+			CollisionTestor::mFunction_IntersectRayGiRenderable(r, pRenderable, tmpResult);
+			for (auto& e : tmpResult.hitList)
+				outHitRes.hitList.push_back(N_RayHitInfoForPathTracer(pRenderable, e));
+		}
+		return false;
+	};
+	N_Ray tmpRay = ray;
+	CollisionTestor::mFunction_TraverseLinearBvh(nodeList, tmpRay, leafFunc);
 	return outHitRes.HasAnyHit();
 }
 
+bool Noise3D::CollisionTestor::IntersectRaySceneForPathTracer_ClosestHit(const N_Ray & ray, N_RayHitInfoForPathTracer & outHitInfo)
+{
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
+	{
+		WARNING_MSG("IntersectRaySceneForPathTracer_ClosestHit: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
+		return false;
+	}
+
+	//each hit clips the ray, so farther objects/nodes are culled
+	bool anyHit = false;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			GI::IGiRenderable* pRenderable = objList[i];
+			N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+			if (CollisionTestor::IntersectRayGiRenderable_ClosestHit(r, pRenderable, hitInfo))
+			{
+				r.t_max = hitInfo.t;
+				outHitInfo = N_RayHitInfoForPathTracer(pRenderable, hitInfo);
+				anyHit = true;
+			}
+		}
+		return false;
+	};
+	N_Ray clippedRay = ray;
+	CollisionTestor::mFunction_TraverseBvh(nodeList, mBvhTree.GetWideNodeList(), clippedRay, true, leafFunc);
+	return anyHit;
+}
+
+bool Noise3D::CollisionTestor::IntersectRaySceneAnyHit(const N_Ray & ray)
+{
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
+	{
+		WARNING_MSG("IntersectRaySceneAnyHit: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
+		return false;
+	}
+
+	//exit on the first blocker
+	bool anyHit = false;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_Ray& r)->bool
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			if (CollisionTestor::mFunction_IntersectRayGiRenderable_AnyHit(r, objList[i]))
+			{
+				anyHit = true;
+				return true;
+			}
+		}
+		return false;
+	};
+	N_Ray tmpRay = ray;
+	CollisionTestor::mFunction_TraverseBvh(nodeList, mBvhTree.GetWideNodeList(), tmpRay, false, leafFunc);
+	return anyHit;
+}
+
 bool Noise3D::CollisionTestor::RebuildBvhTreeForGI(const SceneGraph & graph)
 {
 	mBvhTree.Reset();
@@ -788,6 +1013,41 @@ bool Noise3D::CollisionTestor::RebuildBvhTreeForGI(SceneNode * pNode)
 	return mBvhTree.Construct(pNode);
 }
 
+bool Noise3D::CollisionTestor::UpdateBvhTreeForGI(SceneNode * pNode)
+{
+	return mBvhTree.Refit(pNode);
+}
+
+void Noise3D::CollisionTestor::MarkObjectDirtyForGI(GI::IGiRenderable * pObj)
+{
+	mBvhTree.MarkObjectDirty(pObj);
+}
+
+void Noise3D::CollisionTestor::SetBvhRefitRebuildThresholdForGI(float surfaceAreaRatio)
+{
+	mBvhTree.SetRefitRebuildThreshold(surfaceAreaRatio);
+}
+
+void Noise3D::CollisionTestor::SetBvhBuildMethodForGI(NOISE_BVH_BUILD_METHOD method)
+{
+	mBvhTree.SetBuildMethod(method);
+}
+
+void Noise3D::CollisionTestor::SetWideBvhTraversalEnabled(bool enabled)
+{
+	mIsWideBvhTraversalEnabled = enabled;
+}
+
+bool Noise3D::CollisionTestor::IsWideBvhTraversalEnabled()
+{
+	return mIsWideBvhTraversalEnabled;
+}
+
+void Noise3D::CollisionTestor::SetBvhBuildThreadCountForGI(uint32_t threadCount)
+{
+	mBvhTree.SetBuildThreadCount(threadCount);
+}
+
 const BvhTreeForScene & Noise3D::CollisionTestor::GetBvhTree()
 {
 	return mBvhTree;
@@ -902,184 +1162,339 @@ inline void  Noise3D::CollisionTestor::mFunction_AabbFacet(uint32_t slabsPairId,
 	if (isDirNeg)std::swap(nearHit, farHit);
 }
 
-void Noise3D::CollisionTestor::mFunction_IntersectRayMeshInternalBvhNode(const N_Ray& ray,BvhNodeForTriangularMesh* bvhNode, std::vector<uint32_t>& outTriangleIdList)
+inline bool Noise3D::CollisionTestor::mFunction_IntersectRayLinearBvhNode(const N_Ray & ray, const Vec3 & invDir, const N_BvhLinearNode & node, float & outNearT)
+{
+	//similar to IntersectRayAabb(), but the reciprocal of ray dir is computed only once per ray,
+	//and it's an overlap test of t intervals. (the ray starting inside AABB is also regarded as a hit,
+	//because there might be something inside the AABB to hit)
+	float rayOrigin[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+	float rayDirReciprocal[3] = { invDir.x, invDir.y, invDir.z };
+	float slab_min[3] = { node.aabbMin.x, node.aabbMin.y, node.aabbMin.z };
+	float slab_max[3] = { node.aabbMax.x, node.aabbMax.y, node.aabbMax.z };
+
+	float t_resultMin = ray.t_min;
+	float t_resultMax = ray.t_max;
+	for (int i = 0; i < 3; ++i)
+	{
+		float t_near = (slab_min[i] - rayOrigin[i]) * rayDirReciprocal[i];
+		float t_far = (slab_max[i] - rayOrigin[i]) * rayDirReciprocal[i];
+		if (t_near > t_far) std::swap(t_near, t_far);
+
+		// Update _tFar_ to ensure robust ray--bounds intersection(pbrt-v3, 'rounding errors')
+		t_far *= (1 + 2 * mFunc_Gamma(3));
+
+		//NaN (0 * inf) fails the comparison and is ignored
+		if (t_near > t_resultMin) t_resultMin = t_near;
+		if (t_far < t_resultMax) t_resultMax = t_far;
+		if (t_resultMin > t_resultMax)return false;
+	}
+
+	outNearT = t_resultMin;
+	return true;
+}
+
+inline bool Noise3D::CollisionTestor::mFunction_IntersectRayBvhTriangle(const N_Ray & ray, const N_BvhTriangle & tri, float & outT)
+{
+	//edges are precomputed, and rejection is the same as IntersectRayTriangle(), so that 
+	//the closest triangle found here is hit again when its attributes are interpolated
+	Vec3 P = ray.dir.Cross(tri.e2);//P = D x E2
+	float det = P.Dot(tri.e1);
+	if (std::abs(det) <= std::numeric_limits<float>::epsilon())return false;
+
+	float invDet = 1.0f / det;
+	Vec3 M = ray.origin - tri.v0;// M = O - V0
+	float u = invDet * M.Dot(P);
+	if (u < 0.0f || u> 1.0f)return false;
+
+	Vec3 Q = M.Cross(tri.e1);//Q = M x E1
+	float v = invDet * ray.dir.Dot(Q);
+	if (v < 0.0f || u + v>1.0f)return false;
+
+	float t = invDet * tri.e2.Dot(Q);
+	if (t < ray.t_min || t > ray.t_max)return false;
+
+	outT = t;
+	return true;
+}
+
+uint32_t Noise3D::CollisionTestor::mFunction_IntersectRayWideBvhNode(const N_Ray & ray, const Vec3 & invDir, const N_BvhWideNode & node, float * outNearT)
+{
+	//slabs of all children, NOISE_SIMD_WIDTH children per instruction. invDir is computed with SafeReciprocal(),
+	//so there's no NaN, and min/max of slab distances are enough. unused slots are masked out by childCount
+	SIMD::simd_float originX = SIMD::SimdSet1(ray.origin.x);
+	SIMD::simd_float originY = SIMD::SimdSet1(ray.origin.y);
+	SIMD::simd_float originZ = SIMD::SimdSet1(ray.origin.z);
+	SIMD::simd_float invDirX = SIMD::SimdSet1(invDir.x);
+	SIMD::simd_float invDirY = SIMD::SimdSet1(invDir.y);
+	SIMD::simd_float invDirZ = SIMD::SimdSet1(invDir.z);
+	SIMD::simd_float rayMinT = SIMD::SimdSet1(ray.t_min);
+	SIMD::simd_float rayMaxT = SIMD::SimdSet1(ray.t_max);
+	SIMD::simd_float farScale = SIMD::SimdSet1(1 + 2 * mFunc_Gamma(3));
+
+	uint32_t hitMask = 0;
+	for (uint32_t base = 0; base < N_BvhWideNode::c_width; base += NOISE_SIMD_WIDTH)
+	{
+		SIMD::simd_float t0x = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMinX + base), originX), invDirX);
+		SIMD::simd_float t1x = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMaxX + base), originX), invDirX);
+		SIMD::simd_float t0y = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMinY + base), originY), invDirY);
+		SIMD::simd_float t1y = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMaxY + base), originY), invDirY);
+		SIMD::simd_float t0z = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMinZ + base), originZ), invDirZ);
+		SIMD::simd_float t1z = SIMD::SimdMul(SIMD::SimdSub(SIMD::SimdLoad(node.childAabbMaxZ + base), originZ), invDirZ);
+
+		SIMD::simd_float t_near = SIMD::SimdMax(SIMD::SimdMax(SIMD::SimdMin(t0x, t1x), SIMD::SimdMin(t0y, t1y)), SIMD::SimdMax(SIMD::SimdMin(t0z, t1z), rayMinT));
+		SIMD::simd_float t_far = SIMD::SimdMin(SIMD::SimdMin(SIMD::SimdMax(t0x, t1x), SIMD::SimdMax(t0y, t1y)), SIMD::SimdMax(t0z, t1z));
+
+		//robust ray--bounds intersection(pbrt-v3, 'rounding errors')
+		t_far = SIMD::SimdMin(SIMD::SimdMul(t_far, farScale), rayMaxT);
+
+		SIMD::SimdStore(outNearT + base, t_near);
+		hitMask |= SIMD::SimdMoveMask(SIMD::SimdLessEqual(t_near, t_far)) << base;
+	}
+
+	return hitMask & ((1u << node.childCount) - 1u);
+}
+
+void Noise3D::CollisionTestor::mFunction_IntersectRayGiRenderable(const N_Ray & ray, GI::IGiRenderable * pRenderable, N_RayHitResult & outHitRes)
+{
+	//(2019.3.30)well, it shouldn't run into the 'return' line if the BVH construction is correct.
+	if (pRenderable == nullptr)return;
+
+	switch (pRenderable->GetObjectType())
+	{
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_BOX:
+		CollisionTestor::IntersectRayBox(ray, static_cast<LogicalBox*>(pRenderable), outHitRes);
+		break;
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_SPHERE:
+		CollisionTestor::IntersectRaySphere(ray, static_cast<LogicalSphere*>(pRenderable), outHitRes);
+		break;
+	case NOISE_SCENE_OBJECT_TYPE::LOGICAL_RECT:
+		CollisionTestor::IntersectRayRect(ray, static_cast<LogicalRect*>(pRenderable), outHitRes);
+		break;
+	case NOISE_SCENE_OBJECT_TYPE::MESH:
+	{
+		Mesh* pMesh = static_cast<Mesh*>(pRenderable);
+		if (pMesh->IsBvhTreeBuilt())
+			CollisionTestor::IntersectRayMeshWithBvh(ray, pMesh, outHitRes);
+		else
+			CollisionTestor::IntersectRayMesh(ray, pMesh, outHitRes);
+		break;
+	}
+	default:
+		ERROR_MSG("Error: Bug!! The stupid author forgot to include some collidable object.");
+		break;
+	}
+}
+
+bool Noise3D::CollisionTestor::mFunction_IntersectRayGiRenderable_AnyHit(const N_Ray & ray, GI::IGiRenderable * pRenderable)
 {
-	//similar to scene's BVH
-	N_AABB aabb = bvhNode->GetAABB();
-	for (auto a : bvhNode->GetTriangleIndexList())
+	if (pRenderable == nullptr)return false;
+
+	if (pRenderable->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
+	{
+		Mesh* pMesh = static_cast<Mesh*>(pRenderable);
+		if (pMesh->IsBvhTreeBuilt())
+			return CollisionTestor::IntersectRayMeshWithBvh_AnyHit(ray, pMesh);
+	}
+
+	N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+	return CollisionTestor::IntersectRayGiRenderable_ClosestHit(ray, pRenderable, hitInfo);
+}
+
+bool Noise3D::CollisionTestor::mFunction_GetClosestHit(const N_Ray & ray, const N_RayHitResult & hitRes, N_RayHitInfo & outHitInfo)
+{
+	int closestId = -1;
+	float closest_t = ray.t_max;
+	for (uint32_t i = 0; i < hitRes.hitList.size(); ++i)
 	{
-		if (a == 1466)
+		float t = hitRes.hitList[i].t;
+		if (t >= ray.t_min && t <= closest_t)
 		{
-			int fucked = 1;
+			closest_t = t;
+			closestId = i;
 		}
 	}
-	bool isRayEndPointInside = aabb.IsPointInside(ray.origin) || aabb.IsPointInside(ray.Eval(ray.t_max));
-	bool isHit = CollisionTestor::IntersectRayAabb(ray, aabb);//ray's start,end are outside the AABB but still possible to hit
+	if (closestId < 0)return false;
+	outHitInfo = hitRes.hitList[closestId];
+	return true;
+}
 
-	
-	if (isRayEndPointInside || isHit)
+template <typename leafFunc_t>
+void Noise3D::CollisionTestor::mFunction_TraverseLinearBvh(const std::vector<N_BvhLinearNode>& nodeList, N_Ray & ray, leafFunc_t && leafFunc)
+{
+	//if a node is missed, its whole sub-tree is skipped via skip index,
+	//otherwise step into the next node (first child, or next node for leaf)
+	Vec3 invDir = Vec3(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+	uint32_t nodeCount = nodeList.size();
+	uint32_t nodeId = 0;
+	while (nodeId < nodeCount)
 	{
-		bool isLeafNode = bvhNode->IsLeafNode();
-		//BVH leaf node, extract concrete object to intersect
-		if (isLeafNode)
-		{
-			outTriangleIdList.assign(bvhNode->GetTriangleIndexList().begin(), bvhNode->GetTriangleIndexList().end());
-		}//isLeafNode
-		else
+		const N_BvhLinearNode& node = nodeList[nodeId];
+		float nearT = 0.0f;
+		if (!CollisionTestor::mFunction_IntersectRayLinearBvhNode(ray, invDir, node, nearT))
 		{
-			//gather results from
-			for (uint32_t i = 0; i < bvhNode->GetChildNodeCount(); ++i)
-			{
-				std::vector<uint32_t> tmpResult;
-				BvhNodeForTriangularMesh* pChildNode = bvhNode->GetChildNode(i);
-				CollisionTestor::mFunction_IntersectRayMeshInternalBvhNode(ray, pChildNode, tmpResult);
-				outTriangleIdList.insert(outTriangleIdList.end(),tmpResult.begin(),tmpResult.end());//push to back
-			}
+			//BVH branch pruned. thus accelerated.
+			nodeId = node.GetSkipIndex(nodeId);
+			continue;
 		}
-	}//isHit
-	 //else, BVH branch pruned. thus accelerated.
+
+		if (node.IsLeafNode() && leafFunc(node, ray))return;
+		++nodeId;
+	}
 }
 
-void Noise3D::CollisionTestor::mFunction_IntersectRayBvhNode(const N_Ray & ray, BvhNodeForScene * bvhNode, N_RayHitResult& outHitRes)
+template <typename leafFunc_t>
+void Noise3D::CollisionTestor::mFunction_TraverseLinearBvh_FrontToBack(const std::vector<N_BvhLinearNode>& nodeList, N_Ray & ray, leafFunc_t && leafFunc)
 {
-	//test ray against current bvh AABB
-	//(2019.3.30)WARNING: in some cases, the ray is inside AABB, but there won't be intersection on the surface
-	//however, the ray might still hit something inside the AABB
-	N_AABB aabb = bvhNode->GetAABB();
-	bool isRayEndPointInside = aabb.IsPointInside(ray.origin) || aabb.IsPointInside(ray.Eval(ray.t_max));
-	bool isHit = CollisionTestor::IntersectRayAabb(ray, aabb);//ray's start,end are outside the AABB but still possible to hit
-	if (isRayEndPointInside || isHit )
+	if (nodeList.empty())return;
+
+	//node to visit, and ray's entry distance of the node when it's pushed
+	struct StackEntry
 	{
-		//BVH leaf node, extract concrete object to intersect
-		if (bvhNode->IsLeafNode())
+		uint32_t nodeId;
+		float nearT;
+	};
+	StackEntry stack[c_bvhTraversalStackSize];
+	uint32_t stackSize = 0;
+
+	Vec3 invDir = Vec3(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z);
+	float rootNearT = 0.0f;
+	if (!CollisionTestor::mFunction_IntersectRayLinearBvhNode(ray, invDir, nodeList[0], rootNearT))return;
+	stack[stackSize++] = { 0, rootNearT };
+
+	while (stackSize > 0)
+	{
+		StackEntry entry = stack[--stackSize];
+
+		//ray might have been clipped since the node was pushed
+		if (entry.nearT > ray.t_max)continue;
+
+		const N_BvhLinearNode& node = nodeList[entry.nodeId];
+		if (node.IsLeafNode())
 		{
-			ISceneObject* pObj = bvhNode->GetGiRenderable();
-			N_RayHitResult tmpResult;
-			
-			//(2019.3.30)well, it shouldn't run into the 'return' line if the BVH construction is correct.
-			//but i'm not totally confident about that orz= =
-			if (pObj == nullptr)return;
-			Mesh* pMesh = nullptr;
+			if (leafFunc(node, ray))return;
+			continue;
+		}
 
-			switch (pObj->GetObjectType())
+		//children: the first child follows its parent, and siblings are linked by skip index.
+		//push hit children, then sort them so that the nearest one is on the top of the stack
+		uint32_t firstPushed = stackSize;
+		for (uint32_t childId = entry.nodeId + 1; childId < node.offset; childId = nodeList[childId].GetSkipIndex(childId))
+		{
+			float nearT = 0.0f;
+			if (!CollisionTestor::mFunction_IntersectRayLinearBvhNode(ray, invDir, nodeList[childId], nearT))continue;
+
+			if (stackSize == c_bvhTraversalStackSize)
 			{
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_BOX:
-				CollisionTestor::IntersectRayBox(ray, static_cast<LogicalBox*>(pObj), tmpResult);
-				break;
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_SPHERE:
-				CollisionTestor::IntersectRaySphere(ray, static_cast<LogicalSphere*>(pObj), tmpResult);
-				break;
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_RECT:
-				CollisionTestor::IntersectRayRect(ray, static_cast<LogicalRect*>(pObj), tmpResult);
-				break;
-			case NOISE_SCENE_OBJECT_TYPE::MESH:
-				pMesh = static_cast<Mesh*>(pObj);
-				if (pMesh->IsBvhTreeBuilt())
-					CollisionTestor::IntersectRayMeshWithBvh(ray, pMesh, tmpResult);
-				else
-					CollisionTestor::IntersectRayMesh(ray, pMesh, tmpResult);
-				break;
-			default:
-				ERROR_MSG("Error: Bug!! The stupid author forgot to include some collidable object.");
-				break;
+				//(very deep tree) stack overflow, fall back to stackless traversal.
+				//ray has been clipped by the hits found so far, so it's still correct
+				CollisionTestor::mFunction_TraverseLinearBvh(nodeList, ray, leafFunc);
+				return;
 			}
-			outHitRes.Union(tmpResult);
 
-		}//isLeafNode
-		else
-		{
-			//gather results from
-			for (uint32_t i = 0; i < bvhNode->GetChildNodeCount(); ++i)
+			//insertion, in descending order of nearT
+			uint32_t pos = stackSize++;
+			while (pos > firstPushed && stack[pos - 1].nearT < nearT)
 			{
-				N_RayHitResult tmpResult;
-				BvhNodeForScene* pChildNode = bvhNode->GetChildNode(i);
-				CollisionTestor::mFunction_IntersectRayBvhNode(ray, pChildNode, tmpResult);
-				outHitRes.Union(tmpResult);//push to back
+				stack[pos] = stack[pos - 1];
+				--pos;
 			}
+			stack[pos] = { childId, nearT };
 		}
-	}//isHit
-	//else, BVH branch pruned. thus accelerated.
+	}
 }
 
-void Noise3D::CollisionTestor::mFunction_IntersectRayBvhNodeForPathTracer(const N_Ray & ray, BvhNodeForScene * bvhNode, N_RayHitResultForPathTracer & outHitRes)
+template <typename leafFunc_t>
+bool Noise3D::CollisionTestor::mFunction_TraverseWideBvh(const std::vector<N_BvhWideNode>& wideNodeList, uint32_t rootId, N_Ray & ray, bool isFrontToBack, leafFunc_t && leafFunc)
 {
-	//similar to the common version,
-	//extended version for path tracer
-	N_AABB aabb = bvhNode->GetAABB();
-	bool isRayEndPointInside = aabb.IsPointInside(ray.origin) || aabb.IsPointInside(ray.Eval(ray.t_max));
-	bool isHit = CollisionTestor::IntersectRayAabb(ray, aabb);//ray's start,end are outside the AABB but still possible to hit
-	if (isRayEndPointInside || isHit)
+	//node or leaf to visit (leaf children aren't wide nodes, they're pushed as primitive ranges),
+	//and ray's entry distance when it's pushed
+	struct StackEntry
+	{
+		uint32_t index;
+		uint32_t primitiveCount;
+		float nearT;
+	};
+	StackEntry stack[c_wideBvhTraversalStackSize];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = { rootId, 0, ray.t_min };
+
+	Vec3 invDir = Vec3(SIMD::SafeReciprocal(ray.dir.x), SIMD::SafeReciprocal(ray.dir.y), SIMD::SafeReciprocal(ray.dir.z));
+	alignas(32) float nearTList[N_BvhWideNode::c_width];
+	while (stackSize > 0)
 	{
-		//BVH leaf node, extract concrete object to intersect
-		if (bvhNode->IsLeafNode())
+		StackEntry entry = stack[--stackSize];
+
+		//ray might have been clipped since the entry was pushed
+		if (entry.nearT > ray.t_max)continue;
+
+		if (entry.primitiveCount != 0)
 		{
-			GI::IGiRenderable* pRenderable = bvhNode->GetGiRenderable();
-			N_RayHitResult tmpResult;
-			N_RayHitResultForPathTracer tmpPathTracerResult;
+			//leafFunc only cares about the primitive range
+			N_BvhLinearNode leaf;
+			leaf.offset = entry.index;
+			leaf.primitiveCount = entry.primitiveCount;
+			if (leafFunc(leaf, ray))return true;
+			continue;
+		}
 
-			if (pRenderable == nullptr)return;
-			switch (pRenderable->GetObjectType())
-			{
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_BOX:
-			{
-				LogicalBox* pBox = static_cast<LogicalBox*>(pRenderable);
-				CollisionTestor::IntersectRayBox(ray, pBox, tmpResult);
-				for (auto& e : tmpResult.hitList)
-					tmpPathTracerResult.hitList.push_back(N_RayHitInfoForPathTracer(pRenderable, e));
-				break; 
-			}
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_SPHERE:
-			{
-				LogicalSphere* pSphere = static_cast<LogicalSphere*>(pRenderable);
-				CollisionTestor::IntersectRaySphere(ray, pSphere, tmpResult);
-				for (auto& e : tmpResult.hitList)
-					tmpPathTracerResult.hitList.push_back(N_RayHitInfoForPathTracer(pRenderable, e));
-				break; 
-			}
-			case NOISE_SCENE_OBJECT_TYPE::LOGICAL_RECT:
-			{
-				LogicalRect* pRect = static_cast<LogicalRect*>(pRenderable);
-				CollisionTestor::IntersectRayRect(ray, static_cast<LogicalRect*>(pRenderable), tmpResult);
-				for (auto& e : tmpResult.hitList)
-					tmpPathTracerResult.hitList.push_back(N_RayHitInfoForPathTracer(pRenderable, e));
-				break;
-			}
-			case NOISE_SCENE_OBJECT_TYPE::MESH:
+		const N_BvhWideNode& node = wideNodeList[entry.index];
+		uint32_t hitMask = CollisionTestor::mFunction_IntersectRayWideBvhNode(ray, invDir, node, nearTList);
+
+		//push hit children. for closest hit, keep them sorted so that the nearest one is on the top of the stack
+		uint32_t firstPushed = stackSize;
+		while (hitMask != 0)
+		{
+			uint32_t i = 0;
+			while (!(hitMask & (1u << i)))++i;
+			hitMask &= ~(1u << i);
+			StackEntry childEntry = { node.childIndex[i], node.childPrimitiveCount[i], nearTList[i] };
+
+			if (stackSize == c_wideBvhTraversalStackSize)
 			{
-				Mesh* pMesh = static_cast<Mesh*>(pRenderable);
-				if (pMesh->IsBvhTreeBuilt())
-				{	
-					CollisionTestor::IntersectRayMeshWithBvh(ray, pMesh, tmpResult);
+				//(very deep tree) stack overflow, the child is traversed right now with a new stack.
+				//ray has only been clipped by real hits so far, so it's still correct
+				if (childEntry.primitiveCount != 0)
+				{
+					N_BvhLinearNode leaf;
+					leaf.offset = childEntry.index;
+					leaf.primitiveCount = childEntry.primitiveCount;
+					if (leafFunc(leaf, ray))return true;
 				}
-				else
-				{	
-					CollisionTestor::IntersectRayMesh(ray, pMesh, tmpResult);	
+				else if (CollisionTestor::mFunction_TraverseWideBvh(wideNodeList, childEntry.index, ray, isFrontToBack, leafFunc))
+				{
+					return true;
 				}
-				for(auto& e: tmpResult.hitList)
-					tmpPathTracerResult.hitList.push_back(N_RayHitInfoForPathTracer(pRenderable, e));
-				break;
-			}
-			default:
-				ERROR_MSG("Error: Bug!! The stupid author forgot to include some collidable object.");
-				break;
+				continue;
 			}
 
-			outHitRes.Union(tmpPathTracerResult);
-
-		}//isLeafNode
-		else
-		{
-			//gather results from
-			for (uint32_t i = 0; i < bvhNode->GetChildNodeCount(); ++i)
+			//insertion, in descending order of nearT
+			uint32_t pos = stackSize++;
+			while (isFrontToBack && pos > firstPushed && stack[pos - 1].nearT < childEntry.nearT)
 			{
-				N_RayHitResultForPathTracer tmpResult;
-				BvhNodeForScene* pChildNode = bvhNode->GetChildNode(i);
-				CollisionTestor::mFunction_IntersectRayBvhNodeForPathTracer(ray, pChildNode, tmpResult);
-				outHitRes.Union(tmpResult);//push to back
+				stack[pos] = stack[pos - 1];
+				--pos;
 			}
+			stack[pos] = childEntry;
 		}
-	}//isHit
-	 //else, BVH branch pruned. thus accelerated.
+	}
+	return false;
+}
+
+template <typename leafFunc_t>
+void Noise3D::CollisionTestor::mFunction_TraverseBvh(const std::vector<N_BvhLinearNode>& nodeList, const std::vector<N_BvhWideNode>& wideNodeList, N_Ray & ray, bool isFrontToBack, leafFunc_t && leafFunc)
+{
+	if (mIsWideBvhTraversalEnabled && !wideNodeList.empty())
+	{
+		CollisionTestor::mFunction_TraverseWideBvh(wideNodeList, 0, ray, isFrontToBack, leafFunc);
+	}
+	else if (isFrontToBack)
+	{
+		CollisionTestor::mFunction_TraverseLinearBvh_FrontToBack(nodeList, ray, leafFunc);
+	}
+	else
+	{
+		CollisionTestor::mFunction_TraverseLinearBvh(nodeList, ray, leafFunc);
+	}
 }
 
 void Noise3D::CollisionTestor::mFunction_UpdateGpuInfoForRayIntersection(Mesh* pMesh, bool updateCamToGpu, bool updateMatrixToGpu)
@@ -1155,10 +1570,15 @@ void Noise3D::CollisionTestor::RayIntersectionTransformHelper::HitResult_ModelTo
 	//transform only the hit results back to world space(minimize the count of inv transform)
 	for (auto& refHitInfo : hitResult.hitList)
 	{
-		//hitInfo.t = hitInfo.t
-		//hitInfo.ray = hitInfo.ray;//world space ray can be directly assigned to
-		refHitInfo.normal = AffineTransform::TransformVector_MatrixMul(refHitInfo.normal, worldInvTransposeMat);
-		refHitInfo.normal.Normalize();
-		refHitInfo.pos = AffineTransform::TransformVector_MatrixMul(refHitInfo.pos, worldMat);
+		RayIntersectionTransformHelper::HitInfo_ModelToWorld(refHitInfo);
 	}
 }
+
+void Noise3D::CollisionTestor::RayIntersectionTransformHelper::HitInfo_ModelToWorld(N_RayHitInfo & hitInfo)
+{
+	//hitInfo.t = hitInfo.t
+	//hitInfo.ray = hitInfo.ray;//world space ray can be directly assigned to
+	hitInfo.normal = AffineTransform::TransformVector_MatrixMul(hitInfo.normal, worldInvTransposeMat);
+	hitInfo.normal.Normalize();
+	hitInfo.pos = AffineTransform::TransformVector_MatrixMul(hitInfo.pos, worldMat);
+}
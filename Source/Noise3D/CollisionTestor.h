@@ -56,6 +56,25 @@ namespace Noise3D
 		//ray-Mesh intersection. cpu impl. bvh-accelerated
 		static bool IntersectRayMeshWithBvh(const N_Ray& ray, Mesh* pMesh, N_RayHitResult& outHitRes);
 
+		//ray-Mesh intersection, only the closest hit is output. bvh-accelerated
+		//(nodes are visited front-to-back, and the ray is clipped by the closest hit found so far)
+		static bool IntersectRayMeshWithBvh_ClosestHit(const N_Ray& ray, Mesh* pMesh, N_RayHitInfo& outHitInfo);
+
+		//ray-Mesh occlusion test, return on the first hit within ray's [t_min, t_max]. bvh-accelerated
+		static bool IntersectRayMeshWithBvh_AnyHit(const N_Ray& ray, Mesh* pMesh);
+
+		//ray-renderable intersection(object type is dispatched internally), only the closest hit is output
+		static bool IntersectRayGiRenderable_ClosestHit(const N_Ray& ray, GI::IGiRenderable* pRenderable, N_RayHitInfo& outHitInfo);
+
+		//ray packet-Mesh intersection, closest hit of each ray. bvh-accelerated.
+		//active rays traverse the BVH together, nodes and triangles are tested against several rays at a time(SIMD).
+		//outHitInfoList[i] is valid only if bit i of the returned mask is set
+		static uint32_t IntersectRayPacketMeshWithBvh_ClosestHit(const N_RayPacket& packet, Mesh* pMesh, std::vector<N_RayHitInfo>& outHitInfoList);
+
+		//SIMD width of ray packet kernels (8 for AVX, 4 for SSE, 1 for scalar fallback)
+		static uint32_t GetRayPacketSimdWidth();
+
+
 		//ray-Mesh intersection. gpu GS& stream output impl.
 		bool IntersectRayMesh_GpuBased(const N_Ray& ray, Mesh* pMesh, N_RayHitResult& outHitRes);
 
@@ -67,12 +86,53 @@ namespace Noise3D
 		//another version of ray-scene collision for path tracer
 		bool IntersectRaySceneForPathTracer(const N_Ray& ray, N_RayHitResultForPathTracer& outHitRes);
 
+		//remember to Rebuild BVH tree before intersectRayScene
+		//closest hit version for path tracer, no hit list is gathered
+		bool IntersectRaySceneForPathTracer_ClosestHit(const N_Ray& ray, N_RayHitInfoForPathTracer& outHitInfo);
+
+		//remember to Rebuild BVH tree before intersectRayScene
+		//occlusion query(e.g. shadow ray), exit on the first blocker within ray's [t_min, t_max]
+		bool IntersectRaySceneAnyHit(const N_Ray& ray);
+
+		//remember to Rebuild BVH tree before intersectRayScene
+		//packet version of IntersectRaySceneForPathTracer_ClosestHit(), for coherent rays (e.g. primary rays of a tile).
+		//outHitInfoList[i] is valid only if bit i of the returned mask is set
+		uint32_t IntersectRayPacketSceneForPathTracer_ClosestHit(const N_RayPacket& packet, std::vector<N_RayHitInfoForPathTracer>& outHitInfoList);
+
+		//remember to Rebuild BVH tree before intersectRayScene
+		//packet version of IntersectRaySceneAnyHit() (e.g. shadow rays towards the same area light), returns mask of occluded rays
+		uint32_t IntersectRayPacketSceneAnyHit(const N_RayPacket& packet);
+
+
 		//(re-)build BVH tree from scene graph for ray tracer
 		bool RebuildBvhTreeForGI(const SceneGraph& graph);
 
 		//(re-)build BVH tree from scene graph for ray tracer, but rooted at given node
 		bool RebuildBvhTreeForGI(SceneNode* pNode);
 
+		//refit BVH tree built for given node (only moved/changed objects are re-bounded),
+		//fall back to a full rebuild if refit is impossible
+		bool UpdateBvhTreeForGI(SceneNode* pNode);
+
+		//force an object to be re-bounded by next UpdateBvhTreeForGI()
+		void MarkObjectDirtyForGI(GI::IGiRenderable* pObj);
+
+		//surface area ratio of a degraded sub-tree that triggers a rebuild in UpdateBvhTreeForGI()
+		void SetBvhRefitRebuildThresholdForGI(float surfaceAreaRatio);
+
+		//build method of scene BVH used by following RebuildBvhTreeForGI()
+		void SetBvhBuildMethodForGI(NOISE_BVH_BUILD_METHOD method);
+
+		//thread count of scene BVH and mesh BVH build (0 for hardware concurrency, default)
+		void SetBvhBuildThreadCountForGI(uint32_t threadCount);
+
+		//traverse collapsed 4/8-ary BVH (children are tested with SIMD) instead of the binary one. (enabled by default)
+		//affects closest-hit/any-hit queries of mesh and scene BVH
+		static void SetWideBvhTraversalEnabled(bool enabled);
+
+		static bool IsWideBvhTraversalEnabled();
+
+
 		const BvhTreeForScene& GetBvhTree();
 
 		//TODO: ray-Mesh intersection. gpu impl. simply modify a little bit to Picking_GpuBased
@@ -94,8 +154,14 @@ namespace Noise3D
 		{
 			bool Ray_WorldToModel(const N_Ray& in_ray_world, bool isRigidTransform, ISceneObject * pObj, N_Ray& out_ray_local);
 
+			//rays in 'mask' are transformed, world transform matrices are evaluated only once
+			bool RayPacket_WorldToModel(const N_RayPacket& in_packet_world, uint32_t mask, bool isRigidTransform, ISceneObject * pObj, N_RayPacket& out_packet_local);
+
 			void HitResult_ModelToWorld(N_RayHitResult& hitResult);
 
+			void HitInfo_ModelToWorld(N_RayHitInfo& hitInfo);
+
+
 			Matrix worldMat; 
 			Matrix worldInvMat; 
 			Matrix worldInvTransposeMat;
@@ -113,14 +179,69 @@ namespace Noise3D
 		//get facet id for Ray-AABB intersection
 		static void mFunction_AabbFacet(uint32_t slabsPairId, float dirComponent, NOISE_BOX_FACET& nearHit, NOISE_BOX_FACET& farHit);
 
-		//recursion function for mesh's internal BVH
-		static void mFunction_IntersectRayMeshInternalBvhNode(const N_Ray& ray,BvhNodeForTriangularMesh* bvhNode, std::vector<uint32_t>& outTriangleIdList);
+		//ray-AABB test for flattened BVH node(slabs, with precomputed reciprocal of ray dir). 
+		//intersection of ray's [t_min,t_max] and the slabs' interval is output via 'outNearT'
+		static bool mFunction_IntersectRayLinearBvhNode(const N_Ray& ray, const Vec3& invDir, const N_BvhLinearNode& node, float& outNearT);
+
+		//hit test of a precomputed mesh triangle (Moller-Trumbore, same algebra as IntersectRayTriangle()).
+		//only hit distance is output, attributes of the closest hit are interpolated by caller
+		static bool mFunction_IntersectRayBvhTriangle(const N_Ray& ray, const N_BvhTriangle& tri, float& outT);
+
+		//dispatch ray-object intersection according to object type (leaf of scene BVH)
+		static void mFunction_IntersectRayGiRenderable(const N_Ray& ray, GI::IGiRenderable* pRenderable, N_RayHitResult& outHitRes);
+
+		//dispatch ray-object occlusion test according to object type (leaf of scene BVH)
+		static bool mFunction_IntersectRayGiRenderable_AnyHit(const N_Ray& ray, GI::IGiRenderable* pRenderable);
+
+		//pick the closest hit within ray's [t_min, t_max] from a hit list
+		static bool mFunction_GetClosestHit(const N_Ray& ray, const N_RayHitResult& hitRes, N_RayHitInfo& outHitInfo);
+
+		//stackless traversal of flattened BVH in depth-first order. missed sub-tree is skipped via skip index.
+		//leafFunc(const N_BvhLinearNode&, N_Ray&) tests the primitives of a leaf, it might clip the ray's t_max,
+		//and returns true to terminate the traversal (e.g. any hit)
+		template <typename leafFunc_t>
+		static void mFunction_TraverseLinearBvh(const std::vector<N_BvhLinearNode>& nodeList, N_Ray& ray, leafFunc_t&& leafFunc);
+
+		//front-to-back traversal of flattened BVH for closest hit. children are visited in order of 
+		//ray's entry distance, and nodes beyond current ray.t_max are culled. a fixed-size stack on stack memory is used
+		template <typename leafFunc_t>
+		static void mFunction_TraverseLinearBvh_FrontToBack(const std::vector<N_BvhLinearNode>& nodeList, N_Ray& ray, leafFunc_t&& leafFunc);
+
+		//ray-wide BVH node test, all children at once(SIMD slabs). 'invDir' must be computed by SIMD::SafeReciprocal().
+		//returns mask of hit children, entry distance of child i is output to outNearT[i] (32-byte aligned, c_width floats)
+		static uint32_t mFunction_IntersectRayWideBvhNode(const N_Ray& ray, const Vec3& invDir, const N_BvhWideNode& node, float* outNearT);
+
+		//traversal of collapsed wide BVH from node 'rootId'. a leaf child is passed to leafFunc as a linear node
+		//(only offset & primitiveCount are valid). if 'isFrontToBack', hit children are visited in order of entry distance.
+		//returns true if leafFunc terminated the traversal
+		template <typename leafFunc_t>
+		static bool mFunction_TraverseWideBvh(const std::vector<N_BvhWideNode>& wideNodeList, uint32_t rootId, N_Ray& ray, bool isFrontToBack, leafFunc_t&& leafFunc);
+
+		//wide BVH traversal if it's enabled and available, otherwise traversal of the binary one
+		//(front-to-back for closest hit, stackless for any hit)
+		template <typename leafFunc_t>
+		static void mFunction_TraverseBvh(const std::vector<N_BvhLinearNode>& nodeList, const std::vector<N_BvhWideNode>& wideNodeList, N_Ray& ray, bool isFrontToBack, leafFunc_t&& leafFunc);
+
+		//ray packet-flattened BVH node test of lanes in 'mask' (SIMD slabs). 
+		//returns mask of lanes that hit, and the smallest entry distance of them
+		static uint32_t mFunction_IntersectRayPacketLinearBvhNode(const N_RayPacket& packet, uint32_t mask, const N_BvhLinearNode& node, float& outMinNearT);
+
+		//ray packet-triangle test of lanes in 'mask' (SIMD Moller-Trumbore, one triangle against several rays).
+		//t_max of hit lanes is clipped to the hit distance. returns mask of lanes that hit
+		static uint32_t mFunction_IntersectRayPacketTriangle(N_RayPacket& packet, uint32_t mask, const N_BvhTriangle& tri);
+
+		//packet traversal of mesh BVH in model space. closest triangle of each lane is output (-1 for miss),
+		//for any hit, a lane is terminated on its first hit. returns mask of lanes that hit
+		static uint32_t mFunction_IntersectRayPacketMeshWithBvh(N_RayPacket& localPacket, uint32_t mask, Mesh* pMesh, bool isAnyHit, int* outTriangleIdList);
+
+		//front-to-back traversal of flattened BVH with a ray packet. a node is visited if any active ray hits it,
+		//children are visited in order of the packet's smallest entry distance.
+		//leafFunc(const N_BvhLinearNode&, N_RayPacket&, uint32_t nodeHitMask, uint32_t& activeMask) tests the primitives 
+		//of a leaf, it might clip rays or remove terminated rays from 'activeMask'. traversal ends when no ray is active
+		template <typename leafFunc_t>
+		static void mFunction_TraverseLinearBvh_Packet(const std::vector<N_BvhLinearNode>& nodeList, N_RayPacket& packet, uint32_t activeMask, leafFunc_t&& leafFunc);
 
-		//recursion function for BVH acceleration
-		void mFunction_IntersectRayBvhNode(const N_Ray& ray, BvhNodeForScene* bvhNode, N_RayHitResult& outHitRes);
 
-		//recursion function for BVH acceleration. extra info are added
-		void mFunction_IntersectRayBvhNodeForPathTracer(const N_Ray& ray, BvhNodeForScene* bvhNode, N_RayHitResultForPathTracer& outHitRes);
 
 		//update GPU states for GPU based intersection(ray-mesh/ picking)
 		void mFunction_UpdateGpuInfoForRayIntersection(Mesh* pMesh, bool updateCamToGpu, bool updateMatrixToGpu);
@@ -133,6 +254,16 @@ namespace Noise3D
 		//for ray-scene intersection acceleration
 		BvhTreeForScene mBvhTree;
 
+		//max depth of the traversal stack for front-to-back BVH traversal.
+		//(if it's exceeded, traversal falls back to the stackless one)
+		static const uint32_t c_bvhTraversalStackSize = 64;
+
+		//a wide node pushes up to c_width-1 more entries than it pops
+		static const uint32_t c_wideBvhTraversalStackSize = 256;
+
+		static bool mIsWideBvhTraversalEnabled;
+
+
 		//-------Var for Gpu intersection-----------
 		static const uint32_t c_maxSOByteWidth = 10000;
 		std::mutex				mSOMutex;//path tracer is multi-threaded
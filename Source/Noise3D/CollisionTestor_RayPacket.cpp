@@ -0,0 +1,450 @@
+
+/***********************************************************************
+
+							cpp: Collision Testor (ray packet)
+			packet versions of ray-mesh/ray-scene intersection.
+			rays of a packet traverse the BVH together, nodes and triangles
+			are tested against 8(AVX)/4(SSE)/1(scalar fallback) rays per instruction.
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+using namespace Noise3D::SIMD;
+
+static const uint32_t c_simdWidth = NOISE_SIMD_WIDTH;
+static const uint32_t c_simdLaneMask = (1u << NOISE_SIMD_WIDTH) - 1u;
+static_assert(N_RayPacket::c_maxRayCount % NOISE_SIMD_WIDTH == 0, "ray packet size must be a multiple of SIMD width.");
+
+uint32_t Noise3D::CollisionTestor::IntersectRayPacketMeshWithBvh_ClosestHit(const N_RayPacket & packet, Mesh * pMesh, std::vector<N_RayHitInfo>& outHitInfoList)
+{
+	outHitInfoList.assign(packet.rayCount, N_RayHitInfo(std::numeric_limits<float>::infinity(), Vec3(), Vec3(), Vec2()));
+	if (pMesh == nullptr)
+	{
+		ERROR_MSG("CollisionTestor: object is nullptr.");
+		return 0;
+	}
+
+	if (!pMesh->IsBvhTreeBuilt())
+	{
+		ERROR_MSG("CollisionTestor: mesh's internal BVH hasn't been built!");
+		return 0;
+	}
+
+	if (!pMesh->Collidable::IsCollidable())return 0;
+
+	//convert rays to model space (affine transform keeps ray's parameter t)
+	N_RayPacket localPacket;
+	RayIntersectionTransformHelper helper;
+	if (!helper.RayPacket_WorldToModel(packet, packet.GetActiveMask(), false, pMesh, localPacket))return 0;
+
+	int triIdList[N_RayPacket::c_maxRayCount];
+	uint32_t hitMask = CollisionTestor::mFunction_IntersectRayPacketMeshWithBvh(localPacket, packet.GetActiveMask(), pMesh, false, triIdList);
+
+	//vertex attributes are interpolated only once per ray, for the closest triangle
+	const std::vector<N_DefaultVertex>& vb = *pMesh->GetVertexBuffer();
+	const std::vector<uint32_t>& ib = *pMesh->GetIndexBuffer();
+	uint32_t resultMask = 0;
+	for (uint32_t lane = 0; lane < packet.rayCount; ++lane)
+	{
+		if (!(hitMask & (1u << lane)))continue;
+		int triId = triIdList[lane];
+		N_Ray localRay = localPacket.GetRay(lane);
+		localRay.t_max = packet.t_max[lane];
+		N_RayHitInfo& hitInfo = outHitInfoList[lane];
+		if (!CollisionTestor::IntersectRayTriangle(localRay, vb[ib[3 * triId + 0]], vb[ib[3 * triId + 1]], vb[ib[3 * triId + 2]], hitInfo))continue;
+		hitInfo.triangleIndex = triId;
+		helper.HitInfo_ModelToWorld(hitInfo);
+		resultMask |= (1u << lane);
+	}
+	return resultMask;
+}
+
+uint32_t Noise3D::CollisionTestor::GetRayPacketSimdWidth()
+{
+	return c_simdWidth;
+}
+
+uint32_t Noise3D::CollisionTestor::IntersectRayPacketSceneForPathTracer_ClosestHit(const N_RayPacket & packet, std::vector<N_RayHitInfoForPathTracer>& outHitInfoList)
+{
+	outHitInfoList.assign(packet.rayCount, N_RayHitInfoForPathTracer(nullptr, std::numeric_limits<float>::infinity(), Vec3(), Vec3(), Vec2(), -1));
+
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
+	{
+		WARNING_MSG("IntersectRayPacketSceneForPathTracer_ClosestHit: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
+		return 0;
+	}
+
+	//each hit clips its ray, so farther objects/nodes are culled (for the whole packet if all rays are clipped)
+	uint32_t resultMask = 0;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_RayPacket& p, uint32_t nodeHitMask, uint32_t& activeMask)
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			GI::IGiRenderable* pRenderable = objList[i];
+
+			//mesh with BVH: packet traversal of its own BVH
+			if (pRenderable->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
+			{
+				Mesh* pMesh = static_cast<Mesh*>(pRenderable);
+				if (pMesh->IsBvhTreeBuilt())
+				{
+					if (!pMesh->Collidable::IsCollidable())continue;
+					N_RayPacket localPacket;
+					RayIntersectionTransformHelper helper;
+					if (!helper.RayPacket_WorldToModel(p, nodeHitMask, false, pMesh, localPacket))continue;
+
+					int triIdList[N_RayPacket::c_maxRayCount];
+					uint32_t meshHitMask = CollisionTestor::mFunction_IntersectRayPacketMeshWithBvh(localPacket, nodeHitMask, pMesh, false, triIdList);
+					const std::vector<N_DefaultVertex>& vb = *pMesh->GetVertexBuffer();
+					const std::vector<uint32_t>& ib = *pMesh->GetIndexBuffer();
+					for (uint32_t lane = 0; lane < p.rayCount; ++lane)
+					{
+						if (!(meshHitMask & (1u << lane)))continue;
+						int triId = triIdList[lane];
+						N_Ray localRay = localPacket.GetRay(lane);
+						localRay.t_max = p.t_max[lane];
+						N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+						if (!CollisionTestor::IntersectRayTriangle(localRay, vb[ib[3 * triId + 0]], vb[ib[3 * triId + 1]], vb[ib[3 * triId + 2]], hitInfo))continue;
+						hitInfo.triangleIndex = triId;
+						helper.HitInfo_ModelToWorld(hitInfo);
+						p.t_max[lane] = hitInfo.t;
+						outHitInfoList[lane] = N_RayHitInfoForPathTracer(pRenderable, hitInfo);
+						resultMask |= (1u << lane);
+					}
+					continue;
+				}
+			}
+
+			//other objects only produce 1 or 2 hits, test rays one by one
+			for (uint32_t lane = 0; lane < p.rayCount; ++lane)
+			{
+				if (!(nodeHitMask & (1u << lane)))continue;
+				N_RayHitInfo hitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+				if (CollisionTestor::IntersectRayGiRenderable_ClosestHit(p.GetRay(lane), pRenderable, hitInfo))
+				{
+					p.t_max[lane] = hitInfo.t;
+					outHitInfoList[lane] = N_RayHitInfoForPathTracer(pRenderable, hitInfo);
+					resultMask |= (1u << lane);
+				}
+			}
+		}
+	};
+	N_RayPacket clippedPacket = packet;
+	CollisionTestor::mFunction_TraverseLinearBvh_Packet(nodeList, clippedPacket, packet.GetActiveMask(), leafFunc);
+	return resultMask;
+}
+
+uint32_t Noise3D::CollisionTestor::IntersectRayPacketSceneAnyHit(const N_RayPacket & packet)
+{
+	const std::vector<N_BvhLinearNode>& nodeList = mBvhTree.GetLinearNodeList();
+	const std::vector<GI::IGiRenderable*>& objList = mBvhTree.GetLinearObjectList();
+	if (objList.empty())
+	{
+		WARNING_MSG("IntersectRayPacketSceneAnyHit: BVH tree seems to be empty. Forgot to rebuild BVH? or there is no collidable object in the scene?");
+		return 0;
+	}
+
+	//a ray is removed from the packet on its first blocker, exit when all rays are blocked
+	uint32_t occludedMask = 0;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_RayPacket& p, uint32_t nodeHitMask, uint32_t& activeMask)
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount && (nodeHitMask & activeMask); ++i)
+		{
+			GI::IGiRenderable* pRenderable = objList[i];
+			uint32_t testMask = nodeHitMask & activeMask;
+
+			if (pRenderable->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::MESH)
+			{
+				Mesh* pMesh = static_cast<Mesh*>(pRenderable);
+				if (pMesh->IsBvhTreeBuilt())
+				{
+					if (!pMesh->Collidable::IsCollidable())continue;
+					N_RayPacket localPacket;
+					RayIntersectionTransformHelper helper;
+					if (!helper.RayPacket_WorldToModel(p, testMask, false, pMesh, localPacket))continue;
+
+					int triIdList[N_RayPacket::c_maxRayCount];
+					uint32_t meshHitMask = CollisionTestor::mFunction_IntersectRayPacketMeshWithBvh(localPacket, testMask, pMesh, true, triIdList);
+					occludedMask |= meshHitMask;
+					activeMask &= ~meshHitMask;
+					continue;
+				}
+			}
+
+			for (uint32_t lane = 0; lane < p.rayCount; ++lane)
+			{
+				if (!(testMask & (1u << lane)))continue;
+				if (CollisionTestor::mFunction_IntersectRayGiRenderable_AnyHit(p.GetRay(lane), pRenderable))
+				{
+					occludedMask |= (1u << lane);
+					activeMask &= ~(1u << lane);
+				}
+			}
+		}
+	};
+	N_RayPacket tmpPacket = packet;
+	CollisionTestor::mFunction_TraverseLinearBvh_Packet(nodeList, tmpPacket, packet.GetActiveMask(), leafFunc);
+	return occludedMask;
+}
+
+bool Noise3D::CollisionTestor::RayIntersectionTransformHelper::RayPacket_WorldToModel(
+	const N_RayPacket & in_packet_world, uint32_t mask, bool isRigidTransform, ISceneObject * pObj, N_RayPacket & out_packet_local)
+{
+	SceneNode* pNode = pObj->GetAttachedSceneNode();
+	if (pNode == nullptr)
+	{
+		WARNING_MSG("CollisionTestor: object is not bound to a scene node.");
+		return false;
+	}
+
+	if (isRigidTransform)
+	{
+		pNode->EvalWorldTransform_Rigid().GetAffineTransformMatrix(worldMat, worldInvMat, worldInvTransposeMat);
+	}
+	else
+	{
+		pNode->EvalWorldTransform().GetAffineTransformMatrix(worldMat, worldInvMat, worldInvTransposeMat);
+	}
+
+	//same as Ray_WorldToModel(), lanes not in mask are disabled
+	out_packet_local.rayCount = in_packet_world.rayCount;
+	for (uint32_t lane = 0; lane < N_RayPacket::c_maxRayCount; ++lane)
+	{
+		if (!(mask & (1u << lane)))
+		{
+			out_packet_local.DisableRay(lane);
+			continue;
+		}
+		N_Ray worldRay = in_packet_world.GetRay(lane);
+		N_Ray localRay;
+		localRay.origin = AffineTransform::TransformVector_MatrixMul(worldRay.origin, worldInvMat);
+		Vec3 localRayEnd = AffineTransform::TransformVector_MatrixMul(worldRay.Eval(1.0f), worldInvMat);
+		localRay.dir = localRayEnd - localRay.origin;
+		localRay.t_max = worldRay.t_max;
+		out_packet_local.SetRay(lane, localRay);
+	}
+	return true;
+}
+
+/***********************************************
+
+							PRIVATE
+
+***********************************************/
+
+uint32_t Noise3D::CollisionTestor::mFunction_IntersectRayPacketLinearBvhNode(const N_RayPacket & packet, uint32_t mask, const N_BvhLinearNode & node, float & outMinNearT)
+{
+	//same as mFunction_IntersectRayLinearBvhNode(), for a group of rays per iteration.
+	//reciprocals of ray dir are clamped in N_RayPacket, so there is no NaN here.
+	const float c_robustFarScale = 1.0f + 2.0f * (3.0f * std::numeric_limits<float>::epsilon()) / (1.0f - 3.0f * std::numeric_limits<float>::epsilon());
+	simd_float minX = SimdSet1(node.aabbMin.x), minY = SimdSet1(node.aabbMin.y), minZ = SimdSet1(node.aabbMin.z);
+	simd_float maxX = SimdSet1(node.aabbMax.x), maxY = SimdSet1(node.aabbMax.y), maxZ = SimdSet1(node.aabbMax.z);
+	simd_float farScale = SimdSet1(c_robustFarScale);
+
+	uint32_t hitMask = 0;
+	alignas(32) float nearT[N_RayPacket::c_maxRayCount];
+	for (uint32_t lane = 0; lane < packet.rayCount; lane += c_simdWidth)
+	{
+		if (!((mask >> lane) & c_simdLaneMask))continue;
+
+		simd_float ox = SimdLoad(packet.originX + lane), oy = SimdLoad(packet.originY + lane), oz = SimdLoad(packet.originZ + lane);
+		simd_float ix = SimdLoad(packet.invDirX + lane), iy = SimdLoad(packet.invDirY + lane), iz = SimdLoad(packet.invDirZ + lane);
+
+		simd_float t0x = SimdMul(SimdSub(minX, ox), ix), t1x = SimdMul(SimdSub(maxX, ox), ix);
+		simd_float t0y = SimdMul(SimdSub(minY, oy), iy), t1y = SimdMul(SimdSub(maxY, oy), iy);
+		simd_float t0z = SimdMul(SimdSub(minZ, oz), iz), t1z = SimdMul(SimdSub(maxZ, oz), iz);
+
+		simd_float tNear = SimdMax(SimdMax(SimdMin(t0x, t1x), SimdMin(t0y, t1y)), SimdMax(SimdMin(t0z, t1z), SimdLoad(packet.t_min + lane)));
+		simd_float tFar = SimdMin(SimdMin(SimdMax(t0x, t1x), SimdMax(t0y, t1y)), SimdMax(t0z, t1z));
+		tFar = SimdMin(SimdMul(tFar, farScale), SimdLoad(packet.t_max + lane));
+
+		hitMask |= (SimdMoveMask(SimdLessEqual(tNear, tFar)) << lane);
+		SimdStore(nearT + lane, tNear);
+	}
+	hitMask &= mask;
+
+	float minNearT = std::numeric_limits<float>::infinity();
+	for (uint32_t lane = 0; lane < packet.rayCount; ++lane)
+	{
+		if (hitMask & (1u << lane))minNearT = std::min<float>(minNearT, nearT[lane]);
+	}
+	outMinNearT = minNearT;
+	return hitMask;
+}
+
+uint32_t Noise3D::CollisionTestor::mFunction_IntersectRayPacketTriangle(N_RayPacket & packet, uint32_t mask, const N_BvhTriangle & tri)
+{
+	//same algebra as IntersectRayTriangle() (Moller-Trumbore), precomputed edges are shared by all rays
+	const Vec3& v0 = tri.v0;
+	const Vec3& e1 = tri.e1;
+	const Vec3& e2 = tri.e2;
+	simd_float E1x = SimdSet1(e1.x), E1y = SimdSet1(e1.y), E1z = SimdSet1(e1.z);
+	simd_float E2x = SimdSet1(e2.x), E2y = SimdSet1(e2.y), E2z = SimdSet1(e2.z);
+	simd_float V0x = SimdSet1(v0.x), V0y = SimdSet1(v0.y), V0z = SimdSet1(v0.z);
+	simd_float zero = SimdSet1(0.0f);
+	simd_float one = SimdSet1(1.0f);
+	simd_float epsilon = SimdSet1(std::numeric_limits<float>::epsilon());
+
+	uint32_t hitMask = 0;
+	for (uint32_t lane = 0; lane < packet.rayCount; lane += c_simdWidth)
+	{
+		if (!((mask >> lane) & c_simdLaneMask))continue;
+
+		simd_float Dx = SimdLoad(packet.dirX + lane), Dy = SimdLoad(packet.dirY + lane), Dz = SimdLoad(packet.dirZ + lane);
+
+		//P = D x E2, det = P dot E1
+		simd_float Px = SimdSub(SimdMul(Dy, E2z), SimdMul(Dz, E2y));
+		simd_float Py = SimdSub(SimdMul(Dz, E2x), SimdMul(Dx, E2z));
+		simd_float Pz = SimdSub(SimdMul(Dx, E2y), SimdMul(Dy, E2x));
+		simd_float det = SimdAdd(SimdAdd(SimdMul(Px, E1x), SimdMul(Py, E1y)), SimdMul(Pz, E1z));
+		simd_mask valid = SimdGreater(SimdAbs(det), epsilon);
+		simd_float invDet = SimdDiv(one, det);
+
+		//M = O - V0, u = invDet * (M dot P)
+		simd_float Mx = SimdSub(SimdLoad(packet.originX + lane), V0x);
+		simd_float My = SimdSub(SimdLoad(packet.originY + lane), V0y);
+		simd_float Mz = SimdSub(SimdLoad(packet.originZ + lane), V0z);
+		simd_float u = SimdMul(invDet, SimdAdd(SimdAdd(SimdMul(Mx, Px), SimdMul(My, Py)), SimdMul(Mz, Pz)));
+
+		//Q = M x E1, v = invDet * (D dot Q), t = invDet * (E2 dot Q)
+		simd_float Qx = SimdSub(SimdMul(My, E1z), SimdMul(Mz, E1y));
+		simd_float Qy = SimdSub(SimdMul(Mz, E1x), SimdMul(Mx, E1z));
+		simd_float Qz = SimdSub(SimdMul(Mx, E1y), SimdMul(My, E1x));
+		simd_float v = SimdMul(invDet, SimdAdd(SimdAdd(SimdMul(Dx, Qx), SimdMul(Dy, Qy)), SimdMul(Dz, Qz)));
+		simd_float t = SimdMul(invDet, SimdAdd(SimdAdd(SimdMul(E2x, Qx), SimdMul(E2y, Qy)), SimdMul(E2z, Qz)));
+
+		simd_float tMax = SimdLoad(packet.t_max + lane);
+		valid = SimdAnd(valid, SimdLessEqual(zero, u));
+		valid = SimdAnd(valid, SimdLessEqual(zero, v));
+		valid = SimdAnd(valid, SimdLessEqual(SimdAdd(u, v), one));
+		valid = SimdAnd(valid, SimdLessEqual(SimdLoad(packet.t_min + lane), t));
+		valid = SimdAnd(valid, SimdLessEqual(t, tMax));
+
+		uint32_t laneHitMask = (SimdMoveMask(valid) << lane) & mask;
+		if (laneHitMask == 0)continue;
+		hitMask |= laneHitMask;
+
+		//clip t_max of hit lanes (lanes outside of 'mask' are left unchanged)
+		alignas(32) float tList[c_simdWidth];
+		SimdStore(tList, SimdSelect(valid, t, tMax));
+		for (uint32_t i = 0; i < c_simdWidth; ++i)
+		{
+			if (laneHitMask & (1u << (lane + i)))packet.t_max[lane + i] = tList[i];
+		}
+	}
+	return hitMask;
+}
+
+uint32_t Noise3D::CollisionTestor::mFunction_IntersectRayPacketMeshWithBvh(N_RayPacket & localPacket, uint32_t mask, Mesh * pMesh, bool isAnyHit, int * outTriangleIdList)
+{
+	const BvhTreeForTriangularMesh& bvh = pMesh->GetBvhTree();
+	const std::vector<N_BvhLinearNode>& nodeList = bvh.GetLinearNodeList();
+	const std::vector<uint32_t>& triIdList = bvh.GetLinearTriangleIdList();
+	const std::vector<N_BvhTriangle>& triList = bvh.GetLinearTriangleList();
+
+	for (uint32_t lane = 0; lane < N_RayPacket::c_maxRayCount; ++lane)outTriangleIdList[lane] = -1;
+
+	//only positions are used during traversal, each hit clips its ray
+	uint32_t hitMask = 0;
+	auto leafFunc = [&](const N_BvhLinearNode& node, N_RayPacket& p, uint32_t nodeHitMask, uint32_t& activeMask)
+	{
+		for (uint32_t i = node.offset; i < node.offset + node.primitiveCount; ++i)
+		{
+			uint32_t triHitMask = CollisionTestor::mFunction_IntersectRayPacketTriangle(p, nodeHitMask & activeMask, triList[i]);
+			if (triHitMask == 0)continue;
+
+			uint32_t triId = triIdList[i];
+
+			hitMask |= triHitMask;
+			for (uint32_t lane = 0; lane < p.rayCount; ++lane)
+			{
+				if (triHitMask & (1u << lane))outTriangleIdList[lane] = int(triId);
+			}
+
+			//terminate rays that found a blocker
+			if (isAnyHit)
+			{
+				activeMask &= ~triHitMask;
+				if ((nodeHitMask & activeMask) == 0)return;
+			}
+		}
+	};
+	CollisionTestor::mFunction_TraverseLinearBvh_Packet(nodeList, localPacket, mask, leafFunc);
+	return hitMask;
+}
+
+template <typename leafFunc_t>
+void Noise3D::CollisionTestor::mFunction_TraverseLinearBvh_Packet(const std::vector<N_BvhLinearNode>& nodeList, N_RayPacket & packet, uint32_t activeMask, leafFunc_t && leafFunc)
+{
+	if (nodeList.empty() || activeMask == 0)return;
+
+	//node to visit, and the smallest entry distance of the packet when it's pushed
+	struct StackEntry
+	{
+		uint32_t nodeId;
+		float nearT;
+	};
+	StackEntry stack[c_bvhTraversalStackSize];
+	uint32_t stackSize = 0;
+
+	float rootNearT = 0.0f;
+	if (CollisionTestor::mFunction_IntersectRayPacketLinearBvhNode(packet, activeMask, nodeList[0], rootNearT) == 0)return;
+	stack[stackSize++] = { 0, rootNearT };
+
+	while (stackSize > 0 && activeMask != 0)
+	{
+		StackEntry entry = stack[--stackSize];
+		const N_BvhLinearNode& node = nodeList[entry.nodeId];
+		if (node.IsLeafNode())
+		{
+			//rays might have been clipped (or terminated) since the leaf was pushed, test it again
+			float nearT = 0.0f;
+			uint32_t nodeHitMask = CollisionTestor::mFunction_IntersectRayPacketLinearBvhNode(packet, activeMask, node, nearT);
+			if (nodeHitMask != 0)leafFunc(node, packet, nodeHitMask, activeMask);
+			continue;
+		}
+
+		//children: the first child follows its parent, and siblings are linked by skip index.
+		//push children hit by any ray, sorted so that the nearest one is on the top of the stack
+		uint32_t firstPushed = stackSize;
+		for (uint32_t childId = entry.nodeId + 1; childId < node.offset; childId = nodeList[childId].GetSkipIndex(childId))
+		{
+			float nearT = 0.0f;
+			if (CollisionTestor::mFunction_IntersectRayPacketLinearBvhNode(packet, activeMask, nodeList[childId], nearT) == 0)continue;
+
+			if (stackSize == c_bvhTraversalStackSize)
+			{
+				//(very deep tree) stack overflow, walk this child's sub-tree stacklessly right now
+				uint32_t subTreeEnd = nodeList[childId].GetSkipIndex(childId);
+				uint32_t nodeId = childId;
+				while (nodeId < subTreeEnd && activeMask != 0)
+				{
+					const N_BvhLinearNode& subNode = nodeList[nodeId];
+					float subNearT = 0.0f;
+					uint32_t nodeHitMask = CollisionTestor::mFunction_IntersectRayPacketLinearBvhNode(packet, activeMask, subNode, subNearT);
+					if (nodeHitMask == 0)
+					{
+						nodeId = subNode.GetSkipIndex(nodeId);
+						continue;
+					}
+					if (subNode.IsLeafNode())leafFunc(subNode, packet, nodeHitMask, activeMask);
+					++nodeId;
+				}
+				continue;
+			}
+
+			//insertion, in descending order of nearT
+			uint32_t pos = stackSize++;
+			while (pos > firstPushed && stack[pos - 1].nearT < nearT)
+			{
+				stack[pos] = stack[pos - 1];
+				--pos;
+			}
+			stack[pos] = { childId, nearT };
+		}
+	}
+}
@@ -0,0 +1,269 @@
+
+/***********************************************************************
+
+							cpp: Environment Map Sampler
+
+************************************************************************/
+
+#include "Noise3D.h"
+#include "Noise3D_InDevHeader.h"
+
+using namespace Noise3D;
+
+/***********************************************************************
+
+						PiecewiseConstant1D
+
+************************************************************************/
+
+Noise3D::GI::PiecewiseConstant1D::PiecewiseConstant1D():
+	mFuncIntegral(0.0f)
+{
+}
+
+void Noise3D::GI::PiecewiseConstant1D::Init(const float * pFuncList, uint32_t count)
+{
+	mFuncList.assign(pFuncList, pFuncList + count);
+	mCdfList.resize(count + 1);
+
+	//integral of step function (segment width = 1/count)
+	mCdfList.at(0) = 0.0f;
+	for (uint32_t i = 1; i <= count; ++i)
+	{
+		mCdfList.at(i) = mCdfList.at(i - 1) + mFuncList.at(i - 1) / float(count);
+	}
+	mFuncIntegral = mCdfList.at(count);
+
+	//all zero, fall back to uniform distribution
+	if (mFuncIntegral <= 0.0f)
+	{
+		for (uint32_t i = 1; i <= count; ++i)mCdfList.at(i) = float(i) / float(count);
+	}
+	else
+	{
+		for (uint32_t i = 1; i <= count; ++i)mCdfList.at(i) /= mFuncIntegral;
+	}
+}
+
+float Noise3D::GI::PiecewiseConstant1D::SampleContinuous(float u, float & outPdf, uint32_t & outSegment) const
+{
+	uint32_t count = mFuncList.size();
+	if (count == 0)
+	{
+		outPdf = 0.0f;
+		outSegment = 0;
+		return 0.0f;
+	}
+
+	//last cdf entry <= u (binary search)
+	uint32_t segment = uint32_t(std::upper_bound(mCdfList.begin(), mCdfList.end(), u) - mCdfList.begin());
+	segment = std::min<uint32_t>(std::max<uint32_t>(segment, 1u) - 1u, count - 1);
+
+	//offset inside the segment
+	float du = u - mCdfList.at(segment);
+	float cdfDelta = mCdfList.at(segment + 1) - mCdfList.at(segment);
+	if (cdfDelta > 0.0f)du /= cdfDelta;
+	du = std::min<float>(std::max<float>(du, 0.0f), 1.0f);
+
+	outPdf = (mFuncIntegral > 0.0f) ? mFuncList.at(segment) / mFuncIntegral : 1.0f;
+	outSegment = segment;
+	return std::min<float>((float(segment) + du) / float(count), 0.99999994f);
+}
+
+float Noise3D::GI::PiecewiseConstant1D::GetFuncIntegral() const
+{
+	return mFuncIntegral;
+}
+
+uint32_t Noise3D::GI::PiecewiseConstant1D::GetSegmentCount() const
+{
+	return mFuncList.size();
+}
+
+float Noise3D::GI::PiecewiseConstant1D::GetFunc(uint32_t segment) const
+{
+	return mFuncList.at(segment);
+}
+
+/***********************************************************************
+
+						PiecewiseConstant2D
+
+************************************************************************/
+
+void Noise3D::GI::PiecewiseConstant2D::Init(const float * pFuncList, uint32_t width, uint32_t height)
+{
+	mConditionalList.resize(height);
+	std::vector<float> marginalFuncList(height);
+	for (uint32_t v = 0; v < height; ++v)
+	{
+		mConditionalList.at(v).Init(pFuncList + v * width, width);
+		marginalFuncList.at(v) = mConditionalList.at(v).GetFuncIntegral();
+	}
+	mMarginal.Init(&marginalFuncList.at(0), height);
+}
+
+void Noise3D::GI::PiecewiseConstant2D::Clear()
+{
+	mConditionalList.clear();
+	mMarginal = PiecewiseConstant1D();
+}
+
+bool Noise3D::GI::PiecewiseConstant2D::IsValid() const
+{
+	return !mConditionalList.empty() && mMarginal.GetFuncIntegral() > 0.0f;
+}
+
+Vec2 Noise3D::GI::PiecewiseConstant2D::SampleContinuous(Vec2 u, float & outPdf) const
+{
+	float pdfMarginal = 0.0f, pdfConditional = 0.0f;
+	uint32_t row = 0, column = 0;
+	float v = mMarginal.SampleContinuous(u.y, pdfMarginal, row);
+	float x = mConditionalList.at(row).SampleContinuous(u.x, pdfConditional, column);
+	outPdf = pdfMarginal * pdfConditional;
+	return Vec2(x, v);
+}
+
+float Noise3D::GI::PiecewiseConstant2D::Pdf(Vec2 uv) const
+{
+	if (!IsValid())return 0.0f;
+	uint32_t height = mConditionalList.size();
+	uint32_t width = mConditionalList.at(0).GetSegmentCount();
+	uint32_t column = std::min<uint32_t>(uint32_t(std::max<float>(uv.x, 0.0f) * float(width)), width - 1);
+	uint32_t row = std::min<uint32_t>(uint32_t(std::max<float>(uv.y, 0.0f) * float(height)), height - 1);
+
+	//p(u,v) = p(u|v) * p(v) = f(u,v) / integral
+	return mConditionalList.at(row).GetFunc(column) / mMarginal.GetFuncIntegral();
+}
+
+/***********************************************************************
+
+						EnvironmentMapSampler
+
+************************************************************************/
+
+static inline float EnvMapLuminance(const Color4f& c)
+{
+	return std::max<float>(0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z, 0.0f);
+}
+
+bool Noise3D::GI::EnvironmentMapSampler::Init(Texture2D * pLatLongMap)
+{
+	Clear();
+	if (pLatLongMap == nullptr)
+	{
+		ERROR_MSG("EnvironmentMapSampler: Texture pointer invalid!");
+		return false;
+	}
+	if (!pLatLongMap->IsSysMemBufferValid() && !pLatLongMap->IsCpuPixelStoreValid())
+	{
+		WARNING_MSG("EnvironmentMapSampler: texture didn't keep a copy in memory!");
+		return false;
+	}
+
+	uint32_t width = pLatLongMap->GetWidth();
+	uint32_t height = pLatLongMap->GetHeight();
+	std::vector<float> luminanceList(width * height);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			luminanceList.at(y * width + x) = EnvMapLuminance(pLatLongMap->GetPixelFloat(x, y));
+		}
+	}
+
+	mFunction_BuildDistribution(luminanceList, width, height);
+	return IsValid();
+}
+
+bool Noise3D::GI::EnvironmentMapSampler::Init(TextureCubeMap * pCubeMap, uint32_t latLongHeight)
+{
+	Clear();
+	if (pCubeMap == nullptr)
+	{
+		ERROR_MSG("EnvironmentMapSampler: Texture pointer invalid!");
+		return false;
+	}
+	if (!pCubeMap->IsSysMemBufferValid() && !pCubeMap->IsCpuPixelStoreValid())
+	{
+		WARNING_MSG("EnvironmentMapSampler: texture didn't keep a copy in memory!");
+		return false;
+	}
+
+	//a face covers pi/2 of yaw, so 4*faceWidth columns keep roughly the resolution of the cube map
+	uint32_t height = latLongHeight;
+	if (height == 0)height = std::min<uint32_t>(std::max<uint32_t>(2 * pCubeMap->GetWidth(), 16), 1024);
+	uint32_t width = 2 * height;
+
+	std::vector<float> luminanceList(width * height);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		float pitch = (0.5f - (float(y) + 0.5f) / float(height)) * Ut::PI;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			float yaw = ((float(x) + 0.5f) / float(width) - 0.5f) * 2.0f * Ut::PI;
+			Vec3 dir = Ut::YawPitchToDirection(yaw, pitch);
+			Color4f c = pCubeMap->SamplePixel(dir, TextureCubeMap::N_TEXTURE_CPU_SAMPLE_MODE::BILINEAR);
+			luminanceList.at(y * width + x) = EnvMapLuminance(c);
+		}
+	}
+
+	mFunction_BuildDistribution(luminanceList, width, height);
+	return IsValid();
+}
+
+void Noise3D::GI::EnvironmentMapSampler::Clear()
+{
+	mDistribution.Clear();
+}
+
+bool Noise3D::GI::EnvironmentMapSampler::IsValid() const
+{
+	return mDistribution.IsValid();
+}
+
+Vec3 Noise3D::GI::EnvironmentMapSampler::Sample(Vec2 u, float & outPdf) const
+{
+	float pdfUV = 0.0f;
+	Vec2 uv = mDistribution.SampleContinuous(u, pdfUV);
+
+	float yaw = (uv.x - 0.5f) * 2.0f * Ut::PI;
+	float pitch = (0.5f - uv.y) * Ut::PI;
+	Vec3 dir = Ut::YawPitchToDirection(yaw, pitch);
+
+	//d(omega) = sin(theta) * d(theta) * d(phi) = cos(pitch) * 2pi^2 * du * dv
+	float sinTheta = cosf(pitch);
+	outPdf = (sinTheta > 0.0f) ? pdfUV / (2.0f * Ut::PI * Ut::PI * sinTheta) : 0.0f;
+	return dir;
+}
+
+float Noise3D::GI::EnvironmentMapSampler::Pdf(Vec3 dir) const
+{
+	float yaw = 0.0f, pitch = 0.0f;
+	Ut::DirectionToYawPitch(dir, yaw, pitch);
+	float sinTheta = cosf(pitch);
+	if (sinTheta <= 0.0f)return 0.0f;
+
+	Vec2 uv = Vec2(yaw / (2.0f * Ut::PI) + 0.5f, -pitch / Ut::PI + 0.5f);
+	return mDistribution.Pdf(uv) / (2.0f * Ut::PI * Ut::PI * sinTheta);
+}
+
+/***********************************************************************
+
+								PRIVATE
+
+************************************************************************/
+
+void Noise3D::GI::EnvironmentMapSampler::mFunction_BuildDistribution(std::vector<float>& luminanceList, uint32_t width, uint32_t height)
+{
+	if (width == 0 || height == 0)return;
+
+	//rows near the poles cover less solid angle
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		float sinTheta = sinf(Ut::PI * (float(y) + 0.5f) / float(height));
+		for (uint32_t x = 0; x < width; ++x)luminanceList.at(y * width + x) *= sinTheta;
+	}
+
+	mDistribution.Init(&luminanceList.at(0), width, height);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+
+/***********************************************************************
+
+								h: Environment Map Sampler
+		desc: importance sampling of sky light (lat-long map or cube map).
+		luminance of the sky is tabulated in lat-long parameterization (weighted by
+		sin(theta) of each row), and a 2D piecewise-constant distribution is
+		built from it (marginal CDF of rows, conditional CDF in each row).
+		sampling is O(log n) binary searches on the CDFs, and the pdf of any
+		direction can be queried for multiple importance sampling.
+		reference:
+		Pharr, Jakob & Humphreys, Physically Based Rendering 3rd, 13.6.7 & 14.2.4
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	namespace GI
+	{
+		//piecewise-constant 1D distribution over [0,1) given non-negative function values of segments
+		class PiecewiseConstant1D
+		{
+		public:
+
+			PiecewiseConstant1D();
+
+			void Init(const float* pFuncList, uint32_t count);
+
+			//sample x in [0,1) with inverse CDF, outPdf is density of x, outSegment is the index of function value
+			float SampleContinuous(float u, float& outPdf, uint32_t& outSegment) const;
+
+			//integral of the function over [0,1)
+			float GetFuncIntegral() const;
+
+			uint32_t GetSegmentCount() const;
+
+			float GetFunc(uint32_t segment) const;
+
+		private:
+
+			std::vector<float> mFuncList;
+
+			std::vector<float> mCdfList;//segmentCount+1 elements, mCdfList[0]=0, mCdfList[n]=1
+
+			float mFuncIntegral;
+		};
+
+		//piecewise-constant 2D distribution over [0,1)^2, function values are given row by row (v-major)
+		class PiecewiseConstant2D
+		{
+		public:
+
+			void Init(const float* pFuncList, uint32_t width, uint32_t height);
+
+			void Clear();
+
+			bool IsValid() const;
+
+			//sample (u,v) in [0,1)^2, outPdf is density of (u,v)
+			Vec2 SampleContinuous(Vec2 u, float& outPdf) const;
+
+			float Pdf(Vec2 uv) const;
+
+		private:
+
+			std::vector<PiecewiseConstant1D> mConditionalList;//p(u|v) of each row
+
+			PiecewiseConstant1D mMarginal;//p(v)
+		};
+
+		//importance sampling of a sky texture, the same spherical mapping as Texture2dSampler_Spherical
+		//(u = yaw/2pi + 0.5, v = -pitch/pi + 0.5)
+		class EnvironmentMapSampler
+		{
+		public:
+
+			//a pixel of lat-long map is a segment of the distribution
+			bool Init(Texture2D* pLatLongMap);
+
+			//cube map is tabulated in lat-long grid of (2*height, height), height=0 for 2*face width (at most 1024)
+			bool Init(TextureCubeMap* pCubeMap, uint32_t latLongHeight = 0);
+
+			void Clear();
+
+			bool IsValid() const;
+
+			//sample a direction proportional to luminance, outPdf is w.r.t solid angle
+			Vec3 Sample(Vec2 u, float& outPdf) const;
+
+			//pdf (w.r.t solid angle) of given direction
+			float Pdf(Vec3 dir) const;
+
+		private:
+
+			//luminance of pixels (weighted by sin(theta) of pixel center row here)
+			void mFunction_BuildDistribution(std::vector<float>& luminanceList, uint32_t width, uint32_t height);
+
+			PiecewiseConstant2D mDistribution;
+		};
+	}
+}
\ No newline at end of file
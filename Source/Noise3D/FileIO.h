@@ -6,8 +6,44 @@
 
 #pragma once
 
+#include "_TextParsing.h"
+#include "FileIO_MemoryMappedFile.h"
+
+namespace Noise3D
+{
+	//throughput of a mesh importer, for tracking performance of big files
+	struct N_MeshImportReport
+	{
+		N_MeshImportReport() :
+			fileSize(0), triangleCount(0), vertexCount(0), threadCount(1),
+			parseTime(0.0), mergeTime(0.0), totalTime(0.0) {}
+
+		double GetMegabytesPerSecond() const { return totalTime > 0.0 ? double(fileSize) / (1024.0 * 1024.0) / (totalTime / 1000.0) : 0.0; }
+
+		double GetTrianglesPerSecond() const { return totalTime > 0.0 ? double(triangleCount) / (totalTime / 1000.0) : 0.0; }
+
+		std::string ToString() const
+		{
+			std::ostringstream s;
+			s << "mesh import: " << fileSize / 1024 << "KB, " << triangleCount << " triangles, " << vertexCount << " vertices, "
+				<< threadCount << " threads. parse " << parseTime << "ms, merge " << mergeTime << "ms, total " << totalTime << "ms ("
+				<< GetMegabytesPerSecond() << " MB/s, " << GetTrianglesPerSecond() << " faces/s)\n";
+			return s.str();
+		}
+
+		uint64_t fileSize;
+		uint64_t triangleCount;
+		uint64_t vertexCount;
+		uint32_t threadCount;
+		double parseTime;//ms, (parallel) parsing of text/records
+		double mergeTime;//ms, merging chunks, index fix-up and vertex dedup/weld
+		double totalTime;//ms, including mapping the file
+	};
+}
+
 #include "FileIO_STL.h"
 #include "FileIO_OBJ.h"
+#include "FileIO_N3DMESH.h"
 //#include "FileIO_3DS.h"
 
 
@@ -17,7 +53,8 @@ namespace Noise3D
 
 		class /*_declspec(dllexport)*/ IFileIO : 
 			public IFileIO_STL,
-			public IFileIO_OBJ
+			public IFileIO_OBJ,
+			public IFileIO_N3DMESH
 			//public IFileIO_3DS,
 		{
 		public:
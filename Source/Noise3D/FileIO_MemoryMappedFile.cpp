@@ -0,0 +1,98 @@
+
+/***********************************************************************
+
+                           class : Memory Mapped File
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+
+MemoryMappedFile::MemoryMappedFile() :
+	mFileHandle(INVALID_HANDLE_VALUE),
+	mMappingHandle(NULL),
+	m_pData(nullptr),
+	mSize(0),
+	mIsOpen(false)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open(NFilePath filePath, bool isErrorThrown)
+{
+	Close();
+
+	mFileHandle = ::CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (mFileHandle == INVALID_HANDLE_VALUE)
+	{
+		ERROR_OR_WARNING_MSG(isErrorThrown, "MemoryMappedFile : Cannot Open File ! File path :" + filePath);
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!::GetFileSizeEx(mFileHandle, &fileSize))
+	{
+		Close();
+		ERROR_OR_WARNING_MSG(isErrorThrown, "MemoryMappedFile : failed to get file size ! File path :" + filePath);
+		return false;
+	}
+	mSize = uint64_t(fileSize.QuadPart);
+
+	//a file mapping of size 0 can't be created
+	if (mSize == 0)
+	{
+		mIsOpen = true;
+		return true;
+	}
+
+	mMappingHandle = ::CreateFileMappingA(mFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMappingHandle == NULL)
+	{
+		Close();
+		ERROR_OR_WARNING_MSG(isErrorThrown, "MemoryMappedFile : failed to create file mapping ! File path :" + filePath);
+		return false;
+	}
+
+	m_pData = static_cast<const char*>(::MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_pData == nullptr)
+	{
+		Close();
+		ERROR_OR_WARNING_MSG(isErrorThrown, "MemoryMappedFile : failed to map view of file ! File path :" + filePath);
+		return false;
+	}
+
+	mIsOpen = true;
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if (m_pData != nullptr)::UnmapViewOfFile(m_pData);
+	if (mMappingHandle != NULL)::CloseHandle(mMappingHandle);
+	if (mFileHandle != INVALID_HANDLE_VALUE)::CloseHandle(mFileHandle);
+	m_pData = nullptr;
+	mMappingHandle = NULL;
+	mFileHandle = INVALID_HANDLE_VALUE;
+	mSize = 0;
+	mIsOpen = false;
+}
+
+bool MemoryMappedFile::IsOpen() const
+{
+	return mIsOpen;
+}
+
+const char * MemoryMappedFile::GetData() const
+{
+	return m_pData;
+}
+
+uint64_t MemoryMappedFile::GetSize() const
+{
+	return mSize;
+}
@@ -0,0 +1,51 @@
+
+/***********************************************************************
+
+                           h: Memory Mapped File
+		desc: read-only view of a whole file through win32 file mapping.
+		pages are loaded by the OS on demand, so big mesh files can be
+		parsed in place without copying them into a buffer first.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	class /*_declspec(dllexport)*/ MemoryMappedFile
+	{
+	public:
+
+		MemoryMappedFile();
+
+		~MemoryMappedFile();
+
+		//previously opened file is closed. empty file is valid (with nullptr data).
+		//failure is only reported as a warning if !isErrorThrown
+		bool Open(NFilePath filePath, bool isErrorThrown = true);
+
+		void Close();
+
+		bool IsOpen() const;
+
+		const char* GetData() const;
+
+		uint64_t GetSize() const;
+
+	private:
+
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+		HANDLE mFileHandle;
+
+		HANDLE mMappingHandle;
+
+		const char* m_pData;
+
+		uint64_t mSize;
+
+		bool mIsOpen;
+	};
+};
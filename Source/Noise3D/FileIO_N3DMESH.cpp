@@ -0,0 +1,327 @@
+
+/***********************************************************************
+
+					Description : N3DMESH file Operation
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+
+namespace Noise3D
+{
+	static const char c_magic_N3DMESH[8] = { 'N','3','D','M','E','S','H','\0' };
+
+	//sections start at 16-byte boundaries
+	static inline uint64_t AlignN3DMeshOffset(uint64_t offset)
+	{
+		return (offset + 15) & ~uint64_t(15);
+	}
+
+	//section [offset, offset + count * stride) lies in the file
+	static inline bool IsN3DMeshSectionInFile(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize)
+	{
+		return offset <= fileSize && count * stride <= fileSize - offset;
+	}
+
+	//64-bit words are mixed one by one (a cache key, not a cryptographic hash)
+	static uint64_t HashN3DMeshSourceBlock(const char* p, size_t size)
+	{
+		uint64_t h = 0xcbf29ce484222325ull ^ uint64_t(size);
+		size_t wordCount = size / 8;
+		for (size_t i = 0; i < wordCount; ++i)
+		{
+			uint64_t word = 0;
+			memcpy(&word, p + 8 * i, 8);
+			h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 29;
+		}
+		for (size_t i = wordCount * 8; i < size; ++i)
+		{
+			h = (h ^ uint8_t(p[i])) * 0x100000001b3ull;
+		}
+		return h;
+	}
+}
+
+bool IFileIO_N3DMESH::ImportFile_N3DMESH(NFilePath filePath, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer,
+	std::vector<N_MeshSubsetInfo>& outSubsetList, N_AABB & outLocalAabb, std::vector<N_BvhLinearNode>& outBvhNodeList,
+	std::vector<uint32_t>& outBvhTriangleIdList, N_N3DMeshSourceKey & outSourceKey, bool isErrorThrown)
+{
+	MemoryMappedFile file;
+	if (!file.Open(filePath, isErrorThrown))
+	{
+		ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : Open File Failed! File path :" + filePath);
+		return false;
+	}
+
+	const char* pData = file.GetData();
+	uint64_t fileSize = file.GetSize();
+	N_N3DMeshFileHeader header;
+	if (fileSize < sizeof(header))
+	{
+		ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : File Damaged!! It's not N3DMESH file! File path :" + filePath);
+		return false;
+	}
+	memcpy(&header, pData, sizeof(header));
+	if (!mFunction_CheckHeader_N3DMESH(header, fileSize))
+	{
+		ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : unsupported version/byte order or damaged header! File path :" + filePath);
+		return false;
+	}
+
+	//sections are raw arrays, validated before anything is copied out
+	const UINT* pIndexList = reinterpret_cast<const UINT*>(pData + header.indexOffset);
+	for (uint32_t i = 0; i < header.indexCount; ++i)
+	{
+		if (pIndexList[i] >= header.vertexCount)
+		{
+			ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : index out of range! File path :" + filePath);
+			return false;
+		}
+	}
+
+	const N_N3DMeshSubsetRecord* pSubsetList = reinterpret_cast<const N_N3DMeshSubsetRecord*>(pData + header.subsetOffset);
+	for (uint32_t i = 0; i < header.subsetCount; ++i)
+	{
+		if (uint64_t(pSubsetList[i].nameOffset) + pSubsetList[i].nameLength > header.subsetNameByteCount)
+		{
+			ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : subset name out of range! File path :" + filePath);
+			return false;
+		}
+		if (uint64_t(pSubsetList[i].startPrimitiveID) + pSubsetList[i].primitiveCount > header.indexCount / 3)
+		{
+			ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : subset primitive range out of range! File path :" + filePath);
+			return false;
+		}
+	}
+
+	//depth-first nodes: skip index points forward, leaf range lies in triangle id list
+	const N_BvhLinearNode* pNodeList = reinterpret_cast<const N_BvhLinearNode*>(pData + header.bvhNodeOffset);
+	const uint32_t* pTriangleIdList = reinterpret_cast<const uint32_t*>(pData + header.bvhTriangleIdOffset);
+	uint32_t triangleCount = header.indexCount / 3;
+	for (uint32_t i = 0; i < header.bvhNodeCount; ++i)
+	{
+		const N_BvhLinearNode& node = pNodeList[i];
+		bool isNodeValid = node.IsLeafNode() ?
+			(uint64_t(node.offset) + node.primitiveCount <= header.bvhTriangleIdCount) :
+			(node.offset > i && node.offset <= header.bvhNodeCount);
+		if (!isNodeValid)
+		{
+			ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : BVH node damaged! File path :" + filePath);
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < header.bvhTriangleIdCount; ++i)
+	{
+		if (pTriangleIdList[i] >= triangleCount)
+		{
+			ERROR_OR_WARNING_MSG(isErrorThrown, "Load N3DMESH : BVH triangle id out of range! File path :" + filePath);
+			return false;
+		}
+	}
+
+	//bulk copies out of the mapped pages
+	outVertexBuffer.resize(header.vertexCount);
+	if (header.vertexCount > 0)memcpy(&outVertexBuffer[0], pData + header.vertexOffset, size_t(header.vertexCount) * sizeof(N_DefaultVertex));
+	outIndexBuffer.assign(pIndexList, pIndexList + header.indexCount);
+	outBvhNodeList.assign(pNodeList, pNodeList + header.bvhNodeCount);
+	outBvhTriangleIdList.assign(pTriangleIdList, pTriangleIdList + header.bvhTriangleIdCount);
+
+	const char* pNameList = pData + header.subsetNameOffset;
+	outSubsetList.resize(header.subsetCount);
+	for (uint32_t i = 0; i < header.subsetCount; ++i)
+	{
+		outSubsetList[i].startPrimitiveID = pSubsetList[i].startPrimitiveID;
+		outSubsetList[i].primitiveCount = pSubsetList[i].primitiveCount;
+		outSubsetList[i].matName.assign(pNameList + pSubsetList[i].nameOffset, pSubsetList[i].nameLength);
+	}
+
+	outLocalAabb.min = Vec3(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+	outLocalAabb.max = Vec3(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+
+	outSourceKey.fileSize = header.sourceFileSize;
+	outSourceKey.lastWriteTime = header.sourceLastWriteTime;
+	outSourceKey.contentHash = header.sourceContentHash;
+	outSourceKey.loadFlags = header.sourceLoadFlags;
+
+	return true;
+}
+
+bool IFileIO_N3DMESH::ExportFile_N3DMESH(NFilePath filePath, const std::vector<N_DefaultVertex>& inVertexBuffer, const std::vector<UINT>& inIndexBuffer,
+	const std::vector<N_MeshSubsetInfo>& inSubsetList, const N_AABB & localAabb, const std::vector<N_BvhLinearNode>& inBvhNodeList,
+	const std::vector<uint32_t>& inBvhTriangleIdList, const N_N3DMeshSourceKey & sourceKey, bool isErrorThrown)
+{
+	//subset names are packed into one section
+	std::vector<N_N3DMeshSubsetRecord> subsetRecordList(inSubsetList.size());
+	std::string nameList;
+	for (uint32_t i = 0; i < inSubsetList.size(); ++i)
+	{
+		subsetRecordList[i].startPrimitiveID = inSubsetList[i].startPrimitiveID;
+		subsetRecordList[i].primitiveCount = inSubsetList[i].primitiveCount;
+		subsetRecordList[i].nameOffset = uint32_t(nameList.size());
+		subsetRecordList[i].nameLength = uint32_t(inSubsetList[i].matName.size());
+		nameList += inSubsetList[i].matName;
+	}
+
+	N_N3DMeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, c_magic_N3DMESH, sizeof(header.magic));
+	header.version = c_version_N3DMESH;
+	header.byteOrderTag = c_byteOrderTag_N3DMESH;
+	header.vertexStride = sizeof(N_DefaultVertex);
+	header.bvhNodeStride = sizeof(N_BvhLinearNode);
+	header.vertexCount = uint32_t(inVertexBuffer.size());
+	header.indexCount = uint32_t(inIndexBuffer.size());
+	header.subsetCount = uint32_t(subsetRecordList.size());
+	header.subsetNameByteCount = uint32_t(nameList.size());
+	header.bvhNodeCount = uint32_t(inBvhNodeList.size());
+	header.bvhTriangleIdCount = uint32_t(inBvhTriangleIdList.size());
+	header.aabbMin[0] = localAabb.min.x; header.aabbMin[1] = localAabb.min.y; header.aabbMin[2] = localAabb.min.z;
+	header.aabbMax[0] = localAabb.max.x; header.aabbMax[1] = localAabb.max.y; header.aabbMax[2] = localAabb.max.z;
+	header.sourceFileSize = sourceKey.fileSize;
+	header.sourceLastWriteTime = sourceKey.lastWriteTime;
+	header.sourceContentHash = sourceKey.contentHash;
+	header.sourceLoadFlags = sourceKey.loadFlags;
+
+	//section layout
+	header.vertexOffset = AlignN3DMeshOffset(sizeof(header));
+	header.indexOffset = AlignN3DMeshOffset(header.vertexOffset + uint64_t(header.vertexCount) * sizeof(N_DefaultVertex));
+	header.subsetOffset = AlignN3DMeshOffset(header.indexOffset + uint64_t(header.indexCount) * sizeof(UINT));
+	header.subsetNameOffset = AlignN3DMeshOffset(header.subsetOffset + uint64_t(header.subsetCount) * sizeof(N_N3DMeshSubsetRecord));
+	header.bvhNodeOffset = AlignN3DMeshOffset(header.subsetNameOffset + header.subsetNameByteCount);
+	header.bvhTriangleIdOffset = AlignN3DMeshOffset(header.bvhNodeOffset + uint64_t(header.bvhNodeCount) * sizeof(N_BvhLinearNode));
+
+	//write to a temp file, and replace the target at last
+	std::string tmpFilePath = filePath + ".tmp";
+	std::ofstream fileOut(tmpFilePath, std::ios::binary | std::ios::trunc);
+	if (!fileOut.is_open())
+	{
+		ERROR_OR_WARNING_MSG(isErrorThrown, "Export N3DMESH : Open/Create File Failed! File path :" + tmpFilePath);
+		return false;
+	}
+
+	auto WriteSection = [&fileOut](uint64_t offset, const void* pSection, uint64_t byteSize)
+	{
+		static const char c_padding[16] = {};
+		uint64_t currentOffset = uint64_t(fileOut.tellp());
+		if (offset > currentOffset)fileOut.write(c_padding, std::streamsize(offset - currentOffset));
+		if (byteSize > 0)fileOut.write(static_cast<const char*>(pSection), std::streamsize(byteSize));
+	};
+	WriteSection(0, &header, sizeof(header));
+	WriteSection(header.vertexOffset, inVertexBuffer.data(), uint64_t(header.vertexCount) * sizeof(N_DefaultVertex));
+	WriteSection(header.indexOffset, inIndexBuffer.data(), uint64_t(header.indexCount) * sizeof(UINT));
+	WriteSection(header.subsetOffset, subsetRecordList.data(), uint64_t(header.subsetCount) * sizeof(N_N3DMeshSubsetRecord));
+	WriteSection(header.subsetNameOffset, nameList.data(), header.subsetNameByteCount);
+	WriteSection(header.bvhNodeOffset, inBvhNodeList.data(), uint64_t(header.bvhNodeCount) * sizeof(N_BvhLinearNode));
+	WriteSection(header.bvhTriangleIdOffset, inBvhTriangleIdList.data(), uint64_t(header.bvhTriangleIdCount) * sizeof(uint32_t));
+
+	bool isWriteOk = fileOut.good();
+	fileOut.close();
+	if (!isWriteOk || !::MoveFileExA(tmpFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		::DeleteFileA(tmpFilePath.c_str());
+		ERROR_OR_WARNING_MSG(isErrorThrown, "Export N3DMESH : Write File Failed! File path :" + filePath);
+		return false;
+	}
+
+	return true;
+}
+
+bool IFileIO_N3DMESH::ReadSourceKey_N3DMESH(NFilePath filePath, N_N3DMeshSourceKey & outSourceKey)
+{
+	std::ifstream fileIn(filePath, std::ios::binary | std::ios::ate);
+	if (!fileIn.is_open())return false;
+
+	uint64_t fileSize = uint64_t(fileIn.tellg());
+	N_N3DMeshFileHeader header;
+	if (fileSize < sizeof(header))return false;
+	fileIn.seekg(0);
+	fileIn.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!fileIn.good() || !mFunction_CheckHeader_N3DMESH(header, fileSize))return false;
+
+	outSourceKey.fileSize = header.sourceFileSize;
+	outSourceKey.lastWriteTime = header.sourceLastWriteTime;
+	outSourceKey.contentHash = header.sourceContentHash;
+	outSourceKey.loadFlags = header.sourceLoadFlags;
+	return true;
+}
+
+bool IFileIO_N3DMESH::UpdateSourceKey_N3DMESH(NFilePath filePath, const N_N3DMeshSourceKey & sourceKey)
+{
+	std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
+	if (!file.is_open())return false;
+
+	uint64_t fileSize = uint64_t(file.tellg());
+	N_N3DMeshFileHeader header;
+	if (fileSize < sizeof(header))return false;
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file.good() || !mFunction_CheckHeader_N3DMESH(header, fileSize))return false;
+
+	//only the header is rewritten, sections stay where they are
+	header.sourceFileSize = sourceKey.fileSize;
+	header.sourceLastWriteTime = sourceKey.lastWriteTime;
+	header.sourceContentHash = sourceKey.contentHash;
+	header.sourceLoadFlags = sourceKey.loadFlags;
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	return file.good();
+}
+
+bool IFileIO_N3DMESH::ComputeSourceKey_N3DMESH(NFilePath sourceFilePath, uint32_t loadFlags, bool isComputeHash, N_N3DMeshSourceKey & outSourceKey)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributeData;
+	if (!::GetFileAttributesExA(sourceFilePath.c_str(), GetFileExInfoStandard, &attributeData))return false;
+
+	outSourceKey.fileSize = (uint64_t(attributeData.nFileSizeHigh) << 32) | attributeData.nFileSizeLow;
+	outSourceKey.lastWriteTime = (uint64_t(attributeData.ftLastWriteTime.dwHighDateTime) << 32) | attributeData.ftLastWriteTime.dwLowDateTime;
+	outSourceKey.contentHash = 0;
+	outSourceKey.loadFlags = loadFlags;
+	if (!isComputeHash || outSourceKey.fileSize == 0)return true;
+
+	MemoryMappedFile file;
+	if (!file.Open(sourceFilePath, false))return false;
+
+	//fixed-size blocks are hashed in parallel and combined in order (doesn't depend on thread count)
+	const uint64_t c_blockSize = 1024 * 1024;
+	const char* pData = file.GetData();
+	uint64_t fileSize = file.GetSize();
+	uint32_t blockCount = uint32_t((fileSize + c_blockSize - 1) / c_blockSize);
+	std::vector<uint64_t> blockHashList(blockCount);
+	Ut::ParallelFor(blockCount, Ut::ResolveThreadCount(0), [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+		{
+			uint64_t blockBegin = uint64_t(i) * c_blockSize;
+			blockHashList[i] = HashN3DMeshSourceBlock(pData + blockBegin, size_t(std::min<uint64_t>(c_blockSize, fileSize - blockBegin)));
+		}
+	});
+	outSourceKey.contentHash = HashN3DMeshSourceBlock(reinterpret_cast<const char*>(blockHashList.data()), blockHashList.size() * sizeof(uint64_t));
+
+	return true;
+}
+
+/***********************************************************************
+									PRIVATE
+***********************************************************************/
+
+bool IFileIO_N3DMESH::mFunction_CheckHeader_N3DMESH(const N_N3DMeshFileHeader & header, uint64_t fileSize)
+{
+	if (memcmp(header.magic, c_magic_N3DMESH, sizeof(header.magic)) != 0)return false;
+	if (header.version != c_version_N3DMESH || header.byteOrderTag != c_byteOrderTag_N3DMESH)return false;
+	if (header.vertexStride != sizeof(N_DefaultVertex) || header.bvhNodeStride != sizeof(N_BvhLinearNode))return false;
+	if (header.indexCount % 3 != 0)return false;
+
+	//4-byte elements need aligned offsets (the file is used in place)
+	return
+		header.vertexOffset % 16 == 0 && header.indexOffset % 16 == 0 && header.subsetOffset % 16 == 0 &&
+		header.bvhNodeOffset % 16 == 0 && header.bvhTriangleIdOffset % 16 == 0 &&
+		IsN3DMeshSectionInFile(header.vertexOffset, header.vertexCount, sizeof(N_DefaultVertex), fileSize) &&
+		IsN3DMeshSectionInFile(header.indexOffset, header.indexCount, sizeof(UINT), fileSize) &&
+		IsN3DMeshSectionInFile(header.subsetOffset, header.subsetCount, sizeof(N_N3DMeshSubsetRecord), fileSize) &&
+		IsN3DMeshSectionInFile(header.subsetNameOffset, header.subsetNameByteCount, 1, fileSize) &&
+		IsN3DMeshSectionInFile(header.bvhNodeOffset, header.bvhNodeCount, sizeof(N_BvhLinearNode), fileSize) &&
+		IsN3DMeshSectionInFile(header.bvhTriangleIdOffset, header.bvhTriangleIdCount, sizeof(uint32_t), fileSize);
+}
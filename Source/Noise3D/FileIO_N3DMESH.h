@@ -0,0 +1,120 @@
+
+/***********************************************************************
+
+                           h: N3DMESH file import/export
+		desc: native binary mesh cache. a fixed header is followed by
+		sections that are raw arrays of engine structs (N_DefaultVertex,
+		index, subset records, N_BvhLinearNode...), so a memory-mapped
+		file is loaded with bulk copies instead of parsing. little-endian
+		only (the byte order tag is checked), and the layout is versioned
+		with struct sizes, so a stale/foreign cache is rejected instead of
+		being misread.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	struct N_MeshSubsetInfo;
+	struct N_BvhLinearNode;
+
+	//stamp of the source file a cache was generated from (the cache is stale if anything differs)
+	struct N_N3DMeshSourceKey
+	{
+		N_N3DMeshSourceKey() :
+			fileSize(0), lastWriteTime(0), contentHash(0), loadFlags(0) {}
+
+		bool operator==(const N_N3DMeshSourceKey& rhs) const
+		{
+			return fileSize == rhs.fileSize && lastWriteTime == rhs.lastWriteTime &&
+				contentHash == rhs.contentHash && loadFlags == rhs.loadFlags;
+		}
+
+		uint64_t fileSize;
+		uint64_t lastWriteTime;//FILETIME of last write
+		uint64_t contentHash;//hash of the whole source file
+		uint32_t loadFlags;//loading options that change the result (e.g. STL welding)
+	};
+
+	//fixed-size file header, all offsets are from the beginning of the file (16-byte aligned sections)
+	struct N_N3DMeshFileHeader
+	{
+		char magic[8];//"N3DMESH\0"
+		uint32_t version;
+		uint32_t byteOrderTag;//c_byteOrderTag in writer's byte order
+		uint32_t vertexStride;//sizeof(N_DefaultVertex)
+		uint32_t bvhNodeStride;//sizeof(N_BvhLinearNode)
+
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t subsetCount;
+		uint32_t subsetNameByteCount;
+		uint32_t bvhNodeCount;//0 if BVH isn't stored
+		uint32_t bvhTriangleIdCount;
+
+		float aabbMin[3];
+		float aabbMax[3];
+
+		uint64_t sourceFileSize;
+		uint64_t sourceLastWriteTime;
+		uint64_t sourceContentHash;
+		uint32_t sourceLoadFlags;
+		uint32_t reserved;
+
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t subsetOffset;
+		uint64_t subsetNameOffset;
+		uint64_t bvhNodeOffset;
+		uint64_t bvhTriangleIdOffset;
+	};
+
+	static_assert(sizeof(N_N3DMeshFileHeader) == 152, "N_N3DMeshFileHeader: header layout changed, bump the version.");
+
+	//a subset, name is in the name section [nameOffset, nameOffset+nameLength)
+	struct N_N3DMeshSubsetRecord
+	{
+		uint32_t startPrimitiveID;
+		uint32_t primitiveCount;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+	};
+
+	class IFileIO_N3DMESH
+	{
+	public:
+
+		//the file is mapped and sections are validated (counts, index range, BVH ranges) before being copied.
+		//outBvhNodeList is empty if the file doesn't contain a BVH. a cache loader passes !isErrorThrown, then
+		//a damaged file is only reported as a warning (and false is returned)
+		bool ImportFile_N3DMESH(NFilePath filePath, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer,
+			std::vector<N_MeshSubsetInfo>& outSubsetList, N_AABB& outLocalAabb, std::vector<N_BvhLinearNode>& outBvhNodeList,
+			std::vector<uint32_t>& outBvhTriangleIdList, N_N3DMeshSourceKey& outSourceKey, bool isErrorThrown = true);
+
+		//inBvhNodeList can be empty (no BVH). the file is written to a temp file first and then renamed,
+		//so a reader never sees a half-written cache. failure is only reported as a warning if !isErrorThrown
+		bool ExportFile_N3DMESH(NFilePath filePath, const std::vector<N_DefaultVertex>& inVertexBuffer, const std::vector<UINT>& inIndexBuffer,
+			const std::vector<N_MeshSubsetInfo>& inSubsetList, const N_AABB& localAabb, const std::vector<N_BvhLinearNode>& inBvhNodeList,
+			const std::vector<uint32_t>& inBvhTriangleIdList, const N_N3DMeshSourceKey& sourceKey, bool isErrorThrown = true);
+
+		//only the header is read (cheap check of a cache before loading it). returns false if file doesn't exist or isn't valid
+		bool ReadSourceKey_N3DMESH(NFilePath filePath, N_N3DMeshSourceKey& outSourceKey);
+
+		//rewrite the source key in the header of an existing cache (e.g. source was touched but its content is the same)
+		bool UpdateSourceKey_N3DMESH(NFilePath filePath, const N_N3DMeshSourceKey& sourceKey);
+
+		//size/last write time (and content hash if 'isComputeHash') of a source file. returns false if file doesn't exist
+		static bool ComputeSourceKey_N3DMESH(NFilePath sourceFilePath, uint32_t loadFlags, bool isComputeHash, N_N3DMeshSourceKey& outSourceKey);
+
+		static const uint32_t c_version_N3DMESH = 1;
+
+		static const uint32_t c_byteOrderTag_N3DMESH = 0x01020304;
+
+	private:
+
+		//header is complete, supported and consistent with file size
+		bool mFunction_CheckHeader_N3DMESH(const N_N3DMeshFileHeader& header, uint64_t fileSize);
+
+	};
+};
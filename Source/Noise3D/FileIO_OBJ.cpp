@@ -15,142 +15,450 @@ using namespace Noise3D;
 *********************************************************************/
 bool IFileIO_OBJ::ImportFile_OBJ(NFilePath pFilePath, std::vector<N_DefaultVertex>& refVertexBuffer, std::vector<UINT>& refIndexBuffer)
 {
-	std::ifstream fileIn(pFilePath);
-	if (!fileIn.good())
+	std::vector<N_MeshSubsetInfo> subsetList;
+	return ImportFile_OBJ(pFilePath, refVertexBuffer, refIndexBuffer, subsetList);
+}
+
+bool IFileIO_OBJ::ImportFile_OBJ(NFilePath pFilePath, std::vector<N_DefaultVertex>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<N_MeshSubsetInfo>& outSubsetList, uint32_t threadCount)
+{
+	auto timeBegin = std::chrono::steady_clock::now();
+	auto MillisecondsSince = [](std::chrono::steady_clock::time_point t)->double
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+	};
+
+	MemoryMappedFile file;
+	if (!file.Open(pFilePath))
 	{
 		ERROR_MSG("Import OBJ : Open File failed!!");
 		return false;
 	}
 
-	std::vector<Vec3> pointList;//xyz buffer
-	std::vector<Vec2> texcoordList;//texcoord buffer
-	std::vector<Vec3> VNormalList;//vertex normal buffer
-	std::vector<N_LoadOBJ_vertexInfoIndex> vertexInfoList;//indices combination
+	//chunks on line boundaries, parsed concurrently
+	N_MeshImportReport report;
+	report.fileSize = file.GetSize();
+	threadCount = Ut::ResolveThreadCount(threadCount);
+	if (file.GetSize() < c_parallelParseMinFileSize_OBJ)threadCount = 1;
+	std::vector<const char*> boundaryList;
+	Ut::TextSplitLines(file.GetData(), file.GetData() + file.GetSize(), threadCount, boundaryList);
+	std::vector<N_LoadOBJ_ParsedData> chunkList(boundaryList.size() - 1);
 
-	 //newly input string from file
-	std::string currString;
+	auto timeParse = std::chrono::steady_clock::now();
+	Ut::ParallelFor(uint32_t(chunkList.size()), threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+			mFunction_ParseOBJ(boundaryList[i], boundaryList[i + 1], chunkList[i]);
+	});
+	file.Close();
+	report.parseTime = MillisecondsSince(timeParse);
 
-	//,...............
-	while (!fileIn.eof())
+	for (auto& chunk : chunkList)
 	{
-		fileIn >> currString;
+		if (!chunk.errorMessage.empty())
+		{
+			ERROR_MSG("Import OBJ : " + chunk.errorMessage);
+			return false;
+		}
+	}
+
+	auto timeMerge = std::chrono::steady_clock::now();
+	N_LoadOBJ_ParsedData data;
+	if (!mFunction_MergeChunks(chunkList, data, threadCount))return false;
+	chunkList.clear();
+	if (!mFunction_BuildVertexAndIndexBuffer(data, refVertexBuffer, refIndexBuffer, threadCount))return false;
+	report.mergeTime = MillisecondsSince(timeMerge);
+
+	outSubsetList.clear();
+	for (auto& g : data.groupList)
+	{
+		N_MeshSubsetInfo subset;
+		subset.startPrimitiveID = g.startPrimitiveID;
+		subset.primitiveCount = g.primitiveCount;
+		subset.matName = g.matName;
+		outSubsetList.push_back(subset);
+	}
+
+	report.threadCount = threadCount;
+	report.triangleCount = refIndexBuffer.size() / 3;
+	report.vertexCount = refVertexBuffer.size();
+	report.totalTime = MillisecondsSince(timeBegin);
+	mLastImportReport_OBJ = report;
+	return true;
+}
+
+const N_MeshImportReport & IFileIO_OBJ::GetLastImportReport_OBJ() const
+{
+	return mLastImportReport_OBJ;
+}
 
-		//3d vertex : "v 1.0000000 0.52524242 5.12312345"
-		if (currString == "v")
+/*******************************************************************
+
+										PRIVATE
+
+*********************************************************************/
+
+bool IFileIO_OBJ::mFunction_ParseOBJ(const char * pBegin, const char * pEnd, N_LoadOBJ_ParsedData & outData)
+{
+	//rough reservation (~40 bytes per line)
+	size_t estimatedLineCount = size_t(pEnd - pBegin) / 40;
+	outData.pointList.reserve(estimatedLineCount / 3);
+	outData.cornerList.reserve(estimatedLineCount * 2);
+
+	//a group ends when 'o'/'g'/'usemtl' appears (empty group is removed).
+	//the first group of a chunk continues the last group of previous chunk
+	auto BeginNewGroup = [&outData](bool isContinued)
+	{
+		UINT triangleCount = UINT(outData.cornerList.size() / 3);
+		if (!outData.groupList.empty())
 		{
-			Vec3 currPoint(0, 0, 0);
-			fileIn >> currPoint.x >> currPoint.y >> currPoint.z;
-			pointList.push_back(currPoint);
+			N_LoadOBJ_FaceGroup& lastGroup = outData.groupList.back();
+			lastGroup.primitiveCount = triangleCount - lastGroup.startPrimitiveID;
+			if (lastGroup.primitiveCount == 0)outData.groupList.pop_back();
 		}
+		N_LoadOBJ_FaceGroup newGroup;
+		newGroup.startPrimitiveID = triangleCount;
+		newGroup.matName = outData.lastMatName;
+		newGroup.isContinued = isContinued;
+		newGroup.isMatNameInherited = !outData.isMatNameAssigned;
+		outData.groupList.push_back(newGroup);
+	};
+	BeginNewGroup(true);
 
+	//OBJ index is 1-based, negative index is relative to the end of current list. 0 is illegal.
+	//the start of the list is unknown in a chunk, so a negative index is kept relative to the chunk (fixed up in merging),
+	//and range of indices is validated after merging
+	UINT cornerRelativeFlag = 0;
+	auto ResolveIndex = [&cornerRelativeFlag](int64_t objIndex, size_t chunkCount, UINT relativeFlag, UINT& outIndex)->bool
+	{
+		if (objIndex > 0)
+		{
+			if (objIndex > int64_t(N_LoadOBJ_vertexInfoIndex::c_missingIndex))return false;
+			outIndex = UINT(objIndex - 1);
+			return true;
+		}
+		int64_t index = int64_t(chunkCount) + objIndex;
+		if (objIndex == 0 || index < int64_t(INT_MIN))return false;
+		outIndex = UINT(int32_t(index));
+		cornerRelativeFlag |= relativeFlag;
+		return true;
+	};
+
+	//corners of current polygon (fan triangulation)
+	std::vector<N_LoadOBJ_vertexInfoIndex> polygonCornerList;
+	std::vector<uint8_t> polygonFlagList;
+	bool isAnyRelativeIndex = false;
+
+	const char* p = pBegin;
+	while (p < pEnd)
+	{
+		Ut::TextSkipSpaces(p, pEnd);
+		if (p >= pEnd)break;
+
+		//3d vertex : "v 1.0000000 0.52524242 5.12312345" (w or vertex color is ignored)
+		if (Ut::TextMatchKeyword(p, pEnd, "v", 1))
+		{
+			Vec3 currPoint(0, 0, 0);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currPoint.x);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currPoint.y);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currPoint.z);
+			outData.pointList.push_back(currPoint);
+		}
 		//vertex normal "vn 1.0000000 0.52524242 5.12312345"
-		if (currString == "vn")
+		else if (Ut::TextMatchKeyword(p, pEnd, "vn", 2))
 		{
 			Vec3 currNormal(0, 0, 0);
-			fileIn >> currNormal.x >> currNormal.y >> currNormal.z;
-			VNormalList.push_back(currNormal);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currNormal.x);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currNormal.y);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currNormal.z);
+			outData.normalList.push_back(currNormal);
 		}
-
 		//texture coordinate "vt 1.0000000 0.0000000"
-		if (currString == "vt")
+		else if (Ut::TextMatchKeyword(p, pEnd, "vt", 2))
 		{
 			Vec2 currTexCoord(0, 0);
-			fileIn >> currTexCoord.x >> currTexCoord.y;
-			texcoordList.push_back(currTexCoord);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currTexCoord.x);
+			Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, currTexCoord.y);
+			outData.texcoordList.push_back(currTexCoord);
 		}
-
-		if (currString == "g")
+		//face : "v/vt/vn", "v//vn", "v/vt" or "v" for each corner, 3 or more corners
+		else if (Ut::TextMatchKeyword(p, pEnd, "f", 1))
 		{
-			//(2019.4.29)ignore new geometry
-			char tmpStr[256];
-			fileIn.getline(tmpStr,256);
-		}
-
-		//face : if this face is trangles(OBJ also support quads or curves etc..)
-		//, the combination will be 
-		//  vertex index  / texcoord index  /  vnormal index (for each vertex)
-		// like "1/3/4" "5/6/7"
-		//note that texcoord is optional (which might be missing)
-		if (currString == "f")
-		{
-			for (UINT i = 0;i < 3;++i)
+			polygonCornerList.clear();
+			polygonFlagList.clear();
+			while (true)
 			{
-				//static UINT currUniqueVertexCount = 0;
-				N_LoadOBJ_vertexInfoIndex currVertex = { 0,0,0 };
-				std::stringstream tmpSStream;
-				std::string tmpString;
-
-				//then a "1/2/3" "4/1/3" like string will be input
-				fileIn >> tmpString;
-
-				//replace "/" with SPACE ,so STD::STRINGSTREAM will automatically format
-				//the string into 3 separate part
-				for (auto& c : tmpString) { if (c == '/')c = ' '; }
-
-				tmpSStream << tmpString;
-				tmpSStream >> currVertex.vertexID >> currVertex.texcoordID >> currVertex.vertexNormalID;
-				--currVertex.texcoordID;
-				--currVertex.vertexID;
-				--currVertex.vertexNormalID;
-
-				//this will be an n^2 searching....optimization will be needed
-				//non-existed element will be created
-				bool IsVertexExist = false;
-				UINT  existedVertexIndex = 0;
-
-				for (UINT j = 0;j <vertexInfoList.size();j++)
+				Ut::TextSkipSpaces(p, pEnd);
+				int64_t objIndex = 0;
+				if (!Ut::TextParseInt(p, pEnd, objIndex))break;
+
+				N_LoadOBJ_vertexInfoIndex corner;
+				corner.texcoordID = N_LoadOBJ_vertexInfoIndex::c_missingIndex;
+				corner.vertexNormalID = N_LoadOBJ_vertexInfoIndex::c_missingIndex;
+				cornerRelativeFlag = 0;
+				bool isIndexValid = ResolveIndex(objIndex, outData.pointList.size(), 1, corner.vertexID);
+				if (p < pEnd && *p == '/')
 				{
-					//in DEBUG mode ,[] operator will be a big performance overhead
-					if (vertexInfoList.at(j) == currVertex)
+					++p;
+					if (Ut::TextParseInt(p, pEnd, objIndex))
+						isIndexValid &= ResolveIndex(objIndex, outData.texcoordList.size(), 2, corner.texcoordID);
+					if (p < pEnd && *p == '/')
 					{
-						IsVertexExist = true;
-						existedVertexIndex =j;
-						break;
+						++p;
+						if (Ut::TextParseInt(p, pEnd, objIndex))
+							isIndexValid &= ResolveIndex(objIndex, outData.normalList.size(), 4, corner.vertexNormalID);
 					}
 				}
 
-				if (!IsVertexExist)
+				if (!isIndexValid)
 				{
-					vertexInfoList.push_back(currVertex);
-					//the newest vertex.....
-					refIndexBuffer.push_back(vertexInfoList.size() - 1);
+					outData.errorMessage = "face index out of range! line:" + Ut::TextGetRestOfLine(p, pEnd);
+					return false;
 				}
-				else
+				polygonCornerList.push_back(corner);
+				polygonFlagList.push_back(uint8_t(cornerRelativeFlag));
+				isAnyRelativeIndex |= (cornerRelativeFlag != 0);
+			}
+
+			//flags of relative indices are only allocated when needed
+			if (isAnyRelativeIndex && outData.relativeIndexFlagList.size() < outData.cornerList.size())
+				outData.relativeIndexFlagList.resize(outData.cornerList.size(), 0);
+
+			for (size_t i = 1; i + 1 < polygonCornerList.size(); ++i)
+			{
+				outData.cornerList.push_back(polygonCornerList[0]);
+				outData.cornerList.push_back(polygonCornerList[i]);
+				outData.cornerList.push_back(polygonCornerList[i + 1]);
+				if (isAnyRelativeIndex)
 				{
-					refIndexBuffer.push_back(existedVertexIndex);
+					outData.relativeIndexFlagList.push_back(polygonFlagList[0]);
+					outData.relativeIndexFlagList.push_back(polygonFlagList[i]);
+					outData.relativeIndexFlagList.push_back(polygonFlagList[i + 1]);
 				}
 			}
 		}
+		else if (Ut::TextMatchKeyword(p, pEnd, "o", 1) || Ut::TextMatchKeyword(p, pEnd, "g", 1))
+		{
+			BeginNewGroup(false);
+		}
+		else if (Ut::TextMatchKeyword(p, pEnd, "usemtl", 6))
+		{
+			outData.lastMatName = Ut::TextGetRestOfLine(p, pEnd);
+			outData.isMatNameAssigned = true;
+			BeginNewGroup(false);
+		}
+
+		//comments, "mtllib", "s", "l" and the rest of handled lines
+		Ut::TextSkipLine(p, pEnd);
 	}
 
-	fileIn.close();
+	//close the last group (kept even if empty, faces of next chunk may continue it)
+	N_LoadOBJ_FaceGroup& lastGroup = outData.groupList.back();
+	lastGroup.primitiveCount = UINT(outData.cornerList.size() / 3) - lastGroup.startPrimitiveID;
+
+	return true;
+}
+
+bool IFileIO_OBJ::mFunction_MergeChunks(std::vector<N_LoadOBJ_ParsedData>& chunkList, N_LoadOBJ_ParsedData & outData, uint32_t threadCount)
+{
+	uint32_t chunkCount = uint32_t(chunkList.size());
+
+	//offsets of each chunk in merged lists
+	std::vector<size_t> pointOffset(chunkCount + 1, 0);
+	std::vector<size_t> texcoordOffset(chunkCount + 1, 0);
+	std::vector<size_t> normalOffset(chunkCount + 1, 0);
+	std::vector<size_t> cornerOffset(chunkCount + 1, 0);
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		pointOffset[i + 1] = pointOffset[i] + chunkList[i].pointList.size();
+		texcoordOffset[i + 1] = texcoordOffset[i] + chunkList[i].texcoordList.size();
+		normalOffset[i + 1] = normalOffset[i] + chunkList[i].normalList.size();
+		cornerOffset[i + 1] = cornerOffset[i] + chunkList[i].cornerList.size();
+	}
+	if (cornerOffset[chunkCount] >= size_t(UINT_MAX) || pointOffset[chunkCount] >= size_t(UINT_MAX))
+	{
+		ERROR_MSG("Import OBJ : too many vertices/faces!");
+		return false;
+	}
+
+	//groups: 'usemtl' of previous chunks is inherited, and a continued group is joined with the last group.
+	//empty groups are removed at last
+	outData.groupList.clear();
+	std::string currentMatName;
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		for (auto& g : chunkList[i].groupList)
+		{
+			N_LoadOBJ_FaceGroup group = g;
+			group.startPrimitiveID += UINT(cornerOffset[i] / 3);
+			if (group.isMatNameInherited)group.matName = currentMatName;
+
+			if (group.isContinued && !outData.groupList.empty())
+			{
+				outData.groupList.back().primitiveCount += group.primitiveCount;
+			}
+			else
+			{
+				outData.groupList.push_back(group);
+			}
+		}
+		if (chunkList[i].isMatNameAssigned)currentMatName = chunkList[i].lastMatName;
+	}
+	outData.groupList.erase(std::remove_if(outData.groupList.begin(), outData.groupList.end(),
+		[](const N_LoadOBJ_FaceGroup& g) {return g.primitiveCount == 0; }), outData.groupList.end());
+
+	//a single chunk is moved instead of copied
+	bool isSingleChunk = (chunkCount == 1);
+	if (isSingleChunk)
+	{
+		outData.pointList.swap(chunkList[0].pointList);
+		outData.texcoordList.swap(chunkList[0].texcoordList);
+		outData.normalList.swap(chunkList[0].normalList);
+		outData.cornerList.swap(chunkList[0].cornerList);
+	}
+	else
+	{
+		outData.pointList.resize(pointOffset[chunkCount]);
+		outData.texcoordList.resize(texcoordOffset[chunkCount]);
+		outData.normalList.resize(normalOffset[chunkCount]);
+		outData.cornerList.resize(cornerOffset[chunkCount]);
+	}
+
+	//copy, fix up relative indices, and validate indices (chunk by chunk in parallel)
+	const UINT pointCount = UINT(outData.pointList.size());
+	const UINT texcoordCount = UINT(outData.texcoordList.size());
+	const UINT normalCount = UINT(outData.normalList.size());
+	const UINT missing = N_LoadOBJ_vertexInfoIndex::c_missingIndex;
+	std::atomic<bool> isIndexValid(true);
+	Ut::ParallelFor(chunkCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+		{
+			N_LoadOBJ_ParsedData& chunk = chunkList[i];
+			if (!isSingleChunk)
+			{
+				std::copy(chunk.pointList.begin(), chunk.pointList.end(), outData.pointList.begin() + pointOffset[i]);
+				std::copy(chunk.texcoordList.begin(), chunk.texcoordList.end(), outData.texcoordList.begin() + texcoordOffset[i]);
+				std::copy(chunk.normalList.begin(), chunk.normalList.end(), outData.normalList.begin() + normalOffset[i]);
+				std::copy(chunk.cornerList.begin(), chunk.cornerList.end(), outData.cornerList.begin() + cornerOffset[i]);
+			}
+
+			auto FixUp = [](UINT& index, size_t offset)->bool
+			{
+				int64_t absoluteIndex = int64_t(offset) + int64_t(int32_t(index));
+				index = UINT(absoluteIndex);
+				return absoluteIndex >= 0;
+			};
+
+			bool isChunkValid = true;
+			const std::vector<uint8_t>& flagList = chunk.relativeIndexFlagList;
+			for (size_t c = cornerOffset[i]; c < cornerOffset[i + 1]; ++c)
+			{
+				N_LoadOBJ_vertexInfoIndex& corner = outData.cornerList[c];
+				size_t localCorner = c - cornerOffset[i];
+				uint8_t flag = (localCorner < flagList.size() ? flagList[localCorner] : 0);
+				if (flag & 1)isChunkValid &= FixUp(corner.vertexID, pointOffset[i]);
+				if (flag & 2)isChunkValid &= FixUp(corner.texcoordID, texcoordOffset[i]);
+				if (flag & 4)isChunkValid &= FixUp(corner.vertexNormalID, normalOffset[i]);
+
+				isChunkValid &= (corner.vertexID < pointCount);
+				isChunkValid &= (corner.texcoordID == missing || corner.texcoordID < texcoordCount);
+				isChunkValid &= (corner.vertexNormalID == missing || corner.vertexNormalID < normalCount);
+			}
+			if (!isChunkValid)isIndexValid = false;
+		}
+	});
+
+	if (!isIndexValid)
+	{
+		ERROR_MSG("Import OBJ : face index out of range!");
+		return false;
+	}
+	return true;
+}
+
+bool IFileIO_OBJ::mFunction_BuildVertexAndIndexBuffer(const N_LoadOBJ_ParsedData & data, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, uint32_t threadCount)
+{
+	const uint32_t cornerCount = uint32_t(data.cornerList.size());
+	if (cornerCount < 65536)threadCount = 1;
+
+	//unique corners (O(1) average per corner instead of scanning all previous vertices),
+	//vertex IDs are in order of first occurrence for any thread count
+	std::vector<uint32_t> firstCornerList;
+	size_t expectedVertexCount = data.pointList.size() + data.pointList.size() / 2;
+	Ut::ParallelDedup<N_LoadOBJ_vertexInfoIndex>(cornerCount,
+		[&data](uint32_t i)->const N_LoadOBJ_vertexInfoIndex& {return data.cornerList[i]; },
+		[](const N_LoadOBJ_vertexInfoIndex& v) {return Ut::HashUint3(v.vertexID, v.texcoordID, v.vertexNormalID); },
+		expectedVertexCount, threadCount, outIndexBuffer, firstCornerList);
+
+	std::vector<N_LoadOBJ_vertexInfoIndex> vertexInfoList(firstCornerList.size());
+	for (size_t i = 0; i < firstCornerList.size(); ++i)vertexInfoList[i] = data.cornerList[firstCornerList[i]];
 
 	// All interested data are acquired, now convert to VB/IB
-	refVertexBuffer.resize(vertexInfoList.size());
-	for (UINT i = 0;i < refVertexBuffer.size();++i)
-	{
-		N_DefaultVertex tmpCompleteV = {};
-
-		//several indices which can retrieve vertex information
-		N_LoadOBJ_vertexInfoIndex& indicesCombination = vertexInfoList.at(i);
-		tmpCompleteV.Pos = pointList.at(indicesCombination.vertexID);
-		tmpCompleteV.Normal = VNormalList.at(indicesCombination.vertexNormalID);
-		tmpCompleteV.TexCoord = texcoordList.at(indicesCombination.texcoordID);
-		tmpCompleteV.Color = Vec4(1.0f, 1.0f, 1.0f, 1.0f);
-		//tangent
-		if (tmpCompleteV.Normal.x == 0.0f && tmpCompleteV.Normal.z == 0.0f)
+	outVertexBuffer.resize(vertexInfoList.size());
+	std::atomic<bool> isAnyNormalMissing(false);
+	Ut::ParallelFor(uint32_t(outVertexBuffer.size()), threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		bool isNormalMissing = false;
+		for (UINT i = chunkBegin; i < chunkEnd; ++i)
 		{
-			tmpCompleteV.Tangent = Vec3(1.0f, 0, 0);
+			N_DefaultVertex tmpCompleteV = {};
+
+			//several indices which can retrieve vertex information
+			const N_LoadOBJ_vertexInfoIndex& indicesCombination = vertexInfoList[i];
+			tmpCompleteV.Pos = data.pointList[indicesCombination.vertexID];
+			tmpCompleteV.Color = Vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			if (indicesCombination.texcoordID != N_LoadOBJ_vertexInfoIndex::c_missingIndex)
+				tmpCompleteV.TexCoord = data.texcoordList[indicesCombination.texcoordID];
+			if (indicesCombination.vertexNormalID != N_LoadOBJ_vertexInfoIndex::c_missingIndex)
+				tmpCompleteV.Normal = data.normalList[indicesCombination.vertexNormalID];
+			else
+				isNormalMissing = true;
+			outVertexBuffer[i] = tmpCompleteV;
 		}
-		else
+		if (isNormalMissing)isAnyNormalMissing = true;
+	});
+
+	//missing normals: sum of area-weighted face normals
+	if (isAnyNormalMissing)
+	{
+		for (size_t i = 0; i + 2 < outIndexBuffer.size(); i += 3)
 		{
-			Vec3 tmpVec(-tmpCompleteV.Normal.z, 0, tmpCompleteV.Normal.x);
-			tmpCompleteV.Tangent = tmpCompleteV.Normal.Cross(tmpVec);
-			tmpCompleteV.Tangent.Normalize();
+			N_DefaultVertex& v0 = outVertexBuffer[outIndexBuffer[i]];
+			N_DefaultVertex& v1 = outVertexBuffer[outIndexBuffer[i + 1]];
+			N_DefaultVertex& v2 = outVertexBuffer[outIndexBuffer[i + 2]];
+			Vec3 faceNormal = (v1.Pos - v0.Pos).Cross(v2.Pos - v0.Pos);
+			for (UINT c = 0; c < 3; ++c)
+			{
+				UINT vertexID = outIndexBuffer[i + c];
+				if (vertexInfoList[vertexID].vertexNormalID == N_LoadOBJ_vertexInfoIndex::c_missingIndex)
+					outVertexBuffer[vertexID].Normal += faceNormal;
+			}
+		}
+		for (UINT i = 0; i < outVertexBuffer.size(); ++i)
+		{
+			if (vertexInfoList[i].vertexNormalID == N_LoadOBJ_vertexInfoIndex::c_missingIndex)
+				outVertexBuffer[i].Normal.Normalize();
 		}
-		//.......
-		refVertexBuffer.at(i) = (tmpCompleteV);
 	}
 
+	//tangent
+	Ut::ParallelFor(uint32_t(outVertexBuffer.size()), threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+		{
+			N_DefaultVertex& v = outVertexBuffer[i];
+			if (v.Normal.x == 0.0f && v.Normal.z == 0.0f)
+			{
+				v.Tangent = Vec3(1.0f, 0, 0);
+			}
+			else
+			{
+				Vec3 tmpVec(-v.Normal.z, 0, v.Normal.x);
+				v.Tangent = v.Normal.Cross(tmpVec);
+				v.Tangent.Normalize();
+			}
+		}
+	});
+
 	return true;
 }
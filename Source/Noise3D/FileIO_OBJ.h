@@ -8,6 +8,8 @@
 
 namespace Noise3D
 {
+	struct N_MeshSubsetInfo;
+
 	//in OBJ file ,vertex info is composed of indices
 	struct N_LoadOBJ_vertexInfoIndex
 	{
@@ -32,19 +34,73 @@ namespace Noise3D
 			return false;
 		}
 
+		//optional texcoord/normal index that is not given in a face ("1//3", "1/2", "1")
+		static const UINT c_missingIndex = 0xffffffff;
+
 		UINT vertexID;
 		UINT texcoordID;
 		UINT vertexNormalID;
 	};
 
+	//a group of faces started by 'o'/'g'/'usemtl'
+	struct N_LoadOBJ_FaceGroup
+	{
+		N_LoadOBJ_FaceGroup() :startPrimitiveID(0), primitiveCount(0), isContinued(false), isMatNameInherited(true) {}
+
+		UINT startPrimitiveID;
+		UINT primitiveCount;
+		std::string matName;//name of 'usemtl', empty if not given
+		bool isContinued;//(chunk) not started by a keyword, it continues the last group of previous chunk
+		bool isMatNameInherited;//(chunk) no 'usemtl' before it in the chunk, matName comes from previous chunks
+	};
+
+	//parsed content of (a part of) OBJ file, indices are zero-based.
+	//a chunk of file keeps positive indices absolute, but negative indices are relative to the chunk until merged
+	struct N_LoadOBJ_ParsedData
+	{
+		N_LoadOBJ_ParsedData() :isMatNameAssigned(false) {}
+
+		std::vector<Vec3> pointList;//xyz buffer
+		std::vector<Vec2> texcoordList;//texcoord buffer
+		std::vector<Vec3> normalList;//vertex normal buffer
+		std::vector<N_LoadOBJ_vertexInfoIndex> cornerList;//3 corners per triangle (polygons are fan-triangulated)
+		std::vector<N_LoadOBJ_FaceGroup> groupList;
+		std::vector<uint8_t> relativeIndexFlagList;//(chunk) per corner, bit 0/1/2 for relative v/vt/vn index. empty if none
+		std::string lastMatName;//(chunk) the last 'usemtl' of the chunk
+		bool isMatNameAssigned;//(chunk) any 'usemtl' in the chunk
+		std::string errorMessage;//(chunk) errors are reported after worker threads join
+	};
+
 	class IFileIO_OBJ
 	{
 	public:
 
 		bool ImportFile_OBJ(NFilePath pFilePath, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer);
 
+		//with subsets of 'o'/'g'/'usemtl' (empty matName if no 'usemtl' is given).
+		//big file is split into chunks on line boundaries and parsed by 'threadCount' threads (0 for hardware concurrency),
+		//result doesn't depend on thread count
+		bool ImportFile_OBJ(NFilePath pFilePath, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<N_MeshSubsetInfo>& outSubsetList, uint32_t threadCount = 0);
+
+		//throughput of last successful ImportFile_OBJ
+		const N_MeshImportReport& GetLastImportReport_OBJ() const;
+
+		//files smaller than this are parsed by one thread
+		static const size_t c_parallelParseMinFileSize_OBJ = 4 * 1024 * 1024;
+
 	private:
 
+		//parse a chunk of file content in one pass (no copy of text, no iostream). never throws (safe in worker threads)
+		bool mFunction_ParseOBJ(const char* pBegin, const char* pEnd, N_LoadOBJ_ParsedData& outData);
+
+		//concatenate chunks: fix up relative indices, join groups across chunk boundaries and validate indices
+		bool mFunction_MergeChunks(std::vector<N_LoadOBJ_ParsedData>& chunkList, N_LoadOBJ_ParsedData& outData, uint32_t threadCount);
+
+		//unique (v,vt,vn) corners become vertices (hash map dedup, in order of first occurrence),
+		//normals of corners without 'vn' are computed from faces
+		bool mFunction_BuildVertexAndIndexBuffer(const N_LoadOBJ_ParsedData& data, std::vector<N_DefaultVertex>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, uint32_t threadCount);
+
+		N_MeshImportReport mLastImportReport_OBJ;
 	};
 
 
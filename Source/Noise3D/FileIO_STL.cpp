@@ -9,44 +9,53 @@
 
 using namespace Noise3D;
 
-/*******************************************************************
-
-									INTERFACE
-
-*********************************************************************/
-bool IFileIO_STL::ImportFile_STL(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string & refFileInfo)
+namespace Noise3D
 {
-	std::ifstream tmpFile(pFilePath, std::ios::binary);
-
-	if (!tmpFile.good())
+	//a vector of STL file (x, y, z) to engine space (x, z, y)
+	static inline Vec3 ReadSTLVec3(const char* p)
 	{
-		ERROR_MSG("Load STL : file Open Failed!!");
-		return false;
+		float v[3];
+		memcpy(v, p, sizeof(v));
+		return Vec3(v[0], v[2], v[1]);
 	}
 
-	//move file cursor to the end
-	tmpFile.seekg(0, std::ios::end);
-	std::streamoff static_fileSize = tmpFile.tellg();
-	if (static_fileSize < 84L)
+	//weld corners of exactly the same position, vertices are in order of first occurrence
+	template <typename getCorner_t>
+	static void WeldSTLCorners(uint32_t cornerCount, const getCorner_t& getCorner, uint32_t threadCount, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer)
 	{
-		ERROR_MSG("Load STL : file Damaged!!File Size is Too Small!!");
-		return false;
+		//a vertex is shared by ~6 triangles in closed meshes
+		std::vector<uint32_t> firstCornerList;
+		Ut::ParallelDedup<Ut::N_PositionKey>(cornerCount,
+			[&getCorner](uint32_t i) {return Ut::MakePositionKey(getCorner(i)); },
+			[](const Ut::N_PositionKey& key) {return Ut::HashPositionKey(key); },
+			cornerCount / 4, threadCount, outIndexBuffer, firstCornerList);
+
+		outVertexBuffer.resize(firstCornerList.size());
+		Ut::ParallelFor(uint32_t(firstCornerList.size()), threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; ++i)outVertexBuffer[i] = getCorner(firstCornerList[i]);
+		});
 	}
-	tmpFile.seekg(0);
+}
 
-	char firstChar;
-	tmpFile.read(&firstChar, 1);
-	tmpFile.close();
+/*******************************************************************
 
-	//ASCII STL starts with "solid"
-	if (firstChar == 's')
-	{
-		return mFunction_ImportFile_STL_Ascii(pFilePath, refVertexBuffer, refIndexBuffer, refNormalBuffer, refFileInfo);
-	}
-	else
-	{
-		return mFunction_ImportFile_STL_Binary(pFilePath, refVertexBuffer, refIndexBuffer, refNormalBuffer, refFileInfo);
-	}
+									INTERFACE
+
+*********************************************************************/
+bool IFileIO_STL::ImportFile_STL(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string & refFileInfo, uint32_t threadCount)
+{
+	return mFunction_ImportFile_STL(pFilePath, refVertexBuffer, refIndexBuffer, refNormalBuffer, refFileInfo, false, threadCount);
+}
+
+bool IFileIO_STL::ImportFile_STL_Indexed(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string & refFileInfo, uint32_t threadCount)
+{
+	return mFunction_ImportFile_STL(pFilePath, refVertexBuffer, refIndexBuffer, refNormalBuffer, refFileInfo, true, threadCount);
+}
+
+const N_MeshImportReport & IFileIO_STL::GetLastImportReport_STL() const
+{
+	return mLastImportReport_STL;
 }
 
 bool IFileIO_STL::ExportFile_STL_Binary(NFilePath filePath, const std::string & headerInfo, const std::vector<Vec3>& inVertexBuffer, const std::vector<UINT>& inIndexBuffer)
@@ -225,17 +234,82 @@ bool IFileIO_STL::ExportFile_STL_Binary(NFilePath filePath, const std::string &
 								LOCAL FUNCTION
 
 *********************************************************************/
-bool IFileIO_STL::mFunction_ImportFile_STL_Binary(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer,
-	std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string& refFileInfo)
+bool IFileIO_STL::mFunction_ImportFile_STL(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string & refFileInfo, bool isWeldVertices, uint32_t threadCount)
 {
-	std::ifstream fileIn(pFilePath, std::ios::binary);
+	auto timeBegin = std::chrono::steady_clock::now();
 
-	if (!fileIn.good())
+	MemoryMappedFile file;
+	if (!file.Open(pFilePath))
 	{
-		ERROR_MSG("Load STL Binary : Open File Failed!");
+		ERROR_MSG("Load STL : file Open Failed!!");
+		return false;
+	}
+
+	const char* pData = file.GetData();
+	uint64_t fileSize = file.GetSize();
+	if (fileSize < 84)
+	{
+		file.Close();
+		ERROR_MSG("Load STL : file Damaged!!File Size is Too Small!!");
 		return false;
 	}
 
+	mLastImportReport_STL = N_MeshImportReport();
+	mLastImportReport_STL.fileSize = fileSize;
+	threadCount = Ut::ResolveThreadCount(threadCount);
+	if (fileSize < c_parallelParseMinFileSize_STL)threadCount = 1;
+	mLastImportReport_STL.threadCount = threadCount;
+
+	//ASCII STL starts with "solid", but some binary files also write "solid" in the header,
+	//so the size of binary records is checked first (and text never contains NUL, which
+	//catches damaged binary files with a "solid" header)
+	uint32_t binaryTriangleCount = 0;
+	memcpy(&binaryTriangleCount, pData + 80, sizeof(uint32_t));
+	bool isBinary = (fileSize == 84 + 50 * uint64_t(binaryTriangleCount)) || (strncmp(pData, "solid", 5) != 0)
+		|| (memchr(pData, 0, size_t(std::min<uint64_t>(fileSize, 1024))) != nullptr);
+
+	bool isSucceeded = false;
+	if (isBinary)
+	{
+		isSucceeded = mFunction_ImportFile_STL_Binary(pData, fileSize, refVertexBuffer, refIndexBuffer, refNormalBuffer, refFileInfo, isWeldVertices, threadCount);
+	}
+	else
+	{
+		isSucceeded = mFunction_ImportFile_STL_Ascii(pData, pData + fileSize, refVertexBuffer, refNormalBuffer, refFileInfo, threadCount);
+		file.Close();
+
+		//(vertex count could be illegal in damaged file)
+		auto timeMerge = std::chrono::steady_clock::now();
+		uint32_t cornerCount = uint32_t(refVertexBuffer.size() / 3 * 3);
+		if (isSucceeded && isWeldVertices)
+		{
+			std::vector<Vec3> cornerList;
+			cornerList.swap(refVertexBuffer);
+			WeldSTLCorners(cornerCount, [&cornerList](uint32_t i) {return cornerList[i]; }, threadCount, refVertexBuffer, refIndexBuffer);
+		}
+		else if (isSucceeded)
+		{
+			refVertexBuffer.resize(cornerCount);
+			refIndexBuffer.resize(cornerCount);
+			Ut::ParallelFor(cornerCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)refIndexBuffer[i] = i;
+			});
+		}
+		mLastImportReport_STL.mergeTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeMerge).count();
+	}
+	file.Close();
+	if (!isSucceeded)return false;
+
+	mLastImportReport_STL.triangleCount = refIndexBuffer.size() / 3;
+	mLastImportReport_STL.vertexCount = refVertexBuffer.size();
+	mLastImportReport_STL.totalTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeBegin).count();
+	return true;
+}
+
+bool IFileIO_STL::mFunction_ImportFile_STL_Binary(const char* pData, uint64_t fileSize, std::vector<Vec3>& refVertexBuffer,
+	std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string& refFileInfo, bool isWeldVertices, uint32_t threadCount)
+{
 	/*STL: Baidu encyclopedia
 
 	binary STL use fixed length of bit patterns to store vertex information,
@@ -252,165 +326,177 @@ bool IFileIO_STL::mFunction_ImportFile_STL_Binary(NFilePath pFilePath, std::vect
 
 	the length of a complete STL will be 50 *(triangleCount) + 84  */
 
+	//header could be not null-terminated
+	refFileInfo.assign(pData, std::find(pData, pData + 80, '\0'));
 
-	//newly input string
-	char headerInfo[81] = {};
-	fileIn.read(headerInfo, 80);
-
-	//the first char could not be "s" in BINARY mode , in order to distinguish form ASCII mode,
-	//which starts with "solid"
-	if (headerInfo[0] == 's')
+	uint32_t triangleCount = 0;
+	memcpy(&triangleCount, pData + 80, sizeof(uint32_t));
+	if (84 + 50 * uint64_t(triangleCount) > fileSize || uint64_t(triangleCount) * 3 >= uint64_t(UINT_MAX))
 	{
-		ERROR_MSG("Load STL Binary : File Damaged!! It's not binary STL file!");
+		ERROR_MSG("Load STL Binary : Triangle Count doesn't match file size or Data was damamged!!");
 		return false;
 	}
 
-	refFileInfo = headerInfo;
-	//move reading cursor
-	fileIn.seekg(80);
-
-	//read bit patterns, and reinterpret the data to interested type
-	//using decltype()
-#define REINTERPRET_READ(var) fileIn.read((char*)&var,sizeof(var));
-
-	uint32_t triangleCount = 0;
-	REINTERPRET_READ(triangleCount);
-
-	if (triangleCount > 10000000)
+	//records are not 4-byte aligned (50 bytes), vectors are copied out of the mapped file.
+	//clockwise or counterClockwise : vertex 2 and 3 are swapped
+	const char* pRecords = pData + 84;
+	const uint32_t c_recordSize = 50;
+	auto GetCorner = [pRecords, c_recordSize](uint32_t corner)->Vec3
 	{
-		ERROR_MSG("Load STL Binary : Triangle Count is larger than 10000000 or Data was damamged!!");
-		fileIn.close();
-		return false;
+		static const uint32_t c_vertexOffset[3] = { 12, 36, 24 };
+		return ReadSTLVec3(pRecords + size_t(corner / 3) * c_recordSize + c_vertexOffset[corner % 3]);
+	};
+
+	auto timeParse = std::chrono::steady_clock::now();
+	uint32_t cornerCount = triangleCount * 3;
+	refNormalBuffer.resize(triangleCount);
+	if (!isWeldVertices)
+	{
+		//without optimization, vertices can be overlapped
+		refVertexBuffer.resize(cornerCount);
+		refIndexBuffer.resize(cornerCount);
 	}
-
-	//then reserve spaces for vectors (optimization)
-	refVertexBuffer.reserve(triangleCount * 3);
-	refNormalBuffer.reserve(triangleCount);
-	refIndexBuffer.reserve(triangleCount * 3);
-
-	while (!fileIn.eof())
+	Ut::ParallelFor(triangleCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
 	{
-
-		//a facet normal
-		Vec3 tmpVec3(0, 0, 0);
-		REINTERPRET_READ(tmpVec3.x);
-		REINTERPRET_READ(tmpVec3.z);
-		REINTERPRET_READ(tmpVec3.y);
-		refNormalBuffer.push_back(tmpVec3);
-
-		//3 vertices
-		for (UINT i = 0;i < 3;i++)
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
 		{
-			REINTERPRET_READ(tmpVec3.x);
-			REINTERPRET_READ(tmpVec3.z);
-			REINTERPRET_READ(tmpVec3.y);
-			refVertexBuffer.push_back(tmpVec3);
+			refNormalBuffer[i] = ReadSTLVec3(pRecords + size_t(i) * c_recordSize);
+			if (isWeldVertices)continue;
+			for (uint32_t j = 3 * i; j < 3 * i + 3; ++j)
+			{
+				refVertexBuffer[j] = GetCorner(j);
+				refIndexBuffer[j] = j;
+			}
 		}
+	});
+	mLastImportReport_STL.parseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeParse).count();
 
-		uint16_t faceAttr = 0;
-		REINTERPRET_READ(faceAttr);
-	}
-
-	//clockwise or counterClockwise (?)
-	for (UINT i = 0;i < refVertexBuffer.size();i += 3)
-	{
-		std::swap(refVertexBuffer[i + 1], refVertexBuffer[i + 2]);
-	}
-
-	//without optimization, vertices can be overlapped
-	refIndexBuffer.resize(refVertexBuffer.size());
-	for (UINT i = 0;i < refIndexBuffer.size();i++)
+	//corners are welded directly from the mapped records
+	if (isWeldVertices)
 	{
-		refIndexBuffer.at(i) = i;
+		auto timeMerge = std::chrono::steady_clock::now();
+		WeldSTLCorners(cornerCount, GetCorner, threadCount, refVertexBuffer, refIndexBuffer);
+		mLastImportReport_STL.mergeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeMerge).count();
 	}
 
-
-	fileIn.close();
-
 	return true;
 }
 
-bool IFileIO_STL::mFunction_ImportFile_STL_Ascii(NFilePath pFilePath, std::vector<Vec3>& refVertexBuffer, std::vector<UINT>& refIndexBuffer, std::vector<Vec3>& refNormalBuffer, std::string& refFileInfo)
+bool IFileIO_STL::mFunction_ImportFile_STL_Ascii(const char* pBegin, const char* pEnd, std::vector<Vec3>& refVertexBuffer, std::vector<Vec3>& refNormalBuffer, std::string& refFileInfo, uint32_t threadCount)
 {
-	std::ifstream fileIn(pFilePath);
-
-	if (!fileIn.good())
+	//the first line is "solid" + object name (the name could be null)
+	const char* p = pBegin;
+	Ut::TextSkipSpaces(p, pEnd);
+	if (!Ut::TextMatchKeyword(p, pEnd, "solid", 5))
 	{
-		ERROR_MSG("Load STL Ascii : Open File Failed!!");
+		ERROR_MSG("Load STL Ascii : file damaged!!");
+		return false;
+	}
+	Ut::TextSkipSpaces(p, pEnd);
+	refFileInfo = Ut::TextGetRestOfLine(p, pEnd);
+	Ut::TextSkipLine(p, pEnd);
+
+	//chunks on line boundaries, parsed concurrently
+	std::vector<const char*> boundaryList;
+	Ut::TextSplitLines(p, pEnd, threadCount, boundaryList);
+	uint32_t chunkCount = uint32_t(boundaryList.size() - 1);
+	std::vector<std::vector<Vec3>> chunkVertexList(chunkCount);
+	std::vector<std::vector<Vec3>> chunkNormalList(chunkCount);
+
+	auto timeParse = std::chrono::steady_clock::now();
+	Ut::ParallelFor(chunkCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+			mFunction_ParseSTL_AsciiChunk(boundaryList[i], boundaryList[i + 1], chunkVertexList[i], chunkNormalList[i]);
+	});
+	auto timeMerge = std::chrono::steady_clock::now();
+
+	//offsets of each chunk (a facet can be split by chunk boundary, lists are just concatenated)
+	std::vector<size_t> vertexOffset(chunkCount + 1, 0);
+	std::vector<size_t> normalOffset(chunkCount + 1, 0);
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		vertexOffset[i + 1] = vertexOffset[i] + chunkVertexList[i].size();
+		normalOffset[i + 1] = normalOffset[i] + chunkNormalList[i].size();
+	}
+	if (vertexOffset[chunkCount] >= size_t(UINT_MAX))
+	{
+		ERROR_MSG("Load STL Ascii : too many vertices!");
 		return false;
 	}
 
-	//newly input string
-	std::string currString;
-
-	//object Name
-	std::string objectName;
-
-	//the first line (object name) need to be dealt with specially
-	fileIn >> currString;
-
-	//the beginning of the 
-	if (currString == "solid")
+	if (chunkCount == 1)
 	{
-		//the name of the object could be null, thus input the first line instead of
-		//input next string will be safer
-		char pFirstLineString[80] = {};
-		fileIn.getline(pFirstLineString, 80);
-		objectName = pFirstLineString;
-
-		//delete the space at the front
-		if (objectName.size()> 0)objectName.erase(objectName.begin());
+		refVertexBuffer.swap(chunkVertexList[0]);
+		refNormalBuffer.swap(chunkNormalList[0]);
 	}
 	else
 	{
-		ERROR_MSG("Load STL Ascii : file damaged!!");
-		return false;
+		refVertexBuffer.resize(vertexOffset[chunkCount]);
+		refNormalBuffer.resize(normalOffset[chunkCount]);
+		Ut::ParallelFor(chunkCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+			{
+				std::copy(chunkVertexList[i].begin(), chunkVertexList[i].end(), refVertexBuffer.begin() + vertexOffset[i]);
+				std::copy(chunkNormalList[i].begin(), chunkNormalList[i].end(), refNormalBuffer.begin() + normalOffset[i]);
+			}
+		});
 	}
 
-	refFileInfo = objectName;
+	//clockwise or counterClockwise
+	uint32_t triangleCount = uint32_t(refVertexBuffer.size() / 3);
+	Ut::ParallelFor(triangleCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)std::swap(refVertexBuffer[3 * i + 1], refVertexBuffer[3 * i + 2]);
+	});
+
+	mLastImportReport_STL.parseTime = std::chrono::duration<double, std::milli>(timeMerge - timeParse).count();
+	mLastImportReport_STL.mergeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeMerge).count();
+	return true;
+}
 
+void IFileIO_STL::mFunction_ParseSTL_AsciiChunk(const char * pBegin, const char * pEnd, std::vector<Vec3>& outVertexBuffer, std::vector<Vec3>& outNormalBuffer)
+{
+	//rough reservation (~40 bytes per line, 7 lines per facet)
+	size_t estimatedFacetCount = size_t(pEnd - pBegin) / 280;
+	outVertexBuffer.reserve(estimatedFacetCount * 3);
+	outNormalBuffer.reserve(estimatedFacetCount);
 
-	//loop reading
-	while (!fileIn.eof())
+	//axis y and z are swapped
+	auto ParseVec3 = [&pEnd](const char*& p, Vec3& outVec)
 	{
-		fileIn >> currString;
+		Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, outVec.x);
+		Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, outVec.z);
+		Ut::TextSkipSpaces(p, pEnd);	Ut::TextParseFloat(p, pEnd, outVec.y);
+	};
 
-		if (currString == "endsolid")break;
+	const char* p = pBegin;
+	while (p < pEnd)
+	{
+		Ut::TextSkipSpaces(p, pEnd);
+		if (p >= pEnd)break;
 
-		//"facet normal" + x+y+z
-		if (currString == "normal")
+		//"facet normal" + x+y+z : face normal (may be used as vertex normal)
+		if (Ut::TextMatchKeyword(p, pEnd, "facet", 5))
 		{
-			Vec3 tmpFaceNormal(0, 0, 0);
-			fileIn >> tmpFaceNormal.x >> tmpFaceNormal.z >> tmpFaceNormal.y;
-			//face normal (may be used as vertex normal)
-			refNormalBuffer.push_back(tmpFaceNormal);
+			Ut::TextSkipSpaces(p, pEnd);
+			if (Ut::TextMatchKeyword(p, pEnd, "normal", 6))
+			{
+				Vec3 tmpFaceNormal(0, 0, 0);
+				ParseVec3(p, tmpFaceNormal);
+				outNormalBuffer.push_back(tmpFaceNormal);
+			}
 		}
-
 		//"vertex" +x +y+z
-		if (currString == "vertex")
+		else if (Ut::TextMatchKeyword(p, pEnd, "vertex", 6))
 		{
 			Vec3 tmpPoint(0, 0, 0);
-			fileIn >> tmpPoint.x >> tmpPoint.z >> tmpPoint.y;
-			refVertexBuffer.push_back(tmpPoint);
+			ParseVec3(p, tmpPoint);
+			outVertexBuffer.push_back(tmpPoint);
 		}
-	}
 
-	//clockwise or counterClockwise
-	for (UINT i = 0;i < refVertexBuffer.size();i += 3)
-	{
-		std::swap(refVertexBuffer[i + 1], refVertexBuffer[i + 2]);
+		//"outer loop", "endloop", "endfacet", "endsolid"
+		Ut::TextSkipLine(p, pEnd);
 	}
-
-
-	fileIn.close();
-
-	//without optimization, vertices can be overlapped
-	refIndexBuffer.resize(refVertexBuffer.size());
-	for (UINT i = 0;i < refIndexBuffer.size();i++)
-	{
-		refIndexBuffer.at(i) = i;
-	}
-
-	return true;
 }
-
@@ -12,17 +12,39 @@ namespace Noise3D
 	{
 	public:
 
-		bool ImportFile_STL(NFilePath filePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string & outFileInfo);
+		//triangle soup (3 vertices per facet), outNormalBuffer is per facet.
+		//big ASCII file is split into chunks on line boundaries and parsed by 'threadCount' threads (0 for hardware concurrency),
+		//binary records are read in place from the mapped file
+		bool ImportFile_STL(NFilePath filePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string & outFileInfo, uint32_t threadCount = 0);
+
+		//indexed mesh, vertices of exactly the same position are welded (in parallel, result doesn't depend on thread count).
+		//outNormalBuffer is still per facet
+		bool ImportFile_STL_Indexed(NFilePath filePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string & outFileInfo, uint32_t threadCount = 0);
 	
 		bool ExportFile_STL_Binary(NFilePath filePath, const std::string& headerInfo,const std::vector<Vec3>& inVertexBuffer,const std::vector<UINT>& inIndexBuffer);
 
 		bool ExportFile_STL_Binary(NFilePath filePath, const std::string& headerInfo,const std::vector<Vec3>& inVertexBuffer);
 
+		//throughput of last successful ImportFile_STL
+		const N_MeshImportReport& GetLastImportReport_STL() const;
+
+		//files smaller than this are parsed (and welded) by one thread
+		static const size_t c_parallelParseMinFileSize_STL = 4 * 1024 * 1024;
+
 	private:
 
-		bool mFunction_ImportFile_STL_Binary(NFilePath pFilePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string& outFileInfo);
+		bool mFunction_ImportFile_STL(NFilePath filePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string& outFileInfo, bool isWeldVertices, uint32_t threadCount);
+
+		//80 bytes header, uint32 triangle count, and 50-byte records (normal, 3 vertices, uint16 attribute) viewed in place
+		bool mFunction_ImportFile_STL_Binary(const char* pData, uint64_t fileSize, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string& outFileInfo, bool isWeldVertices, uint32_t threadCount);
+
+		//triangle soup of "facet normal"/"vertex" lines
+		bool mFunction_ImportFile_STL_Ascii(const char* pBegin, const char* pEnd, std::vector<Vec3>& outVertexBuffer, std::vector<Vec3>& outNormalBuffer, std::string& outFileInfo, uint32_t threadCount);
+
+		//"facet normal" and "vertex" lines of a chunk, in file order. never throws (safe in worker threads)
+		void mFunction_ParseSTL_AsciiChunk(const char* pBegin, const char* pEnd, std::vector<Vec3>& outVertexBuffer, std::vector<Vec3>& outNormalBuffer);
 
-		bool mFunction_ImportFile_STL_Ascii(NFilePath pFilePath, std::vector<Vec3>& outVertexBuffer, std::vector<UINT>& outIndexBuffer, std::vector<Vec3>& outNormalBuffer, std::string& outFileInfo);
+		N_MeshImportReport mLastImportReport_STL;
 
 	};
 
@@ -25,7 +25,8 @@ template<typename vertex_t, typename index_t>
 Noise3D::GeometryEntity<vertex_t, index_t>::GeometryEntity() :
 	mIsLocalAabbInitialized(false),
 	m_pVB_Gpu(nullptr),
-	m_pIB_Gpu(nullptr)
+	m_pIB_Gpu(nullptr),
+	mGeometryVersion(0)
 {
 
 }
@@ -70,6 +71,12 @@ const std::vector<index_t>* Noise3D::GeometryEntity<vertex_t, index_t>::GetIndex
 	return &mIB_Mem;
 }
 
+template<typename vertex_t, typename index_t>
+uint32_t Noise3D::GeometryEntity<vertex_t, index_t>::GetGeometryVersion() const
+{
+	return mGeometryVersion;
+}
+
 template <typename vertex_t, typename index_t>
 bool NOISE_MACRO_FUNCTION_EXTERN_CALL Noise3D::GeometryEntity<typename vertex_t, typename index_t>::mFunction_CreateGpuBufferAndUpdateData(const std::vector<vertex_t>& targetVB, const std::vector<index_t>& targetIB)
 {
@@ -80,6 +87,8 @@ bool NOISE_MACRO_FUNCTION_EXTERN_CALL Noise3D::GeometryEntity<typename vertex_t,
 	//this function could be externally invoked by MeshLoader..etc
 	mVB_Mem = targetVB;
 	mIB_Mem = targetIB;
+	mIsLocalAabbInitialized = false;
+	++mGeometryVersion;
 
 	//Prepare to update to video memory, fill in SUBRESOURCE description structure
 	D3D11_SUBRESOURCE_DATA tmpInitData_Vertex;
@@ -128,6 +137,10 @@ bool NOISE_MACRO_FUNCTION_EXTERN_CALL Noise3D::GeometryEntity<vertex_t, index_t>
 	ReleaseCOM(m_pVB_Gpu);
 	ReleaseCOM(m_pIB_Gpu);
 
+	//data in sys mem might have been directly modified (e.g. by ModelProcessor)
+	mIsLocalAabbInitialized = false;
+	++mGeometryVersion;
+
 	//Prepare to update to video memory, fill in SUBRESOURCE description structure
 	D3D11_SUBRESOURCE_DATA tmpInitData_Vertex;
 	ZeroMemory(&tmpInitData_Vertex, sizeof(tmpInitData_Vertex));
@@ -38,6 +38,9 @@ namespace Noise3D
 
 		const	std::vector<index_t>*		GetIndexBuffer() const;
 
+		//increased every time vertex/index data is updated (used to detect out-of-date acceleration structures)
+		uint32_t	GetGeometryVersion() const;
+
 
 		//compute bounding box without applying a world transformation to vertices(local space)
 		virtual N_AABB GetLocalAABB() override;
@@ -61,6 +64,7 @@ namespace Noise3D
 		std::vector<index_t>	 mIB_Mem;//index in CPU memory
 		bool						mIsLocalAabbInitialized;
 		N_AABB				mLocalBoundingBox;//local AABB is calculated only once(and is the minimum AABB)
+		uint32_t			mGeometryVersion;
 	};
 
 };
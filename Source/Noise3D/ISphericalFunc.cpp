@@ -40,15 +40,13 @@ Color4f Noise3D::GI::Texture2dSampler_Spherical::Eval(const Vec3 & dir)
 		float normalizedU = (yaw / (2.0f * Ut::PI)) + 0.5f;
 		float normalizedV = (-pitch / Ut::PI) + 0.5f;
 
-		Color4u c = m_pTex->SamplePixelBilinear(Vec2(normalizedU, normalizedV));
-		result = { float(c.r) / 255.0f,float(c.g) / 255.0f,float(c.b) / 255.0f,float(c.a) / 255.0f };
+		result = m_pTex->SamplePixelBilinear(Vec2(normalizedU, normalizedV));
 	}
 	else
 	{
 		uint32_t pixelX = 0, pixelY = 0;
 		Ut::DirectionToPixelCoord_SphericalMapping(dir, m_pTex->GetWidth(), m_pTex->GetHeight(), pixelX, pixelY);
-		Color4u c = m_pTex->GetPixel(pixelX, pixelY);
-		result = { float(c.r) / 255.0f,float(c.g) / 255.0f,float(c.b) / 255.0f,float(c.a) / 255.0f };
+		result = m_pTex->GetPixelFloat(pixelX, pixelY);
 	}
 	return result;
 };
@@ -62,9 +60,7 @@ void Noise3D::GI::CubeMapSampler::SetTexturePtr(TextureCubeMap * pTex)
 
 Color4f Noise3D::GI::CubeMapSampler::Eval(const Vec3 & dir)
 {
-	Color4u c = m_pTex->GetPixel(dir,TextureCubeMap::N_TEXTURE_CPU_SAMPLE_MODE::BILINEAR);
-	Color4f result = { float(c.r) / 255.0f,float(c.g) / 255.0f,float(c.b) / 255.0f,float(c.a) / 255.0f };
-	return result;
+	return m_pTex->SamplePixel(dir,TextureCubeMap::N_TEXTURE_CPU_SAMPLE_MODE::BILINEAR);
 }
 
 //**************************Texture2D Sampler*************************
@@ -83,7 +79,5 @@ Color4f Noise3D::GI::Texture2dSamplerForSHProjection::Eval(const Vec3 & dir)
 	uint32_t pixelX = 0, pixelY = 0;
 	Vec3 correctedDir = Vec3(dir.x, -dir.y, dir.z);
 	Ut::DirectionToPixelCoord_SphericalMapping(correctedDir, m_pTex->GetWidth(), m_pTex->GetHeight(), pixelX, pixelY);
-	Color4u c = m_pTex->GetPixel(pixelX, pixelY);
-	Color4f result = { float(c.r) / 255.0f,float(c.g) / 255.0f,float(c.b) / 255.0f,float(c.a) / 255.0f };
-	return result;
+	return m_pTex->GetPixelFloat(pixelX, pixelY);
 }
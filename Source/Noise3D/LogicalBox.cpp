@@ -68,6 +68,7 @@ Vec2 Noise3D::LogicalBox::ComputeUV(NOISE_BOX_FACET facet, Vec3 pos)
 void Noise3D::LogicalBox::SetSizeXYZ(Vec3 size)
 {
 	mSize = Vec3(abs(size.x), abs(size.y), abs(size.z));
+	++mGeometryVersion;
 }
 
 inline N_AABB Noise3D::LogicalBox::GetLocalBox()const
@@ -23,6 +23,7 @@ Noise3D::LogicalRect::~LogicalRect()
 void Noise3D::LogicalRect::SetOrientation(NOISE_RECT_ORIENTATION ori)
 {
 	mOrientation = ori;
+	++mGeometryVersion;
 }
 
 NOISE_RECT_ORIENTATION Noise3D::LogicalRect::GetOrientation() const
@@ -89,6 +90,7 @@ void Noise3D::LogicalRect::SetSize(float width, float height)
 	{
 		mSize.x = width;
 		mSize.y = height;
+		++mGeometryVersion;
 	}
 }
 
@@ -97,6 +99,7 @@ void Noise3D::LogicalRect::SetSize(Vec2 size)
 	if (size.x != 0 && size.y != 0)
 	{
 		mSize = size;
+		++mGeometryVersion;
 	}
 }
 
@@ -18,7 +18,7 @@ namespace Noise3D
 	{
 	public:
 
-		ILogicalShape(){};
+		ILogicalShape():mGeometryVersion(0){};
 
 		virtual ~ILogicalShape() { };
 
@@ -34,8 +34,13 @@ namespace Noise3D
 		//Compute Area for the shape(might be useful for area lighting)
 		virtual float ComputeArea() =0 ;
 
+		//incremented whenever size/orientation changes (e.g. scene BVH re-bounds the shape in Refit())
+		uint32_t GetGeometryVersion() const { return mGeometryVersion; }
+
 	protected:
 
+		uint32_t mGeometryVersion;
+
 		friend IFactory<ILogicalShape>;
 
 	};
@@ -29,6 +29,7 @@ Vec2 Noise3D::LogicalSphere::ComputeUV(Vec3 pos)
 void Noise3D::LogicalSphere::SetRadius(float r)
 {
 	mRadius = r > 0.0f ? r : 1.0f;
+	++mGeometryVersion;
 }
 
 float Noise3D::LogicalSphere::GetRadius()const
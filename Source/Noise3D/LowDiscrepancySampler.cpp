@@ -0,0 +1,300 @@
+/***********************************************************************
+
+								Low Discrepancy Sampler
+
+************************************************************************/
+
+#include "Noise3D.h"
+#include "Noise3D_InDevHeader.h"
+
+using namespace Noise3D;
+
+//[0,1) float from 32 bits (24 significant bits are kept)
+static inline float UIntToCanonicalReal(uint32_t x)
+{
+	return float(x >> 8) * (1.0f / 16777216.0f);
+}
+
+/*****************************************
+
+						RANDOM
+
+*****************************************/
+
+void Noise3D::GI::Sampler_Random::GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const
+{
+	//a point is a hash of its index (doesn't depend on how samples are split into calls)
+	uint64_t pixelSeed = RandomSampleGenerator::ComputeSeed(seed, (uint64_t(pixelY) << 32) | pixelX);
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		uint64_t bits = RandomSampleGenerator::ComputeSeed(pixelSeed, dimension, sampleIndex + i);
+		outList.push_back(Vec2(UIntToCanonicalReal(uint32_t(bits)), UIntToCanonicalReal(uint32_t(bits >> 32))));
+	}
+}
+
+/*****************************************
+
+						SOBOL
+
+*****************************************/
+
+void Noise3D::GI::Sampler_Sobol::GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const
+{
+	//Burley20, shuffled_scrambled_sobol2d()
+	uint64_t pixelSeed = RandomSampleGenerator::ComputeSeed(seed, (uint64_t(pixelY) << 32) | pixelX);
+	uint64_t dimSeed = RandomSampleGenerator::ComputeSeed(pixelSeed, dimension);
+	uint32_t shuffleSeed = uint32_t(dimSeed);
+	uint32_t scrambleSeedX = uint32_t(dimSeed >> 32);
+	uint32_t scrambleSeedY = uint32_t(RandomSampleGenerator::ComputeSeed(dimSeed, 1));
+
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		//Owen-scrambled index is a shuffle of the sequence (keeps net property of the first 2^m points)
+		uint32_t index = mFunc_NestedUniformScramble(sampleIndex + i, shuffleSeed);
+		uint32_t x = mFunc_ReverseBits(index);//dimension 0: van der Corput
+		uint32_t y = mFunc_SobolDimension1(index);
+		x = mFunc_NestedUniformScramble(x, scrambleSeedX);
+		y = mFunc_NestedUniformScramble(y, scrambleSeedY);
+		outList.push_back(Vec2(UIntToCanonicalReal(x), UIntToCanonicalReal(y)));
+	}
+}
+
+inline uint32_t Noise3D::GI::Sampler_Sobol::mFunc_ReverseBits(uint32_t x)
+{
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+	x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+	return (x >> 16) | (x << 16);
+}
+
+inline uint32_t Noise3D::GI::Sampler_Sobol::mFunc_NestedUniformScramble(uint32_t x, uint32_t seed)
+{
+	//hash-based Owen scrambling: a Laine-Karras style permutation on reversed bits
+	//(higher bits only affect lower bits after reversing back)
+	x = mFunc_ReverseBits(x);
+	x += seed;
+	x ^= x * 0x6c50b47cu;
+	x ^= x * 0xb82f1e52u;
+	x ^= x * 0xc7afe638u;
+	x ^= x * 0x8d22f6e6u;
+	return mFunc_ReverseBits(x);
+}
+
+inline uint32_t Noise3D::GI::Sampler_Sobol::mFunc_SobolDimension1(uint32_t index)
+{
+	//primitive polynomial x+1, direction numbers v_k = v_(k-1) ^ (v_(k-1) >> 1)
+	uint32_t result = 0;
+	for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1)
+	{
+		if (index & 1u)result ^= v;
+	}
+	return result;
+}
+
+/*****************************************
+
+						HALTON
+
+*****************************************/
+
+static const uint32_t c_haltonPrimeTable[Noise3D::GI::Sampler_Halton::c_maxDimension] =
+{
+	2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+	59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+	137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+	227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+};
+
+void Noise3D::GI::Sampler_Halton::GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const
+{
+	uint64_t pixelSeed = RandomSampleGenerator::ComputeSeed(seed, (uint64_t(pixelY) << 32) | pixelX);
+	uint32_t baseX = c_haltonPrimeTable[dimension % c_maxDimension];
+	uint32_t baseY = c_haltonPrimeTable[(dimension + 1) % c_maxDimension];
+	uint64_t scrambleSeedX = RandomSampleGenerator::ComputeSeed(pixelSeed, dimension);
+	uint64_t scrambleSeedY = RandomSampleGenerator::ComputeSeed(pixelSeed, dimension + 1);
+
+	//random shift of each digit, shared by all points of the sequence
+	uint32_t digitCountX = mFunc_ComputeDigitCount(baseX);
+	uint32_t digitCountY = mFunc_ComputeDigitCount(baseY);
+	uint32_t digitShiftListX[c_maxDigitCount];
+	uint32_t digitShiftListY[c_maxDigitCount];
+	for (uint32_t d = 0; d < digitCountX; ++d)digitShiftListX[d] = uint32_t(RandomSampleGenerator::ComputeSeed(scrambleSeedX, d) % baseX);
+	for (uint32_t d = 0; d < digitCountY; ++d)digitShiftListY[d] = uint32_t(RandomSampleGenerator::ComputeSeed(scrambleSeedY, d) % baseY);
+
+	for (uint32_t i = 0; i < sampleCount; ++i)
+	{
+		float x = mFunc_ScrambledRadicalInverse(sampleIndex + i, baseX, digitCountX, digitShiftListX);
+		float y = mFunc_ScrambledRadicalInverse(sampleIndex + i, baseY, digitCountY, digitShiftListY);
+		outList.push_back(Vec2(x, y));
+	}
+}
+
+uint32_t Noise3D::GI::Sampler_Halton::mFunc_ComputeDigitCount(uint32_t base)
+{
+	uint32_t digitCount = 0;
+	for (uint64_t b = 1; b < (1ULL << 24) && digitCount < c_maxDigitCount; b *= base)++digitCount;
+	return digitCount;
+}
+
+float Noise3D::GI::Sampler_Halton::mFunc_ScrambledRadicalInverse(uint32_t index, uint32_t base, uint32_t digitCount, const uint32_t* digitShiftList)
+{
+	//mirror digits of index around radix point, each digit (including the trailing 0s)
+	//is shifted by a random amount in mod 'base'
+	const float invBase = 1.0f / float(base);
+	float factor = invBase;
+	float result = 0.0f;
+	for (uint32_t digitId = 0; digitId < digitCount; ++digitId)
+	{
+		uint32_t digit = index % base;
+		index /= base;
+		result += float((digit + digitShiftList[digitId]) % base) * factor;
+		factor *= invBase;
+	}
+	return std::min<float>(result, 1.0f - std::numeric_limits<float>::epsilon() * 0.5f);
+}
+
+/*****************************************
+
+					BLUE NOISE DITHER
+
+*****************************************/
+
+Noise3D::GI::Sampler_BlueNoiseDither::Sampler_BlueNoiseDither()
+{
+	mFunction_GenerateVoidAndClusterMask();
+}
+
+void Noise3D::GI::Sampler_BlueNoiseDither::GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const
+{
+	//the point set must be the same for all pixels (only the shift differs),
+	//so the Owen scramble only depends on frame seed and dimension
+	Sampler_Sobol sobol;
+	size_t firstId = outList.size();
+	sobol.GenerateSamples2D(0, 0, seed, dimension, sampleIndex, sampleCount, outList);
+
+	//2 decorrelated mask lookups per dimension, tile offsets along R2 sequence (and frame seed)
+	uint64_t frameSeed = RandomSampleGenerator::ComputeSeed(seed, 0);
+	const float c_r2_a1 = 0.7548776662f;
+	const float c_r2_a2 = 0.5698402910f;
+	auto tileOffset = [&](uint32_t i, float a, uint32_t shift)->uint32_t
+	{
+		float t = float(i) * a;
+		return uint32_t((t - std::floor(t)) * float(c_maskSize)) + uint32_t(frameSeed >> shift);
+	};
+	uint32_t dx1 = tileOffset(2 * dimension + 1, c_r2_a1, 0);
+	uint32_t dy1 = tileOffset(2 * dimension + 1, c_r2_a2, 8);
+	uint32_t dx2 = tileOffset(2 * dimension + 2, c_r2_a1, 16);
+	uint32_t dy2 = tileOffset(2 * dimension + 2, c_r2_a2, 24);
+	float shiftX = GetMaskValue(pixelX + dx1, pixelY + dy1);
+	float shiftY = GetMaskValue(pixelX + dx2, pixelY + dy2);
+
+	//Cranley-Patterson rotation
+	for (size_t i = firstId; i < outList.size(); ++i)
+	{
+		float x = outList[i].x + shiftX;
+		float y = outList[i].y + shiftY;
+		if (x >= 1.0f)x -= 1.0f;
+		if (y >= 1.0f)y -= 1.0f;
+		outList[i] = Vec2(x, y);
+	}
+}
+
+float Noise3D::GI::Sampler_BlueNoiseDither::GetMaskValue(uint32_t x, uint32_t y) const
+{
+	return mMask[(y % c_maskSize) * c_maskSize + (x % c_maskSize)];
+}
+
+void Noise3D::GI::Sampler_BlueNoiseDither::mFunction_GenerateVoidAndClusterMask()
+{
+	const uint32_t N = c_maskSize;
+	const uint32_t totalCount = N * N;
+	const float c_sigma = 1.9f;
+
+	//gaussian energy filter on torus, indexed by (dy * N + dx)
+	std::vector<float> filter(totalCount);
+	for (uint32_t dy = 0; dy < N; ++dy)
+	{
+		for (uint32_t dx = 0; dx < N; ++dx)
+		{
+			float tx = float(std::min<uint32_t>(dx, N - dx));
+			float ty = float(std::min<uint32_t>(dy, N - dy));
+			filter[dy * N + dx] = std::exp(-(tx * tx + ty * ty) / (2.0f * c_sigma * c_sigma));
+		}
+	}
+
+	std::vector<char> pattern(totalCount, 0);
+	std::vector<float> energy(totalCount, 0.0f);
+	auto splat = [&](std::vector<char>& pat, std::vector<float>& e, uint32_t id, bool isAdding)
+	{
+		uint32_t px = id % N, py = id / N;
+		float sign = isAdding ? 1.0f : -1.0f;
+		pat[id] = isAdding ? 1 : 0;
+		for (uint32_t y = 0; y < N; ++y)
+		{
+			const float* filterRow = &filter[((y + N - py) % N) * N];
+			float* energyRow = &e[y * N];
+			for (uint32_t x = 0; x < N; ++x)energyRow[x] += sign * filterRow[(x + N - px) % N];
+		}
+	};
+	//tightest cluster: the '1' with max energy. largest void: the '0' with min energy
+	auto findExtreme = [&](const std::vector<char>& pat, const std::vector<float>& e, char value)->uint32_t
+	{
+		uint32_t bestId = 0;
+		float bestEnergy = value ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+		for (uint32_t i = 0; i < totalCount; ++i)
+		{
+			if (pat[i] != value)continue;
+			if (value ? (e[i] > bestEnergy) : (e[i] < bestEnergy))
+			{
+				bestEnergy = e[i];
+				bestId = i;
+			}
+		}
+		return bestId;
+	};
+
+	//1. initial binary pattern(random 10% minority pixels), then relax it by
+	//moving the tightest cluster to the largest void until they coincide
+	Pcg32RandomEngine engine;
+	uint32_t initialCount = totalCount / 10;
+	for (uint32_t placed = 0; placed < initialCount;)
+	{
+		uint32_t id = engine.NextUInt() % totalCount;
+		if (pattern[id])continue;
+		splat(pattern, energy, id, true);
+		++placed;
+	}
+	for (uint32_t iter = 0; iter < totalCount; ++iter)
+	{
+		uint32_t clusterId = findExtreme(pattern, energy, 1);
+		splat(pattern, energy, clusterId, false);
+		uint32_t voidId = findExtreme(pattern, energy, 0);
+		splat(pattern, energy, voidId, true);
+		if (voidId == clusterId)break;
+	}
+
+	//2. rank initial points by removing tightest clusters one by one
+	std::vector<uint32_t> rank(totalCount, 0);
+	{
+		std::vector<char> tmpPattern = pattern;
+		std::vector<float> tmpEnergy = energy;
+		for (uint32_t r = initialCount; r > 0; --r)
+		{
+			uint32_t clusterId = findExtreme(tmpPattern, tmpEnergy, 1);
+			splat(tmpPattern, tmpEnergy, clusterId, false);
+			rank[clusterId] = r - 1;
+		}
+	}
+
+	//3. rank the rest by filling the largest void one by one
+	for (uint32_t r = initialCount; r < totalCount; ++r)
+	{
+		uint32_t voidId = findExtreme(pattern, energy, 0);
+		splat(pattern, energy, voidId, true);
+		rank[voidId] = r;
+	}
+
+	mMask.resize(totalCount);
+	for (uint32_t i = 0; i < totalCount; ++i)mMask[i] = (float(rank[i]) + 0.5f) / float(totalCount);
+}
@@ -0,0 +1,106 @@
+
+/***********************************************************************
+
+								h: Low Discrepancy Sampler
+		desc: pluggable 2D point set generators used by the batch sampling
+		functions of RandomSampleGenerator (hemisphere, cone, GGX...).
+		a point is decided by (pixel, seed, dimension, sample index), so samplers
+		are stateless and can be shared by all path tracer worker threads.
+		reference:
+		Brent Burley, Practical Hash-based Owen Scrambling(2020)
+		Georgiev & Fajardo, Blue-noise Dithered Sampling(2016)
+		Robert Ulichney, The void-and-cluster method for dither array generation(1993)
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	namespace GI
+	{
+		//interface of samplers.
+		//each call of the batch sampling functions consumes a new 'dimension'(pair) of current pixel.
+		//'seed' is shared by all pixels and samples of a render, samplers decorrelate pixels themselves.
+		//successive samples of a pixel are successive indices of the same sequence
+		class ISampler
+		{
+		public:
+
+			virtual ~ISampler() {}
+
+			//generate points [sampleIndex, sampleIndex + sampleCount) in [0,1)^2 of given dimension
+			virtual void GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const = 0;
+		};
+
+		//independent uniform random points (the reference of convergence)
+		class Sampler_Random :public ISampler
+		{
+		public:
+
+			virtual void GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const override;
+		};
+
+		//first 2 dimensions of Sobol sequence, Owen-scrambled and shuffled with hash(seed, dimension).
+		//each dimension pair is a (0,2)-sequence, different dimensions are decorrelated by the hash.
+		//(best when sample count of a pixel is power of 2)
+		class Sampler_Sobol :public ISampler
+		{
+		public:
+
+			virtual void GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const override;
+
+		private:
+
+			static uint32_t mFunc_ReverseBits(uint32_t x);
+
+			static uint32_t mFunc_NestedUniformScramble(uint32_t x, uint32_t seed);
+
+			static uint32_t mFunc_SobolDimension1(uint32_t index);
+		};
+
+		//Halton sequence with prime bases of (dimension, dimension+1), randomized by
+		//per-digit random shift (hash(seed, dimension, digit))
+		class Sampler_Halton :public ISampler
+		{
+		public:
+
+			virtual void GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const override;
+
+			//bases are reused (cyclically) beyond this dimension
+			static const uint32_t c_maxDimension = 64;
+
+		private:
+
+			//digit count needed to reach float precision(24 bits) in given base
+			static uint32_t mFunc_ComputeDigitCount(uint32_t base);
+
+			static float mFunc_ScrambledRadicalInverse(uint32_t index, uint32_t base, uint32_t digitCount, const uint32_t* digitShiftList);
+
+			static const uint32_t c_maxDigitCount = 24;
+		};
+
+		//a low discrepancy point set(Sobol) toroidally shifted by a tiled blue noise mask value of the pixel,
+		//so error of neighbouring pixels is negatively correlated(looks like high frequency noise)
+		class Sampler_BlueNoiseDither :public ISampler
+		{
+		public:
+
+			//blue noise mask is generated with void-and-cluster method here (once)
+			Sampler_BlueNoiseDither();
+
+			virtual void GenerateSamples2D(uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t dimension, uint32_t sampleIndex, uint32_t sampleCount, std::vector<Vec2>& outList) const override;
+
+			//value in [0,1) of the mask tile at (x,y)
+			float GetMaskValue(uint32_t x, uint32_t y) const;
+
+			static const uint32_t c_maskSize = 64;
+
+		private:
+
+			void mFunction_GenerateVoidAndClusterMask();
+
+			std::vector<float> mMask;//c_maskSize * c_maskSize
+		};
+	}
+}
@@ -18,7 +18,8 @@ Noise3D::NOISE_SCENE_OBJECT_TYPE Noise3D::Mesh::GetObjectType()const
 }
 
 Mesh::Mesh():
-	mIsBvhTreeBuilt(false)
+	mIsBvhTreeBuilt(false),
+	mBvhTreeGeometryVersion(0)
 {
 	Mesh::SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
 };
@@ -166,10 +167,16 @@ bool Noise3D::Mesh::IsBvhTreeBuilt()
 	return mIsBvhTreeBuilt;
 }
 
+bool Noise3D::Mesh::IsBvhTreeUpToDate()
+{
+	return mIsBvhTreeBuilt && mBvhTreeGeometryVersion == GeometryEntity::GetGeometryVersion();
+}
+
 void Noise3D::Mesh::RebuildBvhTree()
 {
 	mBvhTreeLocalSpace.Construct(this);
 	mIsBvhTreeBuilt = true;
+	mBvhTreeGeometryVersion = GeometryEntity::GetGeometryVersion();
 }
 
 BvhTreeForTriangularMesh & Noise3D::Mesh::GetBvhTree()
@@ -73,6 +73,9 @@ namespace Noise3D
 		//is bvh tree manually built (but up-to-date bvh tree is not guaranteed)
 		bool IsBvhTreeBuilt();
 
+		//is bvh tree built from current vertex/index data (not rebuilt since geometry changed)
+		bool IsBvhTreeUpToDate();
+
 		//build bvh tree for triangles
 		void RebuildBvhTree();
 
@@ -102,5 +105,7 @@ namespace Noise3D
 
 		bool mIsBvhTreeBuilt;
 
+		uint32_t mBvhTreeGeometryVersion;//geometry version when bvh tree was built
+
 	};
 };
\ No newline at end of file
@@ -11,7 +11,15 @@
 
 using namespace Noise3D;
 
-MeshLoader::MeshLoader()
+//loading options in the key of mesh cache (caches of different loaders/options are never mixed)
+static const uint32_t c_meshCacheFlag_OBJ = 0x100;
+static const uint32_t c_meshCacheFlag_STL = 0x200;
+static const uint32_t c_meshCacheFlag_STL_WeldVertices = 0x1;
+static const uint32_t c_meshCacheFlag_STL_GenerateTexcoord = 0x2;
+static const uint32_t c_meshCacheFlag_FBX = 0x400;//(material names of subsets are the same for lambert/pbrt loading)
+
+MeshLoader::MeshLoader():
+	mIsMeshCacheEnabled(false)
 {
 
 };
@@ -118,6 +126,16 @@ bool MeshLoader::LoadCustomizedModel(Mesh * const pTargetMesh, const std::vector
 
 bool MeshLoader::LoadFile_STL(Mesh * const pTargetMesh, NFilePath pFilePath)
 {
+	return LoadFile_STL(pTargetMesh, pFilePath, N_LoadSTLDesc());
+}
+
+bool MeshLoader::LoadFile_STL(Mesh * const pTargetMesh, NFilePath pFilePath, const N_LoadSTLDesc& desc)
+{
+	uint32_t cacheFlags = c_meshCacheFlag_STL |
+		(desc.isWeldVertices ? c_meshCacheFlag_STL_WeldVertices : 0) |
+		(desc.isGenerateTexcoord ? c_meshCacheFlag_STL_GenerateTexcoord : 0);
+	if (mIsMeshCacheEnabled && mFunction_LoadMeshCache(pTargetMesh, pFilePath, cacheFlags))return true;
+
 	std::vector<UINT>			tmpIndexList;
 	std::vector<Vec3> tmpVertexList;
 	std::vector<Vec3> tmpNormalList;
@@ -125,20 +143,52 @@ bool MeshLoader::LoadFile_STL(Mesh * const pTargetMesh, NFilePath pFilePath)
 
 	//Load STL using file manager
 	bool fileLoadSucceeded = false;
-	fileLoadSucceeded = mFileIO.ImportFile_STL(pFilePath, tmpVertexList, tmpIndexList, tmpNormalList, tmpInfo);
+	if (desc.isWeldVertices)
+		fileLoadSucceeded = mFileIO.ImportFile_STL_Indexed(pFilePath, tmpVertexList, tmpIndexList, tmpNormalList, tmpInfo, desc.threadCount);
+	else
+		fileLoadSucceeded = mFileIO.ImportFile_STL(pFilePath, tmpVertexList, tmpIndexList, tmpNormalList, tmpInfo, desc.threadCount);
 	if (!fileLoadSucceeded)
 	{
 		ERROR_MSG("IMesh : Load STL failed ! Cannot open file!");
 		return false;
 	}
+	DEBUG_MSG(mFileIO.GetLastImportReport_STL().ToString().c_str());
+
+	uint32_t threadCount = Ut::ResolveThreadCount(desc.threadCount);
+	uint32_t vertexCount = uint32_t(tmpVertexList.size());
+	uint32_t triangleCount = uint32_t(tmpIndexList.size() / 3);
+	if (vertexCount < 65536)threadCount = 1;
 
-	//compute the center pos of bounding box
-	Vec3 aabbCenter;
-	for (int i = 0; i < tmpVertexList.size(); ++i)
+	//vertex normals: facet normal of the file for triangle soup,
+	//sum of area-weighted face normals for shared vertices (welded)
+	std::vector<Vec3> vertexNormalList(vertexCount, Vec3(0, 0, 0));
+	if (desc.isWeldVertices)
+	{
+		std::vector<Vec3> faceNormalList(triangleCount);
+		Ut::ParallelFor(triangleCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			mFunction_ComputeFaceNormals(tmpVertexList, tmpIndexList, chunkBegin, chunkEnd, faceNormalList);
+		});
+		for (uint32_t i = 0; i < triangleCount; ++i)
+		{
+			for (uint32_t c = 0; c < 3; ++c)vertexNormalList[tmpIndexList[3 * i + c]] += faceNormalList[i];
+		}
+	}
+	else
 	{
-		aabbCenter = aabbCenter * (float(i) / (i + 1.0f)) + tmpVertexList.at(i) * (1.0f/(i + 1.0f));
+		for (uint32_t i = 0; i < vertexCount; ++i)vertexNormalList[i] = tmpNormalList.at(i / 3);
 	}
 
+	//center of bounding box (for texcoord)
+	std::vector<N_AABB> chunkAabbList(threadCount);
+	uint32_t chunkCount = Ut::ParallelFor(vertexCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		chunkAabbList[chunkId] = mFunction_ComputeAABB(tmpVertexList.data() + chunkBegin, chunkEnd - chunkBegin);
+	});
+	N_AABB aabb;
+	for (uint32_t i = 0; i < chunkCount; ++i)aabb.Union(chunkAabbList[i]);
+	Vec3 aabbCenter = aabb.IsValid() ? (aabb.min + aabb.max) * 0.5f : Vec3(0, 0, 0);
+
 	//lambda function : compute texcoord for spherical mapping
 	auto ComputeTexCoord_SphericalWrap= [](Vec3 vBoxCenter, Vec3 vPoint)->Vec2
 	{
@@ -168,63 +218,121 @@ bool MeshLoader::LoadFile_STL(Mesh * const pTargetMesh, NFilePath pFilePath)
 		return outTexCoord;
 	};
 
-	UINT normal_index = 0;
-	std::vector<N_DefaultVertex>  completeVertexList;
+	std::vector<N_DefaultVertex>  completeVertexList(vertexCount);
 	//fill vertex attribute
-	for (UINT i = 0;i < tmpVertexList.size();i++)
+	Ut::ParallelFor(vertexCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
 	{
-		N_DefaultVertex	tmpCompleteV;
-		tmpCompleteV.Color = Vec4(1.0f, 1.0f, 1.0f, 1.0f);
-		tmpCompleteV.Pos = tmpVertexList.at(i);
-		tmpCompleteV.Normal = tmpNormalList.at(normal_index);
-		//tangent
-		if (tmpCompleteV.Normal.x==0.0f && tmpCompleteV.Normal.z==0.0f)
-		{
-			tmpCompleteV.Tangent = Vec3(1.0f, 0, 0);
-		}
-		else
+		for (UINT i = chunkBegin; i < chunkEnd; i++)
 		{
-			Vec3 tmpVec(-tmpCompleteV.Normal.z, 0, tmpCompleteV.Normal.x);
-			tmpCompleteV.Tangent = tmpCompleteV.Normal.Cross(tmpVec);
-			//D3DXVec3Cross(&tmpCompleteV.Tangent, &tmpCompleteV.Normal, &tmpVec);
-			tmpCompleteV.Tangent.Normalize();
-			//D3DXVec3Normalize(&tmpCompleteV.Tangent, &tmpCompleteV.Tangent);
+			N_DefaultVertex	tmpCompleteV;
+			tmpCompleteV.Color = Vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			tmpCompleteV.Pos = tmpVertexList[i];
+			tmpCompleteV.Normal = vertexNormalList[i];
+			if (desc.isWeldVertices)tmpCompleteV.Normal.Normalize();
+			//tangent
+			if (tmpCompleteV.Normal.x == 0.0f && tmpCompleteV.Normal.z == 0.0f)
+			{
+				tmpCompleteV.Tangent = Vec3(1.0f, 0, 0);
+			}
+			else
+			{
+				Vec3 tmpVec(-tmpCompleteV.Normal.z, 0, tmpCompleteV.Normal.x);
+				tmpCompleteV.Tangent = tmpCompleteV.Normal.Cross(tmpVec);
+				tmpCompleteV.Tangent.Normalize();
+			}
+			tmpCompleteV.TexCoord = desc.isGenerateTexcoord ? ComputeTexCoord_SphericalWrap(aabbCenter, tmpCompleteV.Pos) : Vec2(0, 0);
+			completeVertexList[i] = tmpCompleteV;
 		}
-		tmpCompleteV.TexCoord = ComputeTexCoord_SphericalWrap(aabbCenter, tmpCompleteV.Pos);
-		completeVertexList.push_back(tmpCompleteV);
-
-		//one normal vector for 3 vertices (1 triangle)
-		if (i % 3 == 2) { normal_index++; }
-	}
+	});
 
 
 	bool isUpdateOk = pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(completeVertexList, tmpIndexList);
 	pTargetMesh->SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
 
+	if (isUpdateOk && mIsMeshCacheEnabled)mFunction_SaveMeshCache(pTargetMesh, pFilePath, cacheFlags, std::vector<N_MeshSubsetInfo>());
+
 	return isUpdateOk;
 }
 
 bool MeshLoader::LoadFile_OBJ(Mesh * const pTargetMesh, NFilePath filePath)
 {
+	if (mIsMeshCacheEnabled && mFunction_LoadMeshCache(pTargetMesh, filePath, c_meshCacheFlag_OBJ))return true;
+
 	std::vector<N_DefaultVertex> tmpCompleteVertexList;
 	std::vector<UINT>	tmpIndexList;
+	std::vector<N_MeshSubsetInfo> tmpSubsetList;
 
 	//STL
 	bool fileLoadSucceeded = false;
-	fileLoadSucceeded = mFileIO.ImportFile_OBJ(filePath, tmpCompleteVertexList, tmpIndexList);
+	fileLoadSucceeded = mFileIO.ImportFile_OBJ(filePath, tmpCompleteVertexList, tmpIndexList, tmpSubsetList);
 	if (!fileLoadSucceeded)
 	{
 		ERROR_MSG("IMesh : Load OBJ failed! Cannot open file. ");
 		return false;
 	}
+	DEBUG_MSG(mFileIO.GetLastImportReport_OBJ().ToString().c_str());
 
 	//copy won't be overhead because std::move is used inside the function
 	bool isUpdateOk = pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(tmpCompleteVertexList, tmpIndexList);
 	pTargetMesh->SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
 
+	//material names are cached as they are in the file (the fallback below depends on current materials)
+	if (isUpdateOk && mIsMeshCacheEnabled)mFunction_SaveMeshCache(pTargetMesh, filePath, c_meshCacheFlag_OBJ, tmpSubsetList);
+
+	//'o'/'g'/'usemtl' groups become subsets. (.mtl is not loaded, so materials that
+	//haven't been created by user fall back to default material)
+	if (isUpdateOk && !tmpSubsetList.empty())
+	{
+		MaterialManager* pMatMgr = Noise3D::GetScene()->GetMaterialMgr();
+		for (auto& subset : tmpSubsetList)
+		{
+			if (subset.matName.empty() || !pMatMgr->FindUid<LambertMaterial>(subset.matName))
+				subset.matName = NOISE_MACRO_DEFAULT_MATERIAL_NAME;
+		}
+		pTargetMesh->SetSubsetList(tmpSubsetList);
+	}
+
 	return isUpdateOk;
 }
 
+bool MeshLoader::LoadFile_N3DMESH(Mesh * const pTargetMesh, NFilePath filePath)
+{
+	std::vector<N_DefaultVertex> tmpVertexList;
+	std::vector<UINT> tmpIndexList;
+	std::vector<N_MeshSubsetInfo> tmpSubsetList;
+	std::vector<N_BvhLinearNode> tmpBvhNodeList;
+	std::vector<uint32_t> tmpBvhTriangleIdList;
+	N_AABB localAabb;
+	N_N3DMeshSourceKey sourceKey;
+
+	if (!mFileIO.ImportFile_N3DMESH(filePath, tmpVertexList, tmpIndexList, tmpSubsetList, localAabb, tmpBvhNodeList, tmpBvhTriangleIdList, sourceKey))
+	{
+		ERROR_MSG("IMesh : Load N3DMESH failed! Cannot open file. ");
+		return false;
+	}
+
+	return mFunction_LoadMeshData(pTargetMesh, tmpVertexList, tmpIndexList, tmpSubsetList, localAabb, tmpBvhNodeList, tmpBvhTriangleIdList);
+}
+
+bool MeshLoader::SaveFile_N3DMESH(Mesh * const pSourceMesh, NFilePath filePath)
+{
+	if (pSourceMesh == nullptr)return false;
+
+	std::vector<N_MeshSubsetInfo> subsetList;
+	pSourceMesh->GetSubsetList(subsetList);
+	return mFunction_SaveMeshData(pSourceMesh, filePath, subsetList, N_N3DMeshSourceKey(), true);
+}
+
+void MeshLoader::SetMeshCacheEnabled(bool isEnabled)
+{
+	mIsMeshCacheEnabled = isEnabled;
+}
+
+bool MeshLoader::IsMeshCacheEnabled() const
+{
+	return mIsMeshCacheEnabled;
+}
+
 void MeshLoader::LoadFile_FBX(NFilePath filePath, N_SceneLoadingResult & outLoadingResult)
 {
 	//if fbx loader has already been initialized,
@@ -232,8 +340,13 @@ void MeshLoader::LoadFile_FBX(NFilePath filePath, N_SceneLoadingResult & outLoad
 	N_FbxLoadingResult fbxResult;
 	mFbxLoader.Initialize();
 
+	//meshes with an up-to-date cache skip geometry extraction
+	N_FbxMeshCacheContext cacheContext;
+	mFunction_BeginFbxMeshCache(filePath, cacheContext);
+	auto skipMeshGeometryFunc = [this, &cacheContext](const N_UID& meshName) {return mFunction_LoadFbxMeshCache(cacheContext, meshName); };
+
 	//some scene nodes are not supported(2017.9.20)
-	mFbxLoader.LoadSceneFromFbx(filePath, fbxResult, true, false);
+	mFbxLoader.LoadSceneFromFbx(filePath, fbxResult, true, false, skipMeshGeometryFunc);
 
 	//create mesh object in Noise3D with the data loaded from fbx
 	SceneManager* pScene = Noise3D::GetScene();
@@ -258,7 +371,7 @@ void MeshLoader::LoadFile_FBX(NFilePath filePath, N_SceneLoadingResult & outLoad
 		}
 
 		//update data to graphic memory
-		bool isUpdateSuccessful = pMesh->mFunction_CreateGpuBufferAndUpdateData(m.vertexBuffer, m.indexBuffer);
+		bool isUpdateSuccessful = mFunction_LoadFbxMeshGeometry(pMesh, m, cacheContext);
 		if (!isUpdateSuccessful) 
 		{
 			WARNING_MSG("Model Loader: Load FBX scene: Mesh failed to load: mesh name:" 
@@ -332,6 +445,9 @@ void MeshLoader::LoadFile_FBX(NFilePath filePath, N_SceneLoadingResult & outLoad
 		{
 			pMesh->SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
 		}
+
+		//4. geometry/subsets/BVH extracted from FBX are cached for next loading
+		if (!m.isGeometrySkipped)mFunction_SaveFbxMeshCache(pMesh, m, cacheContext);
 	}
 }
 
@@ -342,8 +458,13 @@ void Noise3D::MeshLoader::LoadFile_FBX_PbrtMaterial(NFilePath filePath, N_SceneL
 	N_FbxPbrtSceneLoadingResult fbxResult;
 	mFbxLoader.Initialize();
 
+	//meshes with an up-to-date cache skip geometry extraction
+	N_FbxMeshCacheContext cacheContext;
+	mFunction_BeginFbxMeshCache(filePath, cacheContext);
+	auto skipMeshGeometryFunc = [this, &cacheContext](const N_UID& meshName) {return mFunction_LoadFbxMeshCache(cacheContext, meshName); };
+
 	//some scene nodes are not supported(2017.9.20)
-	mFbxLoader.LoadPbrtMeshesFromFbx(filePath, fbxResult);
+	mFbxLoader.LoadPbrtMeshesFromFbx(filePath, fbxResult, skipMeshGeometryFunc);
 
 	//create mesh object in Noise3D with the data loaded from fbx
 	SceneManager*	pScene = Noise3D::GetScene();
@@ -368,7 +489,7 @@ void Noise3D::MeshLoader::LoadFile_FBX_PbrtMaterial(NFilePath filePath, N_SceneL
 		}
 
 		//update data to graphic memory
-		bool isUpdateSuccessful = pMesh->mFunction_CreateGpuBufferAndUpdateData(m.vertexBuffer, m.indexBuffer);
+		bool isUpdateSuccessful = mFunction_LoadFbxMeshGeometry(pMesh, m, cacheContext);
 		if (!isUpdateSuccessful)
 		{
 			WARNING_MSG("Model Loader: Load FBX scene: Mesh failed to load: mesh name:"
@@ -450,6 +571,9 @@ void Noise3D::MeshLoader::LoadFile_FBX_PbrtMaterial(NFilePath filePath, N_SceneL
 		}
 
 		pMesh->SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
+
+		//4. geometry/subsets/BVH extracted from FBX are cached for next loading
+		if (!m.isGeometrySkipped)mFunction_SaveFbxMeshCache(pMesh, m, cacheContext);
 	}
 }
 
@@ -735,3 +859,265 @@ Texture2D * Noise3D::MeshLoader::_FbxLoadTexture(TextureManager* pTexMgr, std::s
 
 	return true;
 }*/
+
+N_AABB MeshLoader::mFunction_ComputeAABB(const Vec3 * pPointList, uint32_t count)
+{
+	using namespace SIMD;
+	N_AABB outAabb;
+	if (count == 0)return outAabb;
+
+	//points are tightly packed floats, 3 registers cover NOISE_SIMD_WIDTH points,
+	//and lane j of register r always holds component (r * width + j) % 3
+	const float* pFloatList = &pPointList[0].x;
+	const float c_inf = std::numeric_limits<float>::infinity();
+	simd_float minList[3] = { SimdSet1(c_inf), SimdSet1(c_inf), SimdSet1(c_inf) };
+	simd_float maxList[3] = { SimdSet1(-c_inf), SimdSet1(-c_inf), SimdSet1(-c_inf) };
+	uint32_t blockCount = count / NOISE_SIMD_WIDTH;
+	for (uint32_t i = 0; i < blockCount; ++i)
+	{
+		const float* p = pFloatList + size_t(i) * 3 * NOISE_SIMD_WIDTH;
+		for (uint32_t r = 0; r < 3; ++r)
+		{
+			simd_float v = SimdLoadUnaligned(p + r * NOISE_SIMD_WIDTH);
+			minList[r] = SimdMin(minList[r], v);
+			maxList[r] = SimdMax(maxList[r], v);
+		}
+	}
+
+	float minComponent[3] = { c_inf, c_inf, c_inf };
+	float maxComponent[3] = { -c_inf, -c_inf, -c_inf };
+	alignas(32) float lanes[NOISE_SIMD_WIDTH];
+	for (uint32_t r = 0; r < 3; ++r)
+	{
+		SimdStore(lanes, minList[r]);
+		for (uint32_t j = 0; j < NOISE_SIMD_WIDTH; ++j)
+			minComponent[(r * NOISE_SIMD_WIDTH + j) % 3] = std::min<float>(minComponent[(r * NOISE_SIMD_WIDTH + j) % 3], lanes[j]);
+		SimdStore(lanes, maxList[r]);
+		for (uint32_t j = 0; j < NOISE_SIMD_WIDTH; ++j)
+			maxComponent[(r * NOISE_SIMD_WIDTH + j) % 3] = std::max<float>(maxComponent[(r * NOISE_SIMD_WIDTH + j) % 3], lanes[j]);
+	}
+
+	//the rest points
+	for (uint32_t i = blockCount * NOISE_SIMD_WIDTH; i < count; ++i)
+	{
+		const float* p = pFloatList + size_t(i) * 3;
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			minComponent[c] = std::min<float>(minComponent[c], p[c]);
+			maxComponent[c] = std::max<float>(maxComponent[c], p[c]);
+		}
+	}
+
+	outAabb.min = Vec3(minComponent[0], minComponent[1], minComponent[2]);
+	outAabb.max = Vec3(maxComponent[0], maxComponent[1], maxComponent[2]);
+	return outAabb;
+}
+
+void MeshLoader::mFunction_ComputeFaceNormals(const std::vector<Vec3>& vertexList, const std::vector<UINT>& indexList, uint32_t triangleBegin, uint32_t triangleEnd, std::vector<Vec3>& outFaceNormalList)
+{
+	using namespace SIMD;
+
+	//NOISE_SIMD_WIDTH triangles are gathered into SoA edge vectors, and cross products are computed lane-wise
+	alignas(32) float edge[6][NOISE_SIMD_WIDTH];//e1.xyz, e2.xyz
+	alignas(32) float normal[3][NOISE_SIMD_WIDTH];
+	uint32_t i = triangleBegin;
+	for (; i + NOISE_SIMD_WIDTH <= triangleEnd; i += NOISE_SIMD_WIDTH)
+	{
+		for (uint32_t j = 0; j < NOISE_SIMD_WIDTH; ++j)
+		{
+			const Vec3& v0 = vertexList[indexList[3 * (i + j)]];
+			const Vec3& v1 = vertexList[indexList[3 * (i + j) + 1]];
+			const Vec3& v2 = vertexList[indexList[3 * (i + j) + 2]];
+			edge[0][j] = v1.x - v0.x;	edge[1][j] = v1.y - v0.y;	edge[2][j] = v1.z - v0.z;
+			edge[3][j] = v2.x - v0.x;	edge[4][j] = v2.y - v0.y;	edge[5][j] = v2.z - v0.z;
+		}
+		simd_float e1x = SimdLoad(edge[0]), e1y = SimdLoad(edge[1]), e1z = SimdLoad(edge[2]);
+		simd_float e2x = SimdLoad(edge[3]), e2y = SimdLoad(edge[4]), e2z = SimdLoad(edge[5]);
+		SimdStore(normal[0], SimdSub(SimdMul(e1y, e2z), SimdMul(e1z, e2y)));
+		SimdStore(normal[1], SimdSub(SimdMul(e1z, e2x), SimdMul(e1x, e2z)));
+		SimdStore(normal[2], SimdSub(SimdMul(e1x, e2y), SimdMul(e1y, e2x)));
+		for (uint32_t j = 0; j < NOISE_SIMD_WIDTH; ++j)outFaceNormalList[i + j] = Vec3(normal[0][j], normal[1][j], normal[2][j]);
+	}
+
+	//the rest triangles
+	for (; i < triangleEnd; ++i)
+	{
+		const Vec3& v0 = vertexList[indexList[3 * i]];
+		const Vec3& v1 = vertexList[indexList[3 * i + 1]];
+		const Vec3& v2 = vertexList[indexList[3 * i + 2]];
+		outFaceNormalList[i] = (v1 - v0).Cross(v2 - v0);
+	}
+}
+
+bool MeshLoader::mFunction_LoadMeshData(Mesh * const pTargetMesh, std::vector<N_DefaultVertex>& vertexList, std::vector<UINT>& indexList,
+	std::vector<N_MeshSubsetInfo>& subsetList, const N_AABB & localAabb, const std::vector<N_BvhLinearNode>& bvhNodeList, const std::vector<uint32_t>& bvhTriangleIdList)
+{
+	bool isUpdateOk = mFunction_LoadMeshGeometry(pTargetMesh, vertexList, indexList, localAabb, bvhNodeList, bvhTriangleIdList);
+	pTargetMesh->SetMaterial(NOISE_MACRO_DEFAULT_MATERIAL_NAME);
+	if (!isUpdateOk)return false;
+
+	//the same material fallback as LoadFile_OBJ
+	if (!subsetList.empty())
+	{
+		MaterialManager* pMatMgr = Noise3D::GetScene()->GetMaterialMgr();
+		for (auto& subset : subsetList)
+		{
+			if (subset.matName.empty() || !pMatMgr->FindUid<LambertMaterial>(subset.matName))
+				subset.matName = NOISE_MACRO_DEFAULT_MATERIAL_NAME;
+		}
+		pTargetMesh->SetSubsetList(subsetList);
+	}
+
+	return true;
+}
+
+bool MeshLoader::mFunction_LoadMeshGeometry(Mesh * const pTargetMesh, std::vector<N_DefaultVertex>& vertexList, std::vector<UINT>& indexList,
+	const N_AABB & localAabb, const std::vector<N_BvhLinearNode>& bvhNodeList, const std::vector<uint32_t>& bvhTriangleIdList)
+{
+	if (!pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(vertexList, indexList))return false;
+
+	//no need to scan vertices again
+	pTargetMesh->mLocalBoundingBox = localAabb;
+	pTargetMesh->mIsLocalAabbInitialized = true;
+
+	//BVH is up-to-date with the geometry just updated
+	if (!bvhNodeList.empty() && pTargetMesh->mBvhTreeLocalSpace.ConstructFromLinearNodes(pTargetMesh, bvhNodeList, bvhTriangleIdList))
+	{
+		pTargetMesh->mIsBvhTreeBuilt = true;
+		pTargetMesh->mBvhTreeGeometryVersion = pTargetMesh->GetGeometryVersion();
+	}
+
+	return true;
+}
+
+bool MeshLoader::mFunction_SaveMeshData(Mesh * const pSourceMesh, NFilePath filePath, const std::vector<N_MeshSubsetInfo>& subsetList, const N_N3DMeshSourceKey & sourceKey, bool isErrorThrown)
+{
+	if (!pSourceMesh->IsBvhTreeUpToDate())pSourceMesh->RebuildBvhTree();
+
+	const BvhTreeForTriangularMesh& bvh = pSourceMesh->GetBvhTree();
+	return mFileIO.ExportFile_N3DMESH(filePath, *pSourceMesh->GetVertexBuffer(), *pSourceMesh->GetIndexBuffer(), subsetList,
+		pSourceMesh->GetLocalAABB(), bvh.GetLinearNodeList(), bvh.GetLinearTriangleIdList(), sourceKey, isErrorThrown);
+}
+
+bool MeshLoader::mFunction_LoadMeshCache(Mesh * const pTargetMesh, NFilePath sourceFilePath, uint32_t loadFlags)
+{
+	N_N3DMeshSourceKey sourceKey;
+	bool isContentHashComputed = false;
+	if (!IFileIO::ComputeSourceKey_N3DMESH(sourceFilePath, loadFlags, false, sourceKey))return false;
+	if (!mFunction_IsMeshCacheUpToDate(sourceFilePath + ".n3dmesh", sourceFilePath, sourceKey, isContentHashComputed))return false;
+
+	//the cache can be damaged after being checked, then the source is imported as usual
+	std::vector<N_DefaultVertex> tmpVertexList;
+	std::vector<UINT> tmpIndexList;
+	std::vector<N_MeshSubsetInfo> tmpSubsetList;
+	std::vector<N_BvhLinearNode> tmpBvhNodeList;
+	std::vector<uint32_t> tmpBvhTriangleIdList;
+	N_AABB localAabb;
+	N_N3DMeshSourceKey cacheKey;
+	if (!mFileIO.ImportFile_N3DMESH(sourceFilePath + ".n3dmesh", tmpVertexList, tmpIndexList, tmpSubsetList,
+		localAabb, tmpBvhNodeList, tmpBvhTriangleIdList, cacheKey, false))return false;
+
+	DEBUG_MSG(("mesh cache loaded: " + sourceFilePath + ".n3dmesh\n").c_str());
+	return mFunction_LoadMeshData(pTargetMesh, tmpVertexList, tmpIndexList, tmpSubsetList, localAabb, tmpBvhNodeList, tmpBvhTriangleIdList);
+}
+
+void MeshLoader::mFunction_SaveMeshCache(Mesh * const pSourceMesh, NFilePath sourceFilePath, uint32_t loadFlags, const std::vector<N_MeshSubsetInfo>& subsetList)
+{
+	N_N3DMeshSourceKey sourceKey;
+	if (!IFileIO::ComputeSourceKey_N3DMESH(sourceFilePath, loadFlags, true, sourceKey))return;
+	mFunction_SaveMeshData(pSourceMesh, sourceFilePath + ".n3dmesh", subsetList, sourceKey, false);
+}
+
+bool MeshLoader::mFunction_IsMeshCacheUpToDate(NFilePath cacheFilePath, NFilePath sourceFilePath, N_N3DMeshSourceKey & sourceKey, bool & isContentHashComputed)
+{
+	N_N3DMeshSourceKey cacheKey;
+	if (!mFileIO.ReadSourceKey_N3DMESH(cacheFilePath, cacheKey))return false;
+	if (cacheKey.fileSize != sourceKey.fileSize || cacheKey.loadFlags != sourceKey.loadFlags)return false;
+
+	//same size & last write time is trusted, otherwise the content is compared (e.g. file was touched/re-checked out)
+	if (cacheKey.lastWriteTime == sourceKey.lastWriteTime)return true;
+	if (!isContentHashComputed)
+	{
+		if (!IFileIO::ComputeSourceKey_N3DMESH(sourceFilePath, sourceKey.loadFlags, true, sourceKey))return false;
+		isContentHashComputed = true;
+	}
+	if (cacheKey.contentHash != sourceKey.contentHash)return false;
+
+	//content is the same, stamp the cache with the new last write time
+	mFileIO.UpdateSourceKey_N3DMESH(cacheFilePath, sourceKey);
+	return true;
+}
+
+void MeshLoader::mFunction_BeginFbxMeshCache(NFilePath fbxFilePath, N_FbxMeshCacheContext & outContext)
+{
+	outContext.fbxFilePath = fbxFilePath;
+	outContext.isSourceKeyValid = mIsMeshCacheEnabled &&
+		IFileIO::ComputeSourceKey_N3DMESH(fbxFilePath, c_meshCacheFlag_FBX, false, outContext.sourceKey);
+	outContext.isContentHashComputed = false;
+	outContext.meshMap.clear();
+}
+
+bool MeshLoader::mFunction_LoadFbxMeshCache(N_FbxMeshCacheContext & context, const N_UID & meshName)
+{
+	if (!context.isSourceKeyValid)return false;
+	if (context.meshMap.find(meshName) != context.meshMap.end())return true;//(mesh of the same name)
+
+	NFilePath cacheFilePath = mFunction_GetFbxMeshCachePath(context.fbxFilePath, meshName);
+	if (!mFunction_IsMeshCacheUpToDate(cacheFilePath, context.fbxFilePath, context.sourceKey, context.isContentHashComputed))return false;
+
+	N_FbxMeshCacheData data;
+	N_N3DMeshSourceKey cacheKey;
+	if (!mFileIO.ImportFile_N3DMESH(cacheFilePath, data.vertexList, data.indexList, data.subsetList,
+		data.localAabb, data.bvhNodeList, data.bvhTriangleIdList, cacheKey, false))return false;
+
+	DEBUG_MSG(("mesh cache loaded: " + cacheFilePath + "\n").c_str());
+	context.meshMap[meshName] = std::move(data);
+	return true;
+}
+
+bool MeshLoader::mFunction_LoadFbxMeshGeometry(Mesh * const pTargetMesh, N_FbxMeshInfo & meshInfo, N_FbxMeshCacheContext & context)
+{
+	if (!meshInfo.isGeometrySkipped)
+	{
+		return pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(meshInfo.vertexBuffer, meshInfo.indexBuffer);
+	}
+
+	//materials of subsets are created from FBX afterwards
+	N_FbxMeshCacheData& data = context.meshMap[meshInfo.name];
+	meshInfo.subsetList = std::move(data.subsetList);
+	return mFunction_LoadMeshGeometry(pTargetMesh, data.vertexList, data.indexList, data.localAabb, data.bvhNodeList, data.bvhTriangleIdList);
+}
+
+void MeshLoader::mFunction_SaveFbxMeshCache(Mesh * const pSourceMesh, const N_FbxMeshInfo & meshInfo, N_FbxMeshCacheContext & context)
+{
+	if (!context.isSourceKeyValid)return;
+	if (!context.isContentHashComputed)
+	{
+		if (!IFileIO::ComputeSourceKey_N3DMESH(context.fbxFilePath, c_meshCacheFlag_FBX, true, context.sourceKey))return;
+		context.isContentHashComputed = true;
+	}
+	mFunction_SaveMeshData(pSourceMesh, mFunction_GetFbxMeshCachePath(context.fbxFilePath, meshInfo.name), meshInfo.subsetList, context.sourceKey, false);
+}
+
+NFilePath MeshLoader::mFunction_GetFbxMeshCachePath(NFilePath fbxFilePath, const N_UID & meshName)
+{
+	std::string fileName = meshName;
+	bool isNameChanged = false;
+	for (char& c : fileName)
+	{
+		if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-')
+		{
+			c = '_';
+			isNameChanged = true;
+		}
+	}
+
+	//(different names can't share a cache after replacement)
+	if (isNameChanged)
+	{
+		std::stringstream hashStream;
+		hashStream << std::hex << std::hash<std::string>()(meshName);
+		fileName += "_" + hashStream.str();
+	}
+	return fbxFilePath + "." + fileName + ".n3dmesh";
+}
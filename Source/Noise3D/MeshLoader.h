@@ -24,6 +24,19 @@ namespace Noise3D
 		std::vector<N_UID> materialNameList;
 	};
 
+	//options of loading STL
+	struct N_LoadSTLDesc
+	{
+		N_LoadSTLDesc() :
+			isWeldVertices(false),
+			isGenerateTexcoord(true),
+			threadCount(0) {}
+
+		bool isWeldVertices;//indexed mesh with shared vertices (smooth normals, e.g. for scans), or triangle soup with facet normals (default, keeps hard edges)
+		bool isGenerateTexcoord;//spherical mapping around AABB center, (0,0) if false (for big scans without textures)
+		uint32_t threadCount;//0 for hardware concurrency
+	};
+
 	class /*_declspec(dllexport)*/ MeshLoader
 	{
 	public:
@@ -41,8 +54,24 @@ namespace Noise3D
 
 		bool		LoadFile_STL(Mesh* const pTargetMesh, NFilePath filePath);
 
+		bool		LoadFile_STL(Mesh* const pTargetMesh, NFilePath filePath, const N_LoadSTLDesc& desc);
+
 		bool		LoadFile_OBJ(Mesh* const pTargetMesh, NFilePath filePath);
 
+		//native binary cache (vertices, indices, subsets, local AABB and flattened BVH), loaded with bulk copies from mapped file
+		bool		LoadFile_N3DMESH(Mesh* const pTargetMesh, NFilePath filePath);
+
+		//mesh's BVH is (re)built first if it isn't up-to-date
+		bool		SaveFile_N3DMESH(Mesh* const pSourceMesh, NFilePath filePath);
+
+		//if enabled, LoadFile_OBJ/LoadFile_STL use "<source file>.n3dmesh" when it matches the source file
+		//(size & last write time, or content hash) and loading options, otherwise the cache is (re)written after loading.
+		//LoadFile_FBX/LoadFile_FBX_PbrtMaterial cache geometry/subsets/BVH of each mesh in "<fbx file>.<mesh name>.n3dmesh"
+		//(nodes and materials are still created from the FBX). disabled by default
+		void		SetMeshCacheEnabled(bool isEnabled);
+
+		bool		IsMeshCacheEnabled() const;
+
 		//bool	LoadFile_3DS(NFilePath pFilePath, std::vector<Mesh*>& outMeshPtrList, std::vector<N_UID>& outMeshNameList);
 
 		//meshes are created automatically. call MeshManager.GetMesh() to retrieve pointers to mesh objects
@@ -66,10 +95,75 @@ namespace Noise3D
 
 		Texture2D* _FbxLoadTexture(TextureManager* pTexMgr, std::string texName, std::string filePath);
 
+		//geometry of an FBX mesh read from its cache while the FBX scene is traversed
+		struct N_FbxMeshCacheData
+		{
+			std::vector<N_DefaultVertex> vertexList;
+			std::vector<UINT> indexList;
+			std::vector<N_MeshSubsetInfo> subsetList;
+			N_AABB localAabb;
+			std::vector<N_BvhLinearNode> bvhNodeList;
+			std::vector<uint32_t> bvhTriangleIdList;
+		};
+
+		//mesh caches of one FBX file loading. all of them are keyed on the FBX file, which is hashed at most once
+		struct N_FbxMeshCacheContext
+		{
+			N_FbxMeshCacheContext() :isSourceKeyValid(false), isContentHashComputed(false) {}
+
+			NFilePath fbxFilePath;
+			N_N3DMeshSourceKey sourceKey;
+			bool isSourceKeyValid;//false if cache is disabled
+			bool isContentHashComputed;
+			std::unordered_map<N_UID, N_FbxMeshCacheData> meshMap;
+		};
+
+		//mesh data of N3DMESH file (or cache) to the mesh
+		bool mFunction_LoadMeshData(Mesh* const pTargetMesh, std::vector<N_DefaultVertex>& vertexList, std::vector<UINT>& indexList,
+			std::vector<N_MeshSubsetInfo>& subsetList, const N_AABB& localAabb, const std::vector<N_BvhLinearNode>& bvhNodeList, const std::vector<uint32_t>& bvhTriangleIdList);
+
+		//GPU buffer, local AABB and BVH part of mFunction_LoadMeshData (subsets/material are left to the caller)
+		bool mFunction_LoadMeshGeometry(Mesh* const pTargetMesh, std::vector<N_DefaultVertex>& vertexList, std::vector<UINT>& indexList,
+			const N_AABB& localAabb, const std::vector<N_BvhLinearNode>& bvhNodeList, const std::vector<uint32_t>& bvhTriangleIdList);
+
+		//caches are written with !isErrorThrown (a failed write only costs the next loading)
+		bool mFunction_SaveMeshData(Mesh* const pSourceMesh, NFilePath filePath, const std::vector<N_MeshSubsetInfo>& subsetList, const N_N3DMeshSourceKey& sourceKey, bool isErrorThrown);
+
+		//load the cache of given source file if it's up-to-date. a damaged cache is a warning and false is returned
+		//(the source file is imported then)
+		bool mFunction_LoadMeshCache(Mesh* const pTargetMesh, NFilePath sourceFilePath, uint32_t loadFlags);
+
+		void mFunction_SaveMeshCache(Mesh* const pSourceMesh, NFilePath sourceFilePath, uint32_t loadFlags, const std::vector<N_MeshSubsetInfo>& subsetList);
+
+		//cache matches source file's size & last write time, or its content (hash is computed into sourceKey once, and the
+		//cache's key is rewritten so that next loading doesn't hash the source again)
+		bool mFunction_IsMeshCacheUpToDate(NFilePath cacheFilePath, NFilePath sourceFilePath, N_N3DMeshSourceKey& sourceKey, bool& isContentHashComputed);
+
+		void mFunction_BeginFbxMeshCache(NFilePath fbxFilePath, N_FbxMeshCacheContext& outContext);
+
+		//skip function of FBX loader: read an up-to-date mesh cache into context.meshMap (geometry extraction is skipped then).
+		//it's called inside FBX SDK traversal, so a damaged cache doesn't throw, the mesh is extracted from FBX instead
+		bool mFunction_LoadFbxMeshCache(N_FbxMeshCacheContext& context, const N_UID& meshName);
+
+		//GPU buffer of an FBX mesh, from FBX data or from the cache read during traversal (subset list is filled then)
+		bool mFunction_LoadFbxMeshGeometry(Mesh* const pTargetMesh, N_FbxMeshInfo& meshInfo, N_FbxMeshCacheContext& context);
+
+		void mFunction_SaveFbxMeshCache(Mesh* const pSourceMesh, const N_FbxMeshInfo& meshInfo, N_FbxMeshCacheContext& context);
+
+		//"<fbx file>.<mesh name>.n3dmesh", characters that can't be in a file name are replaced (and name hash is appended)
+		static NFilePath mFunction_GetFbxMeshCachePath(NFilePath fbxFilePath, const N_UID& meshName);
+
+		//bounding box of tightly packed points (SIMD)
+		N_AABB mFunction_ComputeAABB(const Vec3* pPointList, uint32_t count);
+
+		//non-normalized face normals (length = 2*area) of triangles [triangleBegin, triangleEnd) (SIMD)
+		void mFunction_ComputeFaceNormals(const std::vector<Vec3>& vertexList, const std::vector<UINT>& indexList, uint32_t triangleBegin, uint32_t triangleEnd, std::vector<Vec3>& outFaceNormalList);
+
 		//internal mesh loading helper
 		IFileIO mFileIO;
 		IGeometryMeshGenerator mMeshGenerator;
 		IFbxLoader mFbxLoader;
+		bool mIsMeshCacheEnabled;
 
 	};
 
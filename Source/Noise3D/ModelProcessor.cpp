@@ -25,181 +25,28 @@ ModelProcessor::~ModelProcessor()
 
 void ModelProcessor::WeldVertices(Mesh * pTargetMesh)
 {
-	//get ref to vertex buffer
-	const std::vector<N_DefaultVertex>&  vb = *(pTargetMesh->GetVertexBuffer());
-	const std::vector<UINT>& ib = *(pTargetMesh->GetIndexBuffer());
-
 	// -----Vertices Welding-----
 	// position-duplicated vertices are assumption.
-	//hash-map will be used to remove duplicated vertices in terms of POSITION,
+	//(parallel) hash dedup removes duplicated vertices in terms of POSITION,
 	//then attribute will be combined according to several overlapped vertices
-
-	//hash method of hashmap
-	struct HashVertex
-	{
-		inline float operator()(const N_DefaultVertex& v) const
-		{
-			//3 factors are arbitrarily 
-			constexpr float factor1 = 0.3568f;
-			constexpr float factor2 = 0.2479f;
-			constexpr float factor3 = 1.0f - factor1 - factor2;
-			const Vec3& pos = v.Pos;
-			//return pos.x * factor1 + pos.y * factor2 + pos.z * factor3;
-			return pos.x * factor1 + pos.y * factor2 + pos.z * factor3;
-		}
-	};
-
-
-	//key_eq: position must be precisely the same
-	struct EqVertex
-	{
-		inline bool operator()(const N_DefaultVertex& v1, const N_DefaultVertex& v2) const
-		{
-			const Vec3& pos1 = v1.Pos;
-			const Vec3& pos2 = v2.Pos;
-			return (pos1.x == pos2.x && pos1.y == pos2.y && pos1.z == pos2.z);
-		}
-	};
-
-
-	//hash-map, <vector , index>  pair
-	std::unordered_map<N_DefaultVertex, UINT, HashVertex, EqVertex> point2IndexHashMap;
-	std::vector<N_DefaultVertex> uniqueVertexList;//it's been said that iterate an unordered_map isn't efficient
-	std::vector<UINT> indicesList;
-	std::vector<int> vertexRepeatCountList;
-
-	//1, traverse vertex buffer and insert Vertex into hash-map to remove duplication
-	//this is the BOTTLE-NECK of PERFORMANCE
-	for (UINT i = 0; i < vb.size(); ++i)
-	{
-		//index is re-arranged
-		UINT newIndex = point2IndexHashMap.size();
-		point2IndexHashMap.insert(std::make_pair(vb.at(i), newIndex));
-
-	}
-
-	//Default_Vertex's memory is zero-ed
-	uniqueVertexList.resize(point2IndexHashMap.size(), N_DefaultVertex());
-	vertexRepeatCountList.resize(point2IndexHashMap.size(), 0);
-
-	//2, traverse (original) index buffer to generate new indices,
-	//new indices is derived from unique-vertex-list
-	for (auto& index: ib)
-	{
-		//new index now fit unique vertex list
-		const N_DefaultVertex& v = vb.at(index);
-		UINT newIndex = point2IndexHashMap.at(v);
-		indicesList.push_back(newIndex);
-
-		//because all vertex attribute are cleared to zero initially,
-		//attributes can be sumed up, and NORMALIZE later
-		uniqueVertexList.at(newIndex) += v;
-		vertexRepeatCountList.at(newIndex) += 1;
-	}
-
-	//get the mean value of vertex attribute
-	for (UINT i=0;i<uniqueVertexList.size();++i)
-	{
-		//all attribute multiply the same factor
-		N_DefaultVertex& v = uniqueVertexList.at(i);
-		v *= (1.0f / float(vertexRepeatCountList.at(i)));
-		v.Normal.Normalize();
-		v.Tangent.Normalize();
-	}
-
-	//remember!!! update to GPU
-	pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(uniqueVertexList, indicesList);
-
+	uint32_t threadCount = Ut::ResolveThreadCount(0);
+	std::vector<uint32_t> clusterIdList;
+	uint32_t clusterCount = mFunction_ClusterVertices_Exact(*(pTargetMesh->GetVertexBuffer()), threadCount, clusterIdList);
+	mFunction_MergeClusters(pTargetMesh, clusterIdList, clusterCount, threadCount);
 }
 
-void ModelProcessor::WeldVertices(Mesh * pTargetMesh, float PositionEqualThreshold)
+void ModelProcessor::WeldVertices(Mesh * pTargetMesh, float PositionEqualThreshold, uint32_t threadCount)
 {
-	//get ref to vertex buffer
-	const std::vector<N_DefaultVertex>&  vb = *(pTargetMesh->GetVertexBuffer());
-	const std::vector<UINT>& ib = *(pTargetMesh->GetIndexBuffer());
-
-	// -----Vertices Welding-----
-	// position-duplicated vertices are assumption.
-	//hash-map will be used to remove duplicated vertices in terms of POSITION,
-	//then attribute will be combined according to several overlapped vertices
-
-	//hash method of hashmap
-	struct HashVertex
-	{
-		inline float operator()(const N_DefaultVertex& v) const
-		{
-			//3 factors are arbitrarily 
-			constexpr float factor1 = 0.33333f;//0.3568f;
-			constexpr float factor2 = 0.33333f;//0.2479f;
-			constexpr float factor3 = 1.0f - factor1 - factor2;
-			const Vec3& pos = v.Pos;
-			//return pos.x * factor1 + pos.y * factor2 + pos.z * factor3;
-			return pos.x * factor1 + pos.y * factor2 + pos.z * factor3;
-		}
-	};
-
-
-	//Key_eq: position might be not precisely at the same position
-	static_PositionEqualThreshold = PositionEqualThreshold;
-	struct EqVertex2
-	{
-		inline bool operator()(const N_DefaultVertex& v1, const N_DefaultVertex& v2) const
-		{
-			const Vec3& pos1 = v1.Pos;
-			const Vec3& pos2 = v2.Pos;
-			//return (pos1.x == pos2.x && pos1.y == pos2.y && pos1.z == pos2.z);
-			return (abs(pos1.x - pos2.x) + abs(pos1.y - pos2.y) + abs(pos1.z - pos2.z) <= static_PositionEqualThreshold);
-		}
-	};
-
-
-	//hash-map, <vector , index>  pair
-	std::unordered_map<N_DefaultVertex, UINT, HashVertex, EqVertex2> point2IndexHashTable;
-	std::vector<N_DefaultVertex> uniqueVertexList;//it's been said that iterate an unordered_map isn't efficient
-	std::vector<UINT> indicesList;
-	std::vector<int> vertexRepeatCountList;
-
-	//1, traverse vertex buffer and insert Vertex into hash-map to remove duplication
-	//this is the BOTTLE-NECK of PERFORMANCE
-	for (UINT i = 0; i < vb.size(); ++i)
-	{
-		//index is re-arranged
-		UINT newIndex = point2IndexHashTable.size();
-		point2IndexHashTable.insert(std::make_pair(vb.at(i), newIndex));
-
-	}
-
-	//Default_Vertex's memory is zero-ed
-	uniqueVertexList.resize(point2IndexHashTable.size(), N_DefaultVertex());
-	vertexRepeatCountList.resize(point2IndexHashTable.size(), 0);
-
-	//2, traverse (original) index buffer to generate new indices,
-	//new indices is derived from unique-vertex-list
-	for (auto& index : ib)
-	{
-		//new index now fit unique vertex list
-		const N_DefaultVertex& v = vb.at(index);
-		UINT newIndex = point2IndexHashTable.at(v);
-		indicesList.push_back(newIndex);
-
-		//because all vertex attribute are cleared to zero initially,
-		//attributes can be sumed up, and NORMALIZE later
-		uniqueVertexList.at(newIndex) += v;
-		vertexRepeatCountList.at(newIndex) += 1;
-	}
-
-	//get the mean value of vertex attribute
-	for (UINT i = 0; i<uniqueVertexList.size(); ++i)
-	{
-		//all attribute multiply the same factor
-		N_DefaultVertex& v = uniqueVertexList.at(i);
-		v *= (1.0f / float(vertexRepeatCountList.at(i)));
-		v.Normal.Normalize();
-		v.Tangent.Normalize();
-	}
-
-	//remember!!! update to GPU
-	pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(uniqueVertexList, indicesList);
+	//position might be not precisely at the same position
+	threadCount = Ut::ResolveThreadCount(threadCount);
+	const std::vector<N_DefaultVertex>& vb = *(pTargetMesh->GetVertexBuffer());
+	std::vector<uint32_t> clusterIdList;
+	uint32_t clusterCount = 0;
+	if (PositionEqualThreshold > 0.0f)
+		clusterCount = mFunction_ClusterVertices_Grid(vb, PositionEqualThreshold, threadCount, clusterIdList);
+	else
+		clusterCount = mFunction_ClusterVertices_Exact(vb, threadCount, clusterIdList);
+	mFunction_MergeClusters(pTargetMesh, clusterIdList, clusterCount, threadCount);
 }
 
 void ModelProcessor::MeshSimplify(Mesh * pTargetMesh, float PositionEqualThreshold, float visualImportanceWeightThreshold)
@@ -379,3 +226,228 @@ void ModelProcessor::Smooth_Laplacian(Mesh * pTargetMesh)
 	pTargetMesh->mFunction_CreateGpuBufferAndUpdateData();
 
 }
+
+/***********************************************************************
+											PRIVATE
+***********************************************************************/
+
+namespace Noise3D
+{
+	//cell coordinate of a component, clamped to [0, 2^30] (NaN goes to cell 0)
+	static inline uint32_t WeldCellCoord(float v, float origin, float invCellSize)
+	{
+		float f = floorf((v - origin) * invCellSize);
+		if (!(f >= 0.0f))f = 0.0f;
+		if (f > 1073741824.0f)f = 1073741824.0f;
+		return uint32_t(f);
+	}
+}
+
+uint32_t ModelProcessor::mFunction_ClusterVertices_Exact(const std::vector<N_DefaultVertex>& vb, uint32_t threadCount, std::vector<uint32_t>& outClusterIdList)
+{
+	std::vector<uint32_t> firstVertexList;
+	Ut::ParallelDedup<Ut::N_PositionKey>(uint32_t(vb.size()),
+		[&vb](uint32_t i) {return Ut::MakePositionKey(vb[i].Pos); },
+		[](const Ut::N_PositionKey& key) {return Ut::HashPositionKey(key); },
+		vb.size() / 2, threadCount, outClusterIdList, firstVertexList);
+	return uint32_t(firstVertexList.size());
+}
+
+uint32_t ModelProcessor::mFunction_ClusterVertices_Grid(const std::vector<N_DefaultVertex>& vb, float tolerance, uint32_t threadCount, std::vector<uint32_t>& outClusterIdList)
+{
+	uint32_t vertexCount = uint32_t(vb.size());
+	outClusterIdList.resize(vertexCount);
+	if (vertexCount == 0)return 0;
+
+	//1, grid origin at the min corner of bounding box (keeps cell coordinates small)
+	std::vector<N_AABB> chunkAabbList(threadCount);
+	uint32_t chunkCount = Ut::ParallelFor(vertexCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t i = chunkBegin; i < chunkEnd; ++i)chunkAabbList[chunkId].Union(N_AABB(vb[i].Pos, vb[i].Pos));
+	});
+	N_AABB aabb;
+	for (uint32_t i = 0; i < chunkCount; ++i)aabb.Union(chunkAabbList[i]);
+	Vec3 origin = aabb.IsValid() ? aabb.min : Vec3(0, 0, 0);
+	float invCellSize = 1.0f / tolerance;
+
+	auto GetCellKey = [&](uint32_t i)->Ut::N_PositionKey
+	{
+		Ut::N_PositionKey key;
+		key.x = WeldCellCoord(vb[i].Pos.x, origin.x, invCellSize);
+		key.y = WeldCellCoord(vb[i].Pos.y, origin.y, invCellSize);
+		key.z = WeldCellCoord(vb[i].Pos.z, origin.z, invCellSize);
+		return key;
+	};
+	auto HashCellKey = [](const Ut::N_PositionKey& key) {return Ut::HashPositionKey(key); };
+
+	//2, cell of each vertex, then vertices of each cell in ascending order (counting sort)
+	std::vector<uint32_t> cellIdList, firstVertexOfCellList;
+	Ut::ParallelDedup<Ut::N_PositionKey>(vertexCount, GetCellKey, HashCellKey, vertexCount / 2, threadCount, cellIdList, firstVertexOfCellList);
+	uint32_t cellCount = uint32_t(firstVertexOfCellList.size());
+
+	std::vector<uint32_t> cellOffsetList(cellCount + 1, 0);
+	for (uint32_t i = 0; i < vertexCount; ++i)++cellOffsetList[cellIdList[i] + 1];
+	for (uint32_t i = 0; i < cellCount; ++i)cellOffsetList[i + 1] += cellOffsetList[i];
+	std::vector<uint32_t> cellVertexList(vertexCount);
+	{
+		std::vector<uint32_t> cellFillList(cellOffsetList.begin(), cellOffsetList.end() - 1);
+		for (uint32_t i = 0; i < vertexCount; ++i)cellVertexList[cellFillList[cellIdList[i]]++] = i;
+	}
+
+	//cell coordinates -> cell id (keys are inserted in id order).
+	//most of the 27 neighbor cells are empty, a bitmap of occupied hashes (~8 bits per cell, cache-resident)
+	//rejects them before probing the big table
+	Ut::N_DedupHashTable<Ut::N_PositionKey, decltype(HashCellKey)> cellTable(cellCount, HashCellKey);
+	uint32_t bitmapShift = 32 - 6;
+	while (bitmapShift > 8 && (uint64_t(1) << (32 - bitmapShift)) < uint64_t(cellCount) * 8)--bitmapShift;
+	std::vector<uint64_t> occupiedBitmap(((uint64_t(1) << (32 - bitmapShift)) + 63) / 64, 0);
+	for (uint32_t i = 0; i < cellCount; ++i)
+	{
+		Ut::N_PositionKey key = GetCellKey(firstVertexOfCellList[i]);
+		uint32_t hash = HashCellKey(key);
+		cellTable.FindOrInsert(key, hash, i);
+		occupiedBitmap[(hash >> bitmapShift) / 64] |= uint64_t(1) << ((hash >> bitmapShift) % 64);
+	}
+
+	//3, (parallel over blocks of cells) occupied neighbor cells of each cell.
+	//a cell is as large as tolerance, so nothing beyond the 27 neighbor cells can be within tolerance
+	std::vector<std::vector<uint32_t>> blockNeighborList(threadCount);
+	std::vector<uint32_t> cellNeighborOffsetList(cellCount + 1, 0);//count of each cell first
+	uint32_t blockCount = Ut::ParallelFor(cellCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		std::vector<uint32_t>& neighborList = blockNeighborList[chunkId];
+		for (uint32_t c = chunkBegin; c < chunkEnd; ++c)
+		{
+			Ut::N_PositionKey center = GetCellKey(firstVertexOfCellList[c]);
+			uint32_t neighborCount = 0;
+			for (int dz = -1; dz <= 1; ++dz)
+			{
+				for (int dy = -1; dy <= 1; ++dy)
+				{
+					for (int dx = -1; dx <= 1; ++dx)
+					{
+						Ut::N_PositionKey neighbor = { center.x + dx, center.y + dy, center.z + dz };
+						uint32_t hash = HashCellKey(neighbor);
+						if ((occupiedBitmap[(hash >> bitmapShift) / 64] & (uint64_t(1) << ((hash >> bitmapShift) % 64))) == 0)continue;
+						uint32_t cellId = cellTable.Find(neighbor, hash);
+						if (cellId == cellTable.c_emptySlot)continue;
+						neighborList.push_back(cellId);
+						++neighborCount;
+					}
+				}
+			}
+			cellNeighborOffsetList[c + 1] = neighborCount;
+		}
+	});
+
+	//blocks are contiguous ranges of cells, so their lists are concatenated in cell order
+	for (uint32_t i = 0; i < cellCount; ++i)cellNeighborOffsetList[i + 1] += cellNeighborOffsetList[i];
+	std::vector<uint32_t> cellNeighborList(cellNeighborOffsetList[cellCount]);
+	{
+		uint32_t offset = 0;
+		for (uint32_t b = 0; b < blockCount; ++b)
+		{
+			std::copy(blockNeighborList[b].begin(), blockNeighborList[b].end(), cellNeighborList.begin() + offset);
+			offset += uint32_t(blockNeighborList[b].size());
+			std::vector<uint32_t>().swap(blockNeighborList[b]);
+		}
+	}
+
+	//4, seeds in vertex order: a vertex joins the first seed within tolerance, or becomes a new seed
+	//(a cluster's radius is at most tolerance, so chains of close vertices don't collapse into one).
+	//seeds of each cell are in ascending order, in the cell's range of cellVertexList layout
+	float toleranceSq = tolerance * tolerance;
+	std::vector<uint32_t> cellSeedList(vertexCount);
+	std::vector<uint32_t> cellSeedCountList(cellCount, 0);
+	uint32_t clusterCount = 0;
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		uint32_t cellId = cellIdList[i];
+		uint32_t seed = i;
+		for (uint32_t n = cellNeighborOffsetList[cellId]; n < cellNeighborOffsetList[cellId + 1]; ++n)
+		{
+			uint32_t neighborCellId = cellNeighborList[n];
+			const uint32_t* pSeed = &cellSeedList[cellOffsetList[neighborCellId]];
+			for (uint32_t k = 0; k < cellSeedCountList[neighborCellId]; ++k)
+			{
+				uint32_t j = pSeed[k];
+				if (j >= seed)break;
+				Vec3 d = vb[i].Pos - vb[j].Pos;
+				if (d.LengthSquared() <= toleranceSq)
+				{
+					seed = j;
+					break;
+				}
+			}
+		}
+
+		if (seed == i)
+		{
+			cellSeedList[cellOffsetList[cellId] + cellSeedCountList[cellId]++] = i;
+			outClusterIdList[i] = clusterCount++;
+		}
+		else
+		{
+			outClusterIdList[i] = outClusterIdList[seed];
+		}
+	}
+
+	return clusterCount;
+}
+
+void ModelProcessor::mFunction_MergeClusters(Mesh * pTargetMesh, const std::vector<uint32_t>& clusterIdList, uint32_t clusterCount, uint32_t threadCount)
+{
+	const std::vector<N_DefaultVertex>& vb = *(pTargetMesh->GetVertexBuffer());
+	const std::vector<UINT>& ib = *(pTargetMesh->GetIndexBuffer());
+	uint32_t indexCount = uint32_t(ib.size());
+
+	//index buffer positions of each cluster, in index buffer order (counting sort)
+	std::vector<uint32_t> clusterOffsetList(clusterCount + 1, 0);
+	for (uint32_t k = 0; k < indexCount; ++k)++clusterOffsetList[clusterIdList[ib[k]] + 1];
+	for (uint32_t i = 0; i < clusterCount; ++i)clusterOffsetList[i + 1] += clusterOffsetList[i];
+	std::vector<uint32_t> clusterRefList(indexCount);
+	{
+		std::vector<uint32_t> clusterFillList(clusterOffsetList.begin(), clusterOffsetList.end() - 1);
+		for (uint32_t k = 0; k < indexCount; ++k)clusterRefList[clusterFillList[clusterIdList[ib[k]]]++] = k;
+	}
+
+	//first vertex of each cluster (for clusters that are not referenced by any triangle)
+	std::vector<uint32_t> firstVertexList(clusterCount, UINT_MAX);
+	for (uint32_t i = 0; i < vb.size(); ++i)
+	{
+		if (firstVertexList[clusterIdList[i]] == UINT_MAX)firstVertexList[clusterIdList[i]] = i;
+	}
+
+	//because all vertex attribute are cleared to zero initially,
+	//attributes can be sumed up, and NORMALIZE later.
+	//each cluster is summed in a fixed order, so the result doesn't depend on thread count
+	std::vector<N_DefaultVertex> uniqueVertexList(clusterCount, N_DefaultVertex());
+	Ut::ParallelFor(clusterCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t c = chunkBegin; c < chunkEnd; ++c)
+		{
+			N_DefaultVertex& v = uniqueVertexList[c];
+			uint32_t refCount = clusterOffsetList[c + 1] - clusterOffsetList[c];
+			if (refCount == 0)
+			{
+				v = vb[firstVertexList[c]];
+				continue;
+			}
+			for (uint32_t k = clusterOffsetList[c]; k < clusterOffsetList[c + 1]; ++k)v += vb[ib[clusterRefList[k]]];
+
+			//all attribute multiply the same factor
+			v *= (1.0f / float(refCount));
+			v.Normal.Normalize();
+			v.Tangent.Normalize();
+		}
+	});
+
+	std::vector<UINT> indicesList(indexCount);
+	Ut::ParallelFor(indexCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		for (uint32_t k = chunkBegin; k < chunkEnd; ++k)indicesList[k] = clusterIdList[ib[k]];
+	});
+
+	//remember!!! update to GPU
+	pTargetMesh->mFunction_CreateGpuBufferAndUpdateData(uniqueVertexList, indicesList);
+}
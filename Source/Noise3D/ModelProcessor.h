@@ -14,6 +14,9 @@ namespace Noise3D
 	class Mesh;
 	typedef std::vector<std::vector<UINT>> N_AdjacentList;
 
+	//compares vertex clustering with a brute-force reference (Test/UnitTest_WeldVertices.cpp)
+	void UnitTest_ClusterVertices_Grid();
+
 
 	class /*_declspec(dllexport)*/ ModelProcessor
 	{
@@ -21,7 +24,10 @@ namespace Noise3D
 
 		void WeldVertices(Mesh* pTargetMesh);//vertices will same position will be weld as one
 
-		void WeldVertices(Mesh* pTargetMesh,float PositionEqualThreshold);//vertices will same position will be weld as one
+		//vertices are visited in order, a vertex is welded to the first earlier 'seed' vertex within distance PositionEqualThreshold
+		//(or becomes a new seed). positions are quantized to a grid of cell size = threshold, so only 27 neighbor cells are searched.
+		//attributes of welded vertices are averaged. result doesn't depend on thread count (0 for hardware concurrency)
+		void WeldVertices(Mesh* pTargetMesh,float PositionEqualThreshold, uint32_t threadCount = 0);
 
 		void MeshSimplify(Mesh* pTargetMesh, float PositionEqualThreshold, float visualImportanceWeightThreshold);
 
@@ -33,10 +39,20 @@ namespace Noise3D
 
 		friend class IFactory<ModelProcessor>;
 
+		friend void UnitTest_ClusterVertices_Grid();
+
 		ModelProcessor();
 
 		~ModelProcessor();
 
+		//cluster id of each vertex (clusters in order of their first vertex). positions are compared by bits (-0 and +0 are the same)
+		uint32_t mFunction_ClusterVertices_Exact(const std::vector<N_DefaultVertex>& vb, uint32_t threadCount, std::vector<uint32_t>& outClusterIdList);
+
+		uint32_t mFunction_ClusterVertices_Grid(const std::vector<N_DefaultVertex>& vb, float tolerance, uint32_t threadCount, std::vector<uint32_t>& outClusterIdList);
+
+		//mean of vertices referenced by index buffer in each cluster (summed in index buffer order), then update the mesh
+		void mFunction_MergeClusters(Mesh* pTargetMesh, const std::vector<uint32_t>& clusterIdList, uint32_t clusterCount, uint32_t threadCount);
+
 		static float static_PositionEqualThreshold;
 
 	};
@@ -12,10 +12,12 @@
 #include "MeshLoader.h"
 
 #include "RandomSampleGenerator.h"
+#include "LowDiscrepancySampler.h"
 #include "ISphericalFunc.h"
 #include "SHCommon.h"
 #include "SHRotation.h"
 #include "SHVector.h"
+#include "EnvironmentMapSampler.h"
 
 #include "PathTracer.h"
 #include "BxdfUt.h"
@@ -31,6 +31,10 @@
 #include <memory>
 #include <thread>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 //Third Party : Microsoft's Effects11/FX11
 #include <Effects11\d3dx11effect.h>
@@ -68,8 +72,20 @@
 #include "AffineTransform.h"
 #include "SceneGraph.h"
 #include "ISceneObject.h"
+#include "_SimdFloat.h"
+#include "_BvhLinearNode.h"
+#include "_BvhWideNode.h"
+#include "_BvhTriangle.h"
+#include "_RayPacket.h"
+#include "_BvhBuildInfo.h"
+#include "_ParallelFor.h"
+#include "BvhSahBuilder.h"
+#include "_ParallelDedup.h"
+#include "BvhWideCollapser.h"
+
 #include "BvhTreeForScene.h"
 
+
 #include "LambertMaterial.h"
 #include "PbrtMaterial.h"
 #include "MaterialManager.h"
@@ -92,6 +108,7 @@
 #include "ShadowCommonInterface.h"
 #include "LightManager.h"
 #include "Lights.h"
+#include "TextureCpuPixelStore.h"
 #include "ITexture.h"
 #include "Texture2D.h"
 #include "TextureCubeMap.h"
@@ -126,10 +143,12 @@
 
 /*//--------GI: Spherical Harmonic----------
 #include "RandomSampleGenerator.h"
+#include "LowDiscrepancySampler.h"
 #include "ISphericalFunc.h"
 #include "SHCommon.h"
 #include "SHRotation.h"
 #include "SHVector.h"
+#include "EnvironmentMapSampler.h"
 
 //--------GI :Path Tracer-----------
 #include "PathTracer.h"
@@ -54,6 +54,13 @@
 		debugMsg.clear();\
 	}\
 
+//thrown as ERROR_MSG, or only reported as WARNING_MSG if the caller can recover (e.g. regenerate a cache)
+#define ERROR_OR_WARNING_MSG(isErrorThrown, msg)\
+	{\
+		if (isErrorThrown) ERROR_MSG(msg)\
+		else WARNING_MSG(msg)\
+	}\
+
 #define DEBUG_MSG(msg)  OutputDebugStringA(msg);
 
 //debug msg for HRESULT
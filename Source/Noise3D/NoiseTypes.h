@@ -148,6 +148,15 @@ namespace Noise3D
 			return (max + min) / 2.0f;
 		}
 
+		//surface area (for surface area heuristic)
+		float SurfaceArea() const
+		{
+			if (!IsValid())return 0.0f;
+			Vec3 d = max - min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+
 		//determine if given point is inside AABB
 		bool IsPointInside(Vec3 v)
 		{
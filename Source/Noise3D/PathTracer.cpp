@@ -21,7 +21,21 @@ Noise3D::GI::PathTracer::PathTracer():
 	mTileHeight(16),
 	mIsRenderedFinished(false),
 	mLogExposurePreAmp(1.0f),
-	mAmbientRadiance(0,0,0)
+	mAmbientRadiance(0,0,0),
+	mFrameId(0),
+	mActiveWorkerCount(0),
+	mIsWorkerShutdown(false),
+	mRequestedWorkerThreadCount(0),
+	mTileOrder(NOISE_PATH_TRACER_TILE_ORDER::HILBERT),
+	mRandomSeed(0),
+	m_pSampler(nullptr),
+	mSamplesPerPixel(1),
+	mPassSampleCount(1),
+	mIsPixelJitterEnabled(false),
+	mIsDeadlineEnabled(false),
+	mIsDeadlineCheckedByWorkers(true),
+	mExecutionMode(NOISE_PATH_TRACER_EXECUTION_MODE::TILED),
+	mWavefrontBatchSize(1 << 18)
 {
 	m_pCT = Noise3D::GetScene()->GetCollisionTestor();
 }
@@ -29,12 +43,22 @@ Noise3D::GI::PathTracer::PathTracer():
 Noise3D::GI::PathTracer::~PathTracer()
 {
 	PathTracer::TerminateRenderTask();
+	mFunction_DestroyWorkerThreads();
 	m_pFinalRenderTarget = nullptr;
 	m_pCT = nullptr;
 	m_pShader = nullptr;
 }
 
 void Noise3D::GI::PathTracer::Render(Noise3D::SceneNode * pNode, IPathTracerSoftShader* pShader)
+{
+	//one-shot render is a single pass of all samples
+	N_ProgressiveRenderDesc desc;
+	desc.samplesPerPass = mSamplesPerPixel;
+	desc.maxSamplesPerPixel = mSamplesPerPixel;
+	PathTracer::RenderProgressive(pNode, pShader, desc);
+}
+
+void Noise3D::GI::PathTracer::RenderProgressive(Noise3D::SceneNode * pNode, IPathTracerSoftShader * pShader, const N_ProgressiveRenderDesc & desc)
 {
 	if (pNode == nullptr || pShader==nullptr)
 	{
@@ -42,17 +66,22 @@ void Noise3D::GI::PathTracer::Render(Noise3D::SceneNode * pNode, IPathTracerSoft
 		return;
 	}
 
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
 	//cache world transform(avoid redundant computation)
+	//(previous cache is cleared first, nodes might have been moved since last frame)
 	std::vector<SceneNode*> nodeList;
 	SceneGraph* pSG = pNode->GetHostTree();
 	pSG->Traverse_PreOrder(pNode, nodeList);
+	for (auto node : nodeList)node->ClearWorldTransformCache();
 	for (auto node : nodeList)node->EvalWorldTransform(true);
 
 	//reset render task state
 	mIsRenderedFinished = false;
 
-	//re-build BVH to accelerate ray-object intersection
-	m_pCT->RebuildBvhTreeForGI(pNode);
+	//refit BVH to accelerate ray-object intersection (only moved objects are re-bounded,
+	//the tree is fully built only at the first frame or when objects are added/removed)
+	m_pCT->UpdateBvhTreeForGI(pNode);
 
 	//set soft shader and pass light source list
 	m_pShader = pShader;
@@ -60,63 +89,72 @@ void Noise3D::GI::PathTracer::Render(Noise3D::SceneNode * pNode, IPathTracerSoft
 	mFunction_ComputeLightSourceList(lightSourceList);
 	pShader->_InitInfrastructure(this, m_pCT, std::move(lightSourceList));
 
-	//back buffer's size, partition it into tiles
-	uint32_t w = m_pFinalRenderTarget->GetWidth();
-	uint32_t h = m_pFinalRenderTarget->GetHeight();
-	uint32_t completeTileCountX = (w / mTileWidth);
-	uint32_t completeTileCountY = (h / mTileHeight);
-	uint32_t partialTileWidth = w % mTileWidth;//some tile might be incomplete
-	uint32_t partialTileHeight = h % mTileHeight;//some tile might be incomplete
+	//clear accumulation buffers
+	uint32_t pixelCount = m_pFinalRenderTarget->GetWidth() * m_pFinalRenderTarget->GetHeight();
+	mAccumRadianceList.assign(pixelCount, GI::Radiance(0, 0, 0));
+	mAccumLuminanceList.assign(pixelCount, 0.0);
+	mAccumLuminanceSqList.assign(pixelCount, 0.0);
+	mPixelSampleCountList.assign(pixelCount, 0);
+	mPixelRelativeErrorList.assign(pixelCount, std::numeric_limits<float>::infinity());
+	mPixelConvergedList.assign(pixelCount, 0);
 
-	//generate render tile task info list
-	std::queue<N_RenderTileInfo> renderTaskList;
-	for (uint32_t tileIdY = 0; tileIdY <= completeTileCountY; ++tileIdY)
-	{
-		for (uint32_t tileIdX = 0; tileIdX <= completeTileCountX; ++tileIdX)
-		{
-			//incomplete block at the right/bottom edge are considered
-			uint32_t currentTileW = (tileIdX != completeTileCountX ? mTileWidth : partialTileWidth);
-			uint32_t currentTileH = (tileIdY != completeTileCountY ? mTileHeight : partialTileHeight);
+	mProgressiveDesc = desc;
+	if (mProgressiveDesc.samplesPerPass == 0)mProgressiveDesc.samplesPerPass = 1;
+	mIsPixelJitterEnabled = (mProgressiveDesc.maxSamplesPerPixel != 1);
+	mIsDeadlineEnabled = (mProgressiveDesc.timeBudgetSeconds > 0.0f);
+	mDeadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(mProgressiveDesc.timeBudgetSeconds));
+	mProgressiveStatus = N_ProgressiveRenderStatus();
+	mProgressiveStatus.activePixelCount = pixelCount;
+	mWavefrontStat = N_WavefrontRenderStatistics();
 
-			N_RenderTileInfo info;
-			info.topLeftX = mTileWidth * tileIdX;
-			info.topLeftY = mTileHeight * tileIdY;
-			info.width = currentTileW;
-			info.height = currentTileH;
+	mFunction_PrepareTileList();
 
-			//ignore edge tile with no pixel
-			if (currentTileW>0 && currentTileH >0)
-			{
-				renderTaskList.push(info);
-			}
+	while (true)
+	{
+		//the last pass might be cut to reach max samples exactly
+		uint32_t passSampleCount = mProgressiveDesc.samplesPerPass;
+		if (mProgressiveDesc.maxSamplesPerPixel > 0)
+		{
+			passSampleCount = std::min<uint32_t>(passSampleCount,
+				mProgressiveDesc.maxSamplesPerPixel - mProgressiveStatus.samplesPerPixel);
 		}
-	}
-
+		mPassSampleCount = passSampleCount;
 
-	//dispatch several 'renderTile' worker thread (runs independently),
-	//each of them pop one render task from front and do it
-	//but remember to lock the renderTaskList before popping front
-	std::mutex mutex_renderTaskList;
+		if (mExecutionMode == NOISE_PATH_TRACER_EXECUTION_MODE::WAVEFRONT)
+			mFunction_DispatchPassWavefront();
+		else
+			mFunction_DispatchPass();
 
-	//thread functor
-	struct PathTracerRenderTileFunctor
-	{
-		void operator()(PathTracer* p, std::queue<N_RenderTileInfo>& renderTaskList)
+		//gather statistics (workers are idle now)
+		uint32_t activePixelCount = 0;
+		uint32_t maxSampleCount = 0;
+		uint64_t totalSampleCount = 0;
+		float maxRelativeError = 0.0f;
+		for (uint32_t i = 0; i < pixelCount; ++i)
 		{
-			p->_RenderTileWorkerThread(renderTaskList);
+			totalSampleCount += mPixelSampleCountList[i];
+			maxSampleCount = std::max<uint32_t>(maxSampleCount, mPixelSampleCountList[i]);
+			if (!mPixelConvergedList[i])
+			{
+				++activePixelCount;
+				maxRelativeError = std::max<float>(maxRelativeError, mPixelRelativeErrorList[i]);
+			}
 		}
-	} RenderTileWorkerFunc;
+		++mProgressiveStatus.passCount;
+		mProgressiveStatus.samplesPerPixel = maxSampleCount;
+		mProgressiveStatus.activePixelCount = activePixelCount;
+		mProgressiveStatus.totalSampleCount = totalSampleCount;
+		mProgressiveStatus.maxRelativeError = mProgressiveDesc.isAdaptiveSamplingEnabled ? maxRelativeError : 0.0f;
+		mProgressiveStatus.elapsedSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
 
-	//dispatch worker threads
-	for (uint32_t i = 0; i < c_parallelWorkerThreadCount; ++i)
-	{
-		mWorkerThreadArr[i] = std::thread(RenderTileWorkerFunc, this, std::ref(renderTaskList));
-	}
-	
-	//synchronize (all jobs are done now)
-	for (uint32_t i = 0; i < c_parallelWorkerThreadCount; ++i)
-	{
-		if(mWorkerThreadArr[i].joinable())mWorkerThreadArr[i].join();
+		//stop conditions
+		if (mIsRenderedFinished)break;//terminated
+		if (mProgressiveDesc.passCallback && !mProgressiveDesc.passCallback(mProgressiveStatus))break;
+		if (activePixelCount == 0)break;
+		if (mProgressiveDesc.maxSamplesPerPixel > 0 &&
+			mProgressiveStatus.samplesPerPixel >= mProgressiveDesc.maxSamplesPerPixel)break;
+		if (mFunction_IsDeadlineExceeded())break;
 	}
 
 	//clear cached world transform computed at the beginning of path tracer render
@@ -124,12 +162,62 @@ void Noise3D::GI::PathTracer::Render(Noise3D::SceneNode * pNode, IPathTracerSoft
 	mIsRenderedFinished = true;
 }
 
+GI::N_ProgressiveRenderStatus Noise3D::GI::PathTracer::GetProgressiveRenderStatus()
+{
+	return mProgressiveStatus;
+}
+
 void Noise3D::GI::PathTracer::SetRenderTileSize(uint32_t width, uint32_t height)
 {
 	mTileWidth = width > 0 ? width : 1;
 	mTileHeight = height > 0 ? height : 1;
 }
 
+void Noise3D::GI::PathTracer::SetRenderTileOrder(NOISE_PATH_TRACER_TILE_ORDER order)
+{
+	mTileOrder = order;
+}
+
+void Noise3D::GI::PathTracer::SetWorkerThreadCount(uint32_t count)
+{
+	mRequestedWorkerThreadCount = count;
+}
+
+uint32_t Noise3D::GI::PathTracer::GetWorkerThreadCount()
+{
+	return mWorkerThreadList.size();
+}
+
+void Noise3D::GI::PathTracer::SetExecutionMode(NOISE_PATH_TRACER_EXECUTION_MODE mode)
+{
+	mExecutionMode = mode;
+}
+
+GI::NOISE_PATH_TRACER_EXECUTION_MODE Noise3D::GI::PathTracer::GetExecutionMode()
+{
+	return mExecutionMode;
+}
+
+void Noise3D::GI::PathTracer::SetWavefrontBatchSize(uint32_t pathCount)
+{
+	mWavefrontBatchSize = pathCount > 0 ? pathCount : 1;
+}
+
+GI::N_WavefrontRenderStatistics Noise3D::GI::PathTracer::GetWavefrontStatistics()
+{
+	return mWavefrontStat;
+}
+
+void Noise3D::GI::PathTracer::SetRandomSeed(uint64_t seed)
+{
+	mRandomSeed = seed;
+}
+
+void Noise3D::GI::PathTracer::SetSampler(const ISampler * pSampler)
+{
+	m_pSampler = pSampler;
+}
+
 Texture2D * Noise3D::GI::PathTracer::GetRenderTarget()
 {
 	return m_pFinalRenderTarget;
@@ -187,6 +275,16 @@ uint32_t Noise3D::GI::PathTracer::GetMaxSpecularScatterSampleCount()
 	return mMaxSpecularScatterSampleCount;
 }
 
+void Noise3D::GI::PathTracer::SetSamplesPerPixel(uint32_t spp)
+{
+	mSamplesPerPixel = spp > 0 ? spp : 1;
+}
+
+uint32_t Noise3D::GI::PathTracer::GetSamplesPerPixel()
+{
+	return mSamplesPerPixel;
+}
+
 void Noise3D::GI::PathTracer::SetRayMaxTravelDist(float dist)
 {
 	mRayMaxTravelDist = dist;
@@ -204,11 +302,10 @@ bool Noise3D::GI::PathTracer::IsRenderFinished()
 
 void Noise3D::GI::PathTracer::TerminateRenderTask()
 {
+	//workers stop popping tiles, wait until the tiles being rendered are done
 	mIsRenderedFinished = true;
-	for (int i = 0; i < c_parallelWorkerThreadCount; ++i)
-	{
-		if(mWorkerThreadArr[i].joinable())mWorkerThreadArr[i].join();
-	}
+	std::unique_lock<std::mutex> lock(mWorkerMutex);
+	mFrameFinishedCV.wait(lock, [this]() {return mActiveWorkerCount == 0; });
 }
 
 void Noise3D::GI::PathTracer::SetExposure(float e)
@@ -279,64 +376,648 @@ Color4f Noise3D::GI::PathTracer::mFunction_ToneMapping(Color4f c)
 	return Color4f(r,g,b,a);
 }
 
-void Noise3D::GI::PathTracer::_RenderTileWorkerThread(std::queue<N_RenderTileInfo>& renderTaskList)
+void Noise3D::GI::PathTracer::mFunction_PrepareWorkerThreads()
 {
-	//serveral worker thread works continuously, independently with no break.
-	//all wait to be fed by new task. (
-	//until all work are done
-	while (true)
+	uint32_t workerCount = mRequestedWorkerThreadCount;
+	if (workerCount == 0)workerCount = std::thread::hardware_concurrency();
+	if (workerCount == 0)workerCount = 1;
+	if (workerCount == mWorkerThreadList.size())return;
+
+	//threads are created only once (or when worker count is changed), not every frame
+	mFunction_DestroyWorkerThreads();
+	mIsWorkerShutdown = false;
+	mTileRangeList = std::vector<std::atomic<uint64_t>>(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		mWorkerThreadList.push_back(std::thread(&PathTracer::_RenderTileWorkerThread, this, i, mFrameId));
+	}
+}
+
+void Noise3D::GI::PathTracer::mFunction_DestroyWorkerThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock(mWorkerMutex);
+		mIsWorkerShutdown = true;
+	}
+	mWorkerWakeUpCV.notify_all();
+	for (auto& t : mWorkerThreadList)
+	{
+		if (t.joinable())t.join();
+	}
+	mWorkerThreadList.clear();
+}
+
+void Noise3D::GI::PathTracer::mFunction_GenerateTileOrder(uint32_t tileCountX, uint32_t tileCountY, std::vector<std::pair<uint32_t, uint32_t>>& outList)
+{
+	outList.clear();
+	outList.reserve(tileCountX * tileCountY);
+	switch (mTileOrder)
+	{
+	case NOISE_PATH_TRACER_TILE_ORDER::SPIRAL:
+	{
+		//walk right 1, down 1, left 2, up 2, right 3... from the center tile, keep tiles inside the image
+		int x = int(tileCountX - 1) / 2;
+		int y = int(tileCountY - 1) / 2;
+		const int dirX[4] = { 1, 0, -1, 0 };
+		const int dirY[4] = { 0, 1, 0, -1 };
+		uint32_t totalCount = tileCountX * tileCountY;
+		outList.push_back(std::make_pair(uint32_t(x), uint32_t(y)));
+		for (int segmentLength = 1, dir = 0; outList.size() < totalCount; ++dir)
+		{
+			for (int i = 0; i < segmentLength; ++i)
+			{
+				x += dirX[dir % 4];
+				y += dirY[dir % 4];
+				if (x >= 0 && y >= 0 && x < int(tileCountX) && y < int(tileCountY))
+				{
+					outList.push_back(std::make_pair(uint32_t(x), uint32_t(y)));
+				}
+			}
+			if (dir % 2 == 1)++segmentLength;
+		}
+		break;
+	}
+
+	case NOISE_PATH_TRACER_TILE_ORDER::HILBERT:
+	{
+		//hilbert curve of a 2^n x 2^n grid, tiles outside the image are skipped
+		uint32_t n = 1;
+		while (n < tileCountX || n < tileCountY)n <<= 1;
+		for (uint32_t d = 0; d < n * n; ++d)
+		{
+			//convert distance on curve to (x,y)
+			uint32_t x = 0, y = 0, t = d;
+			for (uint32_t s = 1; s < n; s <<= 1)
+			{
+				uint32_t rx = 1 & (t / 2);
+				uint32_t ry = 1 & (t ^ rx);
+				if (ry == 0)
+				{
+					if (rx == 1)
+					{
+						x = s - 1 - x;
+						y = s - 1 - y;
+					}
+					std::swap(x, y);
+				}
+				x += s * rx;
+				y += s * ry;
+				t /= 4;
+			}
+			if (x < tileCountX && y < tileCountY)outList.push_back(std::make_pair(x, y));
+		}
+		break;
+	}
+
+	case NOISE_PATH_TRACER_TILE_ORDER::SCANLINE:
+	default:
+		for (uint32_t y = 0; y < tileCountY; ++y)
+			for (uint32_t x = 0; x < tileCountX; ++x)
+				outList.push_back(std::make_pair(x, y));
+		break;
+	}
+}
+
+void Noise3D::GI::PathTracer::mFunction_PrepareTileList()
+{
+	//back buffer's size, partition it into tiles
+	uint32_t w = m_pFinalRenderTarget->GetWidth();
+	uint32_t h = m_pFinalRenderTarget->GetHeight();
+	uint32_t tileCountX = (w + mTileWidth - 1) / mTileWidth;
+	uint32_t tileCountY = (h + mTileHeight - 1) / mTileHeight;
+	std::vector<std::pair<uint32_t, uint32_t>> tileCoordList;
+	mFunction_GenerateTileOrder(tileCountX, tileCountY, tileCoordList);
+
+	//distribute tiles round-robin, and store tiles of worker i contiguously as its initial range.
+	//(so the fronts of all workers advance along the tile order together)
+	mFunction_PrepareWorkerThreads();
+	uint32_t workerCount = mWorkerThreadList.size();
+	mTileList.clear();
+	mTileList.reserve(tileCoordList.size());
+	mTileInitialRangeList.resize(workerCount);
+	for (uint32_t workerId = 0; workerId < workerCount; ++workerId)
+	{
+		uint64_t rangeBegin = mTileList.size();
+		for (uint32_t i = workerId; i < tileCoordList.size(); i += workerCount)
+		{
+			//incomplete tile at the right/bottom edge are considered
+			uint32_t tileIdX = tileCoordList[i].first;
+			uint32_t tileIdY = tileCoordList[i].second;
+			N_RenderTileInfo info;
+			info.topLeftX = mTileWidth * tileIdX;
+			info.topLeftY = mTileHeight * tileIdY;
+			info.width = std::min<uint32_t>(mTileWidth, w - info.topLeftX);
+			info.height = std::min<uint32_t>(mTileHeight, h - info.topLeftY);
+			mTileList.push_back(info);
+		}
+		uint64_t rangeEnd = mTileList.size();
+		mTileInitialRangeList[workerId] = (rangeBegin << 32) | rangeEnd;
+	}
+}
+
+void Noise3D::GI::PathTracer::mFunction_DispatchPass()
+{
+	mWorkerJob = [this](uint32_t tileIndex) {PathTracer::_RenderTile(mTileList[tileIndex]); };
+	mIsDeadlineCheckedByWorkers = true;
+	mFunction_DispatchJob(mTileInitialRangeList);
+}
+
+void Noise3D::GI::PathTracer::mFunction_DispatchJob(const std::vector<uint64_t>& initialRangeList)
+{
+	uint32_t workerCount = mWorkerThreadList.size();
+	for (uint32_t workerId = 0; workerId < workerCount; ++workerId)
+	{
+		mTileRangeList[workerId].store(initialRangeList[workerId]);
+	}
+
+	//wake up the thread pool, and wait until all items are done (or render is terminated)
+	{
+		std::lock_guard<std::mutex> lock(mWorkerMutex);
+		mActiveWorkerCount = workerCount;
+		++mFrameId;
+	}
+	mWorkerWakeUpCV.notify_all();
+	{
+		std::unique_lock<std::mutex> lock(mWorkerMutex);
+		mFrameFinishedCV.wait(lock, [this]() {return mActiveWorkerCount == 0; });
+	}
+}
+
+bool Noise3D::GI::PathTracer::mFunction_IsDeadlineExceeded()
+{
+	return mIsDeadlineEnabled && std::chrono::steady_clock::now() >= mDeadline;
+}
+
+bool Noise3D::GI::PathTracer::mFunction_AcquireTile(uint32_t workerId, uint32_t & outTileIndex)
+{
+	//1. pop the front of its own range
+	std::atomic<uint64_t>& ownRange = mTileRangeList[workerId];
+	uint64_t range = ownRange.load();
+	while (uint32_t(range >> 32) < uint32_t(range))
+	{
+		uint64_t begin = range >> 32;
+		if (ownRange.compare_exchange_weak(range, ((begin + 1) << 32) | uint32_t(range)))
+		{
+			outTileIndex = uint32_t(begin);
+			return true;
+		}
+	}
+
+	//2. own range is empty, steal the back half of another worker's range.
+	//(nobody else writes an empty range, so it's safe to store the stolen range directly)
+	uint32_t workerCount = mTileRangeList.size();
+	for (uint32_t i = 1; i < workerCount; ++i)
 	{
-		//if render process is manually forced to terminate, then quit immediately.
+		std::atomic<uint64_t>& victimRange = mTileRangeList[(workerId + i) % workerCount];
+		range = victimRange.load();
+		while (uint32_t(range >> 32) < uint32_t(range))
+		{
+			uint64_t begin = range >> 32;
+			uint64_t end = uint32_t(range);
+			uint64_t stealCount = (end - begin + 1) / 2;
+			uint64_t stealBegin = end - stealCount;
+			if (victimRange.compare_exchange_weak(range, (begin << 32) | stealBegin))
+			{
+				ownRange.store(((stealBegin + 1) << 32) | end);
+				outTileIndex = uint32_t(stealBegin);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void Noise3D::GI::PathTracer::mFunction_ParallelFor(uint32_t itemCount, const std::function<void(uint32_t)>& job)
+{
+	if (itemCount == 0)return;
+
+	//contiguous initial ranges, idle workers steal from others
+	uint32_t workerCount = mWorkerThreadList.size();
+	std::vector<uint64_t> rangeList(workerCount);
+	for (uint32_t workerId = 0; workerId < workerCount; ++workerId)
+	{
+		uint64_t rangeBegin = uint64_t(itemCount) * workerId / workerCount;
+		uint64_t rangeEnd = uint64_t(itemCount) * (workerId + 1) / workerCount;
+		rangeList[workerId] = (rangeBegin << 32) | rangeEnd;
+	}
+	mWorkerJob = job;
+	mIsDeadlineCheckedByWorkers = false;
+	mFunction_DispatchJob(rangeList);
+}
+
+void Noise3D::GI::PathTracer::mFunction_AccumulateSample(uint32_t pixelIndex, const GI::Radiance & radiance)
+{
+	mAccumRadianceList[pixelIndex] += radiance;
+	double luminance = 0.2126 * radiance.x + 0.7152 * radiance.y + 0.0722 * radiance.z;
+	mAccumLuminanceList[pixelIndex] += luminance;
+	mAccumLuminanceSqList[pixelIndex] += luminance * luminance;
+	++mPixelSampleCountList[pixelIndex];
+}
+
+void Noise3D::GI::PathTracer::mFunction_ResolvePixel(uint32_t pixelX, uint32_t pixelY)
+{
+	uint32_t pixelIndex = pixelY * m_pFinalRenderTarget->GetWidth() + pixelX;
+	uint32_t sampleCount = mPixelSampleCountList[pixelIndex];
+	if (sampleCount == 0)return;
+	GI::Radiance pixelRadiance = mAccumRadianceList[pixelIndex];
+	pixelRadiance /= float(sampleCount);
+
+	//adaptive sampling: relative standard error of the mean luminance, sqrt(var/n)/mean
+	if (mProgressiveDesc.isAdaptiveSamplingEnabled && sampleCount > 1)
+	{
+		double n = double(sampleCount);
+		double mean = mAccumLuminanceList[pixelIndex] / n;
+		double variance = std::max<double>(mAccumLuminanceSqList[pixelIndex] / n - mean * mean, 0.0) * n / (n - 1.0);
+		float relativeError = float(std::sqrt(variance / n) / std::max<double>(mean, 1e-4));
+		mPixelRelativeErrorList[pixelIndex] = relativeError;
+		if (sampleCount >= mProgressiveDesc.adaptiveMinSamples &&
+			relativeError < mProgressiveDesc.adaptiveErrorThreshold)
+		{
+			mPixelConvergedList[pixelIndex] = 1;
+		}
+	}
+
+	//set one pixel at a time 
+	//(it's ok, one pixel is not easy to evaluate, setpixel won't be a big overhead)
+	Color4f tmpColor = Color4f(
+		std::max<float>(pixelRadiance.x, 0.0f), 
+		std::max<float>(pixelRadiance.y, 0.0f), 
+		std::max<float>(pixelRadiance.z, 0.0f), 
+		1.0f);
+	mHdrRenderTarget.at(pixelIndex) = tmpColor;
+
+	//(2019.4.19)log exposure to remap hdr(?) (perhaps tone mapping later)
+	Color4u outputColor(mFunction_ToneMapping(tmpColor));//convert to 8bitx4 color via constructor
+	m_pFinalRenderTarget->SetPixel(pixelX, pixelY, outputColor);
+}
+
+void Noise3D::GI::PathTracer::mFunction_DispatchPassWavefront()
+{
+	uint32_t w = m_pFinalRenderTarget->GetWidth();
+	uint32_t pixelCount = w * m_pFinalRenderTarget->GetHeight();
+
+	//pixels to sample in this pass. sample ids are decided before any batch is accumulated
+	std::vector<uint32_t> pixelList;
+	std::vector<uint32_t> baseSampleCountList;
+	for (uint32_t i = 0; i < pixelCount; ++i)
+	{
+		if (mPixelConvergedList[i])continue;
+		pixelList.push_back(i);
+		baseSampleCountList.push_back(mPixelSampleCountList[i]);
+	}
+
+	//scene bounds, to bin ray origins
+	const std::vector<N_BvhLinearNode>& nodeList = m_pCT->GetBvhTree().GetLinearNodeList();
+	mWavefrontSceneAabb = nodeList.empty() ? N_AABB() : nodeList.front().GetAABB();
+
+	//samples of a pixel are adjacent items (item = index in pixelList * mPassSampleCount + k),
+	//a batch is a range of items. time budget is checked between batches
+	uint64_t itemCount = uint64_t(pixelList.size()) * mPassSampleCount;
+	for (uint64_t firstItem = 0; firstItem < itemCount && !mIsRenderedFinished && !mFunction_IsDeadlineExceeded(); firstItem += mWavefrontBatchSize)
+	{
+		uint32_t pathCount = uint32_t(std::min<uint64_t>(mWavefrontBatchSize, itemCount - firstItem));
+		++mWavefrontStat.batchCount;
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		mFunction_WavefrontGenerate(pixelList, baseSampleCountList, firstItem, pathCount);
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		mWavefrontStat.generateSeconds += std::chrono::duration<float>(t1 - t0).count();
+
+		//all paths advance by one bounce per wave, until every path is terminated
+		while (!mWavefrontPathList.empty() && !mIsRenderedFinished)
+		{
+			++mWavefrontStat.waveCount;
+			mWavefrontStat.rayCount += mWavefrontPathList.size();
+
+			t0 = std::chrono::steady_clock::now();
+			mFunction_WavefrontSortRays();
+			t1 = std::chrono::steady_clock::now();
+			mWavefrontStat.sortSeconds += std::chrono::duration<float>(t1 - t0).count();
+
+			mFunction_WavefrontIntersect();
+			t0 = std::chrono::steady_clock::now();
+			mWavefrontStat.intersectSeconds += std::chrono::duration<float>(t0 - t1).count();
+
+			mFunction_WavefrontGroupHitsByMaterial();
+			t1 = std::chrono::steady_clock::now();
+			mWavefrontStat.sortSeconds += std::chrono::duration<float>(t1 - t0).count();
+
+			mFunction_WavefrontShade();
+			t0 = std::chrono::steady_clock::now();
+			mWavefrontStat.shadeSeconds += std::chrono::duration<float>(t0 - t1).count();
+		}
+
+		//samples of an interrupted batch are dropped
 		if (mIsRenderedFinished)break;
 
-		//lock mutex and retrieve undone job info from queue
-		//but only one thread can access queue at the same time
-		while (!mRenderTaskMutex.try_lock());
-		if (renderTaskList.empty())break;
-		N_RenderTileInfo info = renderTaskList.front();
-		renderTaskList.pop();
-		mRenderTaskMutex.unlock();
+		//accumulate in item order, so the sums don't depend on scheduling
+		t0 = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < pathCount; ++i)
+		{
+			uint32_t listIndex = uint32_t((firstItem + i) / mPassSampleCount);
+			mFunction_AccumulateSample(pixelList[listIndex], mWavefrontRadianceList[i]);
+		}
+		t1 = std::chrono::steady_clock::now();
+		mWavefrontStat.resolveSeconds += std::chrono::duration<float>(t1 - t0).count();
+	}
+
+	//adaptive sampling state and output of sampled pixels
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	uint32_t chunkCount = (uint32_t(pixelList.size()) + c_wavefrontChunkSize - 1) / c_wavefrontChunkSize;
+	mFunction_ParallelFor(chunkCount, [&](uint32_t chunkId)
+	{
+		uint32_t end = std::min<uint32_t>((chunkId + 1) * c_wavefrontChunkSize, pixelList.size());
+		for (uint32_t i = chunkId * c_wavefrontChunkSize; i < end; ++i)
+		{
+			mFunction_ResolvePixel(pixelList[i] % w, pixelList[i] / w);
+		}
+	});
+	mWavefrontStat.resolveSeconds += std::chrono::duration<float>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void Noise3D::GI::PathTracer::mFunction_WavefrontGenerate(const std::vector<uint32_t>& pixelList, const std::vector<uint32_t>& baseSampleCountList, uint64_t firstItem, uint32_t pathCount)
+{
+	Camera* pCam = Noise3D::GetScene()->GetCamera();
+	uint32_t totalWidth = m_pFinalRenderTarget->GetWidth();
+	uint32_t totalHeight = m_pFinalRenderTarget->GetHeight();
+	mWavefrontPathList.resize(pathCount);
+	mWavefrontRadianceList.assign(pathCount, GI::Radiance(0, 0, 0));
+
+	uint32_t chunkCount = (pathCount + c_wavefrontChunkSize - 1) / c_wavefrontChunkSize;
+	mFunction_ParallelFor(chunkCount, [&](uint32_t chunkId)
+	{
+		uint32_t end = std::min<uint32_t>((chunkId + 1) * c_wavefrontChunkSize, pathCount);
+		for (uint32_t i = chunkId * c_wavefrontChunkSize; i < end; ++i)
+		{
+			uint64_t item = firstItem + i;
+			uint32_t listIndex = uint32_t(item / mPassSampleCount);
+			uint32_t pixelIndex = pixelList[listIndex];
+			uint32_t sampleId = baseSampleCountList[listIndex] + uint32_t(item % mPassSampleCount);
+			uint32_t pixelX = pixelIndex % totalWidth;
+			uint32_t pixelY = pixelIndex / totalWidth;
+
+			//same primary ray as TILED mode
+			RandomSampleGenerator::SeedThreadLocalEngine(
+				RandomSampleGenerator::ComputeSeed(mRandomSeed, pixelIndex, sampleId));
+			RandomSampleGenerator g;
+			PixelCoord2 pixelCoord = PixelCoord2(float(pixelX), float(pixelY));
+			if (mIsPixelJitterEnabled)
+			{
+				pixelCoord.x += g.CanonicalReal();
+				pixelCoord.y += g.CanonicalReal();
+			}
+
+			N_WavefrontPath& path = mWavefrontPathList[i];
+			path.param = N_TraceRayParam();
+			path.param.ray = pCam->FireRay_WorldSpace(pixelCoord, totalWidth, totalHeight);
+			path.throughput = GI::Radiance(1.0f, 1.0f, 1.0f);
+			path.pixelIndex = pixelIndex;
+			path.sampleId = sampleId;
+			path.slot = i;
+			path.engine = RandomSampleGenerator::GetThreadLocalEngine();
+			path.samplerDimension = 0;
+		}
+	});
+}
+
+void Noise3D::GI::PathTracer::mFunction_WavefrontSortRays()
+{
+	//bin = direction octant(3 bits) + origin cell of a 8x8x8 grid over the scene bounds(9 bits).
+	//counting sort is stable, and rays in a bin are coherent enough to be traced as packets
+	const uint32_t c_cellResolution = 8;
+	const uint32_t c_binCount = 8 * c_cellResolution * c_cellResolution * c_cellResolution;
+	uint32_t pathCount = mWavefrontPathList.size();
+
+	Vec3 aabbMin = mWavefrontSceneAabb.min;
+	Vec3 cellScale = Vec3(0, 0, 0);
+	if (mWavefrontSceneAabb.IsValid())
+	{
+		Vec3 extent = mWavefrontSceneAabb.max - mWavefrontSceneAabb.min;
+		cellScale.x = extent.x > 0.0f ? float(c_cellResolution) / extent.x : 0.0f;
+		cellScale.y = extent.y > 0.0f ? float(c_cellResolution) / extent.y : 0.0f;
+		cellScale.z = extent.z > 0.0f ? float(c_cellResolution) / extent.z : 0.0f;
+	}
+	auto cellCoord = [&](float x, float origin, float scale)->uint32_t
+	{
+		float c = (x - origin) * scale;
+		if (!(c > 0.0f))return 0;
+		return std::min<uint32_t>(uint32_t(c), c_cellResolution - 1);
+	};
+
+	std::vector<uint16_t> binList(pathCount);
+	std::vector<uint32_t> binOffsetList(c_binCount + 1, 0);
+	for (uint32_t i = 0; i < pathCount; ++i)
+	{
+		const N_Ray& ray = mWavefrontPathList[i].param.ray;
+		uint32_t octant = (ray.dir.x < 0.0f ? 1 : 0) | (ray.dir.y < 0.0f ? 2 : 0) | (ray.dir.z < 0.0f ? 4 : 0);
+		uint32_t cell =
+			(cellCoord(ray.origin.x, aabbMin.x, cellScale.x) * c_cellResolution +
+			cellCoord(ray.origin.y, aabbMin.y, cellScale.y)) * c_cellResolution +
+			cellCoord(ray.origin.z, aabbMin.z, cellScale.z);
+		uint16_t bin = uint16_t(octant * c_cellResolution * c_cellResolution * c_cellResolution + cell);
+		binList[i] = bin;
+		++binOffsetList[bin + 1];
+	}
+	for (uint32_t b = 0; b < c_binCount; ++b)binOffsetList[b + 1] += binOffsetList[b];
+
+	mWavefrontPathListBack.resize(pathCount);
+	for (uint32_t i = 0; i < pathCount; ++i)
+	{
+		mWavefrontPathListBack[binOffsetList[binList[i]]++] = mWavefrontPathList[i];
+	}
+	std::swap(mWavefrontPathList, mWavefrontPathListBack);
+}
+
+void Noise3D::GI::PathTracer::mFunction_WavefrontIntersect()
+{
+	uint32_t pathCount = mWavefrontPathList.size();
+	mWavefrontHitList.assign(pathCount, N_RayHitInfoForPathTracer(nullptr, N_RayHitInfo(-123456789.0f, Vec3(), Vec3(), Vec2())));
+	if (m_pCT->GetBvhTree().GetLinearObjectList().empty())return;//everything misses
+
+	//adjacent (binned) rays are intersected as ray packets
+	uint32_t chunkCount = (pathCount + c_wavefrontChunkSize - 1) / c_wavefrontChunkSize;
+	mFunction_ParallelFor(chunkCount, [&](uint32_t chunkId)
+	{
+		std::vector<N_RayHitInfoForPathTracer> packetHitInfoList;
+		uint32_t end = std::min<uint32_t>((chunkId + 1) * c_wavefrontChunkSize, pathCount);
+		for (uint32_t first = chunkId * c_wavefrontChunkSize; first < end; first += N_RayPacket::c_maxRayCount)
+		{
+			N_RayPacket packet;
+			packet.rayCount = std::min<uint32_t>(N_RayPacket::c_maxRayCount, end - first);
+			for (uint32_t lane = 0; lane < packet.rayCount; ++lane)packet.SetRay(lane, mWavefrontPathList[first + lane].param.ray);
+
+			uint32_t hitMask = m_pCT->IntersectRayPacketSceneForPathTracer_ClosestHit(packet, packetHitInfoList);
+			for (uint32_t lane = 0; lane < packet.rayCount; ++lane)
+			{
+				if (hitMask & (1u << lane))mWavefrontHitList[first + lane] = packetHitInfoList[lane];
+			}
+		}
+	});
+}
+
+void Noise3D::GI::PathTracer::mFunction_WavefrontGroupHitsByMaterial()
+{
+	//misses first, then hits of the same material are adjacent (so are the shader branches and textures they use).
+	//order only affects scheduling, shading of a path doesn't depend on it
+	uint32_t pathCount = mWavefrontPathList.size();
+	std::vector<std::pair<GI::PbrtMaterial*, uint32_t>> keyList(pathCount);
+	for (uint32_t i = 0; i < pathCount; ++i)
+	{
+		GI::IGiRenderable* pObj = mWavefrontHitList[i].pHitObj;
+		keyList[i] = std::make_pair(pObj != nullptr ? pObj->GetPbrtMaterial() : nullptr, i);
+	}
+	std::sort(keyList.begin(), keyList.end(),
+		[](const std::pair<GI::PbrtMaterial*, uint32_t>& a, const std::pair<GI::PbrtMaterial*, uint32_t>& b)->bool
+	{
+		if (a.first != b.first)return std::less<GI::PbrtMaterial*>()(a.first, b.first);
+		return a.second < b.second;
+	});
+
+	mWavefrontShadeOrderList.resize(pathCount);
+	for (uint32_t i = 0; i < pathCount; ++i)mWavefrontShadeOrderList[i] = keyList[i].second;
+}
+
+void Noise3D::GI::PathTracer::mFunction_WavefrontShade()
+{
+	uint32_t pathCount = mWavefrontPathList.size();
+	mWavefrontAliveList.assign(pathCount, 0);
+	mWavefrontPathListBack.resize(pathCount);
+
+	uint32_t chunkCount = (pathCount + c_wavefrontChunkSize - 1) / c_wavefrontChunkSize;
+	mFunction_ParallelFor(chunkCount, [&](uint32_t chunkId)
+	{
+		uint32_t end = std::min<uint32_t>((chunkId + 1) * c_wavefrontChunkSize, pathCount);
+		for (uint32_t k = chunkId * c_wavefrontChunkSize; k < end; ++k)
+		{
+			uint32_t i = mWavefrontShadeOrderList[k];
+			const N_WavefrontPath& path = mWavefrontPathList[i];
+			const N_RayHitInfoForPathTracer& hitInfo = mWavefrontHitList[i];
+			mFunction_SeedPathVertex(path);
+
+			N_TraceRayPayload payload;
+			if (hitInfo.pHitObj == nullptr)
+			{
+				m_pShader->Miss(path.param, payload);
+				mWavefrontRadianceList[path.slot] += path.throughput * payload.radiance;
+				continue;
+			}
 
-		//start to do real thing
-		PathTracer::_RenderTile(std::move(info));
+			//continuation is written to the same index of the back list
+			N_WavefrontPath& nextPath = mWavefrontPathListBack[i];
+			nextPath = path;
+			bool isAlive = m_pShader->ClosestHit_Wavefront(path.param, hitInfo, payload, nextPath.param, nextPath.throughput);
+			nextPath.engine = RandomSampleGenerator::GetThreadLocalEngine();
+			nextPath.samplerDimension = RandomSampleGenerator::GetThreadLocalSamplerDimension();
+			mWavefrontRadianceList[path.slot] += path.throughput * payload.radiance;
+			mWavefrontAliveList[i] = isAlive ? 1 : 0;
+		}
+	});
+
+	//compact surviving paths into the next wave. a path beyond max bounces
+	//gets ambient radiance instead (same as TraceRay())
+	uint32_t aliveCount = 0;
+	for (uint32_t i = 0; i < pathCount; ++i)
+	{
+		if (!mWavefrontAliveList[i])continue;
+		const N_WavefrontPath& nextPath = mWavefrontPathListBack[i];
+		if (nextPath.param.bounces > int(mMaxBounces))
+		{
+			mWavefrontRadianceList[nextPath.slot] += nextPath.throughput * mAmbientRadiance;
+			continue;
+		}
+		mWavefrontPathList[aliveCount++] = nextPath;
+	}
+	mWavefrontPathList.resize(aliveCount);
+}
+
+void Noise3D::GI::PathTracer::mFunction_SeedPathVertex(const N_WavefrontPath & path)
+{
+	//random sequence and sampler dimension continue from the previous vertex of the sample,
+	//the same as a path traced in one go by TILED mode (and independent of which wave/thread shades the vertex)
+	RandomSampleGenerator::SetThreadLocalEngine(path.engine);
+
+	uint32_t totalWidth = m_pFinalRenderTarget->GetWidth();
+	RandomSampleGenerator::SetThreadLocalSampler(m_pSampler, path.pixelIndex % totalWidth, path.pixelIndex / totalWidth,
+		mRandomSeed, path.sampleId, path.samplerDimension);
+}
+
+void Noise3D::GI::PathTracer::_RenderTileWorkerThread(uint32_t workerId, uint64_t initialFrameId)
+{
+	//persistent worker: sleep until a new frame is dispatched (or the pool is destroyed)
+	uint64_t lastFrameId = initialFrameId;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mWorkerMutex);
+			mWorkerWakeUpCV.wait(lock, [&]() {return mIsWorkerShutdown || mFrameId != lastFrameId; });
+			if (mIsWorkerShutdown)return;
+			lastFrameId = mFrameId;
+		}
+
+		//render tiles (or other job items) until no one is left.
+		//if render process is manually forced to terminate (or time is up), then quit immediately.
+		uint32_t tileIndex = 0;
+		while (!mIsRenderedFinished && !(mIsDeadlineCheckedByWorkers && mFunction_IsDeadlineExceeded()) &&
+			mFunction_AcquireTile(workerId, tileIndex))
+		{
+			mWorkerJob(tileIndex);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mWorkerMutex);
+			if (--mActiveWorkerCount == 0)mFrameFinishedCV.notify_all();
+		}
 	}
-	mRenderTaskMutex.unlock();
 }
 
 void Noise3D::GI::PathTracer::_RenderTile(const N_RenderTileInfo & info)
 {
 	Camera* pCam = Noise3D::GetScene()->GetCamera();
+	uint32_t totalWidth = m_pFinalRenderTarget->GetWidth();
+	uint32_t totalHeight = m_pFinalRenderTarget->GetHeight();
 	for (uint32_t x = 0; x < info.width; ++x)
 	{
 		for (uint32_t y = 0; y < info.height; ++y)
 		{
 			uint32_t globalPixelX = info.topLeftX + x;
 			uint32_t globalPixelY = info.topLeftY + y;
-			uint32_t totalWidth = m_pFinalRenderTarget->GetWidth();
-			uint32_t totalHeight = m_pFinalRenderTarget->GetHeight();
+			uint32_t pixelIndex = globalPixelY * totalWidth + globalPixelX;
+			if (mPixelConvergedList[pixelIndex])continue;
 
-			//start tracing a ray with payload
-			N_TraceRayPayload payload;
-			N_TraceRayParam param;
-			param.bounces = 0;
-			param.travelledDistance = 0.0f;
-			param.ray = pCam->FireRay_WorldSpace(PixelCoord2(float(globalPixelX), float(globalPixelY)),totalWidth, totalHeight);
-			param.isInsideObject = false;
-			param.isShadowRay = false;
-			PathTracer::TraceRay(param, payload);
-
-			//set one pixel at a time 
-			//(it's ok, one pixel is not easy to evaluate, setpixel won't be a big overhead)
-			Color4f tmpColor = Color4f(
-				std::max<float>(payload.radiance.x, 0.0f), 
-				std::max<float>(payload.radiance.y, 0.0f), 
-				std::max<float>(payload.radiance.z, 0.0f), 
-				1.0f);
-			mHdrRenderTarget.at(globalPixelY * totalWidth + globalPixelX) = tmpColor;
-
-			//(2019.4.19)log exposure to remap hdr(?) (perhaps tone mapping later)
-			Color4u outputColor(mFunction_ToneMapping(tmpColor));//convert to 8bitx4 color via constructor
-			m_pFinalRenderTarget->SetPixel(info.topLeftX + x, info.topLeftY + y, outputColor);
+			uint32_t sampleIdBegin = mPixelSampleCountList[pixelIndex];
+			uint32_t sampleIdEnd = sampleIdBegin + mPassSampleCount;
+			for (uint32_t sampleId = sampleIdBegin; sampleId < sampleIdEnd; ++sampleId)
+			{
+				//samplers of soft shaders use the thread-local engine, re-seed it for each pixel sample
+				//(so a sample doesn't depend on which pass it's rendered in)
+				RandomSampleGenerator::SeedThreadLocalEngine(
+					RandomSampleGenerator::ComputeSeed(mRandomSeed, pixelIndex, sampleId));
+				RandomSampleGenerator g;
+
+				//pixel samples are successive points of the pixel's low discrepancy sequence
+				RandomSampleGenerator::SetThreadLocalSampler(m_pSampler, globalPixelX, globalPixelY, mRandomSeed, sampleId);
+
+				//jitter inside the pixel (only when there are multiple samples)
+				PixelCoord2 pixelCoord = PixelCoord2(float(globalPixelX), float(globalPixelY));
+				if (mIsPixelJitterEnabled)
+				{
+					pixelCoord.x += g.CanonicalReal();
+					pixelCoord.y += g.CanonicalReal();
+				}
+
+				//start tracing a ray with payload
+				N_TraceRayPayload payload;
+				N_TraceRayParam param;
+				param.bounces = 0;
+				param.travelledDistance = 0.0f;
+				param.ray = pCam->FireRay_WorldSpace(pixelCoord, totalWidth, totalHeight);
+				param.isInsideObject = false;
+				param.isShadowRay = false;
+				PathTracer::TraceRay(param, payload);
+				mFunction_AccumulateSample(pixelIndex, payload.radiance);
+			}
+			mFunction_ResolvePixel(globalPixelX, globalPixelY);
 		}
 	}
 }
@@ -355,15 +1036,13 @@ void Noise3D::GI::PathTracer::TraceRay(const N_TraceRayParam& param, N_TraceRayP
 		return;
 	}
 
-	//intersect the ray with the scene and get results
-	N_RayHitResultForPathTracer hitResult;
-	m_pCT->IntersectRaySceneForPathTracer(param.ray, hitResult);
+	//intersect the ray with the scene and get the closest hit
+	N_RayHitInfoForPathTracer info(nullptr, N_RayHitInfo(-123456789.0f, Vec3(), Vec3(), Vec2()));
+	bool isHit = m_pCT->IntersectRaySceneForPathTracer_ClosestHit(param.ray, info);
 
 	//call shader. Radiance and other infos are carried by Payload reference.
-	if (hitResult.HasAnyHit())
+	if (isHit)
 	{
-		int index = hitResult.GetClosestHitIndex();
-		N_RayHitInfoForPathTracer& info = hitResult.hitList.at(index);
 
 		//update ray's travelled distance
 		//(2019.5.16, well this const Param& actually never update the travelledDistance,
@@ -25,6 +25,26 @@ namespace Noise3D
 			SPHERICAL_HARMONIC
 		};
 
+		//the order render tiles are dispatched in
+		enum class NOISE_PATH_TRACER_TILE_ORDER
+		{
+			SCANLINE,//row by row
+			SPIRAL,//from the center of image outwards (interesting part first)
+			HILBERT//along hilbert curve (tiles rendered at the same time are spatially close, cache friendly)
+		};
+
+		//how a pass of samples is executed
+		enum class NOISE_PATH_TRACER_EXECUTION_MODE
+		{
+			//each worker renders whole tiles, a sample is traced to the end (recursively via TraceRay()) before the next one
+			TILED,
+
+			//all paths of a batch advance together by one bounce per wave: rays are binned by direction octant
+			//and origin cell, intersected (as ray packets), then shaded in batches grouped by material.
+			//continuation rays of IPathTracerSoftShader::ClosestHit_Wavefront() form the next wave
+			WAVEFRONT
+		};
+
 		//input param for TraceRay()
 		struct N_TraceRayParam
 		{
@@ -37,7 +57,8 @@ namespace Noise3D
 				skyLightType(SKY_DOME),
 				isIndirectLightOnly(false),
 				isShadowRay(false), 
-				shadowRayLightSourceId(-1){}
+				shadowRayLightSourceId(-1),
+				diffuseLobePdf(0.0f){}
 
 			int bounces;//recursion count
 			float travelledDistance;
@@ -48,6 +69,7 @@ namespace Noise3D
 			bool isShadowRay;//for local lighting/area lighting
 			bool isIndirectLightOnly;//for only indirect
 			int shadowRayLightSourceId;//for shadow ray
+			float diffuseLobePdf;//pdf(solid angle) of the diffuse bounce that spawned the ray, 0 for other rays. for MIS of sky light
 		};
 
 		//output for TraceRay();
@@ -59,19 +81,120 @@ namespace Noise3D
 			//int bounces;
 		};
 
+		//progress of RenderProgressive(), passed to the per-pass callback
+		struct N_ProgressiveRenderStatus
+		{
+			N_ProgressiveRenderStatus() :
+				passCount(0),
+				samplesPerPixel(0),
+				activePixelCount(0),
+				totalSampleCount(0),
+				maxRelativeError(0.0f),
+				elapsedSeconds(0.0f) {}
+
+			uint32_t passCount;//finished passes
+			uint32_t samplesPerPixel;//max accumulated sample count of a pixel
+			uint32_t activePixelCount;//pixels still being sampled (adaptive sampling stops converged ones)
+			uint64_t totalSampleCount;//all primary rays traced so far
+			float maxRelativeError;//max relative standard error of active pixels' luminance (adaptive sampling only)
+			float elapsedSeconds;//wall-clock time since RenderProgressive() was called
+		};
+
+		//param of RenderProgressive(). rendering stops when any limit is reached
+		struct N_ProgressiveRenderDesc
+		{
+			N_ProgressiveRenderDesc() :
+				samplesPerPass(1),
+				maxSamplesPerPixel(0),
+				timeBudgetSeconds(0.0f),
+				isAdaptiveSamplingEnabled(false),
+				adaptiveErrorThreshold(0.02f),
+				adaptiveMinSamples(16),
+				passCallback(nullptr) {}
+
+			uint32_t samplesPerPass;//samples added to each pixel in a pass
+			uint32_t maxSamplesPerPixel;//0 for unlimited
+			float timeBudgetSeconds;//wall-clock budget, 0 for unlimited. tiles started before deadline are finished
+			bool isAdaptiveSamplingEnabled;//stop sampling a pixel when its estimated error is below threshold
+			float adaptiveErrorThreshold;//relative standard error of the mean luminance, e.g. 0.02 (2%)
+			uint32_t adaptiveMinSamples;//a pixel can't be converged before this sample count
+			std::function<bool(const N_ProgressiveRenderStatus&)> passCallback;//called after each pass, return false to stop
+		};
+
+		//where time goes in WAVEFRONT mode (accumulated over all passes of the last Render()/RenderProgressive())
+		struct N_WavefrontRenderStatistics
+		{
+			N_WavefrontRenderStatistics() :
+				batchCount(0),
+				waveCount(0),
+				rayCount(0),
+				generateSeconds(0.0f),
+				sortSeconds(0.0f),
+				intersectSeconds(0.0f),
+				shadeSeconds(0.0f),
+				resolveSeconds(0.0f) {}
+
+			uint32_t batchCount;//path batches (a pass is split into batches of at most SetWavefrontBatchSize() paths)
+			uint32_t waveCount;//sort-intersect-shade iterations of all batches
+			uint64_t rayCount;//rays intersected with the scene (primary and continuation rays)
+			float generateSeconds;//primary ray generation
+			float sortSeconds;//binning rays by octant/origin cell, grouping hits by material
+			float intersectSeconds;
+			float shadeSeconds;//ClosestHit/Miss shaders
+			float resolveSeconds;//accumulating samples into pixels, adaptive sampling and pixel output
+		};
+
 		class /*_declspec(dllexport)*/ PathTracer
 		{
 		public:
 
 			//entry of rendering a single frame to render target
-			//first rebuild BVH of the singleton of CollisionTestor
-			//then dispatch render task to render a tile (might be multi-threaded one day)
+			//first refit BVH of the singleton of CollisionTestor
+			//then dispatch render tiles to the worker threads, and wait until they are done
 			//implementation of soft shaders will be passed in, and called by this path tracer render pipeline
 			void Render(Noise3D::SceneNode* pNode, IPathTracerSoftShader* pShaders);
 
+			//render in passes, samples are accumulated into the HDR render target (and the output render target
+			//is updated after each pass), until max samples/time budget is reached, all pixels have converged,
+			//the callback returns false or TerminateRenderTask() is called.
+			//the image only depends on random seed and total sample count, not on how samples are split into passes
+			void RenderProgressive(Noise3D::SceneNode* pNode, IPathTracerSoftShader* pShaders, const N_ProgressiveRenderDesc& desc);
+
+			//status of current (or last) progressive render
+			N_ProgressiveRenderStatus GetProgressiveRenderStatus();
+
 			//pixel size of a render tile
 			void SetRenderTileSize(uint32_t width, uint32_t height);
 
+			//HILBERT by default
+			void SetRenderTileOrder(NOISE_PATH_TRACER_TILE_ORDER order);
+
+			//worker thread count of the (persistent) render thread pool.
+			//0 for std::thread::hardware_concurrency() (default). takes effect in next Render()
+			void SetWorkerThreadCount(uint32_t count);
+
+			//actual worker thread count of the thread pool (0 before the first Render())
+			uint32_t GetWorkerThreadCount();
+
+			//TILED by default. takes effect in next Render()
+			void SetExecutionMode(NOISE_PATH_TRACER_EXECUTION_MODE mode);
+
+			NOISE_PATH_TRACER_EXECUTION_MODE GetExecutionMode();
+
+			//max paths in flight in WAVEFRONT mode (memory of path/hit queues grows with it). 1<<18 by default
+			void SetWavefrontBatchSize(uint32_t pathCount);
+
+			//per-stage timings of the last render in WAVEFRONT mode
+			N_WavefrontRenderStatistics GetWavefrontStatistics();
+
+			//random engine of each pixel is seeded with hash(seed, pixel), so the rendered image
+			//only depends on this seed, no matter which thread renders the pixel
+			void SetRandomSeed(uint64_t seed);
+
+			//low discrepancy sampler used by batch sampling functions of soft shaders (shared by all worker threads).
+			//nullptr for pure random sampling (default)
+			void SetSampler(const ISampler* pSampler);
+
 			//default render target will be created at initialization automatically
 			Texture2D* GetRenderTarget();
 
@@ -96,6 +219,12 @@ namespace Noise3D
 
 			uint32_t GetMaxSpecularScatterSampleCount();
 
+			//primary rays per pixel (jittered in the pixel if more than 1), results are averaged.
+			//the quality knob of iterative path integrators (1 by default)
+			void SetSamplesPerPixel(uint32_t spp);
+
+			uint32_t GetSamplesPerPixel();
+
 			//ray's max travel distance
 			void SetRayMaxTravelDist(float dist);
 
@@ -131,14 +260,26 @@ namespace Noise3D
 				uint32_t height;
 			};
 
-			//4 or 8 or xx workers thread run independently,
-			//actively pop out task and run it, until no task left
-			void _RenderTileWorkerThread(std::queue<N_RenderTileInfo>& renderTaskList);
+			//persistent worker thread of the thread pool. sleeps until a frame is dispatched, then
+			//pops tiles from its own range and steals from others' until no tile is left
+			void _RenderTileWorkerThread(uint32_t workerId, uint64_t initialFrameId);
 
 			//render an image tile (let's say, 16x16, could be parallelized using multi-thread)
 			//task:fire and trace rays(could be multi-threaded), 
 			void _RenderTile(const N_RenderTileInfo& info);
 
+			//a path in the wavefront queue, the ray of 'param' is the next one to intersect
+			struct N_WavefrontPath
+			{
+				N_TraceRayParam param;
+				GI::Radiance throughput;//product of BSDF*cos/pdf of previous vertices
+				uint32_t pixelIndex;
+				uint32_t sampleId;
+				uint32_t slot;//index of the path's radiance in the batch
+				Pcg32RandomEngine engine;//random sequence of the sample, continued at next vertex
+				uint32_t samplerDimension;//next dimension of the sample's sampler sequence
+			};
+
 		private:
 
 			friend SceneManager;//for external init
@@ -151,8 +292,6 @@ namespace Noise3D
 
 		private:
 
-			static const uint32_t c_parallelWorkerThreadCount = 8;
-
 			//extern init by SceneManager
 			bool	NOISE_MACRO_FUNCTION_EXTERN_CALL mFunction_Init(uint32_t pixelWidth, uint32_t pixelHeight);
 
@@ -160,6 +299,58 @@ namespace Noise3D
 
 			Color4f mFunction_ToneMapping(Color4f c);
 
+			//(re-)create the thread pool if requested worker count changed
+			void mFunction_PrepareWorkerThreads();
+
+			//wake up and join all worker threads
+			void mFunction_DestroyWorkerThreads();
+
+			//tile coordinates (in tiles) in the order of dispatching
+			void mFunction_GenerateTileOrder(uint32_t tileCountX, uint32_t tileCountY, std::vector<std::pair<uint32_t, uint32_t>>& outList);
+
+			//get index of next tile to render for given worker (lock-free). return false if all tiles are taken
+			bool mFunction_AcquireTile(uint32_t workerId, uint32_t& outTileIndex);
+
+			//partition render target into tiles, and assign initial tile ranges of workers
+			void mFunction_PrepareTileList();
+
+			//restore initial tile ranges, wake up the thread pool, and wait until all tiles are rendered
+			void mFunction_DispatchPass();
+
+			//true if time budget of progressive rendering is used up
+			bool mFunction_IsDeadlineExceeded();
+
+			//wake up the thread pool to run 'mWorkerJob' on items of given initial ranges (packed as in mTileRangeList),
+			//and wait until all items are done
+			void mFunction_DispatchJob(const std::vector<uint64_t>& initialRangeList);
+
+			//run job(itemIndex) for items [0, itemCount) on the thread pool (work stealing), wait until they are done.
+			//(not interrupted by the deadline, only by TerminateRenderTask())
+			void mFunction_ParallelFor(uint32_t itemCount, const std::function<void(uint32_t)>& job);
+
+			//add a sample to the pixel's accumulation buffers
+			void mFunction_AccumulateSample(uint32_t pixelIndex, const GI::Radiance& radiance);
+
+			//update adaptive sampling state of the pixel, and output its mean radiance to render targets
+			void mFunction_ResolvePixel(uint32_t pixelX, uint32_t pixelY);
+
+			//WAVEFRONT mode: render a pass of all active pixels in batches of paths
+			void mFunction_DispatchPassWavefront();
+
+			//WAVEFRONT stages of a batch
+			void mFunction_WavefrontGenerate(const std::vector<uint32_t>& pixelList, const std::vector<uint32_t>& baseSampleCountList, uint64_t firstItem, uint32_t pathCount);
+
+			void mFunction_WavefrontSortRays();
+
+			void mFunction_WavefrontIntersect();
+
+			void mFunction_WavefrontGroupHitsByMaterial();
+
+			void mFunction_WavefrontShade();
+
+			//restore random engine and sampler of calling thread for a path vertex (independent of scheduling)
+			void mFunction_SeedPathVertex(const N_WavefrontPath& path);
+
 
 			std::vector<Color4f> mHdrRenderTarget;//temporary internal HDR render target
 
@@ -167,9 +358,58 @@ namespace Noise3D
 
 			IPathTracerSoftShader* m_pShader;//path tracer's soft shader
 
-			//multi-thread
-			std::thread mWorkerThreadArr[c_parallelWorkerThreadCount];
-			std::mutex mRenderTaskMutex;
+			//multi-thread (persistent thread pool)
+			std::vector<std::thread> mWorkerThreadList;
+			std::mutex mWorkerMutex;//guards frame id, active worker count and shut down flag
+			std::condition_variable mWorkerWakeUpCV;//a new frame is dispatched, or shutting down
+			std::condition_variable mFrameFinishedCV;//all workers have finished current frame
+			uint64_t mFrameId;
+			uint32_t mActiveWorkerCount;
+			bool mIsWorkerShutdown;
+			uint32_t mRequestedWorkerThreadCount;//0 for hardware concurrency
+
+			//tiles of current frame. worker i initially owns a contiguous range of it,
+			//range is packed as (begin<<32 | end) in an atomic, so the owner pops the front and others steal the back
+			std::vector<N_RenderTileInfo> mTileList;
+			std::vector<std::atomic<uint64_t>> mTileRangeList;
+			std::function<void(uint32_t)> mWorkerJob;//task of current dispatch, called with an item(tile, ray chunk...) index
+			bool mIsDeadlineCheckedByWorkers;//tiles can be skipped when time is up, wavefront stages can't
+			NOISE_PATH_TRACER_TILE_ORDER mTileOrder;
+
+			uint64_t mRandomSeed;
+
+			const ISampler* m_pSampler;
+
+			uint32_t mSamplesPerPixel;
+
+			//progressive rendering. accumulation buffers are per pixel, and a pixel is only
+			//touched by the thread which renders its tile in a pass
+			std::vector<GI::Radiance> mAccumRadianceList;//sum of sample radiance
+			std::vector<double> mAccumLuminanceList;//sum of sample luminance (for variance estimate)
+			std::vector<double> mAccumLuminanceSqList;//sum of squared sample luminance
+			std::vector<uint32_t> mPixelSampleCountList;
+			std::vector<float> mPixelRelativeErrorList;//updated after each pass of the pixel (adaptive sampling)
+			std::vector<uint8_t> mPixelConvergedList;//not vector<bool>, pixels are written concurrently
+			std::vector<uint64_t> mTileInitialRangeList;//initial tile ranges of workers, restored every pass
+			N_ProgressiveRenderDesc mProgressiveDesc;
+			N_ProgressiveRenderStatus mProgressiveStatus;
+			uint32_t mPassSampleCount;//samples added to each pixel in current pass
+			bool mIsPixelJitterEnabled;
+			bool mIsDeadlineEnabled;
+			std::chrono::steady_clock::time_point mDeadline;
+
+			//wavefront mode. queues are kept between batches/frames to avoid re-allocation
+			NOISE_PATH_TRACER_EXECUTION_MODE mExecutionMode;
+			uint32_t mWavefrontBatchSize;
+			std::vector<N_WavefrontPath> mWavefrontPathList;//current wave
+			std::vector<N_WavefrontPath> mWavefrontPathListBack;//binned copy, then the next wave
+			std::vector<N_RayHitInfoForPathTracer> mWavefrontHitList;//hit of each path of current wave (pHitObj==nullptr for miss)
+			std::vector<uint32_t> mWavefrontShadeOrderList;//paths of current wave grouped by material (misses first)
+			std::vector<uint8_t> mWavefrontAliveList;//path continues after shading
+			std::vector<GI::Radiance> mWavefrontRadianceList;//radiance of each path (slot) of the batch
+			N_AABB mWavefrontSceneAabb;//for origin cells
+			N_WavefrontRenderStatistics mWavefrontStat;
+			static const uint32_t c_wavefrontChunkSize = 256;//paths per job item of wavefront stages (multiple of ray packet size)
 
 			Noise3D::CollisionTestor* m_pCT;//singleton of collision testor
 
@@ -185,7 +425,7 @@ namespace Noise3D
 
 			uint32_t mTileHeight;
 
-			bool mIsRenderedFinished;
+			std::atomic<bool> mIsRenderedFinished;
 
 			//log exposure
 			float mLogExposurePreAmp;
@@ -12,10 +12,25 @@
 using namespace Noise3D;
 
 Noise3D::GI::PathTracerStandardShader::PathTracerStandardShader():
-	mSkyLightMultiplier(1.0f)
+	m_pSkyDomeTex(nullptr),
+	m_pSkyBoxTex(nullptr),
+	mSkyLightMultiplier(1.0f),
+	mIntegrator(NOISE_PATH_TRACER_INTEGRATOR::BRANCHING_RECURSION),
+	mRussianRouletteStartBounce(3),
+	mIsSkyLightImportanceSamplingEnabled(true)
 {
 }
 
+void Noise3D::GI::PathTracerStandardShader::SetIntegrator(NOISE_PATH_TRACER_INTEGRATOR integrator)
+{
+	mIntegrator = integrator;
+}
+
+void Noise3D::GI::PathTracerStandardShader::SetRussianRouletteStartBounce(uint32_t bounce)
+{
+	mRussianRouletteStartBounce = bounce;
+}
+
 void Noise3D::GI::PathTracerStandardShader::SetSkyLightMultiplier(float multiplier)
 {
 	mSkyLightMultiplier = multiplier;
@@ -31,11 +46,14 @@ void Noise3D::GI::PathTracerStandardShader::SetSkyDomeTexture(Texture2D * pTex,
 	if (pTex != nullptr)
 	{
 		m_pSkyDomeTex = pTex;
+
+		//sky is sampled by every escaped path, keep float pixels (and HDR pixels given by user)
+		if (!pTex->IsCpuPixelStoreValid() && pTex->IsSysMemBufferValid())pTex->CreateCpuPixelStore();
+		mSkyDomeSampler.Init(pTex);
 		if (computeSH16)
 		{
-			GI::Texture2dSampler_Spherical sampler;
-			sampler.SetTexturePtr(pTex);
-			mShVecSky.Project(3, 5000, &sampler);
+			//texel-integrated, no monte carlo noise
+			mShVecSky.ProjectLatLongMap(3, pTex);
 		}
 	}
 }
@@ -45,15 +63,20 @@ void Noise3D::GI::PathTracerStandardShader::SetSkyBoxTexture(TextureCubeMap * pT
 	if (pTex != nullptr)
 	{
 		m_pSkyBoxTex = pTex;
+		if (!pTex->IsCpuPixelStoreValid() && pTex->IsSysMemBufferValid())pTex->CreateCpuPixelStore();
+		mSkyBoxSampler.Init(pTex);
 		if (computeSH16)
 		{
-			GI::CubeMapSampler sampler;
-			sampler.SetTexturePtr(pTex);
-			mShVecSky.Project(3, 5000, &sampler);
+			mShVecSky.ProjectCubeMap(3, pTex);
 		}
 	}
 }
 
+void Noise3D::GI::PathTracerStandardShader::SetSkyLightImportanceSampling(bool enabled)
+{
+	mIsSkyLightImportanceSamplingEnabled = enabled;
+}
+
 void Noise3D::GI::PathTracerStandardShader::ClosestHit(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, N_TraceRayPayload & in_out_payload)
 {
 	GI::PbrtMaterial* pMat = hitInfo.pHitObj->GetPbrtMaterial();
@@ -120,10 +143,38 @@ void Noise3D::GI::PathTracerStandardShader::ClosestHit(const N_TraceRayParam & p
 		}
 	}
 
+	//trace the rest of the path iteratively (one sample per lobe choice, no branching)
+	if (mIntegrator == NOISE_PATH_TRACER_INTEGRATOR::ITERATIVE_PATH)
+	{
+		in_out_payload.radiance = _IntegratePathIteratively(param, hitInfo) + outEmission;
+		return;
+	}
+
 	//integrate over the hemisphere with complete BSDF plus emission
 	in_out_payload.radiance = _FinalIntegration(param, hitInfo) + outEmission;
 }
 
+bool Noise3D::GI::PathTracerStandardShader::ClosestHit_Wavefront(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, N_TraceRayPayload & in_out_payload, N_TraceRayParam & out_nextParam, Vec3 & in_out_throughput)
+{
+	//branching recursion can't be split into waves
+	if (mIntegrator != NOISE_PATH_TRACER_INTEGRATOR::ITERATIVE_PATH)
+		return IPathTracerSoftShader::ClosestHit_Wavefront(param, hitInfo, in_out_payload, out_nextParam, in_out_throughput);
+
+	//a vertex of _IntegratePathIteratively(). (the vertex was reached by a diffuse bounce if isSHEnvLight is set,
+	//its emission has been counted by next event estimation)
+	GI::Radiance emission = _EvalEmission(hitInfo);
+	if (emission != Vec3(0, 0, 0))
+	{
+		bool isDiffuseBounce = (param.bounces > 0 && param.isSHEnvLight);
+		bool isSkipped = (param.bounces == 0 && param.isIndirectLightOnly);
+		if (!isDiffuseBounce && !isSkipped)in_out_payload.radiance = emission;
+		return false;
+	}
+
+	in_out_payload.radiance = _EstimateDirectDiffuse(param, hitInfo) + _EstimateDirectSkyLight(param, hitInfo);
+	return _ContinuePath(param, hitInfo, out_nextParam, in_out_throughput);
+}
+
 void Noise3D::GI::PathTracerStandardShader::Miss(const N_TraceRayParam & param, N_TraceRayPayload & in_out_payload)
 {
 	if (mSkyLightType == NOISE_PATH_TRACER_SKYLIGHT_TYPE::NONE)
@@ -132,7 +183,13 @@ void Noise3D::GI::PathTracerStandardShader::Miss(const N_TraceRayParam & param,
 		return;
 	}
 
-	if (param.isSHEnvLight || mSkyLightType == NOISE_PATH_TRACER_SKYLIGHT_TYPE::SPHERICAL_HARMONIC)
+	//diffuse bounce of ITERATIVE_PATH integrator while sky light is also sampled by next event estimation.
+	//(SH env light is not used, radiance is MIS-weighted instead)
+	const EnvironmentMapSampler* pSkySampler = _GetSkyLightSampler();
+	bool isSkyLightMIS = (param.diffuseLobePdf > 0.0f && pSkySampler != nullptr);
+	float misWeight = isSkyLightMIS ? _PowerHeuristic(param.diffuseLobePdf, pSkySampler->Pdf(param.ray.dir)) : 1.0f;
+
+	if ((param.isSHEnvLight && !isSkyLightMIS) || mSkyLightType == NOISE_PATH_TRACER_SKYLIGHT_TYPE::SPHERICAL_HARMONIC)
 	{
 		if (m_pSkyBoxTex != nullptr || m_pSkyDomeTex != nullptr)
 		{
@@ -151,7 +208,7 @@ void Noise3D::GI::PathTracerStandardShader::Miss(const N_TraceRayParam & param,
 			if (param.bounces == 0)	sampler.SetFilterMode(true);
 			sampler.SetTexturePtr(m_pSkyDomeTex);
 			Color4f skyColor = sampler.Eval(param.ray.dir);
-			in_out_payload.radiance = GI::Radiance(skyColor.R(), skyColor.G(), skyColor.B());
+			in_out_payload.radiance = GI::Radiance(skyColor.R(), skyColor.G(), skyColor.B()) * misWeight;
 			if (param.bounces != 0)in_out_payload.radiance *= mSkyLightMultiplier;
 			return;
 		}
@@ -164,7 +221,7 @@ void Noise3D::GI::PathTracerStandardShader::Miss(const N_TraceRayParam & param,
 			CubeMapSampler sampler;
 			sampler.SetTexturePtr(m_pSkyBoxTex);
 			Color4f skyColor = sampler.Eval(param.ray.dir);
-			in_out_payload.radiance = GI::Radiance(skyColor.R(), skyColor.G(), skyColor.B());
+			in_out_payload.radiance = GI::Radiance(skyColor.R(), skyColor.G(), skyColor.B()) * misWeight;
 			if (param.bounces != 0)in_out_payload.radiance *= mSkyLightMultiplier;
 			return;
 		}
@@ -558,6 +615,352 @@ void Noise3D::GI::PathTracerStandardShader::_IntegrateTransmission(int sampleCou
 	outTransmission /= float(sampleCount);
 }
 
+GI::Radiance Noise3D::GI::PathTracerStandardShader::_IntegratePathIteratively(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo)
+{
+	GI::Radiance result;
+	Vec3 throughput = Vec3(1.0f, 1.0f, 1.0f);
+
+	//current vertex of the path
+	N_TraceRayParam vertexParam = param;
+	N_RayHitInfoForPathTracer vertexHitInfo = hitInfo;
+	bool isDiffuseBounce = false;
+
+	while (true)
+	{
+		//emissive surface only display emission (same as branching recursion).
+		//emission reached by a diffuse bounce has been counted by next event estimation
+		GI::Radiance emission = _EvalEmission(vertexHitInfo);
+		if (emission != Vec3(0, 0, 0))
+		{
+			if (!isDiffuseBounce)result += throughput * emission;
+			break;
+		}
+
+		//1. direct lighting of diffuse lobe
+		result += throughput * (_EstimateDirectDiffuse(vertexParam, vertexHitInfo) + _EstimateDirectSkyLight(vertexParam, vertexHitInfo));
+
+		//2&3. continue the path with one of the lobes
+		N_TraceRayParam nextParam;
+		if (!_ContinuePath(vertexParam, vertexHitInfo, nextParam, throughput))break;
+		isDiffuseBounce = nextParam.isSHEnvLight;
+
+		//4. find next vertex
+		N_RayHitInfoForPathTracer nextHitInfo(nullptr, N_RayHitInfo(-123456789.0f, Vec3(), Vec3(), Vec2()));
+		if (!IPathTracerSoftShader::_IntersectScene(nextParam.ray, nextHitInfo))
+		{
+			N_TraceRayPayload payload;
+			this->Miss(nextParam, payload);
+			result += throughput * payload.radiance;
+			break;
+		}
+		vertexParam = nextParam;
+		vertexHitInfo = nextHitInfo;
+	}
+
+	return result;
+}
+
+bool Noise3D::GI::PathTracerStandardShader::_ContinuePath(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, N_TraceRayParam & outNextParam, Vec3 & in_out_throughput)
+{
+	if (param.bounces >= int(_MaxBounces()))return false;
+
+	//choose one of the lobes by its rough energy ratio
+	GI::RandomSampleGenerator g;
+	const N_PbrtMatDesc& mat = hitInfo.pHitObj->GetPbrtMaterial()->GetDesc();
+	float w_d = 0.0f, w_s = 0.0f, w_t = 0.0f;
+	_ComputeLobeWeights(mat, w_d, w_s, w_t);
+	float w_sum = w_d + w_s + w_t;
+
+	Vec3 dir;
+	GI::Radiance weight;
+	bool isInsideObject = param.isInsideObject;
+	bool isSampleValid = false;
+	bool isDiffuseBounce = false;
+	float u = g.CanonicalReal() * w_sum;
+	if (u < w_d)
+	{
+		isSampleValid = _SampleDiffuse(param, hitInfo, dir, weight);
+		weight *= w_sum / w_d;
+		isDiffuseBounce = true;
+	}
+	else if (u < w_d + w_s)
+	{
+		isSampleValid = _SampleSpecular(param, hitInfo, dir, weight);
+		weight *= w_sum / w_s;
+	}
+	else
+	{
+		isSampleValid = _SampleTransmission(param, hitInfo, dir, weight, isInsideObject);
+		weight *= w_sum / w_t;
+	}
+	if (!isSampleValid)return false;
+	in_out_throughput *= weight;
+
+	//russian roulette, survival probability follows the throughput
+	if (param.bounces + 1 >= int(mRussianRouletteStartBounce))
+	{
+		float survival = std::min<float>(std::max<float>(in_out_throughput.x, std::max<float>(in_out_throughput.y, in_out_throughput.z)), 0.95f);
+		if (g.CanonicalReal() >= survival)return false;
+		in_out_throughput /= survival;
+	}
+
+	outNextParam = param;
+	outNextParam.bounces = param.bounces + 1;
+	outNextParam.ray = N_Ray(hitInfo.pos, dir);
+	outNextParam.isInsideObject = isInsideObject;
+	outNextParam.isShadowRay = false;
+	outNextParam.isSHEnvLight = isDiffuseBounce;
+	outNextParam.diffuseLobePdf = isDiffuseBounce ? (std::max<float>(hitInfo.normal.Dot(dir), 0.0f) / Ut::PI) * (w_d / w_sum) : 0.0f;
+	return true;
+}
+
+GI::Radiance Noise3D::GI::PathTracerStandardShader::_EstimateDirectDiffuse(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo)
+{
+	if (mLightSourceList.empty())return GI::Radiance(0, 0, 0);
+
+	//pick one light source uniformly (pdf = 1/lightCount)
+	GI::RandomSampleGenerator g;
+	uint32_t lightCount = mLightSourceList.size();
+	uint32_t lightId = std::min<uint32_t>(uint32_t(g.CanonicalReal() * float(lightCount)), lightCount - 1);
+	GI::IGiRenderable* pLight = mLightSourceList.at(lightId);
+	if (pLight == hitInfo.pHitObj)return GI::Radiance(0, 0, 0);
+
+	std::vector<Vec3> dirList;
+	std::vector<float> pdfList;
+	if (pLight->GetObjectType() == NOISE_SCENE_OBJECT_TYPE::LOGICAL_RECT)
+	{
+		g.RectShadowRays(hitInfo.pos, static_cast<LogicalRect*>(pLight), 1, dirList, pdfList);
+	}
+	else
+	{
+		g.CosinePdfSphericalVec_ShadowRays(hitInfo.pos, pLight, 1, dirList, pdfList);
+	}
+	if (dirList.empty() || pdfList.at(0) <= 0.0f)return GI::Radiance(0, 0, 0);
+
+	Vec3 l = dirList.at(0);
+	Vec3 v = -param.ray.dir;
+	Vec3 n = hitInfo.normal;
+	if (l.Dot(n) <= 0.0f)return GI::Radiance(0, 0, 0);
+	Vec3 h = l + v;
+	if (h == Vec3(0, 0, 0))h = n;
+	h.Normalize();
+
+	//radiance is returned only if the light source is visible
+	N_TraceRayPayload payload;
+	N_TraceRayParam shadowParam = param;
+	shadowParam.ray = N_Ray(hitInfo.pos, l);
+	shadowParam.isShadowRay = true;
+	shadowParam.shadowRayLightSourceId = lightId;
+	IPathTracerSoftShader::_TraceRay(shadowParam, payload);
+	if (payload.radiance == Vec3(0, 0, 0))return GI::Radiance(0, 0, 0);
+
+	BxdfInfo bxdfInfo;
+	_CalculateBxDF(BxDF_LightTransfer_Diffuse, l, v, h, hitInfo, bxdfInfo);
+	float cosTerm = n.Dot(l);
+	return payload.radiance * bxdfInfo.k_d * bxdfInfo.diffuseBRDF * (cosTerm * float(lightCount) / pdfList.at(0));
+}
+
+GI::Radiance Noise3D::GI::PathTracerStandardShader::_EstimateDirectSkyLight(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo)
+{
+	const EnvironmentMapSampler* pSampler = _GetSkyLightSampler();
+	if (pSampler == nullptr)return GI::Radiance(0, 0, 0);
+
+	const N_PbrtMatDesc& mat = hitInfo.pHitObj->GetPbrtMaterial()->GetDesc();
+	float w_d = 0.0f, w_s = 0.0f, w_t = 0.0f;
+	_ComputeLobeWeights(mat, w_d, w_s, w_t);
+	if (w_d <= 0.0f)return GI::Radiance(0, 0, 0);
+
+	//direction proportional to sky luminance
+	GI::RandomSampleGenerator g;
+	float pdfSky = 0.0f;
+	Vec3 l = pSampler->Sample(Vec2(g.CanonicalReal(), g.CanonicalReal()), pdfSky);
+	Vec3 v = -param.ray.dir;
+	Vec3 n = hitInfo.normal;
+	float cosTerm = n.Dot(l);
+	if (pdfSky <= 0.0f || cosTerm <= 0.0f)return GI::Radiance(0, 0, 0);
+	if (IPathTracerSoftShader::_IntersectSceneAnyHit(N_Ray(hitInfo.pos, l)))return GI::Radiance(0, 0, 0);
+
+	//radiance of the sky as if an escaped ray of next bounce
+	N_TraceRayPayload payload;
+	N_TraceRayParam skyParam = param;
+	skyParam.bounces = param.bounces + 1;
+	skyParam.ray = N_Ray(hitInfo.pos, l);
+	skyParam.isSHEnvLight = false;
+	skyParam.diffuseLobePdf = 0.0f;
+	this->Miss(skyParam, payload);
+	if (payload.radiance == Vec3(0, 0, 0))return GI::Radiance(0, 0, 0);
+
+	Vec3 h = l + v;
+	if (h == Vec3(0, 0, 0))h = n;
+	h.Normalize();
+	BxdfInfo bxdfInfo;
+	_CalculateBxDF(BxDF_LightTransfer_Diffuse, l, v, h, hitInfo, bxdfInfo);
+
+	//the same direction could be reached by the diffuse bounce of _ContinuePath() (cosine pdf * lobe probability),
+	//except at the last bounce where the path ends
+	float misWeight = 1.0f;
+	if (param.bounces < int(_MaxBounces()))
+	{
+		float pdfDiffuseLobe = (cosTerm / Ut::PI) * (w_d / (w_d + w_s + w_t));
+		misWeight = _PowerHeuristic(pdfSky, pdfDiffuseLobe);
+	}
+	return payload.radiance * bxdfInfo.k_d * bxdfInfo.diffuseBRDF * (cosTerm * misWeight / pdfSky);
+}
+
+const GI::EnvironmentMapSampler * Noise3D::GI::PathTracerStandardShader::_GetSkyLightSampler()
+{
+	if (!mIsSkyLightImportanceSamplingEnabled || mIntegrator != NOISE_PATH_TRACER_INTEGRATOR::ITERATIVE_PATH)return nullptr;
+	if (mSkyLightType == NOISE_PATH_TRACER_SKYLIGHT_TYPE::SKY_DOME && m_pSkyDomeTex != nullptr && mSkyDomeSampler.IsValid())return &mSkyDomeSampler;
+	if (mSkyLightType == NOISE_PATH_TRACER_SKYLIGHT_TYPE::SKY_BOX && m_pSkyBoxTex != nullptr && mSkyBoxSampler.IsValid())return &mSkyBoxSampler;
+	return nullptr;
+}
+
+void Noise3D::GI::PathTracerStandardShader::_ComputeLobeWeights(const N_PbrtMatDesc & mat, float & w_d, float & w_s, float & w_t)
+{
+	float albedoAvg = (mat.albedo.x + mat.albedo.y + mat.albedo.z) / 3.0f;
+	float F0Avg = (1.0f - mat.metallicity) * 0.03f + mat.metallicity * (mat.metal_F0.x + mat.metal_F0.y + mat.metal_F0.z) / 3.0f;
+	w_d = albedoAvg * (1.0f - mat.metallicity) * (1.0f - mat.transparency);
+	w_t = albedoAvg * (1.0f - mat.metallicity) * mat.transparency;
+	w_s = std::max<float>(F0Avg, 0.1f);//fresnel grows at grazing angle
+}
+
+float Noise3D::GI::PathTracerStandardShader::_PowerHeuristic(float pdf_a, float pdf_b)
+{
+	float a2 = pdf_a * pdf_a;
+	float b2 = pdf_b * pdf_b;
+	return (a2 + b2 > 0.0f) ? a2 / (a2 + b2) : 0.0f;
+}
+
+bool Noise3D::GI::PathTracerStandardShader::_SampleDiffuse(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3 & outDir, GI::Radiance & outWeight)
+{
+	GI::RandomSampleGenerator g;
+	std::vector<Vec3> dirList;
+	std::vector<float> pdfList;
+	g.CosinePdfSphericalVec_Cone(hitInfo.normal, Ut::PI / 2.0f, 1, dirList, pdfList);
+
+	Vec3 l = dirList.at(0);
+	Vec3 v = -param.ray.dir;
+	Vec3 n = hitInfo.normal;
+	if (l.Dot(n) <= 0.0f || pdfList.at(0) <= 0.0f)return false;
+	Vec3 h = l + v;
+	if (h == Vec3(0, 0, 0))h = n;
+	h.Normalize();
+
+	BxdfInfo bxdfInfo;
+	_CalculateBxDF(BxDF_LightTransfer_Diffuse, l, v, h, hitInfo, bxdfInfo);
+	float cosTerm = n.Dot(l);
+	outDir = l;
+	outWeight = bxdfInfo.k_d * bxdfInfo.diffuseBRDF * (cosTerm / pdfList.at(0));
+	return true;
+}
+
+bool Noise3D::GI::PathTracerStandardShader::_SampleSpecular(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3 & outDir, GI::Radiance & outWeight)
+{
+	GI::RandomSampleGenerator g;
+	const N_PbrtMatDesc& mat = hitInfo.pHitObj->GetPbrtMaterial()->GetDesc();
+	std::vector<Vec3> dirList;
+	std::vector<float> pdfList;
+
+	Vec3 reflectedDir = Vec3::Reflect(param.ray.dir, hitInfo.normal);
+	float alpha = _RoughnessToAlpha(mat.roughness);
+	Vec3 n = hitInfo.normal;
+	Vec3 v = -param.ray.dir;
+	v.Normalize();
+	g.GGXImportanceSampling_SpecularReflection(reflectedDir, v, n, alpha, 1, dirList, pdfList);
+
+	Vec3 l = dirList.at(0);
+	l.Normalize();
+	if (l.Dot(n) <= 0.0f || pdfList.at(0) == 0.0f)return false;
+	Vec3 h = l + v;
+	if (h == Vec3(0, 0, 0))h = n;
+	h.Normalize();
+
+	BxdfInfo bxdfInfo;
+	_CalculateBxDF(BxDF_LightTransfer_Specular, l, v, h, hitInfo, bxdfInfo);
+	float cosTerm = n.Dot(l);
+
+	//with the "one extra step" of GGX importance sampling (see _IntegrateSpecular())
+	outDir = l;
+	outWeight = bxdfInfo.k_s * (bxdfInfo.reflectionBRDF * cosTerm * 4.0f * l.Dot(h) / pdfList.at(0));
+	return true;
+}
+
+bool Noise3D::GI::PathTracerStandardShader::_SampleTransmission(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3 & outDir, GI::Radiance & outWeight, bool& outIsInsideObject)
+{
+	GI::RandomSampleGenerator g;
+	const N_PbrtMatDesc& mat = hitInfo.pHitObj->GetPbrtMaterial()->GetDesc();
+	float alpha = _RoughnessToAlpha(mat.roughness);
+	Vec3 n = hitInfo.normal;
+	Vec3 v = -param.ray.dir;
+	n.Normalize();
+	v.Normalize();
+
+	//refractive index of path's incident/outgoing medium (see _IntegrateTransmission())
+	float eta_i = 1.0f;
+	float eta_o = mat.ior;
+	if (param.isInsideObject)std::swap(eta_i, eta_o);
+	Vec3 refractedDir = param.isInsideObject ?
+		Vec3::Refract(param.ray.dir, -hitInfo.normal, eta_i / eta_o) :
+		Vec3::Refract(param.ray.dir, hitInfo.normal, eta_i / eta_o);
+
+	//total internal reflection, path stays inside
+	if (param.isInsideObject && refractedDir == Vec3(0, 0, 0))
+	{
+		Vec3 l = Vec3::Reflect(param.ray.dir, -n);
+		l.Normalize();
+		Vec3 h_inside = -n;
+		BxdfInfo bxdfInfo;
+		_CalculateBxDF(BxDF_LightTransfer_InternalReflection, l, v, h_inside, hitInfo, bxdfInfo);
+		if (bxdfInfo.reflectionBRDF <= 0.0f)return false;
+		float cosTerm = abs(n.Dot(l));
+		outDir = l;
+		outWeight = Vec3(1.0f, 1.0f, 1.0f) * (bxdfInfo.reflectionBRDF * cosTerm * 4.0f * abs(l.Dot(h_inside)) / bxdfInfo.D);
+		outIsInsideObject = true;
+		return true;
+	}
+
+	std::vector<Vec3> dirList;
+	std::vector<float> pdfList;
+	g.GGXImportanceSampling_SpecularTransmission(param.ray.dir, refractedDir, eta_i, eta_o, n, alpha, 1, dirList, pdfList);
+	Vec3 l = dirList.at(0);
+	l.Normalize();
+	if (pdfList.at(0) == 0.0f)return false;
+	Vec3 h_t = BxdfUt::ComputeHalfVectorForRefraction(v, l, eta_i, eta_o, n);
+
+	BxdfInfo bxdfInfo;
+	if (param.isInsideObject)
+	{
+		if (l.Dot(n) < 0.0f)return false;
+		_CalculateBxDF(BxDF_LightTransfer_Transmission_PathObjectToAir, l, v, h_t, hitInfo, bxdfInfo);
+	}
+	else
+	{
+		if (l.Dot(n) > 0.0f)return false;
+		_CalculateBxDF(BxDF_LightTransfer_Transmission_PathAirToObject, l, v, h_t, hitInfo, bxdfInfo);
+	}
+
+	float cosTerm = abs(n.Dot(l));
+	outDir = l;
+	outWeight = bxdfInfo.k_t * (bxdfInfo.transmissionBTDF * cosTerm * 4.0f * abs(l.Dot(h_t)) / pdfList.at(0));
+	outIsInsideObject = !param.isInsideObject;
+	return true;
+}
+
+GI::Radiance Noise3D::GI::PathTracerStandardShader::_EvalEmission(const N_RayHitInfoForPathTracer & hitInfo)
+{
+	GI::PbrtMaterial* pMat = hitInfo.pHitObj->GetPbrtMaterial();
+	if (!pMat->IsEmissionEnabled())return GI::Radiance(0, 0, 0);
+
+	const N_PbrtMatDesc& mat = pMat->GetDesc();
+	Vec3 emission = mat.emission;
+	if (mat.pEmissiveMap != nullptr)
+	{
+		Color4f emissionSampled = mat.pEmissiveMap->SamplePixelBilinear(hitInfo.texcoord);
+		emission *= Vec3(emissionSampled.x, emissionSampled.y, emissionSampled.z);
+	}
+	return emission;
+}
+
 void Noise3D::GI::PathTracerStandardShader::_CalculateBxDF(uint32_t lightTransferType, Vec3 lightDir, Vec3 viewDir, Vec3 halfVector, const N_RayHitInfoForPathTracer & hitInfo, BxdfInfo& outBxdfInfo)
 {
 	if (lightTransferType == 0)return;
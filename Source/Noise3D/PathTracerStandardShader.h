@@ -11,6 +11,19 @@ namespace Noise3D
 {
 	namespace GI
 	{
+		//how the standard shader integrates the rendering equation
+		enum class NOISE_PATH_TRACER_INTEGRATOR
+		{
+			//every hit spawns MaxDiffuseSampleCount/MaxSpecularScatterSampleCount child rays (at bounce 0)
+			//and recurses through TraceRay(), cost grows as samples^bounces
+			BRANCHING_RECURSION,
+
+			//one path per pixel sample, traced iteratively with throughput accumulation, russian roulette
+			//and next event estimation toward light sources. cost grows linearly with bounces,
+			//quality is controlled by PathTracer::SetSamplesPerPixel()
+			ITERATIVE_PATH
+		};
+
 		class PathTracerStandardShader :
 			public IPathTracerSoftShader
 		{
@@ -18,6 +31,12 @@ namespace Noise3D
 
 			PathTracerStandardShader();
 
+			//BRANCHING_RECURSION by default
+			void SetIntegrator(NOISE_PATH_TRACER_INTEGRATOR integrator);
+
+			//bounce from which paths are randomly terminated(russian roulette) in ITERATIVE_PATH mode
+			void SetRussianRouletteStartBounce(uint32_t bounce);
+
 			void SetSkyLightMultiplier(float multiplier);
 
 			void SetSkyLightType(NOISE_PATH_TRACER_SKYLIGHT_TYPE type);
@@ -26,8 +45,15 @@ namespace Noise3D
 
 			void SetSkyBoxTexture(TextureCubeMap* pTex, bool computeSH16 = true);
 
+			//ITERATIVE_PATH integrator: SKY_DOME/SKY_BOX is also sampled by next event estimation (proportional to
+			//luminance), combined with diffuse bounces by multiple importance sampling. enabled by default
+			void SetSkyLightImportanceSampling(bool enabled);
+
 			virtual void ClosestHit(const N_TraceRayParam& param, const N_RayHitInfoForPathTracer& hitInfo, N_TraceRayPayload& in_out_payload) override;
 
+			//ITERATIVE_PATH integrator is split into waves (one vertex per call), BRANCHING_RECURSION falls back to ClosestHit()
+			virtual bool ClosestHit_Wavefront(const N_TraceRayParam& param, const N_RayHitInfoForPathTracer& hitInfo, N_TraceRayPayload& in_out_payload, N_TraceRayParam& out_nextParam, Vec3& in_out_throughput) override;
+
 			virtual void Miss(const N_TraceRayParam & param, N_TraceRayPayload& in_out_payload) override;
 
 		private:
@@ -71,6 +97,37 @@ namespace Noise3D
 			//(additional samples for reflections; might have importance sampling)
 			void _IntegrateSpecular(int samplesCount, const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, GI::Radiance& outReflection);
 
+			//ITERATIVE_PATH integrator: trace the rest of the path from the first hit
+			GI::Radiance _IntegratePathIteratively(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo);
+
+			//choose a lobe and sample the ray continuing the path (with russian roulette). false if the path ends
+			bool _ContinuePath(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, N_TraceRayParam& outNextParam, Vec3& in_out_throughput);
+
+			//next event estimation of diffuse lobe: shadow ray to a randomly chosen light source
+			GI::Radiance _EstimateDirectDiffuse(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo);
+
+			//next event estimation of diffuse lobe toward sky light, MIS-weighted with the diffuse bounce
+			GI::Radiance _EstimateDirectSkyLight(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo);
+
+			//importance sampler of current sky light type, nullptr if it's disabled or unavailable
+			const EnvironmentMapSampler* _GetSkyLightSampler();
+
+			//rough energy ratio of lobes, a path continues with one of them
+			void _ComputeLobeWeights(const N_PbrtMatDesc& mat, float& w_d, float& w_s, float& w_t);
+
+			//MIS weight of strategy a (one sample of each strategy)
+			float _PowerHeuristic(float pdf_a, float pdf_b);
+
+			//single sample of a BSDF lobe for ITERATIVE_PATH integrator. outWeight = BxDF * cos / pdf
+			bool _SampleDiffuse(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3& outDir, GI::Radiance& outWeight);
+
+			bool _SampleSpecular(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3& outDir, GI::Radiance& outWeight);
+
+			bool _SampleTransmission(const N_TraceRayParam & param, const N_RayHitInfoForPathTracer & hitInfo, Vec3& outDir, GI::Radiance& outWeight, bool& outIsInsideObject);
+
+			//emission (with emissive map) of the hit surface
+			GI::Radiance _EvalEmission(const N_RayHitInfoForPathTracer & hitInfo);
+
 			//eval a BxDF and its coefficients given light transfer type
 			void _CalculateBxDF(uint32_t lightTransferType, Vec3 lightDir, Vec3 viewDir, Vec3 halfVector, const N_RayHitInfoForPathTracer & hitInfo, BxdfInfo& outBxdfInfo);
 
@@ -94,6 +151,16 @@ namespace Noise3D
 			SHVector mShVecSky;//SH vector of Env Lighting (env diffuse)
 			
 			float mSkyLightMultiplier;//radiance scale factor
+
+			NOISE_PATH_TRACER_INTEGRATOR mIntegrator;
+
+			uint32_t mRussianRouletteStartBounce;
+
+			EnvironmentMapSampler mSkyDomeSampler;//importance sampling of sky light
+
+			EnvironmentMapSampler mSkyBoxSampler;
+
+			bool mIsSkyLightImportanceSamplingEnabled;
 		};
 	}
 }
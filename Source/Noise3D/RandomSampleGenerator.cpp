@@ -9,30 +9,129 @@
 
 using namespace Noise3D;
 
-std::default_random_engine Noise3D::GI::RandomSampleGenerator::mRandomEngine = std::default_random_engine();
+/*****************************************
+
+						PCG32 ENGINE
+
+*****************************************/
+
+Noise3D::GI::Pcg32RandomEngine::Pcg32RandomEngine()
+{
+	Pcg32RandomEngine::Seed(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL);
+}
+
+Noise3D::GI::Pcg32RandomEngine::Pcg32RandomEngine(uint64_t seed, uint64_t stream)
+{
+	Pcg32RandomEngine::Seed(seed, stream);
+}
+
+void Noise3D::GI::Pcg32RandomEngine::Seed(uint64_t seed, uint64_t stream)
+{
+	//pcg32_srandom_r() of reference implementation
+	mState = 0;
+	mIncrement = (stream << 1u) | 1u;
+	Pcg32RandomEngine::NextUInt();
+	mState += seed;
+	Pcg32RandomEngine::NextUInt();
+}
+
+uint32_t Noise3D::GI::Pcg32RandomEngine::NextUInt()
+{
+	//LCG step, then output permutation XSH-RR (xorshift high bits, random rotation)
+	uint64_t oldState = mState;
+	mState = oldState * 6364136223846793005ULL + mIncrement;
+	uint32_t xorShifted = uint32_t(((oldState >> 18u) ^ oldState) >> 27u);
+	uint32_t rot = uint32_t(oldState >> 59u);
+	return (xorShifted >> rot) | (xorShifted << ((~rot + 1u) & 31u));
+}
+
+float Noise3D::GI::Pcg32RandomEngine::NextCanonicalReal()
+{
+	//24 significant bits, exactly representable by float. never reaches 1.0
+	return float(Pcg32RandomEngine::NextUInt() >> 8) * (1.0f / 16777216.0f);
+}
+
+/*****************************************
+
+					RANDOM SAMPLE GENERATOR
+
+*****************************************/
+
+thread_local Noise3D::GI::Pcg32RandomEngine Noise3D::GI::RandomSampleGenerator::sThreadLocalEngine;
+
+thread_local Noise3D::GI::RandomSampleGenerator::N_SamplerContext Noise3D::GI::RandomSampleGenerator::sThreadLocalSamplerContext = { nullptr, 0, 0, 0, 0, 0 };
+
+thread_local std::vector<Vec2> Noise3D::GI::RandomSampleGenerator::sThreadLocalCanonicalPairList;
+
+Noise3D::GI::RandomSampleGenerator::RandomSampleGenerator():
+	mIsUsingOwnEngine(false)
+{
+}
+
+Noise3D::GI::RandomSampleGenerator::RandomSampleGenerator(uint64_t seed, uint64_t stream):
+	mEngine(seed, stream),
+	mIsUsingOwnEngine(true)
+{
+}
+
+void Noise3D::GI::RandomSampleGenerator::SeedThreadLocalEngine(uint64_t seed, uint64_t stream)
+{
+	sThreadLocalEngine.Seed(seed, stream);
+}
+
+uint64_t Noise3D::GI::RandomSampleGenerator::ComputeSeed(uint64_t key, uint64_t counter1, uint64_t counter2)
+{
+	//splitmix64 finalizer chained over the counters (a stateless hash of (key, counter1, counter2))
+	auto mix = [](uint64_t z)->uint64_t
+	{
+		z += 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	};
+	return mix(mix(mix(key) ^ counter1) ^ counter2);
+}
 
-std::uniform_real_distribution<float> Noise3D::GI::RandomSampleGenerator::mCanonicalDist = std::uniform_real_distribution<float>(0.0, 1.0f);
+Noise3D::GI::Pcg32RandomEngine Noise3D::GI::RandomSampleGenerator::GetThreadLocalEngine()
+{
+	return sThreadLocalEngine;
+}
+
+void Noise3D::GI::RandomSampleGenerator::SetThreadLocalEngine(const Pcg32RandomEngine & engine)
+{
+	sThreadLocalEngine = engine;
+}
 
-std::uniform_real_distribution<float> Noise3D::GI::RandomSampleGenerator::mNormalizedDist = std::uniform_real_distribution<float>(-1.0f, 1.0f);
+void Noise3D::GI::RandomSampleGenerator::SetThreadLocalSampler(const ISampler * pSampler, uint32_t pixelX, uint32_t pixelY, uint64_t seed, uint32_t sampleIndex, uint32_t dimension)
+{
+	N_SamplerContext& ctx = sThreadLocalSamplerContext;
+	ctx.pSampler = pSampler;
+	ctx.pixelX = pixelX;
+	ctx.pixelY = pixelY;
+	ctx.seed = seed;
+	ctx.sampleIndex = sampleIndex;
+	ctx.dimension = dimension;
+}
 
-Noise3D::GI::RandomSampleGenerator::RandomSampleGenerator()
+uint32_t Noise3D::GI::RandomSampleGenerator::GetThreadLocalSamplerDimension()
 {
+	return sThreadLocalSamplerContext.dimension;
 }
 
 float Noise3D::GI::RandomSampleGenerator::CanonicalReal()
 {
-	return mCanonicalDist(mRandomEngine);
+	return mFunc_CanonicalReal();
 }
 
 float Noise3D::GI::RandomSampleGenerator::NormalizedReal()
 {
-	return mNormalizedDist(mRandomEngine);
+	return 2.0f * mFunc_CanonicalReal() - 1.0f;
 }
 
 Vec3 Noise3D::GI::RandomSampleGenerator::UniformSphericalVec()
 {
-	float var1 = mCanonicalDist(mRandomEngine);
-	float var2 = mCanonicalDist(mRandomEngine);
+	float var1 = mFunc_CanonicalReal();
+	float var2 = mFunc_CanonicalReal();
 
 	//according to <gritty detail> and my own paper note
 	//we can generate random points that uniformly distribute on a sphere 
@@ -53,8 +152,8 @@ Vec3 Noise3D::GI::RandomSampleGenerator::UniformSphericalVec()
 
 Vec2 Noise3D::GI::RandomSampleGenerator::UniformSphericalAzimuthal()
 {
-	float var1 = mCanonicalDist(mRandomEngine);
-	float var2 = mCanonicalDist(mRandomEngine);
+	float var1 = mFunc_CanonicalReal();
+	float var2 = mFunc_CanonicalReal();
 
 	//according to <gritty detail> and my own paper note
 	//we can generate random points that uniformly distribute on a sphere 
@@ -73,8 +172,8 @@ Vec3 Noise3D::GI::RandomSampleGenerator::UniformSphericalVec_Cone(Vec3 normal, f
 	//(2019.4.12)perahps there is no need to clamp to [0, pi]
 
 	//(2019.4.12) similar to the original UniformSphericalVec()
-	float var1 = mCanonicalDist(mRandomEngine);
-	float var2 = mCanonicalDist(mRandomEngine);
+	float var1 = mFunc_CanonicalReal();
+	float var2 = mFunc_CanonicalReal();
 
 	//(2019.4.18)derived with partial sphere's pdf and Inverse Transform Sampling
 	//float theta = acosf(1 - 2.0f * var1);
@@ -127,10 +226,13 @@ void Noise3D::GI::RandomSampleGenerator::UniformSphericalVec_Cone(Vec3 normal, f
 	//sampleCount will be divided in integration
 	outPdf = 1.0f;
 
+	//canonical pairs (from low discrepancy sampler, if any)
+	const Vec2* pCanonicalPairList = mFunc_GenerateCanonicalPairs(sampleCount);
+
 	for (int i = 0; i < sampleCount; ++i)
 	{
-		float var1 = mCanonicalDist(mRandomEngine);
-		float var2 = mCanonicalDist(mRandomEngine);
+		float var1 = pCanonicalPairList[i].x;
+		float var2 = pCanonicalPairList[i].y;
 		//F(theta)=(1-costheta)/(r^2(1-cosMaxAngle))
 		float oneMinusCos = 1.0f - cosf(maxAngle);
 		float theta = acosf(1.0f - oneMinusCos*var1);
@@ -189,10 +291,12 @@ void Noise3D::GI::RandomSampleGenerator::CosinePdfSphericalVec_Cone(Vec3 normal,
 	//float pdfNormalizeFactor = 4.0f * (1.0f-cosf(maxAngle))/ ((1.0f-cosf(2.0f*maxAngle)) );//denominator of cosine-weighted pdf
 	if (pdfNormalizeFactor > 1.0f)pdfNormalizeFactor = 1.0f;
 
+	const Vec2* pCanonicalPairList = mFunc_GenerateCanonicalPairs(sampleCount);
+
 	for (int i = 0; i < sampleCount; ++i)
 	{
-		float var1 = mCanonicalDist(mRandomEngine);
-		float var2 = mCanonicalDist(mRandomEngine);
+		float var1 = pCanonicalPairList[i].x;
+		float var2 = pCanonicalPairList[i].y;
 		//more info, plz refer to my zhihu article about 'SH lighting and Uniform Spherical sampling'
 		//learn about the Inverse Transform Sampling(ITS)
 
@@ -276,10 +380,12 @@ void Noise3D::GI::RandomSampleGenerator::GGXImportanceSampling_SpecularReflectio
 	Vec3 matRow1, matRow2, matRow3;
 	mFunc_ConstructTransformMatrixFromYtoNormal(l_center, matRow1, matRow2, matRow3);
 
+	const Vec2* pCanonicalPairList = mFunc_GenerateCanonicalPairs(sampleCount);
+
 	for (int i = 0; i < sampleCount; ++i)
 	{
-		float var1 = mCanonicalDist(mRandomEngine);
-		float var2 = mCanonicalDist(mRandomEngine);
+		float var1 = pCanonicalPairList[i].x;
+		float var2 = pCanonicalPairList[i].y;
 		//ref: https://agraphicsguy.wordpress.com/2015/11/01/sampling-microfacet-brdf/
 		//or [Walter07]
 		float theta = atanf(ggx_alpha * sqrtf(var1 / (1.0f - var1)));
@@ -323,10 +429,12 @@ void Noise3D::GI::RandomSampleGenerator::GGXImportanceSampling_SpecularTransmiss
 	Vec3 matRow1, matRow2, matRow3;
 	mFunc_ConstructTransformMatrixFromYtoNormal(centerOutPath, matRow1, matRow2, matRow3);
 
+	const Vec2* pCanonicalPairList = mFunc_GenerateCanonicalPairs(sampleCount);
+
 	for (int i = 0; i < sampleCount; ++i)
 	{
-		float var1 = mCanonicalDist(mRandomEngine);
-		float var2 = mCanonicalDist(mRandomEngine);
+		float var1 = pCanonicalPairList[i].x;
+		float var2 = pCanonicalPairList[i].y;
 		//ref: https://agraphicsguy.wordpress.com/2015/11/01/sampling-microfacet-brdf/
 		//or [Walter07]
 		float theta = atanf(ggx_alpha * sqrtf(var1 / (1.0f - var1)));
@@ -372,6 +480,36 @@ void Noise3D::GI::RandomSampleGenerator::GGXImportanceSampling_SpecularTransmiss
 
 *****************************************/
 
+inline float Noise3D::GI::RandomSampleGenerator::mFunc_CanonicalReal()
+{
+	return mIsUsingOwnEngine ? mEngine.NextCanonicalReal() : sThreadLocalEngine.NextCanonicalReal();
+}
+
+const Vec2* Noise3D::GI::RandomSampleGenerator::mFunc_GenerateCanonicalPairs(int sampleCount)
+{
+	//(capacity is kept between calls, so the per-bounce calls don't allocate)
+	std::vector<Vec2>& outList = sThreadLocalCanonicalPairList;
+	outList.clear();
+	if (sampleCount <= 0)return outList.data();
+
+	N_SamplerContext& ctx = sThreadLocalSamplerContext;
+	if (!mIsUsingOwnEngine && ctx.pSampler != nullptr)
+	{
+		//each call consumes a dimension pair
+		ctx.pSampler->GenerateSamples2D(ctx.pixelX, ctx.pixelY, ctx.seed, ctx.dimension, ctx.sampleIndex, uint32_t(sampleCount), outList);
+		ctx.dimension += 2;
+		return outList.data();
+	}
+
+	for (int i = 0; i < sampleCount; ++i)
+	{
+		float var1 = mFunc_CanonicalReal();
+		float var2 = mFunc_CanonicalReal();
+		outList.push_back(Vec2(var1, var2));
+	}
+	return outList.data();
+}
+
 inline Vec3 Noise3D::GI::RandomSampleGenerator::mFunc_UniformSphericalVecGen_AzimuthalToDir(float theta, float phi)
 {
 	//NOTE: this parameterization is different from the common one
@@ -11,12 +11,67 @@ namespace Noise3D
 {
 	namespace GI
 	{
+		class ISampler;
+
+		//PCG32 (permuted congruential generator, M.E.O'Neill 2014). 16 bytes of state,
+		//cheap to seed, independent streams can be selected with 'stream'
+		class Pcg32RandomEngine
+		{
+		public:
+
+			Pcg32RandomEngine();
+
+			Pcg32RandomEngine(uint64_t seed, uint64_t stream = 0);
+
+			void Seed(uint64_t seed, uint64_t stream = 0);
+
+			uint32_t NextUInt();
+
+			//uniformly distribute in [0,1)
+			float NextCanonicalReal();
+
+		private:
+
+			uint64_t mState;
+
+			uint64_t mIncrement;//must be odd
+		};
+
+		//random sample generator. 
+		//default constructed generators share a thread-local engine (no contention between path tracer worker threads),
+		//it can be re-seeded per pixel/per sample with SeedThreadLocalEngine() to be independent of thread scheduling.
+		//generators constructed with an explicit seed use its own engine.
+		//if a sampler is set to calling thread, batch sampling functions take canonical pairs from it
+		//(one dimension pair per call) instead of the random engine.
 		class RandomSampleGenerator
 		{
 		public:
 
 			RandomSampleGenerator();
 
+			RandomSampleGenerator(uint64_t seed, uint64_t stream = 0);
+
+			//re-seed the engine used by default constructed generators on calling thread
+			static void SeedThreadLocalEngine(uint64_t seed, uint64_t stream = 0);
+
+			//state of the engine used by default constructed generators on calling thread
+			//(e.g. a path sample continued on another thread picks up its random sequence)
+			static Pcg32RandomEngine GetThreadLocalEngine();
+
+			static void SetThreadLocalEngine(const Pcg32RandomEngine& engine);
+
+			//counter-based seed, e.g. ComputeSeed(globalSeed, pixelIndex, sampleIndex).
+			//(different counters give uncorrelated seeds)
+			static uint64_t ComputeSeed(uint64_t key, uint64_t counter1, uint64_t counter2 = 0);
+
+			//set (low discrepancy) sampler of the pixel sample being rendered on calling thread, next batch sampling
+			//call consumes 'dimension'. 'seed' should be the same for all samples of a pixel, and 'sampleIndex' is
+			//the index of the sample in the pixel's sequence. nullptr for pure random sampling
+			static void SetThreadLocalSampler(const ISampler* pSampler, uint32_t pixelX = 0, uint32_t pixelY = 0, uint64_t seed = 0, uint32_t sampleIndex = 0, uint32_t dimension = 0);
+
+			//next dimension to be consumed of calling thread's sampler
+			static uint32_t GetThreadLocalSamplerDimension();
+
 			//generate canonical real number(uniformly distribute in [0,1])
 			float CanonicalReal();
 
@@ -60,11 +115,32 @@ namespace Noise3D
 
 		private:
 
-			static std::default_random_engine mRandomEngine;
+			struct N_SamplerContext
+			{
+				const ISampler* pSampler;
+				uint32_t pixelX;
+				uint32_t pixelY;
+				uint64_t seed;
+				uint32_t sampleIndex;
+				uint32_t dimension;//next dimension to consume
+			};
+
+			static thread_local Pcg32RandomEngine sThreadLocalEngine;
+
+			static thread_local N_SamplerContext sThreadLocalSamplerContext;
+
+			static thread_local std::vector<Vec2> sThreadLocalCanonicalPairList;//scratch of mFunc_GenerateCanonicalPairs()
+
+			Pcg32RandomEngine mEngine;
+
+			bool mIsUsingOwnEngine;
 
-			static std::uniform_real_distribution<float> mCanonicalDist;
+			//uniformly distribute in [0,1)
+			float mFunc_CanonicalReal();
 
-			static std::uniform_real_distribution<float> mNormalizedDist;
+			//'sampleCount' canonical pairs from the sampler of current thread, or the random engine.
+			//(in a thread-local buffer, valid until next call on the same thread)
+			const Vec2* mFunc_GenerateCanonicalPairs(int sampleCount);
 
 			Vec3 mFunc_UniformSphericalVecGen_AzimuthalToDir(float theta, float phi);
 
@@ -131,6 +131,152 @@ int Noise3D::GI::SH_FlattenIndex(int l, int m)
 	return l*(l + 1) + m;
 }
 
+//coefficients of fully normalized recurrence of SH_EvalBatch() (K(l,m) * P_l_m / sin^m, no Condon-Shortley phase)
+//	Q_m_m = c_m,  Q_l_m = a_l_m * (t * Q_(l-1)_m - b_l_m * Q_(l-2)_m)
+struct N_SHRecurrenceTable
+{
+	N_SHRecurrenceTable(int highestOrderIndex) :
+		order(highestOrderIndex),
+		diagonalList(highestOrderIndex + 1),
+		aList((highestOrderIndex + 1) * (highestOrderIndex + 1)),
+		bList((highestOrderIndex + 1) * (highestOrderIndex + 1))
+	{
+		//c_0 = sqrt(1/4pi), c_m = c_(m-1) * sqrt((2m+1)/2m). (stays small for any order, unlike factorials)
+		double c = std::sqrt(1.0 / (4.0 * double(Ut::PI)));
+		for (int m = 0; m <= highestOrderIndex; ++m)
+		{
+			if (m > 0)c *= std::sqrt(double(2 * m + 1) / double(2 * m));
+			diagonalList[m] = float(c);
+			for (int l = m + 1; l <= highestOrderIndex; ++l)
+			{
+				double l2 = double(l * l), m2 = double(m * m), lm1 = double((l - 1) * (l - 1));
+				aList[l * (highestOrderIndex + 1) + m] = float(std::sqrt((4.0 * l2 - 1.0) / (l2 - m2)));
+				bList[l * (highestOrderIndex + 1) + m] = float(std::sqrt((lm1 - m2) / (4.0 * lm1 - 1.0)));
+			}
+		}
+	}
+
+	int order;
+	std::vector<float> diagonalList;
+	std::vector<float> aList;//[l*(order+1)+m]
+	std::vector<float> bList;
+};
+
+//tables are rebuilt only when a higher order is requested (per thread, Eval() is called by path tracer workers)
+static const N_SHRecurrenceTable& SH_GetRecurrenceTable(int highestOrderIndex)
+{
+	thread_local std::unique_ptr<N_SHRecurrenceTable> pTable;
+	if (pTable == nullptr || pTable->order < highestOrderIndex)
+	{
+		pTable.reset(new N_SHRecurrenceTable(highestOrderIndex));
+	}
+	return *pTable;
+}
+
+//SH bands [bandBegin, bandEnd] of NOISE_SIMD_WIDTH directions. polar axis component 't', azimuth plane (a,b):
+//cos(m*phi)*sin^m = Re((a+ib)^m), sin(m*phi)*sin^m = Im((a+ib)^m), so no trigonometric function is needed
+static void SH_EvalBandsOfSimdGroup(const N_SHRecurrenceTable& table, int bandBegin, int bandEnd,
+	const float* pT, const float* pA, const float* pB, uint32_t laneCount, float* outBasis, uint32_t basisStride)
+{
+	using namespace Noise3D::SIMD;
+	const float sqrt2 = 1.41421356237f;
+	simd_float t = SimdLoad(pT), a = SimdLoad(pA), b = SimdLoad(pB);
+	simd_float C = SimdSet1(1.0f), S = SimdSet1(0.0f);
+	alignas(32) float laneList[NOISE_SIMD_WIDTH];
+
+	auto output = [&](int index, simd_float y)
+	{
+		SimdStore(laneList, y);
+		float* pOut = outBasis + index * basisStride;
+		for (uint32_t i = 0; i < laneCount; ++i)pOut[i] = laneList[i];
+	};
+
+	for (int m = 0; m <= bandEnd; ++m)
+	{
+		if (m > 0)
+		{
+			simd_float nextC = SimdSub(SimdMul(a, C), SimdMul(b, S));
+			S = SimdAdd(SimdMul(a, S), SimdMul(b, C));
+			C = nextC;
+		}
+		simd_float cosTerm = SimdMul(SimdSet1(sqrt2), C);
+		simd_float sinTerm = SimdMul(SimdSet1(sqrt2), S);
+
+		simd_float Q2 = SimdSet1(0.0f);
+		simd_float Q1 = SimdSet1(table.diagonalList[m]);
+		for (int l = m; l <= bandEnd; ++l)
+		{
+			if (l > m)
+			{
+				float coefA = table.aList[l * (table.order + 1) + m];
+				float coefB = table.bList[l * (table.order + 1) + m];
+				simd_float Q = SimdMul(SimdSet1(coefA), SimdSub(SimdMul(t, Q1), SimdMul(SimdSet1(coefB), Q2)));
+				Q2 = Q1;
+				Q1 = Q;
+			}
+			if (l < bandBegin)continue;
+
+			if (m == 0)
+			{
+				output(GI::SH_FlattenIndex(l, 0), Q1);
+			}
+			else
+			{
+				output(GI::SH_FlattenIndex(l, m), SimdMul(Q1, cosTerm));
+				output(GI::SH_FlattenIndex(l, -m), SimdMul(Q1, sinTerm));
+			}
+		}
+	}
+}
+
+void Noise3D::GI::SH_EvalBatch(int highestOrderIndex, uint32_t dirCount, const float * dirX, const float * dirY, const float * dirZ, float * outBasis, uint32_t basisStride)
+{
+	if (highestOrderIndex < 0 || dirCount == 0)return;
+	const N_SHRecurrenceTable& table = SH_GetRecurrenceTable(highestOrderIndex);
+
+	//band 0~4 of SH() is the real SH with z as polar axis, and SH_Recursive() (band 5~) takes y as polar axis
+	const int c_hardcodedBandEnd = 4;
+	for (uint32_t groupBegin = 0; groupBegin < dirCount; groupBegin += NOISE_SIMD_WIDTH)
+	{
+		uint32_t laneCount = std::min<uint32_t>(NOISE_SIMD_WIDTH, dirCount - groupBegin);
+		alignas(32) float x[NOISE_SIMD_WIDTH];
+		alignas(32) float y[NOISE_SIMD_WIDTH];
+		alignas(32) float z[NOISE_SIMD_WIDTH];
+		for (uint32_t i = 0; i < NOISE_SIMD_WIDTH; ++i)
+		{
+			x[i] = 0.0f; y[i] = 0.0f; z[i] = 1.0f;//padding lanes
+			if (i >= laneCount)continue;
+			Vec3 dir = Vec3(dirX[groupBegin + i], dirY[groupBegin + i], dirZ[groupBegin + i]);
+			dir.Normalize();
+			x[i] = dir.x; y[i] = dir.y; z[i] = dir.z;
+		}
+
+		float* pOut = outBasis + groupBegin;
+		SH_EvalBandsOfSimdGroup(table, 0, std::min<int>(highestOrderIndex, c_hardcodedBandEnd), z, x, y, laneCount, pOut, basisStride);
+		if (highestOrderIndex > c_hardcodedBandEnd)
+		{
+			SH_EvalBandsOfSimdGroup(table, c_hardcodedBandEnd + 1, highestOrderIndex, y, x, z, laneCount, pOut, basisStride);
+		}
+	}
+}
+
+void Noise3D::GI::SH_EvalBatch(int highestOrderIndex, const std::vector<Vec3>& dirList, std::vector<float>& outBasis)
+{
+	uint32_t dirCount = dirList.size();
+	int coefficientCount = (highestOrderIndex + 1) * (highestOrderIndex + 1);
+	outBasis.resize(coefficientCount * dirCount);
+	if (highestOrderIndex < 0 || dirCount == 0)return;
+
+	std::vector<float> dirX(dirCount), dirY(dirCount), dirZ(dirCount);
+	for (uint32_t i = 0; i < dirCount; ++i)
+	{
+		dirX[i] = dirList[i].x;
+		dirY[i] = dirList[i].y;
+		dirZ[i] = dirList[i].z;
+	}
+	GI::SH_EvalBatch(highestOrderIndex, dirCount, dirX.data(), dirY.data(), dirZ.data(), outBasis.data(), dirCount);
+}
+
 float Noise3D::GI::SH_NormalizationTermK(int l, int m)
 {	
 	//associate legendre polynomial is implemented in a recursive way. for more detail
@@ -26,6 +26,15 @@ namespace Noise3D
 		//given 2-dimension params and return flattened linear index
 		extern int SH_FlattenIndex(int l, int m);
 
+		//batch evaluation of all (highestOrderIndex+1)^2 SH basis functions for 'dirCount' directions (SoA, normalized here).
+		//basis (l,m) of direction i is output to outBasis[SH_FlattenIndex(l,m) * basisStride + i].
+		//same basis as SH() (and SH_Recursive() beyond band 4), computed with normalized legendre recurrence
+		//shared by all m of a direction, several directions per SIMD instruction. no order limit
+		extern void SH_EvalBatch(int highestOrderIndex, uint32_t dirCount, const float* dirX, const float* dirY, const float* dirZ, float* outBasis, uint32_t basisStride);
+
+		//AoS version, outBasis is resized to (highestOrderIndex+1)^2 * dirList.size(), basisStride = dirList.size()
+		extern void SH_EvalBatch(int highestOrderIndex, const std::vector<Vec3>& dirList, std::vector<float>& outBasis);
+
 		//SH normalization term K
 		extern float SH_NormalizationTermK(int l, int m);
 
@@ -255,3 +255,301 @@ void Noise3D::GI::SHRotationWignerMatrix::mFunction_MultiplyRotationY(std::vecto
 		}
 	}
 }
+
+/**********************************************
+
+						SHRotationZXZXZ
+
+***********************************************/
+
+//band 0~4 of SH() take z as polar axis, higher bands (SH_Recursive()) take y
+static const uint32_t c_zPolarBandEnd = 4;
+
+Noise3D::GI::SHRotationZXZXZ::SHRotationZXZXZ(uint32_t highestBandIndex):
+	mHighestBandIndex(highestBandIndex)
+{
+	m_pCache = SHRotationZXZXZ::mFunction_GetRotationX90Cache(highestBandIndex);
+
+	//identity
+	for (int i = 0; i < 2; ++i)
+	{
+		mCosList[i].assign(3 * (highestBandIndex + 1), 1.0f);
+		mSinList[i].assign(3 * (highestBandIndex + 1), 0.0f);
+	}
+}
+
+void Noise3D::GI::SHRotationZXZXZ::SetRotation(const RigidTransform & t)
+{
+	//columns are rotated basis vectors (so the result doesn't depend on matrix layout conventions)
+	Vec3 origin = t.TransformVector_Rigid(Vec3(0, 0, 0));
+	Vec3 axisList[3] =
+	{
+		t.TransformVector_Rigid(Vec3(1.0f, 0, 0)) - origin,
+		t.TransformVector_Rigid(Vec3(0, 1.0f, 0)) - origin,
+		t.TransformVector_Rigid(Vec3(0, 0, 1.0f)) - origin
+	};
+
+	double mat[3][3];
+	for (int col = 0; col < 3; ++col)
+	{
+		mat[0][col] = axisList[col].x;
+		mat[1][col] = axisList[col].y;
+		mat[2][col] = axisList[col].z;
+	}
+	SHRotationZXZXZ::mFunction_SetRotationMatrix(mat);
+}
+
+void Noise3D::GI::SHRotationZXZXZ::Rotate(const std::vector<Color4f>& inSHVector, std::vector<Color4f>& outSHVector) const
+{
+	SHRotationZXZXZ::Rotate(std::vector<const std::vector<Color4f>*>(1, &inSHVector), std::vector<std::vector<Color4f>*>(1, &outSHVector));
+}
+
+void Noise3D::GI::SHRotationZXZXZ::Rotate(const std::vector<const std::vector<Color4f>*>& inSHVectorList, const std::vector<std::vector<Color4f>*>& outSHVectorList) const
+{
+	if (inSHVectorList.size() != outSHVectorList.size())
+	{
+		ERROR_MSG("SHRotationZXZXZ: input and output SH vector count not match!");
+		return;
+	}
+
+	//band count of each vector
+	std::vector<uint32_t> bandCountList(inSHVectorList.size());
+	for (uint32_t i = 0; i < inSHVectorList.size(); ++i)
+	{
+		uint32_t size = inSHVectorList[i]->size();
+		uint32_t bandCount = uint32_t(std::sqrt(float(size)) + 0.5f);
+		if (bandCount * bandCount != size || bandCount > mHighestBandIndex + 1)
+		{
+			ERROR_MSG("SHRotationZXZXZ: SH vector dimension not match!");
+			return;
+		}
+		bandCountList[i] = bandCount;
+		outSHVectorList[i]->resize(size);
+	}
+
+	//band by band, so that a band's matrices are reused by all vectors
+	std::vector<Color4f> tmpBand(2 * mHighestBandIndex + 1);
+	for (uint32_t l = 0; l <= mHighestBandIndex; ++l)
+	{
+		for (uint32_t i = 0; i < inSHVectorList.size(); ++i)
+		{
+			if (l >= bandCountList[i])continue;
+			const Color4f* pIn = inSHVectorList[i]->data() + l * l;
+			Color4f* pOut = outSHVectorList[i]->data() + l * l;
+			SHRotationZXZXZ::mFunction_RotateBand(l, pIn, pOut, tmpBand.data());
+		}
+	}
+}
+
+/**********************************************
+
+							PRIVATE
+
+***********************************************/
+std::shared_ptr<const Noise3D::GI::SHRotationZXZXZ::N_RotationX90Cache> Noise3D::GI::SHRotationZXZXZ::mFunction_GetRotationX90Cache(uint32_t highestBandIndex)
+{
+	static std::mutex cacheMutex;
+	static std::shared_ptr<const N_RotationX90Cache> pCache;
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (pCache == nullptr || pCache->highestBandIndex < highestBandIndex)
+	{
+		//instances holding the old cache keep it alive
+		std::shared_ptr<N_RotationX90Cache> pNewCache = std::make_shared<N_RotationX90Cache>();
+		SHRotationZXZXZ::mFunction_ComputeRotationX90(highestBandIndex, *pNewCache);
+		pCache = pNewCache;
+	}
+	return pCache;
+}
+
+void Noise3D::GI::SHRotationZXZXZ::mFunction_ComputeRotationX90(uint32_t highestBandIndex, N_RotationX90Cache & outCache)
+{
+	outCache.highestBandIndex = highestBandIndex;
+	outCache.matPos90.assign(mFunction_BandMatrixOffset(highestBandIndex + 1), 0.0f);
+	outCache.matNeg90.assign(mFunction_BandMatrixOffset(highestBandIndex + 1), 0.0f);
+
+	//Y_j(R^-1 * dir) = sum_i(M_ij * Y_i(dir)), M_ij = integral of Y_i(dir) * Y_j(R^-1 * dir) over sphere.
+	//the integrand is a polynomial of degree <= 2*highestBandIndex, so gauss-legendre quadrature in z
+	//(highestBandIndex+1 nodes) x uniform quadrature in phi (2*highestBandIndex+2 nodes) is exact
+	uint32_t zCount = highestBandIndex + 1;
+	uint32_t phiCount = 2 * highestBandIndex + 2;
+	std::vector<double> zList(zCount), zWeightList(zCount);
+	for (uint32_t i = 0; i < zCount; ++i)
+	{
+		//newton iteration for roots of legendre polynomial P_n
+		double x = std::cos(double(Ut::PI) * (double(i) + 0.75) / (double(zCount) + 0.5));
+		double derivative = 1.0;
+		for (int iteration = 0; iteration < 100; ++iteration)
+		{
+			double p0 = 1.0, p1 = x;
+			for (uint32_t k = 2; k <= zCount; ++k)
+			{
+				double p2 = (double(2 * k - 1) * x * p1 - double(k - 1) * p0) / double(k);
+				p0 = p1;
+				p1 = p2;
+			}
+			if (zCount == 1)p0 = 1.0;
+			derivative = double(zCount) * (x * p1 - p0) / (x * x - 1.0);
+			double dx = p1 / derivative;
+			x -= dx;
+			if (std::abs(dx) < 1e-15)break;
+		}
+		zList[i] = x;
+		zWeightList[i] = 2.0 / ((1.0 - x * x) * derivative * derivative);
+	}
+
+	//sample directions (SoA), and R^-1 * dir = Rx(-90) * dir = (x, z, -y)
+	uint32_t dirCount = zCount * phiCount;
+	std::vector<float> dirX(dirCount), dirY(dirCount), dirZ(dirCount), dirNegY(dirCount);
+	std::vector<double> weightList(dirCount);
+	for (uint32_t i = 0; i < zCount; ++i)
+	{
+		for (uint32_t j = 0; j < phiCount; ++j)
+		{
+			double phi = 2.0 * double(Ut::PI) * double(j) / double(phiCount);
+			double r = std::sqrt(std::max<double>(1.0 - zList[i] * zList[i], 0.0));
+			uint32_t k = i * phiCount + j;
+			dirX[k] = float(r * std::cos(phi));
+			dirY[k] = float(r * std::sin(phi));
+			dirZ[k] = float(zList[i]);
+			dirNegY[k] = -dirY[k];
+			weightList[k] = zWeightList[i] * 2.0 * double(Ut::PI) / double(phiCount);
+		}
+	}
+
+	//z-polar basis of all bands. SH_EvalBatch() takes y as polar axis beyond band 4,
+	//swapping y/z of input gives z-polar basis of those bands
+	auto evalZPolarBasis = [&](const float* pX, const float* pY, const float* pZ, std::vector<float>& outBasis)
+	{
+		uint32_t coefficientCount = (highestBandIndex + 1) * (highestBandIndex + 1);
+		outBasis.resize(coefficientCount * dirCount);
+		GI::SH_EvalBatch(highestBandIndex, dirCount, pX, pY, pZ, outBasis.data(), dirCount);
+		if (highestBandIndex > c_zPolarBandEnd)
+		{
+			std::vector<float> swappedBasis(coefficientCount * dirCount);
+			GI::SH_EvalBatch(highestBandIndex, dirCount, pX, pZ, pY, swappedBasis.data(), dirCount);
+			uint32_t bandBegin = (c_zPolarBandEnd + 1) * (c_zPolarBandEnd + 1);
+			std::copy(swappedBasis.begin() + bandBegin * dirCount, swappedBasis.end(), outBasis.begin() + bandBegin * dirCount);
+		}
+	};
+	std::vector<float> basisList, rotatedBasisList;
+	evalZPolarBasis(dirX.data(), dirY.data(), dirZ.data(), basisList);
+	evalZPolarBasis(dirX.data(), dirZ.data(), dirNegY.data(), rotatedBasisList);
+
+	for (uint32_t l = 0; l <= highestBandIndex; ++l)
+	{
+		uint32_t n = 2 * l + 1;
+		float* pMatPos = &outCache.matPos90[mFunction_BandMatrixOffset(l)];
+		float* pMatNeg = &outCache.matNeg90[mFunction_BandMatrixOffset(l)];
+		for (uint32_t row = 0; row < n; ++row)
+		{
+			const float* pBasis = &basisList[(l * l + row) * dirCount];
+			for (uint32_t col = 0; col < n; ++col)
+			{
+				const float* pRotatedBasis = &rotatedBasisList[(l * l + col) * dirCount];
+				double sum = 0.0;
+				for (uint32_t k = 0; k < dirCount; ++k)sum += weightList[k] * double(pBasis[k]) * double(pRotatedBasis[k]);
+
+				//orthogonal matrix, Rx(-90) is the transpose
+				pMatPos[row * n + col] = float(sum);
+				pMatNeg[col * n + row] = float(sum);
+			}
+		}
+	}
+}
+
+uint32_t Noise3D::GI::SHRotationZXZXZ::mFunction_BandMatrixOffset(uint32_t l)
+{
+	//sum of (2k+1)^2, k=0~l-1
+	return l * (2 * l - 1) * (2 * l + 1) / 3;
+}
+
+void Noise3D::GI::SHRotationZXZXZ::mFunction_SetRotationMatrix(const double mat[3][3])
+{
+	//convention 0: z-polar bands, use R directly.
+	//convention 1: y-polar bands, Y_y(dir) = Y_z(S * dir) (S swaps y and z), so rotate with S * R * S instead
+	const int axisMap[2][3] = { { 0,1,2 },{ 0,2,1 } };
+	for (int convention = 0; convention < 2; ++convention)
+	{
+		double m[3][3];
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int col = 0; col < 3; ++col)
+			{
+				m[row][col] = mat[axisMap[convention][row]][axisMap[convention][col]];
+			}
+		}
+
+		//R = Rz(alpha) * Ry(beta) * Rz(gamma)
+		double beta = std::acos(std::max<double>(-1.0, std::min<double>(1.0, m[2][2])));
+		double alpha = 0.0, gamma = 0.0;
+		if (std::sin(beta) > 1e-6)
+		{
+			alpha = std::atan2(m[1][2], m[0][2]);
+			gamma = std::atan2(m[2][1], -m[2][0]);
+		}
+		else if (m[2][2] > 0.0)
+		{
+			//gimbal lock, only alpha+gamma matters
+			alpha = std::atan2(m[1][0], m[0][0]);
+		}
+		else
+		{
+			alpha = std::atan2(-m[1][0], -m[0][0]);
+		}
+
+		//angles in the order of application to SH vector
+		double angleList[3] = { gamma, beta, alpha };
+		for (int angleId = 0; angleId < 3; ++angleId)
+		{
+			for (uint32_t i = 0; i <= mHighestBandIndex; ++i)
+			{
+				mCosList[convention][angleId * (mHighestBandIndex + 1) + i] = float(std::cos(double(i) * angleList[angleId]));
+				mSinList[convention][angleId * (mHighestBandIndex + 1) + i] = float(std::sin(double(i) * angleList[angleId]));
+			}
+		}
+	}
+}
+
+void Noise3D::GI::SHRotationZXZXZ::mFunction_RotateBand(uint32_t l, const Color4f * pIn, Color4f * pOut, Color4f * pTmp) const
+{
+	int convention = (l <= c_zPolarBandEnd) ? 0 : 1;
+	const float* pCos = mCosList[convention].data();
+	const float* pSin = mSinList[convention].data();
+	uint32_t n = 2 * l + 1;
+	const float* pMatPos = &m_pCache->matPos90[mFunction_BandMatrixOffset(l)];
+	const float* pMatNeg = &m_pCache->matNeg90[mFunction_BandMatrixOffset(l)];
+
+	//coefficient pair (m, -m) rotates like a 2d vector (index l+m, l-m in band)
+	auto rotateZ = [&](Color4f* pBand, uint32_t angleId)
+	{
+		for (uint32_t m = 1; m <= l; ++m)
+		{
+			float c = pCos[angleId * (mHighestBandIndex + 1) + m];
+			float s = pSin[angleId * (mHighestBandIndex + 1) + m];
+			Color4f posM = pBand[l + m];
+			Color4f negM = pBand[l - m];
+			pBand[l + m] = posM * c - negM * s;
+			pBand[l - m] = negM * c + posM * s;
+		}
+	};
+
+	auto multiply = [&](const float* pMat, const Color4f* pBandIn, Color4f* pBandOut)
+	{
+		for (uint32_t row = 0; row < n; ++row)
+		{
+			Color4f sum = Color4f(0, 0, 0, 0);
+			for (uint32_t col = 0; col < n; ++col)sum += pBandIn[col] * pMat[row * n + col];
+			pBandOut[row] = sum;
+		}
+	};
+
+	//Rz(gamma) -> Rx(+90) -> Rz(beta) -> Rx(-90) -> Rz(alpha). (pIn may be pOut)
+	for (uint32_t i = 0; i < n; ++i)pTmp[i] = pIn[i];
+	rotateZ(pTmp, 0);
+	multiply(pMatPos, pTmp, pOut);
+	rotateZ(pOut, 1);
+	multiply(pMatNeg, pOut, pTmp);
+	rotateZ(pTmp, 2);
+	for (uint32_t i = 0; i < n; ++i)pOut[i] = pTmp[i];
+}
@@ -59,5 +59,59 @@ namespace Noise3D
 			std::vector<std::vector<float>> mMat;//a series of wigner matrix (in different band)
 
 		};
+
+		//(2019)SH rotation by ZXZXZ decomposition: R = Rz(a) * Ry(b) * Rz(c), Ry(b) = Rx(-90) * Rz(b) * Rx(+90).
+		//rotation about z is applied analytically (2x2 per coefficient pair), the fixed +-90 degree rotations
+		//about x don't depend on R, they are computed once and cached (shared by all instances).
+		//rotated SH signal f'(dir) = f(R^-1 * dir), i.e. f' evaluated at the rotated direction equals f at the original one.
+		//reference: Kautz, Sloan & Snyder, Fast, Arbitrary BRDF Shading for Low-Frequency Lighting Using Spherical Harmonics(2002)
+		class SHRotationZXZXZ
+		{
+		public:
+
+			SHRotationZXZXZ(uint32_t highestBandIndex);
+
+			//decompose rotation part of 't' (euler angles and their cos/sin tables are computed once here)
+			void SetRotation(const RigidTransform& t);
+
+			//rotate SH vector with current rotation (band count is decided by the input size)
+			void Rotate(const std::vector<Color4f>& inSHVector, std::vector<Color4f>& outSHVector) const;
+
+			//rotate many SH vectors with the same rotation (band matrices are reused by all vectors)
+			void Rotate(const std::vector<const std::vector<Color4f>*>& inSHVectorList, const std::vector<std::vector<Color4f>*>& outSHVectorList) const;
+
+		private:
+
+			//fixed rotation about x axis, block-diagonal (band 0,1,..) row-major matrices in one buffer
+			struct N_RotationX90Cache
+			{
+				uint32_t highestBandIndex;
+				std::vector<float> matPos90;//Rx(+90)
+				std::vector<float> matNeg90;//Rx(-90), transpose of Rx(+90)
+			};
+
+			//cached matrices are rebuilt only when a higher band is requested
+			static std::shared_ptr<const N_RotationX90Cache> mFunction_GetRotationX90Cache(uint32_t highestBandIndex);
+
+			//band l matrix of Rx(+90), fitted by quadrature of SH basis (exact for band-limited functions)
+			static void mFunction_ComputeRotationX90(uint32_t highestBandIndex, N_RotationX90Cache& outCache);
+
+			//offset of band l's (2l+1)^2 matrix in block-diagonal buffer
+			static uint32_t mFunction_BandMatrixOffset(uint32_t l);
+
+			//column-vector 3x3 rotation matrix
+			void mFunction_SetRotationMatrix(const double mat[3][3]);
+
+			void mFunction_RotateBand(uint32_t l, const Color4f* pIn, Color4f* pOut, Color4f* pTmp) const;
+
+			uint32_t mHighestBandIndex;
+
+			std::shared_ptr<const N_RotationX90Cache> m_pCache;
+
+			//cos(m*angle), sin(m*angle) (m=0~highestBandIndex) of 3 euler angles, [angleId * (highestBandIndex+1) + m].
+			//band 0~4 (hardcoded SH, z as polar axis) and band 5~ (SH_Recursive, y as polar axis) have their own angles
+			std::vector<float> mCosList[2];
+			std::vector<float> mSinList[2];
+		};
 	}
 }
\ No newline at end of file
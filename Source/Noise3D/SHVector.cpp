@@ -18,6 +18,13 @@ Noise3D::GI::SHVector::SHVector():
 }
 
 void Noise3D::GI::SHVector::Project(int highestOrderIndex, int monteCarloSampleCount, ISphericalFunc<Color4f>* pTargetFunc)
+{
+	N_SHProjectionDesc desc;
+	desc.sampleCount = monteCarloSampleCount;
+	SHVector::Project(highestOrderIndex, desc, pTargetFunc);
+}
+
+void Noise3D::GI::SHVector::Project(int highestOrderIndex, const N_SHProjectionDesc & desc, ISphericalFunc<Color4f>* pTargetFunc)
 {
 	if (highestOrderIndex < 0)
 	{
@@ -25,43 +32,84 @@ void Noise3D::GI::SHVector::Project(int highestOrderIndex, int monteCarloSampleC
 		return;
 	}
 
-	if (monteCarloSampleCount < 1)
+	if (desc.sampleCount < 1)
 	{
 		ERROR_MSG("SHVector: monte carlo ray sample count ought to be larger than 0.");
 		return;
 	}
 
+	if (pTargetFunc == nullptr)
+	{
+		ERROR_MSG("SHVector: target spherical function is nullptr.");
+		return;
+	}
+
 	//n-order SH have n^2 coefficients in total
 	mOrder = highestOrderIndex;
 	int coefficientCount = (highestOrderIndex+1) * (highestOrderIndex+1);//0-based index
-	mCoefficients.resize(coefficientCount);
 
-	//compute SH coefficients by convolving
-	GI::RandomSampleGenerator randomGen;
-#pragma omp parallel for
-	for (int sampleIndex = 0; sampleIndex < monteCarloSampleCount; ++sampleIndex)
-	{
-		Vec3 dir = randomGen.UniformSphericalVec();
+	//each block has its own random stream. non-deterministic projection just picks a new seed
+	uint64_t seed = desc.seed;
+	if (!desc.isDeterministic)seed = GI::RandomSampleGenerator::ComputeSeed(desc.seed, std::random_device()());
 
-		//for every direction sample, calculate all of its SH coefficient by convolving f(x) and corresponding SH function value
-		//L--band index
-		for (int L = 0; L <= highestOrderIndex; ++L)
+	//partial sums of each block, reduced in block order afterwards (so the result doesn't depend on scheduling)
+	int sampleCount = desc.sampleCount;
+	uint32_t blockCount = uint32_t((sampleCount + c_projectionBlockSize - 1) / c_projectionBlockSize);
+	std::vector<Color4f> blockCoefficientList(blockCount * coefficientCount, Color4f(0, 0, 0, 0));
+	uint32_t threadCount = Ut::ResolveThreadCount(desc.threadCount);
+
+	Ut::ParallelFor(blockCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		std::vector<float> dirX(c_projectionBlockSize), dirY(c_projectionBlockSize), dirZ(c_projectionBlockSize);
+		std::vector<Color4f> colorList(c_projectionBlockSize);
+		std::vector<float> basisList(coefficientCount * c_projectionBlockSize);
+		for (uint32_t blockId = chunkBegin; blockId < chunkEnd; ++blockId)
 		{
-			//M--coefficient index inside a SH band
-			for (int M = -L; M <= L; ++M)
+			GI::RandomSampleGenerator randomGen(seed, blockId);
+			Color4f* pBlockCoefficients = &blockCoefficientList[blockId * coefficientCount];
+			int sampleBegin = int(blockId) * c_projectionBlockSize;
+			int sampleEnd = std::min<int>(sampleBegin + c_projectionBlockSize, sampleCount);
+			uint32_t blockSampleCount = uint32_t(sampleEnd - sampleBegin);
+			for (int sampleIndex = sampleBegin; sampleIndex < sampleEnd; ++sampleIndex)
 			{
-				//convolve target spherical function 'pTargetFunc f(x)' with convolution kernel pSHFunc
-				//now just sum them up on sphere surface, monte-carlo integration's division will be done later
-				Color4f color = pTargetFunc->Eval(dir);
-				float sphFunc = GI::SH(L, M, dir);
-				mCoefficients.at(SH_FlattenIndex(L, M)) += color * sphFunc;
+				Vec3 dir = (desc.sampling == NOISE_SH_PROJECTION_SAMPLING::FIBONACCI_SPHERE) ?
+					mFunction_FibonacciSphereDir(sampleIndex, sampleCount) : randomGen.UniformSphericalVec();
+
+				//target function is evaluated once per direction
+				//(convolution kernel is the SH function, monte-carlo integration's division will be done later)
+				uint32_t i = uint32_t(sampleIndex - sampleBegin);
+				colorList[i] = pTargetFunc->Eval(dir);
+				dirX[i] = dir.x; dirY[i] = dir.y; dirZ[i] = dir.z;
 			}
+
+			//SH basis of the whole block, for all L/M
+			GI::SH_EvalBatch(highestOrderIndex, blockSampleCount, dirX.data(), dirY.data(), dirZ.data(), basisList.data(), c_projectionBlockSize);
+			for (int coefIndex = 0; coefIndex < coefficientCount; ++coefIndex)
+			{
+				const float* pBasis = &basisList[coefIndex * c_projectionBlockSize];
+				Color4f sum = Color4f(0, 0, 0, 0);
+				for (uint32_t i = 0; i < blockSampleCount; ++i)
+				{
+					sum += colorList[i] * pBasis[i];
+				}
+				pBlockCoefficients[coefIndex] = sum;
+			}
+		}
+	});
+
+	mCoefficients.assign(coefficientCount, Color4f(0, 0, 0, 0));
+	for (uint32_t blockId = 0; blockId < blockCount; ++blockId)
+	{
+		for (int i = 0; i < coefficientCount; ++i)
+		{
+			mCoefficients.at(i) += blockCoefficientList[blockId * coefficientCount + i];
 		}
 	}
 
 	//weight = 1.0f/(p(x)) = 1.0f/ (1.0f/4pi)) = 4pi
+	//(fibonacci points are equal-area, the same weight applies)
 	constexpr float c_sampleWeight = 4.0f * Ut::PI;
-	float mulFactor = c_sampleWeight / float(monteCarloSampleCount);
+	float mulFactor = c_sampleWeight / float(sampleCount);
 
 	//done summing up sample value, do the division of numerical integration
 	for (int i = 0; i < coefficientCount; ++i)
@@ -77,18 +125,121 @@ void Noise3D::GI::SHVector::Project(int highestOrderIndex, int monteCarloSampleC
 	mIsInitialized = true;
 }
 
-Color4f Noise3D::GI::SHVector::Eval(Vec3 dir)
+void Noise3D::GI::SHVector::ProjectLatLongMap(int highestOrderIndex, Texture2D * pTex, uint32_t threadCount)
 {
+	if (highestOrderIndex < 0)
+	{
+		ERROR_MSG("SHVector: SH order index should be positive.");
+		return;
+	}
 
-	Vec4 result = { 0,0,0,0};
-	for (int L = 0; L <= mOrder; ++L)
+	if (pTex == nullptr || !pTex->IsSysMemBufferValid())
 	{
-		//M--coefficient index inside a SH band
-		for (int M = -L; M <= L; ++M)
+		ERROR_MSG("SHVector: texture is nullptr or it didn't keep a copy in memory.");
+		return;
+	}
+
+	uint32_t width = pTex->GetWidth();
+	uint32_t height = pTex->GetHeight();
+
+	//texel (x,y) covers yaw [2pi*x/w-pi, 2pi*(x+1)/w-pi], pitch [pi/2-pi*(y+1)/h, pi/2-pi*y/h].
+	//solid angle = dYaw * (sin(pitchTop) - sin(pitchBottom)), the same for a whole row
+	auto rowFunc = [&](uint32_t y, std::vector<Vec3>& outDirList, std::vector<Color4f>& outWeightedColorList)
+	{
+		float pitchTop = (0.5f - float(y) / float(height)) * Ut::PI;
+		float pitchBottom = (0.5f - float(y + 1) / float(height)) * Ut::PI;
+		float pitch = (0.5f - (float(y) + 0.5f) / float(height)) * Ut::PI;
+		float solidAngle = (2.0f * Ut::PI / float(width)) * (std::sin(pitchTop) - std::sin(pitchBottom));
+
+		outDirList.resize(width);
+		outWeightedColorList.resize(width);
+		for (uint32_t x = 0; x < width; ++x)
 		{
-			//result = sum(coefficient * SH_basis)
-			result += mCoefficients.at(SH_FlattenIndex(L, M)) * GI::SH(L, M, dir);
+			float yaw = ((float(x) + 0.5f) / float(width) - 0.5f) * 2.0f * Ut::PI;
+			outDirList[x] = Ut::YawPitchToDirection(yaw, pitch);
+			outWeightedColorList[x] = pTex->GetPixelFloat(x, y) * solidAngle;
 		}
+	};
+	SHVector::mFunction_ProjectTexelRows(highestOrderIndex, height, threadCount, rowFunc);
+}
+
+void Noise3D::GI::SHVector::ProjectCubeMap(int highestOrderIndex, TextureCubeMap * pTex, uint32_t threadCount)
+{
+	if (highestOrderIndex < 0)
+	{
+		ERROR_MSG("SHVector: SH order index should be positive.");
+		return;
+	}
+
+	if (pTex == nullptr || !pTex->IsSysMemBufferValid())
+	{
+		ERROR_MSG("SHVector: texture is nullptr or it didn't keep a copy in memory.");
+		return;
+	}
+
+	uint32_t width = pTex->GetWidth();
+	uint32_t height = pTex->GetHeight();
+
+	//a row is a row of a face (6*height rows in total). 
+	//texel center is mapped back to direction with the inverse of TextureCubeMap::GetPixel(dir)'s mapping,
+	//so the texel read by GetPixel(dir) is exactly the texel (x,y) of the face
+	auto rowFunc = [&](uint32_t rowId, std::vector<Vec3>& outDirList, std::vector<Color4f>& outWeightedColorList)
+	{
+		uint32_t faceID = rowId / height;
+		uint32_t y = rowId % height;
+		float v = (float(y) + 0.5f) / float(height);
+		float b0 = 2.0f * float(y) / float(height) - 1.0f;
+		float b1 = 2.0f * float(y + 1) / float(height) - 1.0f;
+
+		outDirList.resize(width);
+		outWeightedColorList.resize(width);
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			float u = (float(x) + 0.5f) / float(width);
+
+			//position on the width=2 cube, in GetPixel()'s (negated, x/z swapped) space
+			Vec3 p;
+			switch (faceID)
+			{
+			case 0: p = Vec3(1.0f, 1.0f - 2.0f * v, 1.0f - 2.0f * u); break;//+x
+			case 1: p = Vec3(-1.0f, 1.0f - 2.0f * v, 2.0f * u - 1.0f); break;//-x
+			case 2: p = Vec3(2.0f * u - 1.0f, 1.0f, 2.0f * v - 1.0f); break;//+y
+			case 3: p = Vec3(2.0f * u - 1.0f, -1.0f, 1.0f - 2.0f * v); break;//-y
+			case 4: p = Vec3(2.0f * u - 1.0f, 1.0f - 2.0f * v, 1.0f); break;//+z
+			default: p = Vec3(1.0f - 2.0f * u, 1.0f - 2.0f * v, -1.0f); break;//-z
+			}
+			Vec3 dir = Vec3(-p.z, -p.y, -p.x);
+			dir.Normalize();
+			outDirList[x] = dir;
+
+			//exact solid angle of the texel [a0,a1]x[b0,b1] on the face
+			float a0 = 2.0f * float(x) / float(width) - 1.0f;
+			float a1 = 2.0f * float(x + 1) / float(width) - 1.0f;
+			float solidAngle =
+				mFunction_CubeMapAreaElement(a1, b1) - mFunction_CubeMapAreaElement(a0, b1) -
+				mFunction_CubeMapAreaElement(a1, b0) + mFunction_CubeMapAreaElement(a0, b0);
+
+			outWeightedColorList[x] = pTex->SamplePixel(dir, TextureCubeMap::N_TEXTURE_CPU_SAMPLE_MODE::POINT) * solidAngle;
+		}
+	};
+	SHVector::mFunction_ProjectTexelRows(highestOrderIndex, 6 * height, threadCount, rowFunc);
+}
+
+Color4f Noise3D::GI::SHVector::Eval(Vec3 dir)
+{
+	int coefficientCount = (mOrder + 1) * (mOrder + 1);
+	if (mCoefficients.size() < coefficientCount)return Color4f(0, 0, 0, 0);
+
+	//all SH basis of the direction in one pass (per-thread buffer, Eval() is called by path tracer workers)
+	thread_local std::vector<float> basisList;
+	basisList.resize(coefficientCount);
+	GI::SH_EvalBatch(mOrder, 1, &dir.x, &dir.y, &dir.z, basisList.data(), 1);
+
+	//result = sum(coefficient * SH_basis)
+	Vec4 result = { 0,0,0,0};
+	for (int i = 0; i < coefficientCount; ++i)
+	{
+		result += mCoefficients[i] * basisList[i];
 	}
 	result = Noise3D::Ut::Clamp(result, Vec4(0, 0, 0, 0), Vec4(1.0f, 1.0f, 1.0f,1.0f));
 	return result;
@@ -96,20 +247,32 @@ Color4f Noise3D::GI::SHVector::Eval(Vec3 dir)
 
 Color4f Noise3D::GI::SHVector::EvalRotated(Vec3 dir)
 {
+	int coefficientCount = (mOrder + 1) * (mOrder + 1);
+	if (mRotatedCoefficients.size() < coefficientCount)return Color4f(0, 0, 0, 0);
+
+	thread_local std::vector<float> basisList;
+	basisList.resize(coefficientCount);
+	GI::SH_EvalBatch(mOrder, 1, &dir.x, &dir.y, &dir.z, basisList.data(), 1);
+
 	Vec4 result = { 0,0,0,0 };
-	for (int L = 0; L <= mOrder; ++L)
+	for (int i = 0; i < coefficientCount; ++i)
 	{
-		//M--coefficient index inside a SH band
-		for (int M = -L; M <= L; ++M)
-		{
-			//result = sum(coefficient * SH_basis)
-			result += mRotatedCoefficients.at(SH_FlattenIndex(L, M)) * GI::SH(L, M, dir);
-		}
+		result += mRotatedCoefficients[i] * basisList[i];
 	}
 	result = Noise3D::Ut::Clamp(result, Vec4(0, 0, 0, 0), Vec4(1.0f, 1.0f, 1.0f, 1.0f));
 	return result;
 }
 
+void Noise3D::GI::SHVector::Eval(const std::vector<Vec3>& dirList, std::vector<Color4f>& outList)
+{
+	SHVector::mFunction_EvalBatch(mCoefficients, dirList, outList);
+}
+
+void Noise3D::GI::SHVector::EvalRotated(const std::vector<Vec3>& dirList, std::vector<Color4f>& outList)
+{
+	SHVector::mFunction_EvalBatch(mRotatedCoefficients, dirList, outList);
+}
+
 Color4f Noise3D::GI::SHVector::Integrate(const SHVector& rhs)
 {
 	//(a1,a2,a3,a4,.....,0,0,0)
@@ -134,9 +297,28 @@ Color4f Noise3D::GI::SHVector::Integrate(const SHVector& rhs)
 
 void Noise3D::GI::SHVector::SetRotation(RigidTransform t)
 {
-	GI::SHRotationWignerMatrix mat(mOrder);
-	mRotatedCoefficients.resize(mCoefficients.size());
-	mat.Multiply(t,mCoefficients, mRotatedCoefficients);
+	//fixed rotation matrices are cached by SHRotationZXZXZ, only euler angles are computed per call
+	GI::SHRotationZXZXZ rotation(mOrder);
+	rotation.SetRotation(t);
+	rotation.Rotate(mCoefficients, mRotatedCoefficients);
+}
+
+void Noise3D::GI::SHVector::SetRotation(RigidTransform t, const std::vector<SHVector*>& shVectorList)
+{
+	int highestOrderIndex = 0;
+	std::vector<const std::vector<Color4f>*> inList;
+	std::vector<std::vector<Color4f>*> outList;
+	for (SHVector* pVec : shVectorList)
+	{
+		if (pVec == nullptr)continue;
+		highestOrderIndex = std::max<int>(highestOrderIndex, pVec->mOrder);
+		inList.push_back(&pVec->mCoefficients);
+		outList.push_back(&pVec->mRotatedCoefficients);
+	}
+
+	GI::SHRotationZXZXZ rotation(highestOrderIndex);
+	rotation.SetRotation(t);
+	rotation.Rotate(inList, outList);
 }
 
 void Noise3D::GI::SHVector::GetCoefficients(std::vector<Color4f>& outList)
@@ -177,4 +359,110 @@ bool Noise3D::GI::SHVector::IsInitialized() const
 
 									PRIVATE
 
-**********************************************************/
\ No newline at end of file
+**********************************************************/
+
+Vec3 Noise3D::GI::SHVector::mFunction_FibonacciSphereDir(int i, int n)
+{
+	//uniform steps in y (equal-area bands), azimuth advances by golden angle.
+	//(y is the polar axis, same as SH_Recursive()'s parameterization)
+	float y = 1.0f - (2.0f * float(i) + 1.0f) / float(n);
+	float r = std::sqrt(std::max<float>(1.0f - y * y, 0.0f));
+	double goldenFrac = double(i) * 0.6180339887498949;//i/phi
+	float yaw = 2.0f * Ut::PI * float(goldenFrac - std::floor(goldenFrac));
+	return Vec3(r * std::cos(yaw), y, r * std::sin(yaw));
+}
+
+void Noise3D::GI::SHVector::mFunction_ProjectTexelRows(int highestOrderIndex, uint32_t rowCount, uint32_t threadCount, 
+	const std::function<void(uint32_t, std::vector<Vec3>&, std::vector<Color4f>&)>& rowFunc)
+{
+	mOrder = highestOrderIndex;
+	int coefficientCount = (highestOrderIndex + 1) * (highestOrderIndex + 1);
+	std::vector<Color4f> rowCoefficientList(rowCount * coefficientCount, Color4f(0, 0, 0, 0));
+
+	Ut::ParallelFor(rowCount, Ut::ResolveThreadCount(threadCount), 
+		[&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+	{
+		std::vector<Vec3> dirList;
+		std::vector<Color4f> weightedColorList;
+		std::vector<float> basisList;
+		for (uint32_t rowId = chunkBegin; rowId < chunkEnd; ++rowId)
+		{
+			rowFunc(rowId, dirList, weightedColorList);
+
+			//SH basis of the whole row, then a coefficient at a time (contiguous texel arrays)
+			uint32_t texelCount = dirList.size();
+			GI::SH_EvalBatch(highestOrderIndex, dirList, basisList);
+			Color4f* pRowCoefficients = &rowCoefficientList[rowId * coefficientCount];
+			for (int coefIndex = 0; coefIndex < coefficientCount; ++coefIndex)
+			{
+				const float* pBasis = basisList.data() + coefIndex * texelCount;
+				Color4f sum = Color4f(0, 0, 0, 0);
+				for (uint32_t i = 0; i < texelCount; ++i)
+				{
+					sum += weightedColorList[i] * pBasis[i];
+				}
+				pRowCoefficients[coefIndex] = sum;
+			}
+		}
+	});
+
+	//texels already carry their integration weight (solid angle)
+	mCoefficients.assign(coefficientCount, Color4f(0, 0, 0, 0));
+	for (uint32_t rowId = 0; rowId < rowCount; ++rowId)
+	{
+		for (int i = 0; i < coefficientCount; ++i)
+		{
+			mCoefficients.at(i) += rowCoefficientList[rowId * coefficientCount + i];
+		}
+	}
+
+	if (!mIsInitialized)
+	{
+		mRotatedCoefficients = mCoefficients;
+	}
+
+	mIsInitialized = true;
+}
+
+void Noise3D::GI::SHVector::mFunction_EvalBatch(const std::vector<Color4f>& coefficientList, const std::vector<Vec3>& dirList, std::vector<Color4f>& outList) const
+{
+	int coefficientCount = (mOrder + 1) * (mOrder + 1);
+	outList.assign(dirList.size(), Color4f(0, 0, 0, 0));
+	if (coefficientList.size() < coefficientCount)return;
+
+	//directions are processed in blocks to keep the basis buffer small ((order+1)^2 x block size)
+	const uint32_t c_blockSize = 256;
+	std::vector<float> dirX(c_blockSize), dirY(c_blockSize), dirZ(c_blockSize);
+	std::vector<float> basisList(coefficientCount * c_blockSize);
+	for (uint32_t blockBegin = 0; blockBegin < dirList.size(); blockBegin += c_blockSize)
+	{
+		uint32_t blockDirCount = std::min<uint32_t>(c_blockSize, dirList.size() - blockBegin);
+		for (uint32_t i = 0; i < blockDirCount; ++i)
+		{
+			const Vec3& dir = dirList[blockBegin + i];
+			dirX[i] = dir.x; dirY[i] = dir.y; dirZ[i] = dir.z;
+		}
+		GI::SH_EvalBatch(mOrder, blockDirCount, dirX.data(), dirY.data(), dirZ.data(), basisList.data(), c_blockSize);
+
+		Color4f* pOut = &outList[blockBegin];
+		for (int coefIndex = 0; coefIndex < coefficientCount; ++coefIndex)
+		{
+			const Color4f& coef = coefficientList[coefIndex];
+			const float* pBasis = &basisList[coefIndex * c_blockSize];
+			for (uint32_t i = 0; i < blockDirCount; ++i)
+			{
+				pOut[i] += coef * pBasis[i];
+			}
+		}
+		for (uint32_t i = 0; i < blockDirCount; ++i)
+		{
+			pOut[i] = Noise3D::Ut::Clamp(pOut[i], Vec4(0, 0, 0, 0), Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+		}
+	}
+}
+
+float Noise3D::GI::SHVector::mFunction_CubeMapAreaElement(float a, float b)
+{
+	//integral of dA/(1+a^2+b^2)^(3/2) over [0,a]x[0,b]
+	return std::atan2(a * b, std::sqrt(a * a + b * b + 1.0f));
+}
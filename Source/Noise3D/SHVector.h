@@ -22,6 +22,40 @@ namespace Noise3D
 {
 	namespace GI
 	{
+		//how direction samples of SH projection are generated
+		enum class NOISE_SH_PROJECTION_SAMPLING
+		{
+			//independent uniform random directions (monte carlo)
+			UNIFORM_RANDOM,
+
+			//spherical fibonacci point set. evenly distributed equal-area samples (quasi monte carlo), no randomness
+			FIBONACCI_SPHERE
+		};
+
+		//params of SH projection
+		struct N_SHProjectionDesc
+		{
+			N_SHProjectionDesc():
+				sampleCount(10000),
+				sampling(NOISE_SH_PROJECTION_SAMPLING::UNIFORM_RANDOM),
+				threadCount(0),
+				isDeterministic(true),
+				seed(0){}
+
+			int sampleCount;
+
+			NOISE_SH_PROJECTION_SAMPLING sampling;
+
+			//0 for std::thread::hardware_concurrency(). pTargetFunc->Eval() is called concurrently if it's not 1
+			uint32_t threadCount;
+
+			//if true, result only depends on sample count/sampling/seed (not on thread count or scheduling).
+			//otherwise random samples are re-seeded on each Project()
+			bool isDeterministic;
+
+			uint64_t seed;
+		};
+
 		//a general Spherical Harmonic coefficent vector class (several operation on SH coefficients are available)
 		//template <typename T> but if i use template in early dev phase, i can't take advantage of intelli-sense
 		class /*_declspec(dllexport)*/ SHVector
@@ -34,12 +68,31 @@ namespace Noise3D
 			//higher order SH functions is implemented using recursive method of Spherical Harmonic Terms (SH_Recursive())
 			void Project(int highestOrderIndex, int monteCarloSampleCount, ISphericalFunc<Color4f>* pTargetFunc);
 
+			//samples are split into fixed-size blocks, each block has its own random stream and coefficient accumulator,
+			//blocks are projected in parallel and reduced in block order. (no shared state is written during sampling)
+			void Project(int highestOrderIndex, const N_SHProjectionDesc& desc, ISphericalFunc<Color4f>* pTargetFunc);
+
+			//deterministic projection of a lat-long(spherical mapping) environment map, no sampling noise.
+			//every texel is weighted by its solid angle, SH basis is evaluated at texel center.
+			//(same mapping as Texture2dSampler_Spherical, the texture must keep a copy in memory).
+			//rows are projected in parallel by 'threadCount' threads (0 for hardware concurrency)
+			void ProjectLatLongMap(int highestOrderIndex, Texture2D* pTex, uint32_t threadCount = 0);
+
+			//deterministic projection of all texels of a cube map's 6 faces (weighted by texel solid angle)
+			void ProjectCubeMap(int highestOrderIndex, TextureCubeMap* pTex, uint32_t threadCount = 0);
+
 			//reconstruct SH signal and evaluate spherical function value in given direction
 			Color4f Eval(Vec3 dir);
 
 			//reconstruct rotated SH signal and evaluate spherical function value in given direction
 			Color4f EvalRotated(Vec3 dir);
 
+			//evaluate SH signal in many directions at once (SH basis of all directions are computed in batch, SH_EvalBatch())
+			void Eval(const std::vector<Vec3>& dirList, std::vector<Color4f>& outList);
+
+			//batch version of EvalRotated()
+			void EvalRotated(const std::vector<Vec3>& dirList, std::vector<Color4f>& outList);
+
 			//perform SH-based integration (common usage is integration between spherical irradiance function
 			//& transfer function to get the final illuminated color) (Actually a dot product of 2 SH vectors)
 			//if the 2 operand's dimension are not equal, 0 will be used to pad to calculate dot product
@@ -48,6 +101,9 @@ namespace Noise3D
 			//make use of SHRotation class. Note that we don't
 			void SetRotation(RigidTransform t);
 
+			//rotate many SH vectors with the same rotation in one call (rotated coefficients of each vector are updated)
+			static void SetRotation(RigidTransform t, const std::vector<SHVector*>& shVectorList);
+
 			//get SH coefficient
 			void GetCoefficients(std::vector<Color4f>& outList);
 
@@ -65,6 +121,23 @@ namespace Noise3D
 
 		private:
 
+			//i-th point of spherical fibonacci point set of n points
+			static Vec3 mFunction_FibonacciSphereDir(int i, int n);
+
+			//rowFunc(rowId, outDirList, outWeightedColorList) outputs texel directions of a row and their color * solid angle.
+			//rows are projected in parallel, partial sums are reduced in row order
+			void mFunction_ProjectTexelRows(int highestOrderIndex, uint32_t rowCount, uint32_t threadCount, 
+				const std::function<void(uint32_t, std::vector<Vec3>&, std::vector<Color4f>&)>& rowFunc);
+
+			//sum of coefficient * basis for each direction, clamped to [0,1]
+			void mFunction_EvalBatch(const std::vector<Color4f>& coefficientList, const std::vector<Vec3>& dirList, std::vector<Color4f>& outList) const;
+
+			//solid angle of the cube face region [0,a]x[0,b] (face at distance 1)
+			static float mFunction_CubeMapAreaElement(float a, float b);
+
+			//samples per block of Project() (block boundaries don't depend on thread count)
+			static const int c_projectionBlockSize = 1024;
+
 			//init by SH Projection
 			bool mIsInitialized;
 
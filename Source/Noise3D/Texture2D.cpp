@@ -10,7 +10,9 @@
 using namespace Noise3D;
 using namespace Noise3D::D3D;
 
-Texture2D::Texture2D()
+Texture2D::Texture2D():
+	mIsCpuPixelStoreHDR(false),
+	mIsPixelBufferDirty(false)
 {
 
 }
@@ -27,6 +29,7 @@ void Texture2D::SetPixel(UINT x, UINT y, const Color4u & color)
 		{
 			UINT pixelIndex = y*mWidth + x;
 			mPixelBuffer.at(pixelIndex) = color;
+			mIsPixelBufferDirty.store(true, std::memory_order_relaxed);
 		}
 		else
 		{
@@ -70,6 +73,7 @@ bool Texture2D::SetPixelArray(const std::vector<Color4u>& in_ColorArray)
 		if (in_ColorArray.size() == mPixelBuffer.size())
 		{
 			mPixelBuffer.assign(in_ColorArray.begin(), in_ColorArray.end());
+			Texture2D::mFunction_OnPixelBufferModified();
 			return true;
 		}
 		else
@@ -88,6 +92,7 @@ bool Texture2D::SetPixelArray(std::vector<Color4u>&& in_ColorArray)
 		if (in_ColorArray.size() == mPixelBuffer.size())
 		{
 			mPixelBuffer = std::move(in_ColorArray);
+			Texture2D::mFunction_OnPixelBufferModified();
 			return true;
 		}
 		else
@@ -113,45 +118,98 @@ bool Texture2D::GetPixelArray(std::vector<Color4u>& outColorArray) const
 
 Color4f Noise3D::Texture2D::SamplePixelBilinear(Vec2 texcoord) const
 {
+	//float pixels, no conversion
+	if (Texture2D::mFunction_IsCpuPixelStoreUpToDate())return mCpuPixelStore.SampleBilinear(texcoord);
+
 	if (Texture2D::IsSysMemBufferValid())
 	{
-		float px_f = texcoord.x * float(mWidth);
-		float py_f = texcoord.y * float(mHeight);
-		int px = int(px_f);
-		int py = int(py_f);
+		return Texture2D::mFunction_SamplePixelBufferBilinear(texcoord);
+	}
+	else
+	{
+		WARNING_MSG("GetPixel : didn't keep a copy in memory !!!");
+	}
+	return Color4f(0, 0, 0, 0);
+}
 
-		int pixelId[4] =
-		{
-			((py) % mHeight) *mWidth + ((px) % mWidth),
-			((py+1) % mHeight) *mWidth + ((px) % mWidth),
-			((py) % mHeight) *mWidth + ((px+1) % mWidth),
-			((py+1) % mHeight) *mWidth + ((px+1) % mWidth)
-		};
-
-		Color4f pixels[4];
-		for (int i = 0; i < 4; ++i)
-		{
-			const Color4u& c = mPixelBuffer.at(pixelId[i]);
-			pixels[i] = Color4f(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, 1.0f);
-		}
+Color4f Noise3D::Texture2D::SamplePixelTrilinear(Vec2 texcoord, float lod) const
+{
+	if (Texture2D::mFunction_IsCpuPixelStoreUpToDate())return mCpuPixelStore.SampleTrilinear(texcoord, lod);
+	return Texture2D::SamplePixelBilinear(texcoord);
+}
 
-		//bilinear interpolation's uv within these 4 pixels
-		float local_u = px_f - float(px);
-		float local_v = py_f - float(py);
-		if (px < 0)local_u = -local_u;
-		if (py < 0)local_v = -local_v;
+void Noise3D::Texture2D::SamplePixelBilinear(const std::vector<Vec2>& texcoordList, std::vector<Color4f>& outList) const
+{
+	outList.resize(texcoordList.size());
+	if (Texture2D::mFunction_IsCpuPixelStoreUpToDate())
+	{
+		mCpuPixelStore.SampleBilinear(texcoordList.size(), texcoordList.data(), 0, outList.data());
+		return;
+	}
 
-		Color4f tmp1 = XMVectorLerp(pixels[0],pixels[2],local_u) ;
-		Color4f tmp2 = XMVectorLerp(pixels[1], pixels[3], local_u);
-		Color4f result = XMVectorLerp(tmp1, tmp2, local_v);
+	for (uint32_t i = 0; i < texcoordList.size(); ++i)
+	{
+		outList[i] = Texture2D::SamplePixelBilinear(texcoordList[i]);
+	}
+}
+
+Color4f Noise3D::Texture2D::GetPixelFloat(UINT x, UINT y) const
+{
+	if (Texture2D::mFunction_IsCpuPixelStoreUpToDate())return mCpuPixelStore.GetPixel(0, x, y);
+
+	Color4u c = Texture2D::GetPixel(x, y);
+	return Color4f(float(c.r) / 255.0f, float(c.g) / 255.0f, float(c.b) / 255.0f, float(c.a) / 255.0f);
+}
 
-		return result;
+bool Noise3D::Texture2D::CreateCpuPixelStore(NOISE_TEXTURE_CPU_PIXEL_FORMAT format, bool generateMipMap)
+{
+	if (!ITexture::IsSysMemBufferValid())
+	{
+		ERROR_MSG("CreateCpuPixelStore: Texture didn't have a copy in System Memory!");
+		return false;
 	}
-	else
+
+	//level 0 of 8-bit pixel buffer
+	std::vector<Color4f> pixelList(mWidth * mHeight);
+	for (uint32_t i = 0; i < pixelList.size(); ++i)
 	{
-		WARNING_MSG("GetPixel : didn't keep a copy in memory !!!");
+		const Color4u& c = mPixelBuffer[i];
+		pixelList[i] = Color4f(float(c.r) / 255.0f, float(c.g) / 255.0f, float(c.b) / 255.0f, float(c.a) / 255.0f);
 	}
-	return Color4f(0, 0, 0, 0);
+	mCpuPixelStore.Create(mWidth, mHeight, pixelList.data(), format, generateMipMap);
+	mIsCpuPixelStoreHDR = false;
+	mIsPixelBufferDirty = false;
+	return mCpuPixelStore.IsValid();
+}
+
+bool Noise3D::Texture2D::CreateCpuPixelStore(const std::vector<Color4f>& hdrPixelArray, NOISE_TEXTURE_CPU_PIXEL_FORMAT format, bool generateMipMap)
+{
+	if (hdrPixelArray.size() != mWidth * mHeight || hdrPixelArray.empty())
+	{
+		ERROR_MSG("CreateCpuPixelStore : array size didn't match.");
+		return false;
+	}
+	mCpuPixelStore.Create(mWidth, mHeight, hdrPixelArray.data(), format, generateMipMap);
+	mIsCpuPixelStoreHDR = true;
+	mIsPixelBufferDirty = false;
+	return mCpuPixelStore.IsValid();
+}
+
+void Noise3D::Texture2D::ReleaseCpuPixelStore()
+{
+	mCpuPixelStore.Clear();
+	mIsCpuPixelStoreHDR = false;
+	mIsPixelBufferDirty = false;
+}
+
+bool Noise3D::Texture2D::IsCpuPixelStoreValid() const
+{
+	return Texture2D::mFunction_IsCpuPixelStoreUpToDate();
+}
+
+void Noise3D::Texture2D::SetCpuSampleWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE mode)
+{
+	mCpuPixelStore.SetWrapMode(mode);
 }
 
 //if user modified pixels via setPixel()/setPixelArray(), 
@@ -160,6 +218,9 @@ bool Texture2D::UpdateToVideoMemory()
 {
 	if (ITexture::IsSysMemBufferValid())
 	{
+		//pixels set by SetPixel() are committed here (SetPixel() is called concurrently, e.g. by path tracer workers)
+		if (mIsPixelBufferDirty)Texture2D::mFunction_OnPixelBufferModified();
+
 		//after modifying buffer in memory, update to GPU
 		ID3D11Resource* pTmpRes;
 		//resource reference count will increase ,so remember to release
@@ -221,6 +282,7 @@ bool Texture2D::ConvertTextureToGreyMap(float factorR, float factorG, float fact
 		float greyScale = factorR *c.r + factorG*c.g + factorB*c.b;
 		c = Color4u(uint8_t(greyScale), uint8_t(greyScale), uint8_t(greyScale), c.a);
 	}
+	Texture2D::mFunction_OnPixelBufferModified();
 
 	//after modifying buffer in memory, update to GPU
 	ID3D11Resource* pTmpRes;
@@ -334,6 +396,7 @@ bool Texture2D::ConvertHeightMapToNormalMap(float heightFieldScaleFactor)
 
 	//copy calculated result
 	mPixelBuffer = std::move(tmpNormalMap);
+	Texture2D::mFunction_OnPixelBufferModified();
 
 	//after modifying buffer in memory, update to GPU
 	ID3D11Resource* pTmpRes;
@@ -476,4 +539,49 @@ void NOISE_MACRO_FUNCTION_EXTERN_CALL Texture2D::mFunction_InitTexture(ID3D11Sha
 	mHeight = texDesc.Height;
 	mMipMapLevels = texDesc.MipLevels;
 	mMipMapChainPixelCount = Ut::ComputeMipMapChainPixelCount(texDesc.MipLevels, mWidth, mHeight);
+	Texture2D::ReleaseCpuPixelStore();
+}
+
+void Noise3D::Texture2D::mFunction_OnPixelBufferModified()
+{
+	//HDR pixels given by user don't match the modified pixels either
+	Texture2D::ReleaseCpuPixelStore();
+}
+
+bool Noise3D::Texture2D::mFunction_IsCpuPixelStoreUpToDate() const
+{
+	return mCpuPixelStore.IsValid() && !mIsPixelBufferDirty.load(std::memory_order_relaxed);
+}
+
+Color4f Noise3D::Texture2D::mFunction_SamplePixelBufferBilinear(Vec2 texcoord) const
+{
+	//same addressing as TextureCpuPixelStore(repeat): texel centers at (i+0.5)/size, bit mask for power-of-2 sizes
+	float px_f = texcoord.x * float(mWidth) - 0.5f;
+	float py_f = texcoord.y * float(mHeight) - 0.5f;
+	float floorX = std::floor(px_f);
+	float floorY = std::floor(py_f);
+	bool isPowerOfTwo = ((mWidth & (mWidth - 1)) == 0) && ((mHeight & (mHeight - 1)) == 0);
+	auto wrap = [isPowerOfTwo](int coord, uint32_t size)->uint32_t
+	{
+		if (isPowerOfTwo)return uint32_t(coord) & (size - 1);
+		int wrapped = coord % int(size);
+		return uint32_t(wrapped < 0 ? wrapped + int(size) : wrapped);
+	};
+	uint32_t x0 = wrap(int(floorX), mWidth), x1 = wrap(int(floorX) + 1, mWidth);
+	uint32_t y0 = wrap(int(floorY), mHeight), y1 = wrap(int(floorY) + 1, mHeight);
+
+	uint32_t pixelId[4] = { y0 * mWidth + x0, y1 * mWidth + x0, y0 * mWidth + x1, y1 * mWidth + x1 };
+	Color4f pixels[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		const Color4u& c = mPixelBuffer[pixelId[i]];
+		pixels[i] = Color4f(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, 1.0f);
+	}
+
+	//bilinear interpolation's uv within these 4 pixels
+	float local_u = px_f - floorX;
+	float local_v = py_f - floorY;
+	Color4f tmp1 = XMVectorLerp(pixels[0], pixels[2], local_u);
+	Color4f tmp2 = XMVectorLerp(pixels[1], pixels[3], local_u);
+	return XMVectorLerp(tmp1, tmp2, local_v);
 }
@@ -27,6 +27,8 @@ namespace Noise3D
 	{
 	public:
 
+		//cpu pixel store is released by following UpdateToVideoMemory(), not here (different pixels can be set
+		//concurrently). until then cpu sampling reads the 8-bit pixel buffer instead of the stale store
 		void				SetPixel(UINT x, UINT y, const Color4u& color);
 
 		Color4u		GetPixel(UINT x, UINT y) const;
@@ -37,7 +39,27 @@ namespace Noise3D
 
 		bool				GetPixelArray(std::vector<Color4u>& outColorArray) const;
 
-		Color4f			SamplePixelBilinear(Vec2 texcoord) const;//sample a pixel
+		Color4f			SamplePixelBilinear(Vec2 texcoord) const;//sample a pixel (from cpu pixel store if it's created)
+
+		Color4f			SamplePixelTrilinear(Vec2 texcoord, float lod) const;//sample mip chain of cpu pixel store (bilinear if there is no store)
+
+		void				SamplePixelBilinear(const std::vector<Vec2>& texcoordList, std::vector<Color4f>& outList) const;//SIMD batch sampling
+
+		Color4f			GetPixelFloat(UINT x, UINT y) const;//level 0 pixel, HDR value if the cpu pixel store keeps one
+
+		//float/half copy (and mip chain) of pixels for cpu-end sampling, converted from the 8-bit pixel buffer.
+		//(modification of 8-bit pixels releases the store)
+		bool				CreateCpuPixelStore(NOISE_TEXTURE_CPU_PIXEL_FORMAT format = NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32, bool generateMipMap = true);
+
+		//cpu pixel store with HDR pixels given by user (size must match the texture), video memory is not affected.
+		//(modification of 8-bit pixels releases the store too)
+		bool				CreateCpuPixelStore(const std::vector<Color4f>& hdrPixelArray, NOISE_TEXTURE_CPU_PIXEL_FORMAT format = NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32, bool generateMipMap = true);
+
+		void				ReleaseCpuPixelStore();
+
+		bool				IsCpuPixelStoreValid() const;//false if pixels were modified after the store was created
+
+		void				SetCpuSampleWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE mode);
 
 		bool				UpdateToVideoMemory();//update image's memory data to video memory
 
@@ -65,6 +87,21 @@ namespace Noise3D
 			std::vector<Color4u>&& pixelBuff,
 			bool isSysMemBuffValid) override;
 
+		//8-bit pixel buffer is modified, release the cpu pixel store (HDR or converted from 8-bit pixels)
+		void		mFunction_OnPixelBufferModified();
+
+		//cpu pixel store is valid and there is no pending SetPixel() modification
+		bool		mFunction_IsCpuPixelStoreUpToDate() const;
+
+		//bilinear sampling of 8-bit pixel buffer (when there is no cpu pixel store)
+		Color4f	mFunction_SamplePixelBufferBilinear(Vec2 texcoord) const;
+
+		TextureCpuPixelStore mCpuPixelStore;
+
+		bool mIsCpuPixelStoreHDR;//given by user, not converted from 8-bit pixel buffer
+
+		std::atomic<bool> mIsPixelBufferDirty;//set by SetPixel(), cleared when the store is released
+
 	};
 
 };
\ No newline at end of file
@@ -0,0 +1,294 @@
+
+/***********************************************************************
+
+							cpp: Texture CPU Pixel Store
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+using namespace DirectX::PackedVector;
+
+Noise3D::TextureCpuPixelStore::TextureCpuPixelStore():
+	mFormat(NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32),
+	mWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE::REPEAT)
+{
+}
+
+void Noise3D::TextureCpuPixelStore::Create(uint32_t width, uint32_t height, const Color4f * pPixels, NOISE_TEXTURE_CPU_PIXEL_FORMAT format, bool generateMipMap)
+{
+	TextureCpuPixelStore::Clear();
+	if (width == 0 || height == 0 || pPixels == nullptr)
+	{
+		ERROR_MSG("TextureCpuPixelStore: invalid pixel data.");
+		return;
+	}
+	mFormat = format;
+
+	//mip chain layout
+	uint32_t pixelCount = 0;
+	uint32_t levelWidth = width, levelHeight = height;
+	while (true)
+	{
+		N_MipLevel level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.pixelOffset = pixelCount;
+		level.isPowerOfTwo = ((levelWidth & (levelWidth - 1)) == 0) && ((levelHeight & (levelHeight - 1)) == 0);
+		mMipLevelList.push_back(level);
+		pixelCount += levelWidth * levelHeight;
+		if (!generateMipMap || (levelWidth == 1 && levelHeight == 1))break;
+		levelWidth = std::max<uint32_t>(levelWidth / 2, 1);
+		levelHeight = std::max<uint32_t>(levelHeight / 2, 1);
+	}
+
+	//mips are always generated in float, then converted
+	std::vector<Color4f> chain(pixelCount);
+	std::copy(pPixels, pPixels + width * height, chain.begin());
+	for (uint32_t i = 1; i < mMipLevelList.size(); ++i)
+	{
+		const N_MipLevel& src = mMipLevelList[i - 1];
+		const N_MipLevel& dst = mMipLevelList[i];
+		for (uint32_t y = 0; y < dst.height; ++y)
+		{
+			uint32_t y0 = std::min<uint32_t>(2 * y, src.height - 1);
+			uint32_t y1 = std::min<uint32_t>(2 * y + 1, src.height - 1);
+			for (uint32_t x = 0; x < dst.width; ++x)
+			{
+				uint32_t x0 = std::min<uint32_t>(2 * x, src.width - 1);
+				uint32_t x1 = std::min<uint32_t>(2 * x + 1, src.width - 1);
+				Color4f sum = chain[src.pixelOffset + y0 * src.width + x0];
+				sum += chain[src.pixelOffset + y0 * src.width + x1];
+				sum += chain[src.pixelOffset + y1 * src.width + x0];
+				sum += chain[src.pixelOffset + y1 * src.width + x1];
+				chain[dst.pixelOffset + y * dst.width + x] = sum * 0.25f;
+			}
+		}
+	}
+
+	if (format == NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32)
+	{
+		mPixelsF32 = std::move(chain);
+	}
+	else
+	{
+		mPixelsF16.resize(4 * pixelCount);
+		for (uint32_t i = 0; i < pixelCount; ++i)
+		{
+			mPixelsF16[4 * i + 0] = XMConvertFloatToHalf(chain[i].x);
+			mPixelsF16[4 * i + 1] = XMConvertFloatToHalf(chain[i].y);
+			mPixelsF16[4 * i + 2] = XMConvertFloatToHalf(chain[i].z);
+			mPixelsF16[4 * i + 3] = XMConvertFloatToHalf(chain[i].w);
+		}
+	}
+}
+
+void Noise3D::TextureCpuPixelStore::Clear()
+{
+	mMipLevelList.clear();
+	mPixelsF32.clear();
+	mPixelsF16.clear();
+}
+
+bool Noise3D::TextureCpuPixelStore::IsValid() const
+{
+	return !mMipLevelList.empty();
+}
+
+void Noise3D::TextureCpuPixelStore::SetWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE mode)
+{
+	mWrapMode = mode;
+}
+
+NOISE_TEXTURE_CPU_WRAP_MODE Noise3D::TextureCpuPixelStore::GetWrapMode() const
+{
+	return mWrapMode;
+}
+
+NOISE_TEXTURE_CPU_PIXEL_FORMAT Noise3D::TextureCpuPixelStore::GetFormat() const
+{
+	return mFormat;
+}
+
+uint32_t Noise3D::TextureCpuPixelStore::GetMipLevelCount() const
+{
+	return mMipLevelList.size();
+}
+
+uint32_t Noise3D::TextureCpuPixelStore::GetWidth(uint32_t level) const
+{
+	return level < mMipLevelList.size() ? mMipLevelList[level].width : 0;
+}
+
+uint32_t Noise3D::TextureCpuPixelStore::GetHeight(uint32_t level) const
+{
+	return level < mMipLevelList.size() ? mMipLevelList[level].height : 0;
+}
+
+Color4f Noise3D::TextureCpuPixelStore::GetPixel(uint32_t level, uint32_t x, uint32_t y) const
+{
+	if (level >= mMipLevelList.size() || x >= mMipLevelList[level].width || y >= mMipLevelList[level].height)
+	{
+		WARNING_MSG("TextureCpuPixelStore: GetPixel out of range!");
+		return Color4f(0, 0, 0, 0);
+	}
+	return TextureCpuPixelStore::mFunction_Fetch(mMipLevelList[level], x, y);
+}
+
+Color4f Noise3D::TextureCpuPixelStore::SampleBilinear(Vec2 texcoord, uint32_t level) const
+{
+	if (mMipLevelList.empty())return Color4f(0, 0, 0, 0);
+	const N_MipLevel& mip = mMipLevelList[std::min<uint32_t>(level, mMipLevelList.size() - 1)];
+
+	float px_f = texcoord.x * float(mip.width) - 0.5f;
+	float py_f = texcoord.y * float(mip.height) - 0.5f;
+	float floorX = std::floor(px_f);
+	float floorY = std::floor(py_f);
+	float local_u = px_f - floorX;
+	float local_v = py_f - floorY;
+
+	uint32_t x0 = mFunction_WrapCoord(int(floorX), mip.width, mip.isPowerOfTwo);
+	uint32_t x1 = mFunction_WrapCoord(int(floorX) + 1, mip.width, mip.isPowerOfTwo);
+	uint32_t y0 = mFunction_WrapCoord(int(floorY), mip.height, mip.isPowerOfTwo);
+	uint32_t y1 = mFunction_WrapCoord(int(floorY) + 1, mip.height, mip.isPowerOfTwo);
+
+	Color4f c00 = mFunction_Fetch(mip, x0, y0);
+	Color4f c10 = mFunction_Fetch(mip, x1, y0);
+	Color4f c01 = mFunction_Fetch(mip, x0, y1);
+	Color4f c11 = mFunction_Fetch(mip, x1, y1);
+	Color4f tmp1 = c00 + (c10 - c00) * local_u;
+	Color4f tmp2 = c01 + (c11 - c01) * local_u;
+	return tmp1 + (tmp2 - tmp1) * local_v;
+}
+
+Color4f Noise3D::TextureCpuPixelStore::SampleTrilinear(Vec2 texcoord, float lod) const
+{
+	if (mMipLevelList.empty())return Color4f(0, 0, 0, 0);
+	lod = std::min<float>(std::max<float>(lod, 0.0f), float(mMipLevelList.size() - 1));
+	uint32_t level0 = uint32_t(lod);
+	uint32_t level1 = std::min<uint32_t>(level0 + 1, mMipLevelList.size() - 1);
+	float t = lod - float(level0);
+
+	Color4f c0 = TextureCpuPixelStore::SampleBilinear(texcoord, level0);
+	if (t == 0.0f || level0 == level1)return c0;
+	Color4f c1 = TextureCpuPixelStore::SampleBilinear(texcoord, level1);
+	return c0 + (c1 - c0) * t;
+}
+
+void Noise3D::TextureCpuPixelStore::SampleBilinear(uint32_t count, const Vec2 * pTexcoordList, uint32_t level, Color4f * pOutList) const
+{
+	using namespace Noise3D::SIMD;
+	if (mMipLevelList.empty())
+	{
+		for (uint32_t i = 0; i < count; ++i)pOutList[i] = Color4f(0, 0, 0, 0);
+		return;
+	}
+	const N_MipLevel& mip = mMipLevelList[std::min<uint32_t>(level, mMipLevelList.size() - 1)];
+
+	//SoA lanes: fraction of texel position, and the 4 texels' channels
+	alignas(32) float fracX[NOISE_SIMD_WIDTH];
+	alignas(32) float fracY[NOISE_SIMD_WIDTH];
+	alignas(32) float texel[4][4][NOISE_SIMD_WIDTH];//[corner 00,10,01,11][channel]
+	alignas(32) float result[4][NOISE_SIMD_WIDTH];
+
+	for (uint32_t groupBegin = 0; groupBegin < count; groupBegin += NOISE_SIMD_WIDTH)
+	{
+		uint32_t laneCount = std::min<uint32_t>(NOISE_SIMD_WIDTH, count - groupBegin);
+
+		//addressing (integer) and gathering are scalar
+		for (uint32_t i = 0; i < NOISE_SIMD_WIDTH; ++i)
+		{
+			Vec2 texcoord = (i < laneCount) ? pTexcoordList[groupBegin + i] : Vec2(0, 0);
+			float px_f = texcoord.x * float(mip.width) - 0.5f;
+			float py_f = texcoord.y * float(mip.height) - 0.5f;
+			float floorX = std::floor(px_f);
+			float floorY = std::floor(py_f);
+			fracX[i] = px_f - floorX;
+			fracY[i] = py_f - floorY;
+
+			uint32_t x0 = mFunction_WrapCoord(int(floorX), mip.width, mip.isPowerOfTwo);
+			uint32_t x1 = mFunction_WrapCoord(int(floorX) + 1, mip.width, mip.isPowerOfTwo);
+			uint32_t y0 = mFunction_WrapCoord(int(floorY), mip.height, mip.isPowerOfTwo);
+			uint32_t y1 = mFunction_WrapCoord(int(floorY) + 1, mip.height, mip.isPowerOfTwo);
+			Color4f corners[4] = { mFunction_Fetch(mip, x0, y0), mFunction_Fetch(mip, x1, y0), mFunction_Fetch(mip, x0, y1), mFunction_Fetch(mip, x1, y1) };
+			for (int c = 0; c < 4; ++c)
+			{
+				texel[c][0][i] = corners[c].x;
+				texel[c][1][i] = corners[c].y;
+				texel[c][2][i] = corners[c].z;
+				texel[c][3][i] = corners[c].w;
+			}
+		}
+
+		//interpolation of all lanes at once, channel by channel
+		simd_float u = SimdLoad(fracX);
+		simd_float v = SimdLoad(fracY);
+		for (int ch = 0; ch < 4; ++ch)
+		{
+			simd_float c00 = SimdLoad(texel[0][ch]);
+			simd_float c10 = SimdLoad(texel[1][ch]);
+			simd_float c01 = SimdLoad(texel[2][ch]);
+			simd_float c11 = SimdLoad(texel[3][ch]);
+			simd_float tmp1 = SimdAdd(c00, SimdMul(SimdSub(c10, c00), u));
+			simd_float tmp2 = SimdAdd(c01, SimdMul(SimdSub(c11, c01), u));
+			SimdStore(result[ch], SimdAdd(tmp1, SimdMul(SimdSub(tmp2, tmp1), v)));
+		}
+
+		for (uint32_t i = 0; i < laneCount; ++i)
+		{
+			pOutList[groupBegin + i] = Color4f(result[0][i], result[1][i], result[2][i], result[3][i]);
+		}
+	}
+}
+
+void Noise3D::TextureCpuPixelStore::SampleTrilinear(uint32_t count, const Vec2 * pTexcoordList, float lod, Color4f * pOutList) const
+{
+	if (mMipLevelList.empty() || count == 0)
+	{
+		for (uint32_t i = 0; i < count; ++i)pOutList[i] = Color4f(0, 0, 0, 0);
+		return;
+	}
+	lod = std::min<float>(std::max<float>(lod, 0.0f), float(mMipLevelList.size() - 1));
+	uint32_t level0 = uint32_t(lod);
+	uint32_t level1 = std::min<uint32_t>(level0 + 1, mMipLevelList.size() - 1);
+	float t = lod - float(level0);
+
+	TextureCpuPixelStore::SampleBilinear(count, pTexcoordList, level0, pOutList);
+	if (t == 0.0f || level0 == level1)return;
+
+	//blend with the next level
+	std::vector<Color4f> nextLevelList(count);
+	TextureCpuPixelStore::SampleBilinear(count, pTexcoordList, level1, nextLevelList.data());
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		pOutList[i] = pOutList[i] + (nextLevelList[i] - pOutList[i]) * t;
+	}
+}
+
+/**********************************************
+
+							PRIVATE
+
+***********************************************/
+inline Color4f Noise3D::TextureCpuPixelStore::mFunction_Fetch(const N_MipLevel & level, uint32_t x, uint32_t y) const
+{
+	uint32_t index = level.pixelOffset + y * level.width + x;
+	if (mFormat == NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32)return mPixelsF32[index];
+
+	const uint16_t* pHalf = &mPixelsF16[4 * index];
+	return Color4f(XMConvertHalfToFloat(pHalf[0]), XMConvertHalfToFloat(pHalf[1]), XMConvertHalfToFloat(pHalf[2]), XMConvertHalfToFloat(pHalf[3]));
+}
+
+inline uint32_t Noise3D::TextureCpuPixelStore::mFunction_WrapCoord(int coord, uint32_t size, bool isPowerOfTwo) const
+{
+	if (mWrapMode == NOISE_TEXTURE_CPU_WRAP_MODE::CLAMP)
+	{
+		return uint32_t(std::min<int>(std::max<int>(coord, 0), int(size) - 1));
+	}
+
+	//repeat. (two's complement makes the mask work for negative coords too)
+	if (isPowerOfTwo)return uint32_t(coord) & (size - 1);
+	int wrapped = coord % int(size);
+	return uint32_t(wrapped < 0 ? wrapped + int(size) : wrapped);
+}
@@ -0,0 +1,95 @@
+
+/***********************************************************************
+
+							h: Texture CPU Pixel Store
+		desc: float/half rgba copy of a texture (and its mip chain) in system
+		memory for cpu-end sampling (path tracer, SH projection, env lighting).
+		unlike the 8-bit pixel buffer of ITexture, HDR range is kept, and no
+		format conversion is needed in bilinear/trilinear sampling.
+		a batch of texcoords can be sampled with SIMD interpolation.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	//storage format of cpu-end pixels
+	enum class NOISE_TEXTURE_CPU_PIXEL_FORMAT
+	{
+		FLOAT32,//4 floats per pixel
+		FLOAT16//4 halfs per pixel (half memory, converted on fetch)
+	};
+
+	//texel address mode out of [0,1]
+	enum class NOISE_TEXTURE_CPU_WRAP_MODE
+	{
+		REPEAT,//bit mask for power-of-2 sizes, modulo otherwise
+		CLAMP
+	};
+
+	class /*_declspec(dllexport)*/ TextureCpuPixelStore
+	{
+	public:
+
+		TextureCpuPixelStore();
+
+		//copy level 0 pixels (width * height, row-major), mip chain is generated with 2x2 box filter
+		void Create(uint32_t width, uint32_t height, const Color4f* pPixels, NOISE_TEXTURE_CPU_PIXEL_FORMAT format, bool generateMipMap);
+
+		void Clear();
+
+		bool IsValid() const;
+
+		void SetWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE mode);
+
+		NOISE_TEXTURE_CPU_WRAP_MODE GetWrapMode() const;
+
+		NOISE_TEXTURE_CPU_PIXEL_FORMAT GetFormat() const;
+
+		uint32_t GetMipLevelCount() const;
+
+		uint32_t GetWidth(uint32_t level = 0) const;
+
+		uint32_t GetHeight(uint32_t level = 0) const;
+
+		//x,y must be in range of given level
+		Color4f GetPixel(uint32_t level, uint32_t x, uint32_t y) const;
+
+		//texel centers are at (i+0.5)/size
+		Color4f SampleBilinear(Vec2 texcoord, uint32_t level = 0) const;
+
+		//bilinear samples of 2 nearest mip levels, blended by fraction of 'lod'
+		Color4f SampleTrilinear(Vec2 texcoord, float lod) const;
+
+		//batch version, weights and interpolation of NOISE_SIMD_WIDTH texcoords are computed with SIMD instructions
+		void SampleBilinear(uint32_t count, const Vec2* pTexcoordList, uint32_t level, Color4f* pOutList) const;
+
+		//batch version, the same 'lod' for all texcoords
+		void SampleTrilinear(uint32_t count, const Vec2* pTexcoordList, float lod, Color4f* pOutList) const;
+
+	private:
+
+		struct N_MipLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			uint32_t pixelOffset;//first pixel in the chain
+			bool isPowerOfTwo;//both width and height, repeat mode uses (size-1) as bit mask
+		};
+
+		Color4f mFunction_Fetch(const N_MipLevel& level, uint32_t x, uint32_t y) const;
+
+		uint32_t mFunction_WrapCoord(int coord, uint32_t size, bool isPowerOfTwo) const;
+
+		NOISE_TEXTURE_CPU_PIXEL_FORMAT mFormat;
+
+		NOISE_TEXTURE_CPU_WRAP_MODE mWrapMode;
+
+		std::vector<N_MipLevel> mMipLevelList;
+
+		std::vector<Color4f> mPixelsF32;//FLOAT32
+
+		std::vector<uint16_t> mPixelsF16;//FLOAT16, 4 halfs (rgba) per pixel
+	};
+}
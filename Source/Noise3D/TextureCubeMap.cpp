@@ -49,41 +49,16 @@ Color4u Noise3D::TextureCubeMap::GetPixel(Vec3 dir, N_TEXTURE_CPU_SAMPLE_MODE mo
 
 	if (ITexture::IsSysMemBufferValid())
 	{
-		//normalize the direction to put its end on a width=2 cube 
-		float normalizedFactor = std::max<float>(std::max<float>(abs(dir.x), abs(dir.y)), abs(dir.z));
-		dir /= -normalizedFactor;
-		std::swap(dir.x, dir.z);//right-handed to left-handed
-
-		//cube maps faces: +x, -x, +y, -y, +z, -z
-		uint32_t faceID = -1;
-		if (Ut::TolerantEqual(dir.x , 1.0f))faceID = 0;
-		else if (Ut::TolerantEqual(dir.x , -1.0f))faceID =1;
-		else if (Ut::TolerantEqual(dir.y , 1.0f))faceID = 2;
-		else if (Ut::TolerantEqual(dir.y , -1.0f))faceID =3;
-		else if (Ut::TolerantEqual(dir.z , 1.0f))faceID = 4;
-		else if (Ut::TolerantEqual(dir.z , -1.0f))faceID = 5;
-
-		if (faceID >= 6)
+		uint32_t faceID = 0;
+		float u = 0.0f, v = 0.0f;
+		if (!TextureCubeMap::mFunction_DirectionToFaceCoord(dir, faceID, u, v))
 		{
 			ERROR_MSG("GetPixel : direction invalid.");
 			return Color4u(0, 255, 255, 255);//error
 		}
 
-		uint32_t px = 0;
-		uint32_t py = 0;
-		float positiveX = (dir.x+ 1.0f)/2.0f;
-		float positiveY = (dir.y + 1.0f)/2.0f;
-		float positiveZ = (dir.z + 1.0f)/2.0f;
-		switch (faceID)
-		{
-		case 0: px = uint32_t((1.0f-positiveZ) * mWidth); py = uint32_t((1.0f- positiveY) * mHeight); break;//+x
-		case 1: px = uint32_t((positiveZ) * mWidth); py = uint32_t((1.0f - positiveY) * mHeight); break;//-x
-		case 2: px = uint32_t(positiveX * mWidth); py = uint32_t((positiveZ) * mHeight); break;//+y
-		case 3: px = uint32_t((positiveX) * mWidth); py = uint32_t((1.0f - positiveZ) * mHeight); break;//-y
-		case 4: px = uint32_t((positiveX) * mWidth); py = uint32_t((1.0f - positiveY) * mHeight); break;//+z
-		case 5: px = uint32_t((1.0f-positiveX) * mWidth); py = uint32_t((1.0f-positiveY) * mHeight); break;//-z
-		default: break;
-		}
+		uint32_t px = uint32_t(u * mWidth);
+		uint32_t py = uint32_t(v * mHeight);
 		if (px == mWidth)px = mWidth - 1;
 		if (py == mHeight)py = mHeight - 1;
 
@@ -106,6 +81,63 @@ Color4u Noise3D::TextureCubeMap::GetPixel(Vec3 dir, N_TEXTURE_CPU_SAMPLE_MODE mo
 	return Color4u(255, 0, 255, 255);
 }
 
+Color4f Noise3D::TextureCubeMap::SamplePixel(Vec3 dir, N_TEXTURE_CPU_SAMPLE_MODE mode)
+{
+	if (!mCpuFaceStore[0].IsValid())
+	{
+		Color4u c = TextureCubeMap::GetPixel(dir, mode);
+		return Color4f(float(c.r) / 255.0f, float(c.g) / 255.0f, float(c.b) / 255.0f, float(c.a) / 255.0f);
+	}
+
+	uint32_t faceID = 0;
+	float u = 0.0f, v = 0.0f;
+	if (!TextureCubeMap::mFunction_DirectionToFaceCoord(dir, faceID, u, v))
+	{
+		ERROR_MSG("SamplePixel : direction invalid.");
+		return Color4f(0, 0, 0, 0);
+	}
+
+	const TextureCpuPixelStore& face = mCpuFaceStore[faceID];
+	if (mode == BILINEAR)return face.SampleBilinear(Vec2(u, v));
+
+	uint32_t px = std::min<uint32_t>(uint32_t(u * mWidth), mWidth - 1);
+	uint32_t py = std::min<uint32_t>(uint32_t(v * mHeight), mHeight - 1);
+	return face.GetPixel(0, px, py);
+}
+
+bool Noise3D::TextureCubeMap::CreateCpuPixelStore(NOISE_TEXTURE_CPU_PIXEL_FORMAT format, bool generateMipMap)
+{
+	if (!ITexture::IsSysMemBufferValid())
+	{
+		ERROR_MSG("CreateCpuPixelStore: Texture didn't have a copy in System Memory!");
+		return false;
+	}
+
+	//level 0 of each face (faces are mMipMapChainPixelCount apart)
+	std::vector<Color4f> pixelList(mWidth * mHeight);
+	for (uint32_t faceID = 0; faceID < 6; ++faceID)
+	{
+		const Color4u* pFace = &mPixelBuffer.at(faceID * mMipMapChainPixelCount);
+		for (uint32_t i = 0; i < pixelList.size(); ++i)
+		{
+			const Color4u& c = pFace[i];
+			pixelList[i] = Color4f(float(c.r) / 255.0f, float(c.g) / 255.0f, float(c.b) / 255.0f, float(c.a) / 255.0f);
+		}
+		mCpuFaceStore[faceID].Create(mWidth, mHeight, pixelList.data(), format, generateMipMap);
+		mCpuFaceStore[faceID].SetWrapMode(NOISE_TEXTURE_CPU_WRAP_MODE::CLAMP);
+	}
+	return true;
+}
+
+void Noise3D::TextureCubeMap::ReleaseCpuPixelStore()
+{
+	for (uint32_t faceID = 0; faceID < 6; ++faceID)mCpuFaceStore[faceID].Clear();
+}
+
+bool Noise3D::TextureCubeMap::IsCpuPixelStoreValid() const
+{
+	return mCpuFaceStore[0].IsValid();
+}
 
 /*************************************
 
@@ -131,4 +163,40 @@ void NOISE_MACRO_FUNCTION_EXTERN_CALL Noise3D::TextureCubeMap::mFunction_InitTex
 	mHeight = texDesc.Height;
 	mMipMapLevels = texDesc.MipLevels;
 	mMipMapChainPixelCount = Ut::ComputeMipMapChainPixelCount(texDesc.MipLevels, mWidth, mHeight);
+	TextureCubeMap::ReleaseCpuPixelStore();
+}
+
+bool Noise3D::TextureCubeMap::mFunction_DirectionToFaceCoord(Vec3 dir, uint32_t & outFaceID, float & outU, float & outV) const
+{
+	//normalize the direction to put its end on a width=2 cube 
+	float normalizedFactor = std::max<float>(std::max<float>(abs(dir.x), abs(dir.y)), abs(dir.z));
+	if (normalizedFactor == 0.0f)return false;
+	dir /= -normalizedFactor;
+	std::swap(dir.x, dir.z);//right-handed to left-handed
+
+	//cube maps faces: +x, -x, +y, -y, +z, -z
+	uint32_t faceID = -1;
+	if (Ut::TolerantEqual(dir.x , 1.0f))faceID = 0;
+	else if (Ut::TolerantEqual(dir.x , -1.0f))faceID =1;
+	else if (Ut::TolerantEqual(dir.y , 1.0f))faceID = 2;
+	else if (Ut::TolerantEqual(dir.y , -1.0f))faceID =3;
+	else if (Ut::TolerantEqual(dir.z , 1.0f))faceID = 4;
+	else if (Ut::TolerantEqual(dir.z , -1.0f))faceID = 5;
+	if (faceID >= 6)return false;
+
+	float positiveX = (dir.x+ 1.0f)/2.0f;
+	float positiveY = (dir.y + 1.0f)/2.0f;
+	float positiveZ = (dir.z + 1.0f)/2.0f;
+	switch (faceID)
+	{
+	case 0: outU = 1.0f-positiveZ; outV = 1.0f- positiveY; break;//+x
+	case 1: outU = positiveZ; outV = 1.0f - positiveY; break;//-x
+	case 2: outU = positiveX; outV = positiveZ; break;//+y
+	case 3: outU = positiveX; outV = 1.0f - positiveZ; break;//-y
+	case 4: outU = positiveX; outV = 1.0f - positiveY; break;//+z
+	case 5: outU = 1.0f-positiveX; outV = 1.0f-positiveY; break;//-z
+	default: break;
+	}
+	outFaceID = faceID;
+	return true;
 }
@@ -28,6 +28,17 @@ namespace Noise3D
 
 		Color4u	 GetPixel(Vec3 dir, N_TEXTURE_CPU_SAMPLE_MODE mode);
 
+		//float result (HDR if cpu pixel store keeps it). bilinear filtering is clamped inside the face,
+		//and needs the cpu pixel store (otherwise the nearest texel is returned)
+		Color4f	 SamplePixel(Vec3 dir, N_TEXTURE_CPU_SAMPLE_MODE mode);
+
+		//float/half copy (and mip chain) of 6 faces for cpu-end sampling, converted from the 8-bit pixel buffer
+		bool		CreateCpuPixelStore(NOISE_TEXTURE_CPU_PIXEL_FORMAT format = NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32, bool generateMipMap = true);
+
+		void		ReleaseCpuPixelStore();
+
+		bool		IsCpuPixelStoreValid() const;
+
 	private:
 
 		friend  class TextureManager;
@@ -44,6 +55,11 @@ namespace Noise3D
 			const N_UID& uid,
 			std::vector<Color4u>&& pixelBuff,
 			bool isSysMemBuffValid) override;
+
+		//face and texcoord([0,1]) of the texel pointed by direction
+		bool		mFunction_DirectionToFaceCoord(Vec3 dir, uint32_t& outFaceID, float& outU, float& outV) const;
+
+		TextureCpuPixelStore mCpuFaceStore[6];//+x, -x, +y, -y, +z, -z
 	};
 
 };
\ No newline at end of file
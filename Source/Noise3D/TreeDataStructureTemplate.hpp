@@ -299,7 +299,9 @@ namespace Noise3D
 		//delete all nodes except root. and reset the root
 		void Reset()
 		{
-			mFunc_Remove<false>(m_pRoot);
+			//(mFunc_Remove<false> refuses to remove root, so remove sub-trees of root one by one)
+			std::vector<derivedNode_t*> childList = m_pRoot->mChildNodeList;
+			for (auto pn : childList)mFunc_Remove<false>(pn);
 			m_pRoot->mChildNodeList.clear();
 			m_pRoot->m_pFatherNode = nullptr;
 		}
@@ -0,0 +1,74 @@
+/***********************************************************************
+
+							h: BVH build info
+		desc: build method selection, build statistics and primitive
+		reference shared by BVH for scene and BVH for triangular mesh.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	enum class NOISE_BVH_BUILD_METHOD
+	{
+		//split at spatial midpoint of the largest axis into left/middle/right piles (the original method)
+		MIDPOINT,
+
+		//surface area heuristic, evaluated with binned centroids. binary tree.
+		SAH_BINNED
+	};
+
+	//statistics of a built (and flattened) BVH, to compare different build methods
+	struct N_BvhBuildStatistics
+	{
+		N_BvhBuildStatistics() :
+			nodeCount(0),
+			leafNodeCount(0),
+			primitiveCount(0),
+			maxDepth(0),
+			maxLeafPrimitiveCount(0),
+			wideNodeCount(0),
+			sahCost(0.0f) {}
+
+		uint32_t nodeCount;
+		uint32_t leafNodeCount;
+		uint32_t primitiveCount;//primitives referenced by leaf nodes
+		uint32_t maxDepth;//root is at depth 0
+		uint32_t maxLeafPrimitiveCount;
+		uint32_t wideNodeCount;//node count of the collapsed wide BVH
+
+		//expected cost of a random ray (relative to the cost of a primitive intersection)
+		//cost = sum_interior(SA(node)/SA(root)) * c_traversal + sum_leaf(SA(node)/SA(root)) * primitiveCount
+		float sahCost;
+	};
+
+	//what the last BvhTreeForScene::Refit() did
+	struct N_BvhRefitStatistics
+	{
+		N_BvhRefitStatistics() :
+			dirtyObjectCount(0),
+			rebuiltMeshBvhCount(0),
+			rebuiltSubtreeCount(0),
+			isFullyRebuilt(false) {}
+
+		uint32_t dirtyObjectCount;//objects whose world transform/geometry changed
+		uint32_t rebuiltMeshBvhCount;//meshes whose internal BVH was rebuilt (geometry changed)
+		uint32_t rebuiltSubtreeCount;//degraded sub-trees rebuilt after refit
+		bool isFullyRebuilt;//refit was impossible (e.g. objects were added/removed), the whole tree was re-constructed
+	};
+
+	//primitive(triangle/scene object) reference used during construction.
+	//builders reorder a list of it in place instead of copying sub-lists
+	struct N_BvhBuildPrimitive
+	{
+		N_BvhBuildPrimitive() : id(0) {}
+		N_BvhBuildPrimitive(uint32_t _id, const N_AABB& _aabb) :
+			aabb(_aabb), centroid((_aabb.min + _aabb.max) * 0.5f), id(_id) {}
+
+		N_AABB aabb;
+		Vec3 centroid;
+		uint32_t id;//triangle id, or index of object list
+	};
+
+}
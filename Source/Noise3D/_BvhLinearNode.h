@@ -0,0 +1,45 @@
+/***********************************************************************
+
+							h: BVH linear node
+		desc: compact node of a flattened BVH. BVH for scene and BVH for
+		triangular mesh are both flattened into a depth-first ordered node
+		array after Construct(), so that traversal walks through a
+		contiguous block of memory instead of chasing heap pointers.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	//nodes are stored in depth-first(pre-order) order, thus the first child
+	//of an interior node is always the next node in the array, and the next sibling
+	//of a node is the node right after its sub-tree. A 'skip index' is enough to describe
+	//the tree topology without any child pointers.
+	//32 bytes, 2 nodes fit in a 64-byte cache line.
+	struct N_BvhLinearNode
+	{
+		N_BvhLinearNode() : offset(0), primitiveCount(0) {}
+
+		//leaf node holds at least one primitive
+		bool IsLeafNode() const { return primitiveCount != 0; }
+
+		//index of the node right after current node's sub-tree
+		//(i.e. next sibling, or next sibling of some ancestor)
+		uint32_t GetSkipIndex(uint32_t currentIndex) const { return IsLeafNode() ? currentIndex + 1 : offset; }
+
+		N_AABB GetAABB() const { return N_AABB(aabbMin, aabbMax); }
+
+		Vec3 aabbMin;
+
+		//interior node: skip index.  leaf node: index of the first primitive in linear primitive list
+		uint32_t offset;
+
+		Vec3 aabbMax;
+
+		//0 for interior node
+		uint32_t primitiveCount;
+	};
+
+	static_assert(sizeof(N_BvhLinearNode) == 32, "N_BvhLinearNode: node size should be 32 bytes.");
+}
@@ -0,0 +1,33 @@
+/***********************************************************************
+
+							h: BVH triangle
+		desc: intersection-only copy of a mesh triangle. BVH for triangular
+		mesh stores them in the order of its linear triangle id list, so
+		that triangles of a leaf node are contiguous in memory, and a hit
+		test doesn't touch index buffer and the other vertex attributes.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	//precomputed edges for Moller-Trumbore test. (normal, texcoord... of the closest hit
+	//are interpolated from the mesh's vertex buffer afterwards)
+	//36 bytes, vs. 3 indices + 3 N_DefaultVertex scattered in the buffers
+	struct N_BvhTriangle
+	{
+		N_BvhTriangle() {}
+
+		N_BvhTriangle(const Vec3& _v0, const Vec3& _v1, const Vec3& _v2) :
+			v0(_v0), e1(_v1 - _v0), e2(_v2 - _v0) {}
+
+		Vec3 v0;
+
+		Vec3 e1;//v1 - v0
+
+		Vec3 e2;//v2 - v0
+	};
+
+	static_assert(sizeof(N_BvhTriangle) == 36, "N_BvhTriangle: triangle size should be 36 bytes.");
+}
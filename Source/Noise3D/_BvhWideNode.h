@@ -0,0 +1,67 @@
+/***********************************************************************
+
+							h: BVH wide node
+		desc: node of a 4-ary/8-ary BVH collapsed from the flattened binary
+		BVH. bounds of all children are stored in SoA layout, so a ray is
+		tested against every child with one sequence of SIMD instructions.
+		reference: Wald et al., Getting Rid of Packets(2008)
+
+************************************************************************/
+
+#pragma once
+
+//child count of a wide node: 8 for AVX, 4 otherwise (scalar fallback tests children one by one)
+#if NOISE_SIMD_WIDTH == 8
+#define NOISE_BVH_WIDE_NODE_WIDTH 8
+#else
+#define NOISE_BVH_WIDE_NODE_WIDTH 4
+#endif
+
+namespace Noise3D
+{
+	//children are packed in slots [0, childCount). a leaf child isn't a wide node,
+	//it's referred to by its primitive range directly in father's slot.
+	struct alignas(32) N_BvhWideNode
+	{
+		static const uint32_t c_width = NOISE_BVH_WIDE_NODE_WIDTH;
+
+		N_BvhWideNode() : childCount(0)
+		{
+			for (uint32_t i = 0; i < c_width; ++i)
+			{
+				childAabbMinX[i] = childAabbMinY[i] = childAabbMinZ[i] = 0.0f;
+				childAabbMaxX[i] = childAabbMaxY[i] = childAabbMaxZ[i] = 0.0f;
+				childIndex[i] = 0;
+				childPrimitiveCount[i] = 0;
+			}
+		}
+
+		bool IsChildLeaf(uint32_t i) const { return childPrimitiveCount[i] != 0; }
+
+		void SetChildAABB(uint32_t i, const N_AABB& aabb)
+		{
+			childAabbMinX[i] = aabb.min.x; childAabbMinY[i] = aabb.min.y; childAabbMinZ[i] = aabb.min.z;
+			childAabbMaxX[i] = aabb.max.x; childAabbMaxY[i] = aabb.max.y; childAabbMaxZ[i] = aabb.max.z;
+		}
+
+		N_AABB GetChildAABB(uint32_t i) const
+		{
+			return N_AABB(Vec3(childAabbMinX[i], childAabbMinY[i], childAabbMinZ[i]), Vec3(childAabbMaxX[i], childAabbMaxY[i], childAabbMaxZ[i]));
+		}
+
+		float childAabbMinX[c_width];
+		float childAabbMinY[c_width];
+		float childAabbMinZ[c_width];
+		float childAabbMaxX[c_width];
+		float childAabbMaxY[c_width];
+		float childAabbMaxZ[c_width];
+
+		//interior child: index of the wide node.  leaf child: index of the first primitive in linear primitive list
+		uint32_t childIndex[c_width];
+
+		//0 for interior child
+		uint32_t childPrimitiveCount[c_width];
+
+		uint32_t childCount;
+	};
+}
@@ -73,8 +73,10 @@ bool IFbxLoader::Initialize()
 	return true;
 }
 
-bool IFbxLoader::LoadSceneFromFbx(NFilePath fbxPath, N_FbxLoadingResult& outResult, bool loadMesh,  bool loadSkeleton)
+bool IFbxLoader::LoadSceneFromFbx(NFilePath fbxPath, N_FbxLoadingResult& outResult, bool loadMesh,  bool loadSkeleton,
+	const std::function<bool(const N_UID&)>& skipMeshGeometryFunc)
 {
+	mSkipMeshGeometryFunc = skipMeshGeometryFunc;
 	if(!_Initialize(fbxPath, loadMesh, loadSkeleton))return false;
 
 	//output result reference binding
@@ -89,8 +91,10 @@ bool IFbxLoader::LoadSceneFromFbx(NFilePath fbxPath, N_FbxLoadingResult& outResu
 	return true;
 }
 
-bool Noise3D::IFbxLoader::LoadPbrtMeshesFromFbx(NFilePath fbxPath, N_FbxPbrtSceneLoadingResult & outResult)
+bool Noise3D::IFbxLoader::LoadPbrtMeshesFromFbx(NFilePath fbxPath, N_FbxPbrtSceneLoadingResult & outResult,
+	const std::function<bool(const N_UID&)>& skipMeshGeometryFunc)
 {
+	mSkipMeshGeometryFunc = skipMeshGeometryFunc;
 	if (!_Initialize(fbxPath, true, false))return false;
 
 	//output result reference binding
@@ -297,13 +301,18 @@ void IFbxLoader::_ProcessSceneNode_Mesh(FbxNode * pNode, N_FbxMeshInfo& outMeshI
 
 
 	//--------------------------------MESH GEOMETRY--------------------------
+	//(geometry and subsets of a skipped mesh come from elsewhere, its subset list stays empty)
+	outMeshInfo.isGeometrySkipped = (mSkipMeshGeometryFunc && mSkipMeshGeometryFunc(outMeshInfo.name));
 	int triangleCount = 0;
-	_LoadMeshGeometry(pMesh, refVertexBuffer, refIndexBuffer,triangleCount);
-
-	//-----------------------------MATERIAL-------------------------------
-	//1.subset
 	std::vector<N_FbxMeshSubset> matIdSubsetList;
-	_LoadMesh_MatIndexOfTriangles(pMesh, triangleCount, matIdSubsetList);
+	if (!outMeshInfo.isGeometrySkipped)
+	{
+		_LoadMeshGeometry(pMesh, refVertexBuffer, refIndexBuffer, triangleCount);
+
+		//-----------------------------MATERIAL-------------------------------
+		//1.subset
+		_LoadMesh_MatIndexOfTriangles(pMesh, triangleCount, matIdSubsetList);
+	}
 
 	switch (matType)
 	{
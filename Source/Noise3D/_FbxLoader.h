@@ -27,9 +27,13 @@ namespace Noise3D
 		bool		Initialize();
 
 		//there are many types of scene nodes in fbx, but mesh/animation are the only two interested now(2017.9.20)
-		bool		LoadSceneFromFbx(NFilePath fbxPath, N_FbxLoadingResult& outResult, bool loadMesh=true, bool loadSkeleton =false);
+		//if skipMeshGeometryFunc(meshName) returns true, vertices/indices/subsets of that mesh aren't extracted
+		//(isGeometrySkipped is set, e.g. they are read from mesh cache), transform and materials are still loaded
+		bool		LoadSceneFromFbx(NFilePath fbxPath, N_FbxLoadingResult& outResult, bool loadMesh=true, bool loadSkeleton =false,
+			const std::function<bool(const N_UID&)>& skipMeshGeometryFunc = nullptr);
 
-		bool		LoadPbrtMeshesFromFbx(NFilePath fbxPath, N_FbxPbrtSceneLoadingResult& outResult);
+		bool		LoadPbrtMeshesFromFbx(NFilePath fbxPath, N_FbxPbrtSceneLoadingResult& outResult,
+			const std::function<bool(const N_UID&)>& skipMeshGeometryFunc = nullptr);
 
 	private:
 
@@ -115,6 +119,8 @@ namespace Noise3D
 
 		bool						mEnableLoadSkeleton;
 
+		std::function<bool(const N_UID&)>	mSkipMeshGeometryFunc;//of current LoadXXX() call
+
 	};
 
 };
\ No newline at end of file
@@ -35,9 +35,10 @@ namespace Noise3D
 
 	struct N_FbxMeshInfo
 	{
-		N_FbxMeshInfo() {}
+		N_FbxMeshInfo():isGeometrySkipped(false) {}
 
 		N_UID	name;
+		bool		isGeometrySkipped;//buffers/subsets are empty, see IFbxLoader::LoadSceneFromFbx()
 		std::vector<N_DefaultVertex> vertexBuffer;
 		std::vector<uint32_t> indexBuffer;
 		std::vector<N_MeshSubsetInfo> subsetList;
@@ -0,0 +1,245 @@
+
+/***********************************************************************
+
+						h: Parallel Dedup
+		desc: unique keys of a list (vertex dedup/welding of importers).
+		elements are partitioned into buckets by high bits of their hash,
+		each thread owns some buckets with open addressing (linear probing)
+		hash tables, and unique IDs are assigned in order of first occurrence,
+		so the result doesn't depend on thread count.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	namespace Ut
+	{
+		//32-bit hash of 3 words (keys of dedup tables)
+		inline uint32_t HashUint3(uint32_t a, uint32_t b, uint32_t c)
+		{
+			uint64_t h = uint64_t(a) * 0x9E3779B97F4A7C15ull;
+			h ^= (uint64_t(b) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2));
+			h ^= (uint64_t(c) + 0x85EBCA77C2B2AE63ull + (h << 6) + (h >> 2));
+			h ^= h >> 29;
+			return uint32_t(h * 0xBF58476D1CE4E5B9ull >> 32);
+		}
+
+		//bits of an exact position (see MakePositionKey), or integer coordinates of a grid cell
+		struct N_PositionKey
+		{
+			inline bool operator==(const N_PositionKey& rhs) const
+			{
+				return x == rhs.x && y == rhs.y && z == rhs.z;
+			}
+
+			uint32_t x, y, z;
+		};
+
+		//position compared by bits (-0 and +0 are the same)
+		inline N_PositionKey MakePositionKey(const Vec3& v)
+		{
+			N_PositionKey key;
+			memcpy(&key.x, &v.x, 4);
+			memcpy(&key.y, &v.y, 4);
+			memcpy(&key.z, &v.z, 4);
+			if (key.x == 0x80000000)key.x = 0;
+			if (key.y == 0x80000000)key.y = 0;
+			if (key.z == 0x80000000)key.z = 0;
+			return key;
+		}
+
+		inline uint32_t HashPositionKey(const N_PositionKey& key)
+		{
+			return HashUint3(key.x, key.y, key.z);
+		}
+
+		//hash table of unique keys. slots keep indices into the compact key list,
+		//and the first element of each key is recorded
+		template <typename key_t, typename hash_t>
+		struct N_DedupHashTable
+		{
+			static const uint32_t c_emptySlot = 0xffffffff;
+
+			N_DedupHashTable(size_t expectedCount, const hash_t& hashFunc) :
+				mHashFunc(hashFunc)
+			{
+				size_t capacity = 64;
+				while (capacity < expectedCount * 2)capacity *= 2;
+				slotList.assign(capacity, c_emptySlot);
+				mask = capacity - 1;
+				keyList.reserve(expectedCount);
+				firstElementList.reserve(expectedCount);
+			}
+
+			//index of the key that equals given key (new key is appended).
+			//elements must be inserted in ascending order, so keys are in order of first occurrence
+			uint32_t FindOrInsert(const key_t& key, uint32_t hash, uint32_t elementIndex)
+			{
+				if ((keyList.size() + 1) * 2 > slotList.size())mFunction_Grow();
+
+				size_t slot = hash & mask;
+				while (slotList[slot] != c_emptySlot)
+				{
+					if (keyList[slotList[slot]] == key)return slotList[slot];
+					slot = (slot + 1) & mask;
+				}
+				uint32_t newKey = uint32_t(keyList.size());
+				slotList[slot] = newKey;
+				keyList.push_back(key);
+				firstElementList.push_back(elementIndex);
+				return newKey;
+			}
+
+			//index of the key that equals given key, c_emptySlot if it's not in the table
+			uint32_t Find(const key_t& key, uint32_t hash) const
+			{
+				size_t slot = hash & mask;
+				while (slotList[slot] != c_emptySlot)
+				{
+					if (keyList[slotList[slot]] == key)return slotList[slot];
+					slot = (slot + 1) & mask;
+				}
+				return c_emptySlot;
+			}
+
+			std::vector<uint32_t> slotList;
+
+			std::vector<key_t> keyList;
+
+			std::vector<uint32_t> firstElementList;//of each key
+
+			size_t mask;
+
+		private:
+
+			void mFunction_Grow()
+			{
+				slotList.assign(slotList.size() * 2, c_emptySlot);
+				mask = slotList.size() - 1;
+				for (uint32_t i = 0; i < keyList.size(); ++i)
+				{
+					size_t slot = mHashFunc(keyList[i]) & mask;
+					while (slotList[slot] != c_emptySlot)slot = (slot + 1) & mask;
+					slotList[slot] = i;
+				}
+			}
+
+			const hash_t& mHashFunc;
+		};
+
+		template <typename key_t, typename hash_t>
+		const uint32_t N_DedupHashTable<key_t, hash_t>::c_emptySlot;
+
+		//outIdList[i] is the unique ID of i-th key ( getKey(i) ), IDs are in order of first occurrence.
+		//outFirstElementList[id] is the first element of each unique key.
+		//hash_t : uint32_t(const key_t&), key_t needs operator==
+		template <typename key_t, typename getKey_t, typename hash_t>
+		void ParallelDedup(uint32_t count, const getKey_t& getKey, const hash_t& hashFunc, size_t expectedUniqueCount, uint32_t threadCount,
+			std::vector<uint32_t>& outIdList, std::vector<uint32_t>& outFirstElementList)
+		{
+			outIdList.resize(count);
+			if (threadCount == 0)threadCount = 1;
+
+			//one table, keys are already in order of first occurrence
+			if (threadCount == 1)
+			{
+				N_DedupHashTable<key_t, hash_t> hashTable(expectedUniqueCount, hashFunc);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					key_t key = getKey(i);
+					outIdList[i] = hashTable.FindOrInsert(key, hashFunc(key), i);
+				}
+				outFirstElementList.swap(hashTable.firstElementList);
+				return;
+			}
+
+			std::vector<uint32_t> hashList(count);
+			Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)hashList[i] = hashFunc(getKey(i));
+			});
+
+			//partition elements into buckets by high bits of hash (a bucket per thread), counting sort
+			//keeps ascending element order inside a bucket. count of each (block, bucket) first
+			auto getBucket = [threadCount](uint32_t hash) {return uint32_t((uint64_t(hash) * threadCount) >> 32); };
+			std::vector<uint32_t> blockBucketOffset(threadCount * threadCount, 0);
+			uint32_t partitionBlockCount = Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				uint32_t* pBucketCount = &blockBucketOffset[chunkId * threadCount];
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)++pBucketCount[getBucket(hashList[i])];
+			});
+
+			//offsets in bucket-major, block-minor order
+			std::vector<uint32_t> bucketBeginList(threadCount + 1, 0);
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < threadCount; ++bucket)
+			{
+				bucketBeginList[bucket] = offset;
+				for (uint32_t block = 0; block < partitionBlockCount; ++block)
+				{
+					uint32_t bucketCount = blockBucketOffset[block * threadCount + bucket];
+					blockBucketOffset[block * threadCount + bucket] = offset;
+					offset += bucketCount;
+				}
+			}
+			bucketBeginList[threadCount] = offset;
+
+			std::vector<uint32_t> bucketElementList(count);
+			Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				uint32_t* pBucketOffset = &blockBucketOffset[chunkId * threadCount];
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)bucketElementList[pBucketOffset[getBucket(hashList[i])]++] = i;
+			});
+
+			//first element of the key of each element, each thread only visits elements of its own bucket
+			std::vector<uint32_t> firstElementOf(count);
+			Ut::ParallelFor(threadCount, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t bucket = chunkBegin; bucket < chunkEnd; ++bucket)
+				{
+					uint32_t bucketBegin = bucketBeginList[bucket];
+					uint32_t bucketEnd = bucketBeginList[bucket + 1];
+					N_DedupHashTable<key_t, hash_t> hashTable(std::min<size_t>(bucketEnd - bucketBegin, expectedUniqueCount / threadCount), hashFunc);
+					for (uint32_t k = bucketBegin; k < bucketEnd; ++k)
+					{
+						uint32_t i = bucketElementList[k];
+						firstElementOf[i] = hashTable.firstElementList[hashTable.FindOrInsert(getKey(i), hashList[i], i)];
+					}
+				}
+			});
+
+			//IDs in order of first occurrence, prefix sum of each block
+			std::vector<uint32_t> blockUniqueCount(threadCount + 1, 0);
+			uint32_t blockCount = Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				uint32_t uniqueCount = 0;
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)uniqueCount += (firstElementOf[i] == i ? 1 : 0);
+				blockUniqueCount[chunkId + 1] = uniqueCount;
+			});
+			for (uint32_t i = 0; i < blockCount; ++i)blockUniqueCount[i + 1] += blockUniqueCount[i];
+
+			outFirstElementList.resize(blockUniqueCount[blockCount]);
+			Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				uint32_t id = blockUniqueCount[chunkId];
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+				{
+					if (firstElementOf[i] != i)continue;
+					outFirstElementList[id] = i;
+					outIdList[i] = id++;
+				}
+			});
+
+			//(the first element of a key is already resolved in previous pass)
+			Ut::ParallelFor(count, threadCount, [&](uint32_t chunkId, uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t i = chunkBegin; i < chunkEnd; ++i)
+				{
+					if (firstElementOf[i] != i)outIdList[i] = outIdList[firstElementOf[i]];
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,119 @@
+
+/***********************************************************************
+
+							cpp: Parallel For
+
+************************************************************************/
+
+#include "Noise3D.h"
+
+using namespace Noise3D;
+
+uint32_t Noise3D::Ut::ResolveThreadCount(uint32_t threadCount)
+{
+	if (threadCount > 0)return threadCount;
+	uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+	return hardwareThreadCount > 0 ? hardwareThreadCount : 1;
+}
+
+Ut::ParallelWorkerPool & Noise3D::Ut::ParallelWorkerPool::GetInstance()
+{
+	static ParallelWorkerPool instance;
+	return instance;
+}
+
+void Noise3D::Ut::ParallelWorkerPool::Run(uint32_t chunkCount, const std::function<void(uint32_t)>& chunkFunc)
+{
+	if (chunkCount == 0)return;
+
+	N_Job job;
+	job.pChunkFunc = &chunkFunc;
+	job.chunkCount = chunkCount;
+	job.nextChunk = 0;
+	job.finishedChunkCount = 0;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mJobQueue.push_back(&job);
+	lock.unlock();
+	if (chunkCount > 2)mJobQueuedCV.notify_all();
+	else mJobQueuedCV.notify_one();
+
+	//calling thread takes chunks of its own job until none is left (a worker might have dequeued the job already,
+	//so it's not necessarily at the front of the queue)
+	lock.lock();
+	while (job.nextChunk < job.chunkCount)
+	{
+		uint32_t chunkId = mFunction_TakeChunk(mJobQueue, job);
+		lock.unlock();
+		chunkFunc(chunkId);
+		lock.lock();
+		++job.finishedChunkCount;
+	}
+
+	//the job lives on this stack frame, wait for the chunks taken by workers
+	mChunkFinishedCV.wait(lock, [&job]() {return job.finishedChunkCount == job.chunkCount; });
+}
+
+uint32_t Noise3D::Ut::ParallelWorkerPool::GetWorkerThreadCount() const
+{
+	return mWorkerThreadList.size();
+}
+
+/***********************************************************************
+
+								PRIVATE
+
+************************************************************************/
+
+Noise3D::Ut::ParallelWorkerPool::ParallelWorkerPool():
+	mIsShutdown(false)
+{
+	//calling thread of Run() is the last worker
+	uint32_t workerCount = Ut::ResolveThreadCount(0) - 1;
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		mWorkerThreadList.push_back(std::thread(&ParallelWorkerPool::mFunction_WorkerThread, this));
+	}
+}
+
+Noise3D::Ut::ParallelWorkerPool::~ParallelWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mIsShutdown = true;
+	}
+	mJobQueuedCV.notify_all();
+	for (auto& t : mWorkerThreadList)
+	{
+		if (t.joinable())t.join();
+	}
+}
+
+void Noise3D::Ut::ParallelWorkerPool::mFunction_WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		mJobQueuedCV.wait(lock, [this]() {return mIsShutdown || !mJobQueue.empty(); });
+		if (mIsShutdown)return;
+
+		N_Job& job = *mJobQueue.front();
+		uint32_t chunkId = mFunction_TakeChunk(mJobQueue, job);
+		lock.unlock();
+		(*job.pChunkFunc)(chunkId);
+		lock.lock();
+
+		//(owner of the job might return right after this, job can't be touched afterwards)
+		if (++job.finishedChunkCount == job.chunkCount)mChunkFinishedCV.notify_all();
+	}
+}
+
+uint32_t Noise3D::Ut::ParallelWorkerPool::mFunction_TakeChunk(std::deque<N_Job*>& jobQueue, N_Job & job)
+{
+	uint32_t chunkId = job.nextChunk++;
+	if (job.nextChunk == job.chunkCount)
+	{
+		jobQueue.erase(std::find(jobQueue.begin(), jobQueue.end(), &job));
+	}
+	return chunkId;
+}
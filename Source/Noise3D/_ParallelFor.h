@@ -0,0 +1,91 @@
+
+/***********************************************************************
+
+							h: Parallel For
+		desc: data-parallel loop of BVH build, mesh import/welding, SH
+		projection etc. chunks run on persistent worker threads that are
+		shared by the whole engine (created on first use), and the calling
+		thread runs chunks too, so a nested ParallelFor never deadlocks.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	namespace Ut
+	{
+		//0 is regarded as std::thread::hardware_concurrency()
+		uint32_t ResolveThreadCount(uint32_t threadCount);
+
+		//persistent worker threads of ParallelFor()
+		class ParallelWorkerPool
+		{
+		public:
+
+			static ParallelWorkerPool& GetInstance();
+
+			//call chunkFunc(chunkId) for chunkId in [0, chunkCount) on worker threads and calling thread,
+			//return when all chunks are done
+			void Run(uint32_t chunkCount, const std::function<void(uint32_t)>& chunkFunc);
+
+			uint32_t GetWorkerThreadCount() const;
+
+		private:
+
+			//a Run() in progress, it's in the job queue until all its chunks are taken
+			struct N_Job
+			{
+				const std::function<void(uint32_t)>* pChunkFunc;
+				uint32_t chunkCount;
+				uint32_t nextChunk;
+				uint32_t finishedChunkCount;
+			};
+
+			ParallelWorkerPool();
+
+			~ParallelWorkerPool();
+
+			ParallelWorkerPool(const ParallelWorkerPool&) = delete;
+
+			ParallelWorkerPool& operator=(const ParallelWorkerPool&) = delete;
+
+			void mFunction_WorkerThread();
+
+			//take next chunk of front job (mutex must be locked), the job is dequeued when its last chunk is taken
+			static uint32_t mFunction_TakeChunk(std::deque<N_Job*>& jobQueue, N_Job& job);
+
+			std::vector<std::thread> mWorkerThreadList;
+			std::mutex mMutex;//guards job queue, job states and shut down flag
+			std::condition_variable mJobQueuedCV;
+			std::condition_variable mChunkFinishedCV;
+			std::deque<N_Job*> mJobQueue;
+			bool mIsShutdown;
+		};
+
+		//split [0, count) into at most 'threadCount' contiguous chunks, and call func(chunkId, chunkBegin, chunkEnd)
+		//for each chunk concurrently. return chunk count.
+		//chunk boundaries only depend on count and threadCount (not on which thread runs a chunk).
+		template <typename func_t>
+		uint32_t ParallelFor(uint32_t count, uint32_t threadCount, func_t&& func)
+		{
+			if (threadCount == 0)threadCount = 1;
+			if (threadCount > count)threadCount = (count > 0 ? count : 1);
+			uint32_t chunkSize = (count + threadCount - 1) / threadCount;
+			uint32_t chunkCount = (chunkSize > 0 ? (count + chunkSize - 1) / chunkSize : 1);
+			if (chunkCount == 1)
+			{
+				func(0, 0, count);
+				return 1;
+			}
+
+			std::function<void(uint32_t)> chunkFunc = [&func, count, chunkSize](uint32_t chunkId)
+			{
+				uint32_t chunkBegin = chunkId * chunkSize;
+				func(chunkId, chunkBegin, std::min<uint32_t>(count, chunkBegin + chunkSize));
+			};
+			ParallelWorkerPool::GetInstance().Run(chunkCount, chunkFunc);
+			return chunkCount;
+		}
+	}
+}
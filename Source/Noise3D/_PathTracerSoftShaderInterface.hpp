@@ -41,9 +41,20 @@ namespace Noise3D
 			//5. doesn't hit anything, might want to sample the skydome/skybox cubemap or sth
 			virtual void Miss(const N_TraceRayParam & param, N_TraceRayPayload& in_out_payload)=0;
 
+			//4'. closest hit in WAVEFRONT execution mode (optional). instead of tracing the rest of the path recursively,
+			//output radiance leaving this vertex along -param.ray.dir (it's weighted by the path throughput by caller),
+			//and the ray which continues the path. 'in_out_throughput' should be multiplied by the continuation's BSDF*cos/pdf.
+			//return false if the path ends here.
+			//by default ClosestHit() is called (which might still trace recursively), and the path ends
+			virtual bool ClosestHit_Wavefront(const N_TraceRayParam& param, const N_RayHitInfoForPathTracer& hitInfo, N_TraceRayPayload& in_out_payload, N_TraceRayParam& out_nextParam, Vec3& in_out_throughput)
+			{
+				this->ClosestHit(param, hitInfo, in_out_payload);
+				return false;
+			}
+
 		protected:
 
-			friend void PathTracer::Render(Noise3D::SceneNode*, IPathTracerSoftShader*);
+			friend class PathTracer;
 
 			void _InitInfrastructure(PathTracer* pt, CollisionTestor* ct, std::vector<GI::IGiRenderable*>&& lightSourceList)
 			{
@@ -54,11 +65,47 @@ namespace Noise3D
 
 			void _TraceRay(const N_TraceRayParam& param, N_TraceRayPayload& out_payload)
 			{
+				//shadow ray only cares about whether the target light source is visible
+				if (param.isShadowRay)
+				{
+					_TraceShadowRay(param, out_payload);
+					return;
+				}
+
 				//distance will be accumulated automatically in PathTracer::TraceRay()
 				//diffuse/specular bounces should be updated manually
 				m_pFatherPathTracer->TraceRay(param, out_payload);
 			}
 
+			//intersect the target light source first, then the segment in front of it is tested 
+			//with an occlusion(any hit) query which exits on the first blocker.
+			//if the light source is visible, ClosestHit() is called on the light source
+			void _TraceShadowRay(const N_TraceRayParam& param, N_TraceRayPayload& out_payload)
+			{
+				GI::IGiRenderable* pLight = mLightSourceList.at(param.shadowRayLightSourceId);
+				N_RayHitInfo lightHitInfo(-123456789.0f, Vec3(), Vec3(), Vec2());
+				if (!CollisionTestor::IntersectRayGiRenderable_ClosestHit(param.ray, pLight, lightHitInfo))return;
+
+				N_Ray occlusionRay = param.ray;
+				occlusionRay.t_max = lightHitInfo.t * (1.0f - 1e-3f);
+				if (m_pCollisionTestor->IntersectRaySceneAnyHit(occlusionRay))return;
+
+				this->ClosestHit(param, N_RayHitInfoForPathTracer(pLight, lightHitInfo), out_payload);
+			}
+
+			//closest hit of a ray with the scene, no shader is invoked
+			//(for shaders that trace a whole path iteratively instead of recursive _TraceRay())
+			bool _IntersectScene(const N_Ray& ray, N_RayHitInfoForPathTracer& outHitInfo)
+			{
+				return m_pCollisionTestor->IntersectRaySceneForPathTracer_ClosestHit(ray, outHitInfo);
+			}
+
+			//any hit of a ray with the scene (occlusion test of shadow rays toward sky light)
+			bool _IntersectSceneAnyHit(const N_Ray& ray)
+			{
+				return m_pCollisionTestor->IntersectRaySceneAnyHit(ray);
+			}
+
 			uint32_t _MaxBounces()
 			{
 				return m_pFatherPathTracer->GetMaxBounces();
@@ -0,0 +1,71 @@
+/***********************************************************************
+
+							h: Ray packet
+		desc: a small batch of (coherent) rays in SoA layout, so that a BVH node
+		or a triangle can be tested against several rays with one sequence of
+		SIMD instructions. used by the packet version of ray-scene/ray-mesh
+		intersection in CollisionTestor.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	//up to 16 rays, each component is stored contiguously (and aligned for AVX loads).
+	//lanes beyond 'rayCount' are kept inactive (t_min > t_max), so kernels can always
+	//process whole SIMD vectors
+	struct alignas(32) N_RayPacket
+	{
+		static const uint32_t c_maxRayCount = 16;
+
+		N_RayPacket() :rayCount(0)
+		{
+			for (uint32_t i = 0; i < c_maxRayCount; ++i)DisableRay(i);
+		}
+
+		//set ray of given lane. reciprocal of dir is computed here (tiny components are clamped
+		//to avoid 0*inf=NaN in slab tests)
+		void SetRay(uint32_t i, const N_Ray& ray)
+		{
+			originX[i] = ray.origin.x; originY[i] = ray.origin.y; originZ[i] = ray.origin.z;
+			dirX[i] = ray.dir.x; dirY[i] = ray.dir.y; dirZ[i] = ray.dir.z;
+			invDirX[i] = SIMD::SafeReciprocal(ray.dir.x);
+			invDirY[i] = SIMD::SafeReciprocal(ray.dir.y);
+			invDirZ[i] = SIMD::SafeReciprocal(ray.dir.z);
+			t_min[i] = ray.t_min;
+			t_max[i] = ray.t_max;
+		}
+
+		N_Ray GetRay(uint32_t i) const
+		{
+			return N_Ray(Vec3(originX[i], originY[i], originZ[i]), Vec3(dirX[i], dirY[i], dirZ[i]), t_min[i], t_max[i]);
+		}
+
+		//inactive lane never hits anything
+		void DisableRay(uint32_t i)
+		{
+			originX[i] = originY[i] = originZ[i] = 0.0f;
+			dirX[i] = dirY[i] = dirZ[i] = 1.0f;
+			invDirX[i] = invDirY[i] = invDirZ[i] = 1.0f;
+			t_min[i] = 1.0f;
+			t_max[i] = -1.0f;
+		}
+
+		//mask of lanes [0, rayCount)
+		uint32_t GetActiveMask() const { return rayCount >= 32 ? 0xffffffff : ((1u << rayCount) - 1u); }
+
+		float originX[c_maxRayCount];
+		float originY[c_maxRayCount];
+		float originZ[c_maxRayCount];
+		float dirX[c_maxRayCount];
+		float dirY[c_maxRayCount];
+		float dirZ[c_maxRayCount];
+		float invDirX[c_maxRayCount];
+		float invDirY[c_maxRayCount];
+		float invDirZ[c_maxRayCount];
+		float t_min[c_maxRayCount];
+		float t_max[c_maxRayCount];
+		uint32_t rayCount;
+	};
+}
@@ -0,0 +1,99 @@
+/***********************************************************************
+
+							h: SIMD float
+		desc: thin wrappers of SSE/AVX instructions, so that SIMD kernels
+		(ray packet, wide BVH node tests) are written once for every width.
+		lane masks of comparison results are converted to bit masks by SimdMoveMask.
+
+************************************************************************/
+
+#pragma once
+
+//SIMD width, decided at compile time:
+//AVX(8-wide) if compiled with /arch:AVX(2), SSE(4-wide) on x64 or /arch:SSE(2),
+//otherwise (or NOISE_SIMD_FORCE_SCALAR is defined) a portable scalar fallback
+#if defined(NOISE_SIMD_FORCE_SCALAR)
+#define NOISE_SIMD_WIDTH 1
+#elif defined(__AVX__)
+#define NOISE_SIMD_WIDTH 8
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NOISE_SIMD_WIDTH 4
+#include <xmmintrin.h>
+#else
+#define NOISE_SIMD_WIDTH 1
+#endif
+
+namespace Noise3D
+{
+	namespace SIMD
+	{
+#if NOISE_SIMD_WIDTH == 8
+		typedef __m256 simd_float;
+		typedef __m256 simd_mask;
+		inline simd_float SimdLoad(const float* p) { return _mm256_load_ps(p); }
+		inline simd_float SimdLoadUnaligned(const float* p) { return _mm256_loadu_ps(p); }
+		inline simd_float SimdSet1(float x) { return _mm256_set1_ps(x); }
+		inline void SimdStore(float* p, simd_float a) { _mm256_store_ps(p, a); }
+		inline simd_float SimdAdd(simd_float a, simd_float b) { return _mm256_add_ps(a, b); }
+		inline simd_float SimdSub(simd_float a, simd_float b) { return _mm256_sub_ps(a, b); }
+		inline simd_float SimdMul(simd_float a, simd_float b) { return _mm256_mul_ps(a, b); }
+		inline simd_float SimdDiv(simd_float a, simd_float b) { return _mm256_div_ps(a, b); }
+		inline simd_float SimdMin(simd_float a, simd_float b) { return _mm256_min_ps(a, b); }
+		inline simd_float SimdMax(simd_float a, simd_float b) { return _mm256_max_ps(a, b); }
+		inline simd_float SimdAbs(simd_float a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		inline simd_mask SimdLessEqual(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		inline simd_mask SimdGreater(simd_float a, simd_float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		inline simd_mask SimdAnd(simd_mask a, simd_mask b) { return _mm256_and_ps(a, b); }
+		inline simd_float SimdSelect(simd_mask m, simd_float a, simd_float b) { return _mm256_blendv_ps(b, a, m); }
+		inline uint32_t SimdMoveMask(simd_mask m) { return uint32_t(_mm256_movemask_ps(m)); }
+#elif NOISE_SIMD_WIDTH == 4
+		typedef __m128 simd_float;
+		typedef __m128 simd_mask;
+		inline simd_float SimdLoad(const float* p) { return _mm_load_ps(p); }
+		inline simd_float SimdLoadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+		inline simd_float SimdSet1(float x) { return _mm_set1_ps(x); }
+		inline void SimdStore(float* p, simd_float a) { _mm_store_ps(p, a); }
+		inline simd_float SimdAdd(simd_float a, simd_float b) { return _mm_add_ps(a, b); }
+		inline simd_float SimdSub(simd_float a, simd_float b) { return _mm_sub_ps(a, b); }
+		inline simd_float SimdMul(simd_float a, simd_float b) { return _mm_mul_ps(a, b); }
+		inline simd_float SimdDiv(simd_float a, simd_float b) { return _mm_div_ps(a, b); }
+		inline simd_float SimdMin(simd_float a, simd_float b) { return _mm_min_ps(a, b); }
+		inline simd_float SimdMax(simd_float a, simd_float b) { return _mm_max_ps(a, b); }
+		inline simd_float SimdAbs(simd_float a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		inline simd_mask SimdLessEqual(simd_float a, simd_float b) { return _mm_cmple_ps(a, b); }
+		inline simd_mask SimdGreater(simd_float a, simd_float b) { return _mm_cmpgt_ps(a, b); }
+		inline simd_mask SimdAnd(simd_mask a, simd_mask b) { return _mm_and_ps(a, b); }
+		inline simd_float SimdSelect(simd_mask m, simd_float a, simd_float b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+		inline uint32_t SimdMoveMask(simd_mask m) { return uint32_t(_mm_movemask_ps(m)); }
+#else
+		typedef float simd_float;
+		typedef bool simd_mask;
+		inline simd_float SimdLoad(const float* p) { return *p; }
+		inline simd_float SimdLoadUnaligned(const float* p) { return *p; }
+		inline simd_float SimdSet1(float x) { return x; }
+		inline void SimdStore(float* p, simd_float a) { *p = a; }
+		inline simd_float SimdAdd(simd_float a, simd_float b) { return a + b; }
+		inline simd_float SimdSub(simd_float a, simd_float b) { return a - b; }
+		inline simd_float SimdMul(simd_float a, simd_float b) { return a * b; }
+		inline simd_float SimdDiv(simd_float a, simd_float b) { return a / b; }
+		inline simd_float SimdMin(simd_float a, simd_float b) { return a < b ? a : b; }
+		inline simd_float SimdMax(simd_float a, simd_float b) { return a > b ? a : b; }
+		inline simd_float SimdAbs(simd_float a) { return std::abs(a); }
+		inline simd_mask SimdLessEqual(simd_float a, simd_float b) { return a <= b; }
+		inline simd_mask SimdGreater(simd_float a, simd_float b) { return a > b; }
+		inline simd_mask SimdAnd(simd_mask a, simd_mask b) { return a && b; }
+		inline simd_float SimdSelect(simd_mask m, simd_float a, simd_float b) { return m ? a : b; }
+		inline uint32_t SimdMoveMask(simd_mask m) { return m ? 1u : 0u; }
+#endif
+
+		//1/x with tiny x clamped (sign kept), so slab tests never compute 0*inf=NaN
+		inline float SafeReciprocal(float x)
+		{
+			const float c_tiny = 1e-18f;
+			if (x >= 0.0f && x < c_tiny)return 1.0f / c_tiny;
+			if (x < 0.0f && x > -c_tiny)return -1.0f / c_tiny;
+			return 1.0f / x;
+		}
+	}
+}
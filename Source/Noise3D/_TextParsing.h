@@ -0,0 +1,170 @@
+/***********************************************************************
+
+							h: Text Parsing
+		desc: hand-rolled scanning of numbers and keywords in (memory mapped)
+		text buffers, for text mesh formats like OBJ and ASCII STL.
+		no locale, no iostream, no copy of tokens. a cursor is advanced
+		through [p, pEnd) and never dereferenced at pEnd.
+
+************************************************************************/
+
+#pragma once
+
+namespace Noise3D
+{
+	namespace Ut
+	{
+		inline bool TextIsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+
+		inline bool TextIsDigit(char c) { return uint8_t(c - '0') < 10; }
+
+		//skip spaces and tabs (but not '\n')
+		inline void TextSkipSpaces(const char*& p, const char* pEnd)
+		{
+			while (p < pEnd && TextIsSpace(*p))++p;
+		}
+
+		//move to the first char of next line
+		inline void TextSkipLine(const char*& p, const char* pEnd)
+		{
+			const char* pNewLine = static_cast<const char*>(::memchr(p, '\n', size_t(pEnd - p)));
+			p = (pNewLine == nullptr) ? pEnd : pNewLine + 1;
+		}
+
+		//split [pBegin, pEnd) into at most 'chunkCount' pieces of similar size on line boundaries (a piece
+		//begins at the first char of a line). outBoundaryList keeps (piece count + 1) pointers
+		inline void TextSplitLines(const char* pBegin, const char* pEnd, uint32_t chunkCount, std::vector<const char*>& outBoundaryList)
+		{
+			outBoundaryList.clear();
+			outBoundaryList.push_back(pBegin);
+			if (chunkCount == 0)chunkCount = 1;
+			size_t chunkSize = size_t(pEnd - pBegin) / chunkCount;
+			for (uint32_t i = 1; i < chunkCount; ++i)
+			{
+				const char* p = pBegin + chunkSize * i;
+				if (p <= outBoundaryList.back())continue;
+				TextSkipLine(p, pEnd);
+				if (p >= pEnd)break;
+				if (p > outBoundaryList.back())outBoundaryList.push_back(p);
+			}
+			outBoundaryList.push_back(pEnd);
+		}
+
+		//the rest of current line without leading/trailing spaces (cursor is not moved)
+		inline std::string TextGetRestOfLine(const char* p, const char* pEnd)
+		{
+			TextSkipSpaces(p, pEnd);
+			const char* pLineEnd = p;
+			while (pLineEnd < pEnd && *pLineEnd != '\n')++pLineEnd;
+			while (pLineEnd > p && TextIsSpace(*(pLineEnd - 1)))--pLineEnd;
+			return std::string(p, pLineEnd);
+		}
+
+		//whether the token at cursor is 'keyword' (followed by a space or end of line). cursor moves behind it if matched
+		inline bool TextMatchKeyword(const char*& p, const char* pEnd, const char* keyword, size_t keywordLength)
+		{
+			if (size_t(pEnd - p) < keywordLength || ::memcmp(p, keyword, keywordLength) != 0)return false;
+			const char* pNext = p + keywordLength;
+			if (pNext < pEnd && !TextIsSpace(*pNext) && *pNext != '\n')return false;
+			p = pNext;
+			return true;
+		}
+
+		//decimal integer with optional sign. a value that doesn't fit saturates to +-INT64_MAX (all digits are consumed),
+		//so e.g. a corrupted face index fails the caller's range check instead of overflowing
+		inline bool TextParseInt(const char*& p, const char* pEnd, int64_t& outValue)
+		{
+			const char* s = p;
+			bool isNegative = false;
+			if (s < pEnd && (*s == '-' || *s == '+'))isNegative = (*(s++) == '-');
+			if (s >= pEnd || !TextIsDigit(*s))return false;
+
+			const int64_t c_maxValue = std::numeric_limits<int64_t>::max();
+			int64_t value = 0;
+			while (s < pEnd && TextIsDigit(*s))
+			{
+				int64_t digit = *(s++) - '0';
+				value = (value <= (c_maxValue - digit) / 10) ? value * 10 + digit : c_maxValue;
+			}
+			outValue = isNegative ? -value : value;
+			p = s;
+			return true;
+		}
+
+		//decimal real number like "-1.25", "3", ".5", "1e-3". (at most 19 significant digits are used)
+		inline bool TextParseFloat(const char*& p, const char* pEnd, float& outValue)
+		{
+			static const double c_pow10[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+			const char* s = p;
+			bool isNegative = false;
+			if (s < pEnd && (*s == '-' || *s == '+'))isNegative = (*(s++) == '-');
+
+			uint64_t mantissa = 0;
+			int significantDigitCount = 0;
+			int exponent = 0;
+			bool hasDigit = false;
+
+			//integer part
+			while (s < pEnd && TextIsDigit(*s))
+			{
+				hasDigit = true;
+				if (significantDigitCount < 19)
+				{
+					mantissa = mantissa * 10 + uint64_t(*s - '0');
+					if (mantissa != 0)++significantDigitCount;
+				}
+				else
+				{
+					++exponent;
+				}
+				++s;
+			}
+
+			//fraction part
+			if (s < pEnd && *s == '.')
+			{
+				++s;
+				while (s < pEnd && TextIsDigit(*s))
+				{
+					hasDigit = true;
+					if (significantDigitCount < 19)
+					{
+						mantissa = mantissa * 10 + uint64_t(*s - '0');
+						if (mantissa != 0)++significantDigitCount;
+						--exponent;
+					}
+					++s;
+				}
+			}
+			if (!hasDigit)return false;
+
+			//exponent part (only consumed if it's well-formed)
+			if (s < pEnd && (*s == 'e' || *s == 'E'))
+			{
+				const char* e = s + 1;
+				int64_t expValue = 0;
+				if (TextParseInt(e, pEnd, expValue))
+				{
+					exponent += int(std::max<int64_t>(std::min<int64_t>(expValue, 1000), -1000));
+					s = e;
+				}
+			}
+
+			double value = double(mantissa);
+			if (exponent > 0)
+			{
+				value *= (exponent <= 22) ? c_pow10[exponent] : std::pow(10.0, double(exponent));
+			}
+			else if (exponent < 0)
+			{
+				value /= (-exponent <= 22) ? c_pow10[-exponent] : std::pow(10.0, double(-exponent));
+			}
+			outValue = float(isNegative ? -value : value);
+			p = s;
+			return true;
+		}
+	}
+}
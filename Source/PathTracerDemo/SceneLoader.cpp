@@ -6,6 +6,7 @@ void SceneLoader::Init(SceneManager* pMgr)
 	m_pScene = pMgr;
 	m_pMeshMgr = m_pScene->GetMeshMgr();
 	m_pModelLoader = m_pScene->GetMeshLoader();
+	m_pModelLoader->SetMeshCacheEnabled(true);//.n3dmesh next to OBJ/STL assets, reloading skips parsing and BVH build
 	m_pMatMgr = m_pScene->GetMaterialMgr();
 	m_pTexMgr = m_pScene->GetTextureMgr();
 	m_pShapeMgr = m_pScene->GetLogicalShapeMgr();
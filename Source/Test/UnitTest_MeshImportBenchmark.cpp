@@ -0,0 +1,415 @@
+//load-time benchmark of mesh importers (generated large files)
+#include "Noise3D.h"
+#include <iostream>
+#include <chrono>
+
+using namespace Noise3D;
+
+//a (n x n) quad grid, each quad is a polygon face "f v/vt/vn" (fan-triangulated by the importer)
+static uint64_t GenerateGridOBJ(const std::string& filePath, uint32_t n)
+{
+	std::ofstream fileOut(filePath);
+	fileOut << "# generated grid " << n << "x" << n << "\n";
+	fileOut << "o grid\nusemtl default\n";
+	for (uint32_t y = 0; y <= n; ++y)
+		for (uint32_t x = 0; x <= n; ++x)
+			fileOut << "v " << float(x) * 0.01f << " " << float(y) * 0.01f << " " << 0.001f * float((x * y) % 7) << "\n";
+	for (uint32_t y = 0; y <= n; ++y)
+		for (uint32_t x = 0; x <= n; ++x)
+			fileOut << "vt " << float(x) / float(n) << " " << float(y) / float(n) << "\n";
+	fileOut << "vn 0 0 1\n";
+	for (uint32_t y = 0; y < n; ++y)
+	{
+		for (uint32_t x = 0; x < n; ++x)
+		{
+			uint32_t a = y * (n + 1) + x + 1, b = a + 1, c = a + n + 2, d = a + n + 1;
+			fileOut << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 " << c << "/" << c << "/1 " << d << "/" << d << "/1\n";
+		}
+	}
+	fileOut.close();
+
+	std::ifstream fileIn(filePath, std::ios::binary | std::ios::ate);
+	return uint64_t(fileIn.tellg());
+}
+
+//ASCII STL of a (n x n) quad grid, 2 facets per quad
+static uint64_t GenerateGridSTL_Ascii(const std::string& filePath, uint32_t n)
+{
+	std::ofstream fileOut(filePath);
+	fileOut << "solid grid\n";
+	auto WriteFacet = [&fileOut](float x0, float y0, float x1, float y1, float x2, float y2)
+	{
+		fileOut << "  facet normal 0 0 1\n    outer loop\n";
+		fileOut << "      vertex " << x0 << " " << y0 << " 0\n";
+		fileOut << "      vertex " << x1 << " " << y1 << " 0\n";
+		fileOut << "      vertex " << x2 << " " << y2 << " 0\n";
+		fileOut << "    endloop\n  endfacet\n";
+	};
+	for (uint32_t y = 0; y < n; ++y)
+	{
+		for (uint32_t x = 0; x < n; ++x)
+		{
+			float x0 = float(x) * 0.01f, y0 = float(y) * 0.01f, x1 = x0 + 0.01f, y1 = y0 + 0.01f;
+			WriteFacet(x0, y0, x1, y0, x1, y1);
+			WriteFacet(x0, y0, x1, y1, x0, y1);
+		}
+	}
+	fileOut << "endsolid grid\n";
+	fileOut.close();
+
+	std::ifstream fileIn(filePath, std::ios::binary | std::ios::ate);
+	return uint64_t(fileIn.tellg());
+}
+
+//the same grid as triangle soup, written by the binary STL exporter
+static uint64_t GenerateGridSTL_Binary(IFileIO& fileIO, const std::string& filePath, uint32_t n)
+{
+	std::vector<Vec3> vertexList;
+	vertexList.reserve(6 * n * n);
+	for (uint32_t y = 0; y < n; ++y)
+	{
+		for (uint32_t x = 0; x < n; ++x)
+		{
+			float x0 = float(x) * 0.01f, y0 = float(y) * 0.01f, x1 = float(x + 1) * 0.01f, y1 = float(y + 1) * 0.01f;
+			Vec3 quad[4] = { Vec3(x0, 0, y0), Vec3(x1, 0, y0), Vec3(x1, 0, y1), Vec3(x0, 0, y1) };
+			vertexList.push_back(quad[0]); vertexList.push_back(quad[1]); vertexList.push_back(quad[2]);
+			vertexList.push_back(quad[0]); vertexList.push_back(quad[2]); vertexList.push_back(quad[3]);
+		}
+	}
+	fileIO.ExportFile_STL_Binary(filePath, "grid", vertexList);
+
+	std::ifstream fileIn(filePath, std::ios::binary | std::ios::ate);
+	return uint64_t(fileIn.tellg());
+}
+
+//hand-written OBJ, every line is followed by a comment line, so that the file is big enough to be
+//split into chunks and chunk boundaries fall between statements
+static void WriteTestOBJ(const std::string& filePath, const std::vector<std::string>& lineList)
+{
+	std::ofstream fileOut(filePath);
+	std::string paddingLine = "#" + std::string(IFileIO::c_parallelParseMinFileSize_OBJ / lineList.size() + 1, '-');
+	for (auto& line : lineList)fileOut << line << "\n" << paddingLine << "\n";
+}
+
+//expected corner of a triangle, normal is only checked if it's given by 'vn'
+struct N_ExpectedOBJCorner
+{
+	Vec3 pos;
+	Vec2 texcoord;
+	Vec3 normal;
+	bool isNormalGiven;
+};
+
+struct N_OBJTestCase
+{
+	std::string name;
+	std::vector<std::string> lineList;
+	bool isValid;//out-of-range indices are rejected
+	std::vector<N_ExpectedOBJCorner> cornerList;//3 per triangle
+	size_t vertexCount;
+	std::vector<N_MeshSubsetInfo> subsetList;
+};
+
+static N_MeshSubsetInfo MakeSubset(UINT startPrimitiveID, UINT primitiveCount, const std::string& matName)
+{
+	N_MeshSubsetInfo subset;
+	subset.startPrimitiveID = startPrimitiveID;
+	subset.primitiveCount = primitiveCount;
+	subset.matName = matName;
+	return subset;
+}
+
+static std::vector<N_OBJTestCase> MakeOBJTestCases()
+{
+	const std::vector<std::string> quadLineList = { "v 0 0 0", "v 1 0 0", "v 1 1 0", "v 0 1 0" };
+	const Vec3 p[6] = { Vec3(0,0,0), Vec3(1,0,0), Vec3(1,1,0), Vec3(0,1,0), Vec3(0.5f,1.5f,0), Vec3(-0.5f,1.0f,0) };
+	const Vec2 t[3] = { Vec2(0,0), Vec2(1,0), Vec2(1,1) };
+	const Vec3 n = Vec3(0, 0, 1);
+	auto C = [](Vec3 pos, Vec2 texcoord, const Vec3* pNormal)
+	{
+		return N_ExpectedOBJCorner{ pos, texcoord, pNormal ? *pNormal : Vec3(0,0,0), pNormal != nullptr };
+	};
+	std::vector<N_OBJTestCase> caseList;
+
+	//negative (relative) indices and corner formats "v//vn", "v/vt", "v"
+	N_OBJTestCase c1;
+	c1.name = "corner formats";
+	c1.lineList = quadLineList;
+	c1.lineList.insert(c1.lineList.end(), { "vt 0 0", "vt 1 0", "vt 1 1", "vn 0 0 1",
+		"f -4//-1 -3//-1 -2//-1", "f 1/1 2/2 3/3", "f 1 3 4", "f -4/-3 -2/-1 -1/-1" });
+	c1.isValid = true;
+	c1.cornerList = {
+		C(p[0], Vec2(0,0), &n), C(p[1], Vec2(0,0), &n), C(p[2], Vec2(0,0), &n),
+		C(p[0], t[0], nullptr), C(p[1], t[1], nullptr), C(p[2], t[2], nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[0], t[0], nullptr), C(p[2], t[2], nullptr), C(p[3], t[2], nullptr) };
+	c1.vertexCount = 10;
+	c1.subsetList = { MakeSubset(0, 4, "") };
+	caseList.push_back(c1);
+
+	//polygons of 5 and 6 corners are fan-triangulated
+	N_OBJTestCase c2;
+	c2.name = "polygons";
+	c2.lineList = quadLineList;
+	c2.lineList.insert(c2.lineList.end(), { "v 0.5 1.5 0", "v -0.5 1 0", "f 1 2 3 5 4", "f -6 -5 -4 -2 -3 -1" });
+	c2.isValid = true;
+	c2.cornerList = {
+		C(p[0], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[4], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[4], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[4], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[4], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr), C(p[5], Vec2(0,0), nullptr) };
+	c2.vertexCount = 6;
+	c2.subsetList = { MakeSubset(0, 7, "") };
+	caseList.push_back(c2);
+
+	//'o'/'g'/'usemtl' become subsets: empty groups are removed, 'usemtl' is inherited by following groups
+	N_OBJTestCase c3;
+	c3.name = "groups";
+	c3.lineList = quadLineList;
+	c3.lineList.insert(c3.lineList.end(), { "f 1 2 3", "o objA", "usemtl red", "f 1 3 4", "f 1 2 3",
+		"g empty", "g partB", "f 2 3 4", "usemtl blue", "f 1 2 4", "g partC", "f 4 3 2" });
+	c3.isValid = true;
+	c3.cornerList = {
+		C(p[0], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr),
+		C(p[1], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[0], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr), C(p[3], Vec2(0,0), nullptr),
+		C(p[3], Vec2(0,0), nullptr), C(p[2], Vec2(0,0), nullptr), C(p[1], Vec2(0,0), nullptr) };
+	c3.vertexCount = 4;
+	c3.subsetList = { MakeSubset(0, 1, ""), MakeSubset(1, 2, "red"), MakeSubset(3, 1, "red"),
+		MakeSubset(4, 1, "blue"), MakeSubset(5, 1, "blue") };
+	caseList.push_back(c3);
+
+	//out-of-range indices (absolute/relative, v/vt/vn, index 0) are rejected
+	const char* badFaceList[6] = { "f 1 2 5", "f 0 1 2", "f -5 1 2", "f 1/4 2/1 3/1", "f 1//2 2//1 3//1", "f 1/-4 2/1 3/1" };
+	for (const char* badFace : badFaceList)
+	{
+		N_OBJTestCase c4;
+		c4.name = std::string("reject \"") + badFace + "\"";
+		c4.lineList = quadLineList;
+		c4.lineList.insert(c4.lineList.end(), { "vt 0 0", "vt 1 0", "vt 1 1", "vn 0 0 1", "f 1 2 3", badFace, "f 1 3 4" });
+		c4.isValid = false;
+		c4.vertexCount = 0;
+		caseList.push_back(c4);
+	}
+
+	return caseList;
+}
+
+//small hand-written files, with 1 thread and several threads (chunks are merged then)
+void UnitTest_OBJImportCases()
+{
+	IFileIO fileIO;
+	std::vector<N_OBJTestCase> caseList = MakeOBJTestCases();
+	uint32_t threadCountList[4] = { 1, 2, 3, 8 };
+
+	for (uint32_t i = 0; i < caseList.size(); ++i)
+	{
+		const N_OBJTestCase& c = caseList[i];
+		std::string filePath = "test_case_" + std::to_string(i) + ".obj";
+		WriteTestOBJ(filePath, c.lineList);
+
+		for (uint32_t threadCount : threadCountList)
+		{
+			std::vector<N_DefaultVertex> vertexList;
+			std::vector<UINT> indexList;
+			std::vector<N_MeshSubsetInfo> subsetList;
+			bool isSucceeded = false;
+			try
+			{
+				isSucceeded = fileIO.ImportFile_OBJ(filePath, vertexList, indexList, subsetList, threadCount);
+			}
+			catch (std::exception e)
+			{
+				isSucceeded = false;
+			}
+
+			bool isCorrect = (isSucceeded == c.isValid);
+			if (isCorrect && c.isValid)
+			{
+				isCorrect = indexList.size() == c.cornerList.size() && vertexList.size() == c.vertexCount && subsetList.size() == c.subsetList.size();
+				for (size_t j = 0; isCorrect && j < indexList.size(); ++j)
+				{
+					const N_DefaultVertex& v = vertexList[indexList[j]];
+					const N_ExpectedOBJCorner& expected = c.cornerList[j];
+					isCorrect = v.Pos == expected.pos && v.TexCoord == expected.texcoord && (!expected.isNormalGiven || v.Normal == expected.normal);
+				}
+				for (size_t j = 0; isCorrect && j < subsetList.size(); ++j)
+				{
+					isCorrect = subsetList[j].startPrimitiveID == c.subsetList[j].startPrimitiveID &&
+						subsetList[j].primitiveCount == c.subsetList[j].primitiveCount && subsetList[j].matName == c.subsetList[j].matName;
+				}
+			}
+			std::cout << "OBJ case " << c.name << ", " << threadCount << " threads: " << (isCorrect ? "ok" : "[WRONG RESULT]") << std::endl;
+		}
+	}
+}
+
+void UnitTest_OBJImportBenchmark()
+{
+	IFileIO fileIO;
+	uint32_t gridSizeList[3] = { 100, 500, 1000 };
+
+	for (uint32_t n : gridSizeList)
+	{
+		std::string filePath = "benchmark_grid_" + std::to_string(n) + ".obj";
+		GenerateGridOBJ(filePath, n);
+
+		//1 thread, then all hardware threads (chunks are only parsed in parallel for big files)
+		std::vector<N_DefaultVertex> vertexList[2];
+		std::vector<UINT> indexList[2];
+		std::vector<N_MeshSubsetInfo> subsetList[2];
+		uint32_t threadCountList[2] = { 1, 0 };
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			bool isSucceeded = fileIO.ImportFile_OBJ(filePath, vertexList[i], indexList[i], subsetList[i], threadCountList[i]);
+
+			//quad grid: (n+1)^2 unique vertices, 2n^2 triangles
+			bool isCorrect = isSucceeded && vertexList[i].size() == (n + 1) * (n + 1) && indexList[i].size() == 6 * n * n && subsetList[i].size() == 1;
+			std::cout << "OBJ grid " << n << "x" << n << ": " << fileIO.GetLastImportReport_OBJ().ToString()
+				<< (isCorrect ? "" : "  [WRONG RESULT]\n");
+		}
+
+		//result doesn't depend on thread count
+		bool isSame = (indexList[0] == indexList[1]) && vertexList[0].size() == vertexList[1].size() &&
+			memcmp(vertexList[0].data(), vertexList[1].data(), vertexList[0].size() * sizeof(N_DefaultVertex)) == 0;
+		if (!isSame)std::cout << "  [RESULT DEPENDS ON THREAD COUNT]" << std::endl;
+	}
+}
+
+void UnitTest_STLAsciiImportBenchmark()
+{
+	IFileIO fileIO;
+	uint32_t gridSizeList[3] = { 100, 300, 600 };
+
+	for (uint32_t n : gridSizeList)
+	{
+		std::string filePath = "benchmark_grid_" + std::to_string(n) + ".stl";
+		GenerateGridSTL_Ascii(filePath, n);
+
+		std::vector<Vec3> vertexList[2];
+		std::vector<UINT> indexList[2];
+		std::vector<Vec3> normalList[2];
+		std::string fileInfo[2];
+		uint32_t threadCountList[2] = { 1, 0 };
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			bool isSucceeded = fileIO.ImportFile_STL(filePath, vertexList[i], indexList[i], normalList[i], fileInfo[i], threadCountList[i]);
+
+			//triangle soup: 3 vertices per facet
+			bool isCorrect = isSucceeded && vertexList[i].size() == 6 * n * n && normalList[i].size() == 2 * n * n && fileInfo[i] == "grid";
+			std::cout << "STL ascii grid " << n << "x" << n << ": " << fileIO.GetLastImportReport_STL().ToString()
+				<< (isCorrect ? "" : "  [WRONG RESULT]\n");
+		}
+
+		bool isSame = vertexList[0].size() == vertexList[1].size() &&
+			memcmp(vertexList[0].data(), vertexList[1].data(), vertexList[0].size() * sizeof(Vec3)) == 0;
+		if (!isSame)std::cout << "  [RESULT DEPENDS ON THREAD COUNT]" << std::endl;
+	}
+}
+
+void UnitTest_STLBinaryImportBenchmark()
+{
+	IFileIO fileIO;
+	uint32_t gridSizeList[3] = { 100, 500, 1000 };
+
+	for (uint32_t n : gridSizeList)
+	{
+		std::string filePath = "benchmark_grid_" + std::to_string(n) + "_binary.stl";
+		GenerateGridSTL_Binary(fileIO, filePath, n);
+
+		//triangle soup (records are read in place)
+		std::vector<Vec3> soupVertexList;
+		std::vector<UINT> soupIndexList;
+		std::vector<Vec3> soupNormalList;
+		std::string fileInfo;
+		bool isSucceeded = fileIO.ImportFile_STL(filePath, soupVertexList, soupIndexList, soupNormalList, fileInfo);
+		bool isCorrect = isSucceeded && soupVertexList.size() == 6 * n * n && soupNormalList.size() == 2 * n * n;
+		std::cout << "STL binary grid " << n << "x" << n << " (soup): " << fileIO.GetLastImportReport_STL().ToString()
+			<< (isCorrect ? "" : "  [WRONG RESULT]\n");
+
+		//welded, 1 thread then all hardware threads
+		std::vector<Vec3> vertexList[2];
+		std::vector<UINT> indexList[2];
+		std::vector<Vec3> normalList[2];
+		uint32_t threadCountList[2] = { 1, 0 };
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			isSucceeded = fileIO.ImportFile_STL_Indexed(filePath, vertexList[i], indexList[i], normalList[i], fileInfo, threadCountList[i]);
+
+			//quad grid: (n+1)^2 shared vertices, and the same triangles as the soup
+			isCorrect = isSucceeded && vertexList[i].size() == (n + 1) * (n + 1) && indexList[i].size() == 6 * n * n;
+			for (size_t j = 0; isCorrect && j < indexList[i].size(); ++j)
+			{
+				isCorrect = (vertexList[i][indexList[i][j]] == soupVertexList[j]);
+			}
+			std::cout << "STL binary grid " << n << "x" << n << " (welded): " << fileIO.GetLastImportReport_STL().ToString()
+				<< (isCorrect ? "" : "  [WRONG RESULT]\n");
+		}
+
+		bool isSame = (indexList[0] == indexList[1]) && vertexList[0].size() == vertexList[1].size() &&
+			memcmp(vertexList[0].data(), vertexList[1].data(), vertexList[0].size() * sizeof(Vec3)) == 0;
+		if (!isSame)std::cout << "  [RESULT DEPENDS ON THREAD COUNT]" << std::endl;
+	}
+}
+
+//the same grid loaded from OBJ text and from .n3dmesh cache
+void UnitTest_N3DMESHLoadBenchmark()
+{
+	IFileIO fileIO;
+	uint32_t gridSizeList[3] = { 100, 500, 1000 };
+
+	for (uint32_t n : gridSizeList)
+	{
+		std::string objFilePath = "benchmark_grid_" + std::to_string(n) + ".obj";
+		std::string cacheFilePath = objFilePath + ".n3dmesh";
+		GenerateGridOBJ(objFilePath, n);
+
+		std::vector<N_DefaultVertex> vertexList;
+		std::vector<UINT> indexList;
+		std::vector<N_MeshSubsetInfo> subsetList;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		fileIO.ImportFile_OBJ(objFilePath, vertexList, indexList, subsetList);
+		auto t1 = std::chrono::high_resolution_clock::now();
+
+		N_AABB aabb;
+		for (auto& v : vertexList)aabb.Union(N_AABB(v.Pos, v.Pos));
+		N_N3DMeshSourceKey sourceKey;
+		IFileIO::ComputeSourceKey_N3DMESH(objFilePath, 0, true, sourceKey);
+		fileIO.ExportFile_N3DMESH(cacheFilePath, vertexList, indexList, subsetList, aabb, std::vector<N_BvhLinearNode>(), std::vector<uint32_t>(), sourceKey);
+
+		std::vector<N_DefaultVertex> cachedVertexList;
+		std::vector<UINT> cachedIndexList;
+		std::vector<N_MeshSubsetInfo> cachedSubsetList;
+		std::vector<N_BvhLinearNode> cachedBvhNodeList;
+		std::vector<uint32_t> cachedBvhTriangleIdList;
+		N_AABB cachedAabb;
+		N_N3DMeshSourceKey cachedSourceKey;
+		auto t2 = std::chrono::high_resolution_clock::now();
+		bool isSucceeded = fileIO.ImportFile_N3DMESH(cacheFilePath, cachedVertexList, cachedIndexList, cachedSubsetList, cachedAabb,
+			cachedBvhNodeList, cachedBvhTriangleIdList, cachedSourceKey);
+		auto t3 = std::chrono::high_resolution_clock::now();
+
+		bool isSame = isSucceeded && cachedIndexList == indexList && cachedVertexList.size() == vertexList.size() &&
+			memcmp(cachedVertexList.data(), vertexList.data(), vertexList.size() * sizeof(N_DefaultVertex)) == 0 &&
+			cachedSubsetList.size() == subsetList.size() && cachedSourceKey == sourceKey;
+		std::cout << "N3DMESH grid " << n << "x" << n << ": OBJ " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+			<< "ms, n3dmesh " << std::chrono::duration<double, std::milli>(t3 - t2).count() << "ms"
+			<< (isSame ? "" : "  [WRONG RESULT]") << std::endl;
+	}
+}
+
+int main()
+{
+	UnitTest_OBJImportCases();
+	UnitTest_OBJImportBenchmark();
+	UnitTest_STLAsciiImportBenchmark();
+	UnitTest_STLBinaryImportBenchmark();
+	UnitTest_N3DMESHLoadBenchmark();
+	system("pause");
+	return 0;
+}
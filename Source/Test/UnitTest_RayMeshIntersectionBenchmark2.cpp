@@ -97,21 +97,86 @@ BOOL Init3D(HWND hwnd)
 
 #define STREAM file
 
-	//method1
-	timer.ResetAll();
-	timer.NextTick();
-	for (int i = 0; i < c_rayCount; ++i)
+	//method1 (BVH, compare build methods)
+	const NOISE_BVH_BUILD_METHOD buildMethods[2] = { NOISE_BVH_BUILD_METHOD::MIDPOINT, NOISE_BVH_BUILD_METHOD::SAH_BINNED };
+	const char* buildMethodNames[2] = { "midpoint", "SAH binned" };
+	for (int methodId = 0; methodId < 2; ++methodId)
 	{
-		N_RayHitResult tmpHitRes;
-		const N_Ray& ray = rayArray.at(i);
-		bool intersect1 = pCT->IntersectRayMeshWithBvh(ray, pMesh, tmpHitRes);
-		hitRes.Union(tmpHitRes);
+		timer.ResetAll();
+		timer.NextTick();
+		pMesh->GetBvhTree().SetBuildMethod(buildMethods[methodId]);
+		pMesh->RebuildBvhTree();
+		timer.NextTick();
+		const N_BvhBuildStatistics& stat = pMesh->GetBvhTree().GetBuildStatistics();
+		STREAM << "BVH build method: " << buildMethodNames[methodId] << '\n';
+		STREAM << "build time:" << timer.GetTotalTimeElapsed() << '\n';
+		STREAM << "nodeCount:" << stat.nodeCount << " leafCount:" << stat.leafNodeCount << " maxDepth:" << stat.maxDepth << '\n';
+		STREAM << "maxLeafPrimitiveCount:" << stat.maxLeafPrimitiveCount << " SAH cost:" << stat.sahCost << '\n';
+
+		hitRes.hitList.clear();
+		timer.ResetAll();
+		timer.NextTick();
+		for (int i = 0; i < c_rayCount; ++i)
+		{
+			N_RayHitResult tmpHitRes;
+			const N_Ray& ray = rayArray.at(i);
+			bool intersect1 = pCT->IntersectRayMeshWithBvh(ray, pMesh, tmpHitRes);
+			hitRes.Union(tmpHitRes);
+		}
+		timer.NextTick();
+		STREAM << "method: BVH" << '\n';
+		STREAM << "triCount:" << pMesh->GetTriangleCount() << '\n';
+		STREAM << "rayCount:" << c_rayCount << '\n';
+		STREAM << "time:" << timer.GetTotalTimeElapsed() << '\n';
+
+		//binary BVH vs collapsed wide BVH
+		STREAM << "wideNodeCount:" << stat.wideNodeCount << " (width:" << N_BvhWideNode::c_width << ")" << '\n';
+		for (int isWide = 0; isWide < 2; ++isWide)
+		{
+			CollisionTestor::SetWideBvhTraversalEnabled(isWide != 0);
+			timer.ResetAll();
+			timer.NextTick();
+			for (int i = 0; i < c_rayCount; ++i)
+			{
+				N_RayHitInfo hitInfo(0.0f, Vec3(), Vec3(), Vec2());
+				pCT->IntersectRayMeshWithBvh_ClosestHit(rayArray.at(i), pMesh, hitInfo);
+			}
+			timer.NextTick();
+			STREAM << "method: BVH closest hit" << (isWide ? " (wide BVH)" : " (binary BVH)") << '\n';
+			STREAM << "time:" << timer.GetTotalTimeElapsed() << '\n';
+		}
+
+		//rays sharing the origin are grouped into packets(16), compare with the single ray version
+		uint32_t mismatchCount = 0;
+		std::vector<N_RayHitInfo> packetHitInfoList;
+		timer.ResetAll();
+		timer.NextTick();
+		for (int i = 0; i < c_rayCount; i += N_RayPacket::c_maxRayCount)
+		{
+			N_RayPacket packet;
+			packet.rayCount = std::min<uint32_t>(N_RayPacket::c_maxRayCount, c_rayCount - i);
+			for (uint32_t j = 0; j < packet.rayCount; ++j)packet.SetRay(j, rayArray.at(i + j));
+			pCT->IntersectRayPacketMeshWithBvh_ClosestHit(packet, pMesh, packetHitInfoList);
+		}
+		timer.NextTick();
+		for (int i = 0; i < c_rayCount; i += N_RayPacket::c_maxRayCount)
+		{
+			N_RayPacket packet;
+			packet.rayCount = std::min<uint32_t>(N_RayPacket::c_maxRayCount, c_rayCount - i);
+			for (uint32_t j = 0; j < packet.rayCount; ++j)packet.SetRay(j, rayArray.at(i + j));
+			uint32_t hitMask = pCT->IntersectRayPacketMeshWithBvh_ClosestHit(packet, pMesh, packetHitInfoList);
+			for (uint32_t j = 0; j < packet.rayCount; ++j)
+			{
+				N_RayHitInfo hitInfo(0.0f, Vec3(), Vec3(), Vec2());
+				bool isHit = pCT->IntersectRayMeshWithBvh_ClosestHit(rayArray.at(i + j), pMesh, hitInfo);
+				bool isPacketHit = (hitMask & (1u << j)) != 0;
+				if (isHit != isPacketHit || (isHit && hitInfo.triangleIndex != packetHitInfoList.at(j).triangleIndex))++mismatchCount;
+			}
+		}
+		STREAM << "method: BVH ray packet closest hit (SIMD width:" << CollisionTestor::GetRayPacketSimdWidth() << ")" << '\n';
+		STREAM << "time:" << timer.GetTotalTimeElapsed() << '\n';
+		STREAM << "mismatch with single ray:" << mismatchCount << '\n';
 	}
-	timer.NextTick();
-	STREAM << "method: BVH" << '\n';
-	STREAM << "triCount:" << pMesh->GetTriangleCount() << '\n';
-	STREAM << "rayCount:" << c_rayCount << '\n';
-	STREAM << "time:" << timer.GetTotalTimeElapsed() << '\n';
 
 	//method2
 	timer.ResetAll();
@@ -83,9 +83,73 @@ void UnitTest_WignerMatrixConstruction()
 	OutputWignerMatrixByIndex();
 }
 
+//rotated SH signal evaluated at rotated directions should equal the original signal, and timing of
+//rotating many SH vectors with the same rotation (batched) vs one by one
+void UnitTest_SHRotationZXZXZ()
+{
+	Ut::Timer timer(Ut::NOISE_TIMER_TIMEUNIT_MILLISECOND);
+	GI::RandomSampleGenerator g;
+	const int coefficientCount = (c_bandWidth + 1)*(c_bandWidth + 1);
+	std::vector<NColor4f> shVector(coefficientCount);
+	for (int i = 0; i < coefficientCount; ++i)shVector.at(i) = NColor4f(g.NormalizedReal(), g.NormalizedReal(), g.NormalizedReal(), 1.0f);
+
+	RigidTransform t;
+	t.SetRotation(Vec3(0.3f, 0.5f, 0.7f));
+	GI::SHRotationZXZXZ rotation(c_bandWidth);
+	rotation.SetRotation(t);
+	std::vector<NColor4f> rotatedShVector;
+	rotation.Rotate(shVector, rotatedShVector);
+
+	float maxError = 0.0f;
+	for (int i = 0; i < 1000; ++i)
+	{
+		Vec3 dir = g.UniformSphericalVec();
+		Vec3 rotatedDir = t.TransformVector_Rigid(dir) - t.GetPosition();
+		std::vector<float> basis, rotatedBasis;
+		GI::SH_EvalBatch(c_bandWidth, std::vector<Vec3>(1, dir), basis);
+		GI::SH_EvalBatch(c_bandWidth, std::vector<Vec3>(1, rotatedDir), rotatedBasis);
+		float value = 0.0f, rotatedValue = 0.0f;
+		for (int j = 0; j < coefficientCount; ++j)
+		{
+			value += shVector.at(j).x * basis.at(j);
+			rotatedValue += rotatedShVector.at(j).x * rotatedBasis.at(j);
+		}
+		maxError = std::max<float>(maxError, std::abs(value - rotatedValue));
+	}
+	std::cout << "ZXZXZ rotation, band " << c_bandWidth << " max error:" << maxError << std::endl;
+
+	const int vectorCount = 10000;
+	std::vector<std::vector<NColor4f>> inList(vectorCount, shVector), outList(vectorCount);
+	std::vector<const std::vector<NColor4f>*> inPtrList;
+	std::vector<std::vector<NColor4f>*> outPtrList;
+	for (int i = 0; i < vectorCount; ++i)
+	{
+		inPtrList.push_back(&inList.at(i));
+		outPtrList.push_back(&outList.at(i));
+	}
+
+	timer.ResetAll();
+	timer.NextTick();
+	for (int i = 0; i < vectorCount; ++i)
+	{
+		GI::SHRotationZXZXZ r(c_bandWidth);
+		r.SetRotation(t);
+		r.Rotate(inList.at(i), outList.at(i));
+	}
+	timer.NextTick();
+	std::cout << vectorCount << " vectors, one by one:" << timer.GetTotalTimeElapsed() << "ms" << std::endl;
+
+	timer.ResetAll();
+	timer.NextTick();
+	rotation.Rotate(inPtrList, outPtrList);
+	timer.NextTick();
+	std::cout << vectorCount << " vectors, batched:" << timer.GetTotalTimeElapsed() << "ms" << std::endl;
+}
+
 int main()
 {
 	UnitTest_WignerMatrixConstruction();
+	UnitTest_SHRotationZXZXZ();
 	system("pause");
 	return 0;
 }
\ No newline at end of file
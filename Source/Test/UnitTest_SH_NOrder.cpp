@@ -79,9 +79,54 @@ void UnitTest_Factorial()
 	std::cout << std::endl;
 }
 
+//SH_EvalBatch vs SH() (hardcoded band 0~4 + SH_Recursive beyond), max error and time of all basis of many directions
+void UnitTest_SH_EvalBatch()
+{
+	Ut::Timer timer(Ut::NOISE_TIMER_TIMEUNIT_MILLISECOND);
+	GI::RandomSampleGenerator g;
+	const int dirCount = 100000;
+	std::vector<Vec3> dirList(dirCount);
+	for (int i = 0; i < dirCount; ++i)dirList.at(i) = g.UniformSphericalVec();
+
+	for (int order = 2; order <= 8; order += 2)
+	{
+		int coefficientCount = (order + 1) * (order + 1);
+		std::vector<float> scalarBasis(coefficientCount * dirCount);
+		timer.ResetAll();
+		timer.NextTick();
+		for (int i = 0; i < dirCount; ++i)
+		{
+			for (int l = 0; l <= order; ++l)
+			{
+				for (int m = -l; m <= l; ++m)
+				{
+					scalarBasis.at(GI::SH_FlattenIndex(l, m) * dirCount + i) = GI::SH(l, m, dirList.at(i));
+				}
+			}
+		}
+		timer.NextTick();
+		double scalarTime = timer.GetTotalTimeElapsed();
+
+		std::vector<float> batchBasis;
+		timer.ResetAll();
+		timer.NextTick();
+		GI::SH_EvalBatch(order, dirList, batchBasis);
+		timer.NextTick();
+		double batchTime = timer.GetTotalTimeElapsed();
+
+		float maxError = 0.0f;
+		for (int i = 0; i < coefficientCount * dirCount; ++i)
+		{
+			maxError = std::max<float>(maxError, std::abs(scalarBasis.at(i) - batchBasis.at(i)));
+		}
+		std::cout << "order " << order << ": max error:" << maxError << "  [SH] " << scalarTime << "ms  [SH_EvalBatch] " << batchTime << "ms" << std::endl;
+	}
+}
+
 int main()
 {
 	UnitTest_SH_Recursive();
+	UnitTest_SH_EvalBatch();
 	system("pause");
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+
+//sampler convergence benchmark:
+//a small image of a diffuse hemisphere(normal varies per pixel) lit by an analytic sky with a sun lobe
+//is rendered with cosine-weighted hemisphere sampling. RMSE against a reference image is
+//compared between samplers over sample counts.
+
+#include "Noise3D.h"
+#include <sstream>
+#include <iostream>
+
+using namespace Noise3D;
+
+Ut::Timer timer(Ut::NOISE_TIMER_TIMEUNIT_MILLISECOND);
+
+const uint32_t c_imageSize = 32;
+const uint64_t c_seed = 12345;
+
+//analytic environment radiance
+float SkyRadiance(Vec3 dir)
+{
+	Vec3 sunDir = Vec3(0.4f, 0.8f, 0.3f);
+	sunDir.Normalize();
+	float sky = 0.5f * std::max<float>(dir.y, 0.0f) + 0.1f;
+	float sun = 8.0f * std::pow(std::max<float>(dir.Dot(sunDir), 0.0f), 32.0f);
+	return sky + sun;
+}
+
+//normal of the pixel on a hemisphere facing the viewer (+z)
+Vec3 PixelNormal(uint32_t x, uint32_t y)
+{
+	float u = (float(x) + 0.5f) / float(c_imageSize) * 2.0f - 1.0f;
+	float v = 1.0f - (float(y) + 0.5f) / float(c_imageSize) * 2.0f;
+	float r2 = std::min<float>(u * u + v * v, 0.99f);
+	Vec3 n = Vec3(u, v, std::sqrt(1.0f - r2));
+	n.Normalize();
+	return n;
+}
+
+//render the image with 'spp' cosine-weighted samples per pixel.
+//isOnePointPerCall: each sample is a separate call with its sample index (like path tracer's pixel samples)
+void RenderImage(const GI::ISampler* pSampler, uint32_t spp, uint64_t seed, bool isOnePointPerCall, std::vector<float>& outImage)
+{
+	GI::RandomSampleGenerator g;
+	outImage.resize(c_imageSize * c_imageSize);
+	for (uint32_t y = 0; y < c_imageSize; ++y)
+	{
+		for (uint32_t x = 0; x < c_imageSize; ++x)
+		{
+			uint32_t pixelId = y * c_imageSize + x;
+			GI::RandomSampleGenerator::SeedThreadLocalEngine(GI::RandomSampleGenerator::ComputeSeed(seed, pixelId));
+
+			std::vector<Vec3> dirList;
+			std::vector<float> pdfList;
+			if (isOnePointPerCall)
+			{
+				for (uint32_t i = 0; i < spp; ++i)
+				{
+					GI::RandomSampleGenerator::SetThreadLocalSampler(pSampler, x, y, seed, i);
+					g.CosinePdfSphericalVec_Cone(PixelNormal(x, y), Ut::PI / 2.0f, 1, dirList, pdfList);
+				}
+			}
+			else
+			{
+				GI::RandomSampleGenerator::SetThreadLocalSampler(pSampler, x, y, seed);
+				g.CosinePdfSphericalVec_Cone(PixelNormal(x, y), Ut::PI / 2.0f, spp, dirList, pdfList);
+			}
+
+			//lambertian, albedo = 1: L_o = 1/N * sum(L * (1/pi) * cos / pdf)
+			Vec3 n = PixelNormal(x, y);
+			float sum = 0.0f;
+			for (uint32_t i = 0; i < spp; ++i)
+			{
+				float cosTerm = std::max<float>(n.Dot(dirList.at(i)), 0.0f);
+				if (pdfList.at(i) > 0.0f)sum += SkyRadiance(dirList.at(i)) * cosTerm / (Ut::PI * pdfList.at(i));
+			}
+			outImage.at(pixelId) = sum / float(spp);
+		}
+	}
+	GI::RandomSampleGenerator::SetThreadLocalSampler(nullptr);
+}
+
+float ComputeRMSE(const std::vector<float>& image, const std::vector<float>& reference)
+{
+	double sum = 0.0;
+	for (uint32_t i = 0; i < image.size(); ++i)
+	{
+		double diff = double(image.at(i)) - double(reference.at(i));
+		sum += diff * diff;
+	}
+	return float(std::sqrt(sum / double(image.size())));
+}
+
+int main()
+{
+	GI::Sampler_Random samplerRandom;
+	GI::Sampler_Sobol samplerSobol;
+	GI::Sampler_Halton samplerHalton;
+	timer.ResetAll();
+	timer.NextTick();
+	GI::Sampler_BlueNoiseDither samplerBlueNoise;
+	timer.NextTick();
+	std::cout << "blue noise mask generation time:" << timer.GetTotalTimeElapsed() << std::endl;
+
+	const GI::ISampler* samplers[4] = { &samplerRandom, &samplerSobol, &samplerHalton, &samplerBlueNoise };
+	const char* samplerNames[4] = { "random", "sobol(owen)", "halton", "blue noise dither" };
+
+	//reference image(high sample count, different seed)
+	std::cout << "rendering reference..." << std::endl;
+	std::vector<float> referenceImage;
+	RenderImage(&samplerSobol, 16384, c_seed + 1, false, referenceImage);
+
+	std::ofstream file("sampler_convergence.txt", std::ios::out | std::ios::trunc);
+#define STREAM file
+
+	STREAM << "image:" << c_imageSize << "x" << c_imageSize << '\n';
+	for (int samplerId = 0; samplerId < 4; ++samplerId)
+	{
+		STREAM << "sampler: " << samplerNames[samplerId] << '\n';
+		for (uint32_t spp = 1; spp <= 256; spp *= 2)
+		{
+			std::vector<float> image;
+			timer.ResetAll();
+			timer.NextTick();
+			RenderImage(samplers[samplerId], spp, c_seed, false, image);
+			timer.NextTick();
+
+			//a point per call must give the same points as a batch
+			std::vector<float> imageOnePointPerCall;
+			RenderImage(samplers[samplerId], spp, c_seed, true, imageOnePointPerCall);
+			STREAM << "spp:" << spp << " RMSE:" << ComputeRMSE(image, referenceImage) << " time:" << timer.GetTotalTimeElapsed()
+				<< " RMSE(a point per call):" << ComputeRMSE(imageOnePointPerCall, referenceImage) << '\n';
+		}
+	}
+	file.close();
+
+	std::cout << "done. result is written to sampler_convergence.txt" << std::endl;
+	system("pause");
+	return 0;
+}
@@ -0,0 +1,94 @@
+//unit test for cpu-end float/half texture sampling (TextureCpuPixelStore)
+#include "Noise3D.h"
+#include <iostream>
+
+using namespace Noise3D;
+
+static float ColorDiff(const Color4f& a, const Color4f& b)
+{
+	return std::max<float>(std::max<float>(std::abs(a.x - b.x), std::abs(a.y - b.y)), std::max<float>(std::abs(a.z - b.z), std::abs(a.w - b.w)));
+}
+
+void UnitTest_TextureSampling()
+{
+	const uint32_t width = 512, height = 256;
+	std::vector<Color4f> pixelList(width * height);
+	GI::RandomSampleGenerator gen;
+	for (auto& c : pixelList)c = Color4f(gen.NormalizedReal() * 8.0f, gen.NormalizedReal(), gen.NormalizedReal(), 1.0f);
+
+	const uint32_t sampleCount = 1000000;
+	std::vector<Vec2> texcoordList(sampleCount);
+	for (auto& uv : texcoordList)uv = Vec2(gen.NormalizedReal() * 3.0f - 1.0f, gen.NormalizedReal() * 3.0f - 1.0f);
+
+	TextureCpuPixelStore storeF32, storeF16;
+	storeF32.Create(width, height, &pixelList.at(0), NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT32, true);
+	storeF16.Create(width, height, &pixelList.at(0), NOISE_TEXTURE_CPU_PIXEL_FORMAT::FLOAT16, true);
+	std::cout << "mip level count:" << storeF32.GetMipLevelCount() << std::endl;
+
+	Ut::Timer timer(Ut::NOISE_TIMER_TIMEUNIT_MILLISECOND);
+	NOISE_TEXTURE_CPU_WRAP_MODE modeList[2] = { NOISE_TEXTURE_CPU_WRAP_MODE::REPEAT, NOISE_TEXTURE_CPU_WRAP_MODE::CLAMP };
+	for (auto mode : modeList)
+	{
+		storeF32.SetWrapMode(mode);
+		storeF16.SetWrapMode(mode);
+		std::cout << (mode == NOISE_TEXTURE_CPU_WRAP_MODE::REPEAT ? "[REPEAT]" : "[CLAMP]") << std::endl;
+
+		//scalar vs batch bilinear
+		std::vector<Color4f> scalarList(sampleCount), batchList(sampleCount), halfList(sampleCount);
+		timer.ResetAll();
+		timer.NextTick();
+		for (uint32_t i = 0; i < sampleCount; ++i)scalarList.at(i) = storeF32.SampleBilinear(texcoordList.at(i));
+		timer.NextTick();
+		double scalarTime = timer.GetTotalTimeElapsed();
+
+		timer.ResetAll();
+		timer.NextTick();
+		storeF32.SampleBilinear(sampleCount, &texcoordList.at(0), 0, &batchList.at(0));
+		timer.NextTick();
+		double batchTime = timer.GetTotalTimeElapsed();
+
+		timer.ResetAll();
+		timer.NextTick();
+		storeF16.SampleBilinear(sampleCount, &texcoordList.at(0), 0, &halfList.at(0));
+		timer.NextTick();
+		double halfTime = timer.GetTotalTimeElapsed();
+
+		float maxBatchError = 0.0f, maxHalfError = 0.0f;
+		for (uint32_t i = 0; i < sampleCount; ++i)
+		{
+			maxBatchError = std::max<float>(maxBatchError, ColorDiff(scalarList.at(i), batchList.at(i)));
+			//half has 11 significant bits
+			maxHalfError = std::max<float>(maxHalfError, ColorDiff(scalarList.at(i), halfList.at(i)) / std::max<float>(1.0f, scalarList.at(i).x));
+		}
+		std::cout << "bilinear: batch max error:" << maxBatchError << "  half max relative error:" << maxHalfError << std::endl;
+		std::cout << "[scalar] " << scalarTime << "ms  [batch] " << batchTime << "ms  [batch half] " << halfTime << "ms" << std::endl;
+
+		//trilinear, lod between level 1 and 2
+		const float lod = 1.3f;
+		storeF32.SampleTrilinear(sampleCount, &texcoordList.at(0), lod, &batchList.at(0));
+		float maxTrilinearError = 0.0f;
+		for (uint32_t i = 0; i < sampleCount; ++i)
+		{
+			Color4f c = storeF32.SampleTrilinear(texcoordList.at(i), lod);
+			maxTrilinearError = std::max<float>(maxTrilinearError, ColorDiff(c, batchList.at(i)));
+		}
+		std::cout << "trilinear: batch max error:" << maxTrilinearError << std::endl;
+	}
+
+	//texel center must return exact texel; the last mip level is the average of all pixels
+	Color4f center = storeF32.SampleBilinear(Vec2(10.5f / float(width), 20.5f / float(height)));
+	std::cout << "texel center error:" << ColorDiff(center, pixelList.at(20 * width + 10)) << std::endl;
+	Color4f average = Color4f(0, 0, 0, 0);
+	for (auto& c : pixelList)average += c;
+	average /= float(pixelList.size());
+	uint32_t lastLevel = storeF32.GetMipLevelCount() - 1;
+	std::cout << "last mip level " << storeF32.GetWidth(lastLevel) << "x" << storeF32.GetHeight(lastLevel)
+		<< " average error:" << ColorDiff(storeF32.GetPixel(lastLevel, 0, 0), average) << std::endl;
+}
+
+int main()
+{
+	UnitTest_TextureSampling();
+	system("pause");
+	return 0;
+}
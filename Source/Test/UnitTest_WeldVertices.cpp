@@ -0,0 +1,116 @@
+//vertex welding: grid clustering compared with the O(n^2) greedy definition
+#include "Noise3D.h"
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+using namespace Noise3D;
+
+//a vertex joins the first earlier seed within tolerance, or becomes a new seed
+static uint32_t ClusterVertices_Reference(const std::vector<N_DefaultVertex>& vb, float tolerance, std::vector<uint32_t>& outClusterIdList)
+{
+	std::vector<uint32_t> seedList;
+	outClusterIdList.resize(vb.size());
+	for (uint32_t i = 0; i < vb.size(); ++i)
+	{
+		uint32_t clusterId = uint32_t(seedList.size());
+		for (uint32_t s = 0; s < seedList.size(); ++s)
+		{
+			Vec3 d = vb[i].Pos - vb[seedList[s]].Pos;
+			if (d.LengthSquared() <= tolerance * tolerance)
+			{
+				clusterId = s;
+				break;
+			}
+		}
+		if (clusterId == seedList.size())seedList.push_back(i);
+		outClusterIdList[i] = clusterId;
+	}
+	return uint32_t(seedList.size());
+}
+
+static N_DefaultVertex MakeVertex(Vec3 pos)
+{
+	N_DefaultVertex v = {};
+	v.Pos = pos;
+	return v;
+}
+
+//lattice of spacing 0.25 around the origin (exact in float), points are duplicated and shuffled.
+//neighbors are exactly 'tolerance' apart and lie on cell boundaries when tolerance is 0.25 or 0.5
+static std::vector<N_DefaultVertex> MakeLatticeVertices(std::mt19937& rng)
+{
+	std::vector<N_DefaultVertex> vb;
+	for (int z = -4; z <= 4; ++z)
+	{
+		for (int y = -4; y <= 4; ++y)
+		{
+			for (int x = -4; x <= 4; ++x)
+			{
+				Vec3 pos = Vec3(float(x), float(y), float(z)) * 0.25f;
+				uint32_t duplicateCount = 1 + rng() % 3;
+				for (uint32_t i = 0; i < duplicateCount; ++i)vb.push_back(MakeVertex(pos));
+				if (x == 0)vb.push_back(MakeVertex(Vec3(-0.0f, pos.y, pos.z)));
+			}
+		}
+	}
+	std::shuffle(vb.begin(), vb.end(), rng);
+	return vb;
+}
+
+//random points with jittered duplicates (like a triangle soup of a scanned model)
+static std::vector<N_DefaultVertex> MakeJitteredVertices(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> posDist(0.0f, 10.0f), jitterDist(-0.004f, 0.004f);
+	std::vector<N_DefaultVertex> vb;
+	for (uint32_t i = 0; i < 2000; ++i)
+	{
+		Vec3 pos = Vec3(posDist(rng), posDist(rng), posDist(rng));
+		uint32_t duplicateCount = 1 + rng() % 6;
+		for (uint32_t j = 0; j < duplicateCount; ++j)vb.push_back(MakeVertex(pos + Vec3(jitterDist(rng), jitterDist(rng), jitterDist(rng))));
+	}
+	std::shuffle(vb.begin(), vb.end(), rng);
+	return vb;
+}
+
+void Noise3D::UnitTest_ClusterVertices_Grid()
+{
+	struct N_WeldTestSet
+	{
+		std::string name;
+		std::vector<N_DefaultVertex> vertexList;
+		std::vector<float> toleranceList;
+	};
+
+	std::mt19937 rng(7);
+	N_WeldTestSet setList[2] = {
+		{ "lattice(spacing 0.25)", MakeLatticeVertices(rng), { 0.2f, 0.25f, 0.3f, 0.5f } },
+		{ "jittered soup", MakeJitteredVertices(rng), { 0.004f, 0.01f, 0.3f, 1.5f } } };
+	uint32_t threadCountList[5] = { 1, 2, 3, 7, 16 };
+
+	ModelProcessor modelProcessor;
+	for (auto& set : setList)
+	{
+		for (float tolerance : set.toleranceList)
+		{
+			std::vector<uint32_t> referenceIdList;
+			uint32_t referenceCount = ClusterVertices_Reference(set.vertexList, tolerance, referenceIdList);
+
+			for (uint32_t threadCount : threadCountList)
+			{
+				std::vector<uint32_t> clusterIdList;
+				uint32_t clusterCount = modelProcessor.mFunction_ClusterVertices_Grid(set.vertexList, tolerance, threadCount, clusterIdList);
+				bool isCorrect = (clusterCount == referenceCount && clusterIdList == referenceIdList);
+				std::cout << "weld " << set.name << ", tolerance " << tolerance << ", " << threadCount << " threads: "
+					<< set.vertexList.size() << " vertices -> " << clusterCount << " clusters" << (isCorrect ? "" : "  [WRONG RESULT]") << std::endl;
+			}
+		}
+	}
+}
+
+int main()
+{
+	Noise3D::UnitTest_ClusterVertices_Grid();
+	system("pause");
+	return 0;
+}